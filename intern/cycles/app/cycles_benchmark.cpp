@@ -0,0 +1,688 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Headless benchmark
+ *
+ * Renders a fixed set of procedurally generated XML scenes, each stressing a different part of
+ * the renderer, and reports the time spent syncing, updating the scene and building BVHs,
+ * rendering and denoising, along with peak device memory, as JSON. Scenes are generated from a
+ * fixed seed, so results of different builds can be compared. */
+
+#include <stdio.h>
+
+#include "device/device.h"
+#include "render/buffers.h"
+#include "render/camera.h"
+#include "render/film.h"
+#include "render/scene.h"
+#include "render/session.h"
+#include "render/stats.h"
+
+#include "util/util_args.h"
+#include "util/util_foreach.h"
+#include "util/util_hash.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+#include "util/util_path.h"
+#include "util/util_string.h"
+#include "util/util_system.h"
+#include "util/util_task.h"
+#include "util/util_time.h"
+#include "util/util_version.h"
+
+#include "app/cycles_xml.h"
+
+CCL_NAMESPACE_BEGIN
+
+struct BenchmarkOptions {
+  DeviceInfo device;
+  int threads;
+  int samples;
+  int width, height;
+  bool denoise;
+  /* Comma separated names of the scenes to render, all when empty. */
+  string scenes;
+  string scene_dir;
+  string output_path;
+  bool quiet;
+};
+
+struct BenchmarkResult {
+  string name;
+  bool success;
+  double sync_time;
+  SceneTimes times;
+  double total_time;
+  size_t peak_device_memory;
+  size_t num_objects;
+  size_t num_lights;
+};
+
+/* Scene Generation
+ *
+ * Positions are random but deterministic, from a hash of the element index and a seed per use. */
+
+static float benchmark_random(uint index, uint seed)
+{
+  return hash_uint2_to_float(index, seed);
+}
+
+static string xml_float3(const float3 &f)
+{
+  return string_printf("%g %g %g", (double)f.x, (double)f.y, (double)f.z);
+}
+
+static string xml_emission_shader(const char *name)
+{
+  string xml = string_printf("<shader name=\"%s\">\n", name);
+  xml += "  <emission name=\"e\" color=\"1 1 1\" strength=\"1\"/>\n";
+  xml += "  <connect from=\"e emission\" to=\"output surface\"/>\n";
+  return xml + "</shader>\n";
+}
+
+/* Camera, sky and the emission shader used by all lights. */
+static string xml_header(const BenchmarkOptions &options)
+{
+  string xml = "<cycles>\n";
+  xml += "<transform translate=\"0 1.5 -8\" rotate=\"10 1 0 0\">\n";
+  xml += string_printf(
+      "  <camera width=\"%d\" height=\"%d\" fov=\"0.7\"/>\n", options.width, options.height);
+  xml += "</transform>\n";
+  xml += "<background>\n";
+  xml += "  <background name=\"bg\" color=\"0.5 0.6 0.8\" strength=\"0.5\"/>\n";
+  xml += "  <connect from=\"bg background\" to=\"output surface\"/>\n";
+  xml += "</background>\n";
+  xml += xml_emission_shader("lamp");
+  return xml;
+}
+
+static string xml_footer()
+{
+  return "</cycles>\n";
+}
+
+static string xml_diffuse_shader(const char *name, const float3 &color)
+{
+  string xml = string_printf("<shader name=\"%s\">\n", name);
+  xml += "  <diffuse_bsdf name=\"d\" color=\"" + xml_float3(color) + "\"/>\n";
+  xml += "  <connect from=\"d bsdf\" to=\"output surface\"/>\n";
+  return xml + "</shader>\n";
+}
+
+static string xml_sun(const char *dir, float angle)
+{
+  return string_printf(
+      "<state shader=\"lamp\"><light type=\"distant\" dir=\"%s\" strength=\"3 3 3\" "
+      "angle=\"%g\"/></state>\n",
+      dir,
+      (double)angle);
+}
+
+/* Grid of quads in the XZ plane, facing up. */
+static string xml_grid_mesh(int resolution, float size, const char *extra_attributes = "")
+{
+  string P, verts, nverts;
+
+  for (int j = 0; j <= resolution; j++) {
+    for (int i = 0; i <= resolution; i++) {
+      const float x = size * ((float)i / resolution - 0.5f);
+      const float z = size * ((float)j / resolution - 0.5f);
+      P += xml_float3(make_float3(x, 0.0f, z)) + " ";
+    }
+  }
+
+  for (int j = 0; j < resolution; j++) {
+    for (int i = 0; i < resolution; i++) {
+      const int v = i + j * (resolution + 1);
+      verts += string_printf("%d %d %d %d ", v, v + resolution + 1, v + resolution + 2, v + 1);
+      nverts += "4 ";
+    }
+  }
+
+  return string_printf("<mesh %s P=\"%s\" verts=\"%s\" nverts=\"%s\"/>\n",
+                       extra_attributes,
+                       P.c_str(),
+                       verts.c_str(),
+                       nverts.c_str());
+}
+
+/* Sphere of quads with triangles at the poles, facing outwards. */
+static string xml_sphere_mesh(int segments, int rings, const char *extra_attributes = "")
+{
+  string P = "0 1 0 0 -1 0 ";
+  string verts, nverts;
+
+  for (int r = 1; r < rings; r++) {
+    const float theta = M_PI_F * r / rings;
+    for (int s = 0; s < segments; s++) {
+      const float phi = M_2PI_F * s / segments;
+      P += xml_float3(make_float3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)));
+      P += " ";
+    }
+  }
+
+  for (int r = 0; r < rings; r++) {
+    for (int s = 0; s < segments; s++) {
+      const int s1 = (s + 1) % segments;
+      const int upper = 2 + (r - 1) * segments, lower = 2 + r * segments;
+
+      if (r == 0) {
+        verts += string_printf("0 %d %d ", lower + s1, lower + s);
+        nverts += "3 ";
+      }
+      else if (r == rings - 1) {
+        verts += string_printf("%d %d 1 ", upper + s, upper + s1);
+        nverts += "3 ";
+      }
+      else {
+        verts += string_printf("%d %d %d %d ", upper + s, upper + s1, lower + s1, lower + s);
+        nverts += "4 ";
+      }
+    }
+  }
+
+  return string_printf("<mesh %s P=\"%s\" verts=\"%s\" nverts=\"%s\"/>\n",
+                       extra_attributes,
+                       P.c_str(),
+                       verts.c_str(),
+                       nverts.c_str());
+}
+
+static string xml_ground()
+{
+  string xml = "<state shader=\"ground\">\n";
+  xml += "<transform translate=\"0 0 4\">\n" + xml_grid_mesh(1, 40.0f) + "</transform>\n";
+  return xml + "</state>\n";
+}
+
+/* Thousands of instances of a few meshes, scattered over the ground. */
+static string benchmark_scene_instancing(const BenchmarkOptions &options)
+{
+  const int num_instances = 4000;
+
+  string xml = xml_header(options);
+  xml += xml_diffuse_shader("ground", make_float3(0.5f, 0.5f, 0.5f));
+  xml += "<shader name=\"rock\">\n";
+  xml += "  <principled_bsdf name=\"p\" base_color=\"0.4 0.35 0.3\" roughness=\"0.6\"/>\n";
+  xml += "  <connect from=\"p bsdf\" to=\"output surface\"/>\n";
+  xml += "</shader>\n";
+  xml += xml_sun("-0.3 -1 0.4", 0.05f);
+  xml += xml_ground();
+
+  xml += "<state shader=\"rock\" interpolation=\"smooth\">\n";
+  xml += "<transform translate=\"0 0.5 0\" scale=\"0.5 0.5 0.5\">\n";
+  xml += xml_sphere_mesh(32, 16, "name=\"rock\"");
+  xml += "</transform>\n";
+  xml += "<transform translate=\"1.5 0.4 1\" scale=\"0.8 0.4 0.8\">\n";
+  xml += xml_sphere_mesh(12, 6, "name=\"pebble\"");
+  xml += "</transform>\n";
+
+  for (int i = 0; i < num_instances; i++) {
+    const float3 co = make_float3(16.0f * benchmark_random(i, 0) - 8.0f,
+                                  0.0f,
+                                  16.0f * benchmark_random(i, 1) - 2.0f);
+    const float scale = 0.05f + 0.2f * benchmark_random(i, 2);
+    const float angle = 360.0f * benchmark_random(i, 3);
+
+    xml += string_printf(
+        "<transform translate=\"%s\" rotate=\"%g 0 1 0\" scale=\"%g %g %g\">",
+        xml_float3(co + make_float3(0.0f, scale * 0.5f, 0.0f)).c_str(),
+        (double)angle,
+        (double)scale,
+        (double)(scale * (0.5f + benchmark_random(i, 4))),
+        (double)scale);
+    xml += string_printf("<instance geometry=\"%s\"/></transform>\n",
+                         (i % 3 == 0) ? "rock" : "pebble");
+  }
+  xml += "</state>\n";
+
+  return xml + xml_footer();
+}
+
+/* A sphere covered in curves, rendered with the principled hair BSDF. */
+static string benchmark_scene_hair(const BenchmarkOptions &options)
+{
+  const int num_curves = 20000;
+  const int num_keys = 6;
+
+  string xml = xml_header(options);
+  xml += xml_diffuse_shader("ground", make_float3(0.5f, 0.5f, 0.5f));
+  xml += xml_diffuse_shader("skin", make_float3(0.8f, 0.6f, 0.5f));
+  xml += "<shader name=\"hair\">\n";
+  xml += "  <principled_hair_bsdf name=\"h\" melanin=\"0.5\" roughness=\"0.25\"/>\n";
+  xml += "  <connect from=\"h bsdf\" to=\"output surface\"/>\n";
+  xml += "</shader>\n";
+  xml += xml_sun("0.5 -1 0.6", 0.1f);
+  xml += xml_ground();
+
+  xml += "<transform translate=\"0 1.2 0\">\n";
+  xml += "<state shader=\"skin\" interpolation=\"smooth\">\n";
+  xml += xml_sphere_mesh(32, 16);
+  xml += "</state>\n";
+
+  /* Curves grow along the normal of the upper part of the sphere and droop down. */
+  string P, radius, nkeys;
+  for (int i = 0; i < num_curves; i++) {
+    const float theta = 0.55f * M_PI_F * sqrtf(benchmark_random(i, 0));
+    const float phi = M_2PI_F * benchmark_random(i, 1);
+    const float3 N = make_float3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+    const float length = 0.4f + 0.4f * benchmark_random(i, 2);
+
+    for (int k = 0; k < num_keys; k++) {
+      const float t = (float)k / (num_keys - 1);
+      const float3 co = N * (1.0f + length * t) - make_float3(0.0f, 0.6f * length * t * t, 0.0f);
+      P += xml_float3(co) + " ";
+      radius += string_printf("%g ", (double)(0.004f * (1.0f - 0.8f * t)));
+    }
+    nkeys += string_printf("%d ", num_keys);
+  }
+
+  xml += "<state shader=\"hair\">\n";
+  xml += string_printf("<hair P=\"%s\" radius=\"%s\" nkeys=\"%s\"/>\n",
+                       P.c_str(),
+                       radius.c_str(),
+                       nkeys.c_str());
+  xml += "</state>\n";
+  xml += "</transform>\n";
+
+  return xml + xml_footer();
+}
+
+/* Heterogeneous volume from a noise texture, lit by a point light. */
+static string benchmark_scene_volume(const BenchmarkOptions &options)
+{
+  string xml = xml_header(options);
+  xml += xml_diffuse_shader("ground", make_float3(0.5f, 0.5f, 0.5f));
+  xml += "<shader name=\"smoke\">\n";
+  xml += "  <texture_coordinate name=\"tc\"/>\n";
+  xml += "  <noise_texture name=\"n\" scale=\"2\" detail=\"4\"/>\n";
+  xml += "  <principled_volume name=\"v\" color=\"0.8 0.8 0.8\" anisotropy=\"0.3\"/>\n";
+  xml += "  <connect from=\"tc object\" to=\"n vector\"/>\n";
+  xml += "  <connect from=\"n fac\" to=\"v density\"/>\n";
+  xml += "  <connect from=\"v volume\" to=\"output volume\"/>\n";
+  xml += "</shader>\n";
+  xml += xml_ground();
+
+  xml += "<state shader=\"lamp\">\n";
+  xml += "<light type=\"point\" co=\"2 4 -1\" strength=\"800 700 600\" size=\"0.2\"/>\n";
+  xml += "</state>\n";
+
+  xml += "<state shader=\"smoke\">\n";
+  xml += "<transform translate=\"0 1.5 1\" scale=\"2 1.5 2\">\n";
+  xml += "<mesh P=\"-1 -1 -1  1 -1 -1  -1 1 -1  1 1 -1  -1 -1 1  1 -1 1  -1 1 1  1 1 1\" ";
+  xml += "verts=\"0 4 6 2  1 3 7 5  0 1 5 4  2 6 7 3  0 2 3 1  4 5 7 6\" ";
+  xml += "nverts=\"4 4 4 4 4 4\"/>\n";
+  xml += "</transform>\n";
+  xml += "</state>\n";
+
+  return xml + xml_footer();
+}
+
+/* Subdivided terrain with true displacement, diced at render time. */
+static string benchmark_scene_displacement(const BenchmarkOptions &options)
+{
+  string xml = xml_header(options);
+  xml += "<shader name=\"terrain\" displacement_method=\"true\">\n";
+  xml += "  <texture_coordinate name=\"tc\"/>\n";
+  xml += "  <noise_texture name=\"n\" scale=\"0.4\" detail=\"8\"/>\n";
+  xml += "  <displacement name=\"d\" scale=\"1.5\" midlevel=\"0.5\"/>\n";
+  xml += "  <diffuse_bsdf name=\"b\" color=\"0.4 0.5 0.3\"/>\n";
+  xml += "  <connect from=\"tc object\" to=\"n vector\"/>\n";
+  xml += "  <connect from=\"n fac\" to=\"d height\"/>\n";
+  xml += "  <connect from=\"d displacement\" to=\"output displacement\"/>\n";
+  xml += "  <connect from=\"b bsdf\" to=\"output surface\"/>\n";
+  xml += "</shader>\n";
+  xml += xml_sun("-0.6 -1 0.3", 0.05f);
+
+  xml += "<state shader=\"terrain\" interpolation=\"smooth\" dicing_rate=\"1\">\n";
+  xml += "<transform translate=\"0 -0.5 6\">\n";
+  xml += xml_grid_mesh(16, 24.0f, "subdivision=\"catmull-clark\"");
+  xml += "</transform>\n";
+  xml += "</state>\n";
+
+  return xml + xml_footer();
+}
+
+/* Many small colored point lights above a ground plane with some spheres. */
+static string benchmark_scene_many_lights(const BenchmarkOptions &options)
+{
+  const int grid = 32;
+
+  string xml = xml_header(options);
+  xml += xml_diffuse_shader("ground", make_float3(0.5f, 0.5f, 0.5f));
+  xml += xml_diffuse_shader("ball", make_float3(0.7f, 0.7f, 0.7f));
+  xml += xml_ground();
+
+  xml += "<state shader=\"ball\" interpolation=\"smooth\">\n";
+  for (int i = 0; i < 8; i++) {
+    xml += string_printf("<transform translate=\"%g 0.6 %g\" scale=\"0.6 0.6 0.6\">\n",
+                         (double)(-5.0f + 1.5f * i),
+                         (double)(2.0f * (i % 3)));
+    xml += xml_sphere_mesh(24, 12);
+    xml += "</transform>\n";
+  }
+  xml += "</state>\n";
+
+  xml += "<state shader=\"lamp\">\n";
+  for (int j = 0; j < grid; j++) {
+    for (int i = 0; i < grid; i++) {
+      const uint index = i + j * grid;
+      const float3 co = make_float3(16.0f * ((i + 0.5f) / grid) - 8.0f,
+                                    0.3f + 1.5f * benchmark_random(index, 0),
+                                    16.0f * ((j + 0.5f) / grid) - 2.0f);
+      const float3 color = make_float3(benchmark_random(index, 1),
+                                       benchmark_random(index, 2),
+                                       benchmark_random(index, 3));
+      xml += string_printf("<light type=\"point\" co=\"%s\" strength=\"%s\" size=\"0.05\"/>\n",
+                           xml_float3(co).c_str(),
+                           xml_float3(color * 20.0f).c_str());
+    }
+  }
+  xml += "</state>\n";
+
+  return xml + xml_footer();
+}
+
+typedef string (*BenchmarkSceneFunc)(const BenchmarkOptions &options);
+
+static const struct {
+  const char *name;
+  BenchmarkSceneFunc generate;
+} benchmark_scenes[] = {
+    {"instancing", benchmark_scene_instancing},
+    {"hair", benchmark_scene_hair},
+    {"volume", benchmark_scene_volume},
+    {"displacement", benchmark_scene_displacement},
+    {"many_lights", benchmark_scene_many_lights},
+};
+
+/* Rendering */
+
+static BenchmarkResult benchmark_render(const BenchmarkOptions &options,
+                                        const string &name,
+                                        const string &filepath)
+{
+  BenchmarkResult result;
+  result.name = name;
+  result.success = false;
+  result.sync_time = 0.0;
+  result.total_time = 0.0;
+  result.peak_device_memory = 0;
+  result.num_objects = 0;
+  result.num_lights = 0;
+
+  SessionParams session_params;
+  session_params.device = options.device;
+  session_params.background = true;
+  session_params.progressive = true;
+  session_params.samples = options.samples;
+  session_params.threads = options.threads;
+  session_params.denoising.use = options.denoise;
+
+  SceneParams scene_params;
+  scene_params.shadingsystem = SHADINGSYSTEM_SVM;
+
+  scoped_timer total_timer;
+  Session *session = new Session(session_params);
+
+  /* Sync, creating the scene from its description. */
+  scoped_timer sync_timer;
+  Scene *scene = new Scene(scene_params, session->device);
+  xml_read_file(scene, filepath.c_str());
+
+  scene->camera->width = options.width;
+  scene->camera->height = options.height;
+  scene->camera->compute_auto_viewplane();
+
+  scene->film->denoising_data_pass = options.denoise;
+  scene->film->tag_update(scene);
+
+  session->scene = scene;
+  result.sync_time = sync_timer.get_time();
+  result.num_objects = scene->objects.size();
+  result.num_lights = scene->lights.size();
+
+  BufferParams buffer_params;
+  buffer_params.width = options.width;
+  buffer_params.height = options.height;
+  buffer_params.full_width = options.width;
+  buffer_params.full_height = options.height;
+  buffer_params.denoising_data_pass = options.denoise;
+
+  session->reset(buffer_params, options.samples);
+  session->start();
+  session->wait();
+
+  string status, substatus;
+  session->progress.get_status(status, substatus);
+  result.success = !session->progress.get_error();
+  if (!result.success) {
+    fprintf(stderr, "Failed to render %s: %s\n", name.c_str(), status.c_str());
+  }
+
+  result.times = scene->times;
+  result.peak_device_memory = session->stats.mem_peak;
+
+  delete session;
+  result.total_time = total_timer.get_time();
+
+  return result;
+}
+
+/* Report */
+
+static string benchmark_json_report(const BenchmarkOptions &options,
+                                    const vector<BenchmarkResult> &results)
+{
+  const string indent(2, ' ');
+
+  vector<string> scenes;
+  foreach (const BenchmarkResult &result, results) {
+    string scene = "{";
+    scene += "\"name\": " + json_string(result.name) + ", ";
+    scene += string_printf("\"success\": %s, ", result.success ? "true" : "false");
+    scene += string_printf("\"objects\": %llu, ", (unsigned long long)result.num_objects);
+    scene += string_printf("\"lights\": %llu, ", (unsigned long long)result.num_lights);
+    scene += string_printf("\"sync_seconds\": %.3f, ", result.sync_time);
+    scene += string_printf("\"update_seconds\": %.3f, ", result.times.update);
+    scene += string_printf("\"bvh_build_seconds\": %.3f, ", result.times.bvh_build);
+    scene += string_printf("\"render_seconds\": %.3f, ", result.times.render);
+    scene += string_printf("\"denoise_seconds\": %.3f, ", result.times.denoise);
+    scene += string_printf("\"total_seconds\": %.3f, ", result.total_time);
+    scene += string_printf("\"peak_device_memory\": %llu",
+                           (unsigned long long)result.peak_device_memory);
+    scenes.push_back(scene + "}");
+  }
+
+  string report = "{\n";
+  report += indent + "\"version\": " + json_string(CYCLES_VERSION_STRING) + ",\n";
+  report += indent + "\"device\": " + json_string(options.device.description) + ",\n";
+  report += indent + "\"cpu\": " + json_string(system_cpu_brand_string()) + ",\n";
+  report += indent + string_printf("\"threads\": %d,\n", options.threads);
+  report += indent + string_printf("\"samples\": %d,\n", options.samples);
+  report += indent + string_printf("\"width\": %d,\n", options.width);
+  report += indent + string_printf("\"height\": %d,\n", options.height);
+  report += indent + string_printf("\"denoise\": %s,\n", options.denoise ? "true" : "false");
+  report += indent + "\"scenes\": " + json_array(scenes, 1) + "\n";
+  return report + "}\n";
+}
+
+/* Options */
+
+static bool benchmark_options_parse(BenchmarkOptions &options, int argc, const char **argv)
+{
+  options.threads = 0;
+  options.samples = 16;
+  options.width = 640;
+  options.height = 360;
+  options.quiet = false;
+
+  string devicename = "CPU";
+  bool skip_denoise = false, list = false, debug = false, help = false;
+  int verbosity = 1;
+
+  ArgParse ap;
+  ap.options("Usage: cycles_benchmark [options]",
+             "--device %s",
+             &devicename,
+             "Device to render with",
+             "--threads %d",
+             &options.threads,
+             "CPU rendering threads, all by default",
+             "--samples %d",
+             &options.samples,
+             "Number of samples to render",
+             "--width %d",
+             &options.width,
+             "Image width in pixels",
+             "--height %d",
+             &options.height,
+             "Image height in pixels",
+             "--scenes %s",
+             &options.scenes,
+             "Comma separated names of the scenes to render, all by default",
+             "--scene-dir %s",
+             &options.scene_dir,
+             "Directory to write the generated XML scenes to",
+             "--output %s",
+             &options.output_path,
+             "File path to write the JSON report to, instead of printing it",
+             "--skip-denoise",
+             &skip_denoise,
+             "Render without denoising",
+             "--quiet",
+             &options.quiet,
+             "Don't print progress messages",
+             "--list-scenes",
+             &list,
+             "List the benchmark scenes",
+#ifdef WITH_CYCLES_LOGGING
+             "--debug",
+             &debug,
+             "Enable debug logging",
+             "--verbose %d",
+             &verbosity,
+             "Set verbosity of the logger",
+#endif
+             "--help",
+             &help,
+             "Print help message",
+             NULL);
+
+  if (ap.parse(argc, argv) < 0) {
+    fprintf(stderr, "%s\n", ap.geterror().c_str());
+    ap.usage();
+    return false;
+  }
+
+  if (debug) {
+    util_logging_start();
+    util_logging_verbosity_set(verbosity);
+  }
+
+  if (help) {
+    ap.usage();
+    exit(EXIT_SUCCESS);
+  }
+  else if (list) {
+    for (size_t i = 0; i < sizeof(benchmark_scenes) / sizeof(*benchmark_scenes); i++) {
+      printf("%s\n", benchmark_scenes[i].name);
+    }
+    exit(EXIT_SUCCESS);
+  }
+
+  options.denoise = !skip_denoise;
+
+  DeviceType device_type = Device::type_from_string(devicename.c_str());
+  vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
+  if (devices.empty()) {
+    fprintf(stderr, "Unknown device: %s\n", devicename.c_str());
+    return false;
+  }
+  options.device = devices.front();
+
+  if (options.samples <= 0 || options.width <= 0 || options.height <= 0) {
+    fprintf(stderr, "Samples, width and height must be positive\n");
+    return false;
+  }
+
+  if (options.scene_dir.empty()) {
+    options.scene_dir = path_cache_get("benchmark");
+  }
+
+  return true;
+}
+
+CCL_NAMESPACE_END
+
+using namespace ccl;
+
+int main(int argc, const char **argv)
+{
+  util_logging_init(argv[0]);
+  path_init();
+
+  BenchmarkOptions options;
+  if (!benchmark_options_parse(options, argc, argv)) {
+    return EXIT_FAILURE;
+  }
+
+  vector<string> scene_names;
+  if (!options.scenes.empty()) {
+    string_split(scene_names, options.scenes, ",");
+  }
+
+  vector<BenchmarkResult> results;
+  bool success = true;
+
+  for (size_t i = 0; i < sizeof(benchmark_scenes) / sizeof(*benchmark_scenes); i++) {
+    const string name = benchmark_scenes[i].name;
+    if (!scene_names.empty() &&
+        std::find(scene_names.begin(), scene_names.end(), name) == scene_names.end()) {
+      continue;
+    }
+
+    string xml = benchmark_scenes[i].generate(options);
+    const string filepath = path_join(options.scene_dir, name + ".xml");
+    path_create_directories(filepath);
+    if (!path_write_text(filepath, xml)) {
+      fprintf(stderr, "Failed to write scene %s\n", filepath.c_str());
+      return EXIT_FAILURE;
+    }
+
+    if (!options.quiet) {
+      fprintf(stderr, "Rendering %s\n", name.c_str());
+    }
+
+    BenchmarkResult result = benchmark_render(options, name, filepath);
+    success &= result.success;
+    results.push_back(result);
+  }
+
+  options.threads = TaskScheduler::num_threads();
+  options.threads = (options.threads > 0) ? options.threads : system_cpu_thread_count();
+
+  string report = benchmark_json_report(options, results);
+  if (options.output_path.empty()) {
+    printf("%s", report.c_str());
+  }
+  else if (!path_write_text(options.output_path, report)) {
+    fprintf(stderr, "Failed to write report to %s\n", options.output_path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -19,17 +19,20 @@
 #include "device/device.h"
 #include "render/buffers.h"
 #include "render/camera.h"
+#include "render/denoising.h"
 #include "render/integrator.h"
 #include "render/scene.h"
 #include "render/session.h"
 
 #include "util/util_args.h"
+#include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_function.h"
 #include "util/util_image.h"
 #include "util/util_logging.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
+#include "util/util_task.h"
 #include "util/util_string.h"
 #include "util/util_time.h"
 #include "util/util_transform.h"
@@ -48,6 +51,10 @@ struct Options {
   Session *session;
   Scene *scene;
   string filepath;
+  /* Frames of a sequence to denoise, in order. */
+  vector<string> denoise_filepaths;
+  bool denoise;
+  DenoiseParams denoise_params;
   int width, height;
   SceneParams scene_params;
   SessionParams session_params;
@@ -120,6 +127,8 @@ static BufferParams &session_buffer_params()
   buffer_params.height = options.height;
   buffer_params.full_width = options.width;
   buffer_params.full_height = options.height;
+  /* Named, so the pass is written by tile output. */
+  Pass::add(PASS_COMBINED, buffer_params.passes, "Combined");
 
   return buffer_params;
 }
@@ -147,7 +156,10 @@ static void scene_init()
 
 static void session_init()
 {
-  options.session_params.write_render_cb = write_render;
+  /* Tile output streams tiles to file, without keeping a full frame buffer in memory. */
+  if (options.session_params.tile_output_path.empty()) {
+    options.session_params.write_render_cb = write_render;
+  }
   options.session = new Session(options.session_params);
 
   if (options.session_params.background && !options.quiet)
@@ -168,6 +180,12 @@ static void session_init()
 static void session_exit()
 {
   if (options.session) {
+    if (options.session_params.use_profiling) {
+      RenderStats stats;
+      options.session->collect_statistics(&stats);
+      printf("\n%s\n", stats.full_report().c_str());
+    }
+
     delete options.session;
     options.session = NULL;
   }
@@ -360,9 +378,37 @@ static int files_parse(int argc, const char *argv[])
   if (argc > 0)
     options.filepath = argv[0];
 
+  for (int i = 0; i < argc; i++)
+    options.denoise_filepaths.push_back(argv[i]);
+
   return 0;
 }
 
+static bool denoise_frames()
+{
+  /* Denoised frames replace the input, the same as denoising an animation in Blender. */
+  vector<string> output = options.denoise_filepaths;
+  if (!options.output_path.empty()) {
+    output[0] = options.output_path;
+  }
+
+  TaskScheduler::init(options.session_params.threads);
+
+  Denoiser denoiser(options.session_params.device);
+  denoiser.params = options.denoise_params;
+  denoiser.input = options.denoise_filepaths;
+  denoiser.output = output;
+  denoiser.tile_size = options.session_params.tile_size;
+
+  const bool success = denoiser.run();
+  if (!success) {
+    fprintf(stderr, "Failed to denoise: %s\n", denoiser.error.c_str());
+  }
+
+  TaskScheduler::exit();
+  return success;
+}
+
 static void options_parse(int argc, const char **argv)
 {
   options.width = 0;
@@ -370,6 +416,7 @@ static void options_parse(int argc, const char **argv)
   options.filepath = "";
   options.session = NULL;
   options.quiet = false;
+  options.denoise = false;
 
   /* device names */
   string device_names = "";
@@ -390,10 +437,12 @@ static void options_parse(int argc, const char **argv)
 
   /* parse options */
   ArgParse ap;
-  bool help = false, debug = false, version = false;
+  bool help = false, debug = false, version = false, packet_tracing = false;
+  bool numa_replication = false;
   int verbosity = 1;
 
-  ap.options("Usage: cycles [options] file.xml",
+  ap.options("Usage: cycles [options] file.xml\n"
+             "       cycles --denoise [options] frame.exr ...",
              "%*",
              files_parse,
              "",
@@ -432,6 +481,42 @@ static void options_parse(int argc, const char **argv)
              "--tile-height %d",
              &options.session_params.tile_size.y,
              "Tile height in pixels",
+             "--packet-tracing",
+             &packet_tracing,
+             "Trace camera rays in packets on the CPU, using the BVH2 layout",
+             "--numa-replication",
+             &numa_replication,
+             "Copy scene data to every NUMA node, so CPU threads read from local memory",
+             "--profile",
+             &options.session_params.use_profiling,
+             "Print render time, shader and ray statistics after rendering (CPU only)",
+             "--profile-report %s",
+             &options.session_params.profiling_report_path,
+             "File path to write render statistics as JSON, implies --profile",
+             "--tile-output %s",
+             &options.session_params.tile_output_path,
+             "Write finished tiles directly to this tiled EXR file, without keeping the full "
+             "frame in memory (background rendering only)",
+             "--denoise",
+             &options.denoise,
+             "Denoise a sequence of multilayer EXR frames rendered with denoising data passes, "
+             "instead of rendering. Frames are overwritten unless --output is given for a single "
+             "frame",
+             "--denoise-radius %d",
+             &options.denoise_params.radius,
+             "Denoising radius in pixels",
+             "--denoise-strength %f",
+             &options.denoise_params.strength,
+             "Denoising strength",
+             "--denoise-feature-strength %f",
+             &options.denoise_params.feature_strength,
+             "Denoising feature strength",
+             "--denoise-relative-pca",
+             &options.denoise_params.relative_pca,
+             "Use a relative threshold to remove feature passes that carry no information",
+             "--denoise-neighbor-frames %d",
+             &options.denoise_params.neighbor_frames,
+             "Number of frames before and after each frame to denoise it with",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -484,6 +569,19 @@ static void options_parse(int argc, const char **argv)
     exit(EXIT_SUCCESS);
   }
 
+  if (!options.session_params.profiling_report_path.empty()) {
+    options.session_params.use_profiling = true;
+  }
+
+  if (packet_tracing) {
+    DebugFlags().cpu.packet_tracing = true;
+    options.scene_params.bvh_layout = BVH_LAYOUT_BVH2;
+  }
+
+  if (numa_replication) {
+    DebugFlags().cpu.numa_replication = true;
+  }
+
   if (ssname == "osl")
     options.scene_params.shadingsystem = SHADINGSYSTEM_OSL;
   else if (ssname == "svm")
@@ -493,8 +591,9 @@ static void options_parse(int argc, const char **argv)
   options.session_params.background = true;
 #endif
 
-  /* Use progressive rendering */
-  options.session_params.progressive = true;
+  /* Use progressive rendering, except when writing tiles as soon as they finish. */
+  options.session_params.progressive = options.session_params.tile_output_path.empty() ||
+                                       !options.session_params.background;
 
   /* find matching device */
   DeviceType device_type = Device::type_from_string(devicename.c_str());
@@ -530,6 +629,16 @@ static void options_parse(int argc, const char **argv)
     fprintf(stderr, "No file path specified\n");
     exit(EXIT_FAILURE);
   }
+  else if (options.denoise && options.denoise_filepaths.size() > 1 &&
+           !options.output_path.empty()) {
+    fprintf(stderr, "Output file path can only be specified when denoising a single frame\n");
+    exit(EXIT_FAILURE);
+  }
+  else if (options.denoise && (options.denoise_params.neighbor_frames < 0 ||
+                               options.denoise_params.neighbor_frames > 7)) {
+    fprintf(stderr, "Number of denoising neighbor frames must be between 0 and 7\n");
+    exit(EXIT_FAILURE);
+  }
 
   /* For smoother Viewport */
   options.session_params.start_resolution = 64;
@@ -545,6 +654,10 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (options.denoise) {
+    return denoise_frames() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
@@ -26,6 +26,7 @@
 #include "render/camera.h"
 #include "render/film.h"
 #include "render/graph.h"
+#include "render/hair.h"
 #include "render/integrator.h"
 #include "render/light.h"
 #include "render/mesh.h"
@@ -374,6 +375,16 @@ static void xml_read_background(XMLReadState &state, xml_node node)
   xml_read_shader_graph(state, shader, node);
 }
 
+/* Object */
+
+static void xml_add_object(Scene *scene, Geometry *geom, const Transform &tfm)
+{
+  Object *object = new Object();
+  object->geometry = geom;
+  object->tfm = tfm;
+  scene->objects.push_back(object);
+}
+
 /* Mesh */
 
 static Mesh *xml_add_mesh(Scene *scene, const Transform &tfm)
@@ -383,10 +394,7 @@ static Mesh *xml_add_mesh(Scene *scene, const Transform &tfm)
   scene->geometry.push_back(mesh);
 
   /* create object*/
-  Object *object = new Object();
-  object->geometry = mesh;
-  object->tfm = tfm;
-  scene->objects.push_back(object);
+  xml_add_object(scene, mesh, tfm);
 
   return mesh;
 }
@@ -397,6 +405,12 @@ static void xml_read_mesh(const XMLReadState &state, xml_node node)
   Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
   mesh->used_shaders.push_back(state.shader);
 
+  /* name to instance the mesh with */
+  string name;
+  if (xml_read_string(&name, node, "name")) {
+    mesh->name = ustring(name);
+  }
+
   /* read state */
   int shader = 0;
   bool smooth = state.smooth;
@@ -533,6 +547,68 @@ static void xml_read_mesh(const XMLReadState &state, xml_node node)
   }
 }
 
+/* Hair */
+
+static void xml_read_hair(const XMLReadState &state, xml_node node)
+{
+  /* add hair */
+  Hair *hair = new Hair();
+  state.scene->geometry.push_back(hair);
+  hair->used_shaders.push_back(state.shader);
+  xml_add_object(state.scene, hair, state.tfm);
+
+  string name;
+  if (xml_read_string(&name, node, "name")) {
+    hair->name = ustring(name);
+  }
+
+  /* read keys and curves, with a radius per key or one for all keys */
+  vector<float3> P;
+  vector<float> radius;
+  vector<int> nkeys;
+
+  xml_read_float3_array(P, node, "P");
+  xml_read_float_array(radius, node, "radius");
+  xml_read_int_array(nkeys, node, "nkeys");
+
+  if (radius.empty()) {
+    radius.push_back(0.01f);
+  }
+
+  hair->reserve_curves(nkeys.size(), P.size());
+
+  int key = 0;
+  for (size_t i = 0; i < nkeys.size(); i++) {
+    hair->add_curve(key, 0);
+
+    for (int j = 0; j < nkeys[i]; j++, key++) {
+      assert(key < (int)P.size());
+      hair->add_curve_key(P[key], (radius.size() == P.size()) ? radius[key] : radius[0]);
+    }
+  }
+}
+
+/* Instance */
+
+static void xml_read_instance(const XMLReadState &state, xml_node node)
+{
+  string name;
+
+  if (!xml_read_string(&name, node, "geometry")) {
+    fprintf(stderr, "Instance missing \"geometry\" attribute.\n");
+    return;
+  }
+
+  foreach (Geometry *geom, state.scene->geometry) {
+    if (geom->name == name) {
+      xml_add_object(state.scene, geom, state.tfm);
+      return;
+    }
+  }
+
+  fprintf(stderr, "Unknown geometry \"%s\".\n", name.c_str());
+}
+
 /* Light */
 
 static void xml_read_light(XMLReadState &state, xml_node node)
@@ -632,6 +708,12 @@ static void xml_read_scene(XMLReadState &state, xml_node scene_node)
     else if (string_iequals(node.name(), "mesh")) {
       xml_read_mesh(state, node);
     }
+    else if (string_iequals(node.name(), "hair")) {
+      xml_read_hair(state, node);
+    }
+    else if (string_iequals(node.name(), "instance")) {
+      xml_read_instance(state, node);
+    }
     else if (string_iequals(node.name(), "light")) {
       xml_read_light(state, node);
     }
@@ -374,6 +374,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Sample all lights (for indirect samples), rather than randomly picking one",
         default=True,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights by their estimated contribution to the shading point, using a hierarchy built over "
+        "point, spot and area lights (reduces noise in scenes with many lights)",
+        default=True,
+    )
     light_sampling_threshold: FloatProperty(
         name="Light Sampling Threshold",
         description="Probabilistically terminate light samples when the light contribution is below this threshold (more noise but faster rendering). "
@@ -677,6 +683,13 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=0,
         min=0, max=16,
     )
+    debug_bvh_refit_threshold: FloatProperty(
+        name="BVH Refit Threshold",
+        description="Refit the BVH of deforming geometry instead of building it again, until its quality "
+        "drops by this factor (0 to always build)",
+        default=1.5,
+        min=0.0, max=10.0,
+    )
     tile_order: EnumProperty(
         name="Tile Order",
         description="Tile order for rendering",
@@ -784,6 +797,27 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Use Texture Cache",
+        description="Read image textures on demand through a tiled, mipmapped cache instead of loading them fully into memory, "
+        "only used when rendering on the CPU",
+        default=False,
+    )
+
+    texture_cache_size: IntProperty(
+        name="Texture Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=1024,
+        min=1, max=1 << 20,
+    )
+
+    texture_auto_convert: BoolProperty(
+        name="Auto Convert Textures",
+        description="Convert images that are not tiled and mipmapped to .tx files in the user cache directory, "
+        "so they can be read partially",
+        default=True,
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -816,6 +850,16 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default='EMBREE',
     )
     debug_use_cpu_split_kernel: BoolProperty(name="Split Kernel", default=False)
+    debug_use_cpu_packet_tracing: BoolProperty(
+        name="Packet Tracing",
+        description="Trace camera rays in packets, only used with the BVH2 layout",
+        default=False,
+    )
+    debug_use_cpu_numa_replication: BoolProperty(
+        name="NUMA Replication",
+        description="Copy scene data to every NUMA node, so render threads read from local memory",
+        default=False,
+    )
 
     debug_use_cuda_adaptive_compile: BoolProperty(name="Adaptive Compile", default=False)
     debug_use_cuda_split_kernel: BoolProperty(name="Split Kernel", default=False)
@@ -68,6 +68,8 @@ BlenderSession::BlenderSession(BL::RenderEngine &b_engine,
       b_scene(PointerRNA_NULL),
       b_v3d(PointerRNA_NULL),
       b_rv3d(PointerRNA_NULL),
+      persistent_depsgraph(NULL),
+      persistent_depsgraph_main(NULL),
       width(0),
       height(0),
       preview_osl(preview_osl),
@@ -97,6 +99,8 @@ BlenderSession::BlenderSession(BL::RenderEngine &b_engine,
       b_scene(PointerRNA_NULL),
       b_v3d(b_v3d),
       b_rv3d(b_rv3d),
+      persistent_depsgraph(NULL),
+      persistent_depsgraph_main(NULL),
       width(width),
       height(height),
       preview_osl(false),
@@ -168,6 +172,14 @@ void BlenderSession::create_session()
 
 void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsgraph)
 {
+  /* Rendering the same view layer with the dependency graph of the previous frame. */
+  const bool use_depsgraph_updates = persistent_depsgraph != NULL &&
+                                     b_depsgraph.ptr.data == persistent_depsgraph &&
+                                     b_data.ptr.data == persistent_depsgraph_main &&
+                                     b_depsgraph.view_layer_eval().name() == b_rlay_name;
+  persistent_depsgraph = NULL;
+  persistent_depsgraph_main = NULL;
+
   /* Update data, scene and depsgraph pointers. These can change after undo. */
   this->b_data = b_data;
   this->b_depsgraph = b_depsgraph;
@@ -222,7 +234,6 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
   }
 
   session->progress.reset();
-  scene->reset();
 
   session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -231,11 +242,21 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
    */
   session->stats.mem_peak = session->stats.mem_used;
 
-  /* There is no single depsgraph to use for the entire render.
-   * See note on create_session().
-   */
-  /* sync object should be re-created */
-  sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  if (use_depsgraph_updates) {
+    /* Only sync what changed since the previous frame, everything else is kept on the device,
+     * including geometry, BVHs, images and shaders. */
+    sync->sync_recalc(b_depsgraph, b_v3d);
+  }
+  else {
+    scene->reset();
+
+    /* There is no single depsgraph to use for the entire render.
+     * See note on create_session().
+     */
+    /* sync object should be re-created */
+    delete sync;
+    sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  }
 
   BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
   BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
@@ -599,6 +620,12 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
   session->write_render_tile_cb = function_null;
   session->update_render_tile_cb = function_null;
 
+  /* A cancelled render may not have synced all updates. */
+  if (scene->params.persistent_data && !session->progress.get_cancel()) {
+    persistent_depsgraph = b_depsgraph.ptr.data;
+    persistent_depsgraph_main = b_data.ptr.data;
+  }
+
   /* TODO: find a way to clear this data for persistent data render */
 #if 0
   /* free all memory used (host and device), so we wouldn't leave render
@@ -1127,6 +1154,10 @@ void BlenderSession::free_blender_memory_if_possible()
      */
     return;
   }
+  if (b_scene.render().use_persistent_data()) {
+    /* The dependency graph is kept for the next frame. */
+    return;
+  }
   b_engine.free_blender_memory();
 }
 
@@ -112,6 +112,12 @@ class BlenderSession {
   string b_rlay_name;
   string b_rview_name;
 
+  /* Dependency graph of the last completed render and the main database it used. With
+   * persistent data Blender keeps it alive for the next frame of the same view layer, and only
+   * its updates need to be synced. Undo reads a new main database and frees the graph. */
+  void *persistent_depsgraph;
+  void *persistent_depsgraph_main;
+
   string last_status;
   string last_error;
   float last_progress;
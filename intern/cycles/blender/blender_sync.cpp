@@ -294,6 +294,7 @@ void BlenderSync::sync_integrator()
   integrator->sample_all_lights_direct = get_boolean(cscene, "sample_all_lights_direct");
   integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
   integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
+  integrator->use_light_tree = get_boolean(cscene, "use_light_tree");
 
   if (RNA_boolean_get(&cscene, "use_adaptive_sampling")) {
     integrator->sampling_pattern = SAMPLING_PATTERN_PMJ;
@@ -348,6 +349,14 @@ void BlenderSync::sync_integrator()
 
   if (integrator->modified(previntegrator))
     integrator->tag_update(scene);
+
+  /* These settings decide whether the light tree is built. */
+  if (integrator->use_light_tree != previntegrator.use_light_tree ||
+      integrator->method != previntegrator.method ||
+      integrator->sample_all_lights_direct != previntegrator.sample_all_lights_direct ||
+      integrator->sample_all_lights_indirect != previntegrator.sample_all_lights_indirect) {
+    scene->light_manager->tag_update(scene);
+  }
 }
 
 /* Film */
@@ -698,6 +707,11 @@ void BlenderSync::free_data_after_sync(BL::Depsgraph &b_depsgraph)
   if (!can_free_caches) {
     return;
   }
+  /* Releasing caches tags objects for update, which would make persistent data sync all objects
+   * again for the next frame. */
+  if (b_scene.render().use_persistent_data()) {
+    return;
+  }
   /* TODO(sergey): We can actually remove the whole dependency graph,
    * but that will need some API support first.
    */
@@ -729,6 +743,7 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  params.bvh_refit_threshold = RNA_float_get(&cscene, "debug_bvh_refit_threshold");
 
   PointerRNA csscene = RNA_pointer_get(&b_scene.ptr, "cycles_curves");
   params.hair_subdivisions = get_int(csscene, "subdivisions");
@@ -754,6 +769,10 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  params.use_texture_cache = get_boolean(cscene, "use_texture_cache");
+  params.texture_cache_size = get_int(cscene, "texture_cache_size");
+  params.texture_auto_convert = get_boolean(cscene, "texture_auto_convert");
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
@@ -30,6 +30,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_tbb.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -92,7 +93,11 @@ int BVHStackEntry::encodeIdx() const
 BVH::BVH(const BVHParams &params_,
          const vector<Geometry *> &geometry_,
          const vector<Object *> &objects_)
-    : params(params_), geometry(geometry_), objects(objects_)
+    : params(params_),
+      geometry(geometry_),
+      objects(objects_),
+      build_sah_cost(0.0f),
+      refit_sah_cost(0.0f)
 {
 }
 
@@ -173,6 +178,10 @@ void BVH::build(Progress &progress, Stats *)
   progress.set_substatus("Packing BVH nodes");
   pack_nodes(root);
 
+  /* Reference for the cost of refitted trees. */
+  build_sah_cost = root->computeSubtreeSAHCost(params);
+  refit_sah_cost = build_sah_cost;
+
   /* free build nodes */
   root->deleteSubtree();
 }
@@ -182,7 +191,7 @@ void BVH::build(Progress &progress, Stats *)
 void BVH::refit(Progress &progress)
 {
   progress.set_substatus("Packing BVH primitives");
-  pack_primitives();
+  refit_pack_primitives();
 
   if (progress.get_cancel())
     return;
@@ -318,6 +327,38 @@ void BVH::pack_primitives()
   }
 }
 
+void BVH::refit_pack_primitives()
+{
+  /* Primitives keep their place in the arrays, only their vertices and visibility change. */
+  const size_t num_prims = pack.prim_index.size();
+
+  parallel_for(blocked_range<size_t>(0, num_prims, 1024), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      const int pidx = pack.prim_index[i];
+      if (pidx == -1) {
+        continue;
+      }
+
+      const Object *ob = objects[pack.prim_object[i]];
+
+      if (pack.prim_tri_index[i] != (uint)-1) {
+        /* Primitive indices of the top level BVH point into the global arrays. */
+        const Mesh *mesh = static_cast<const Mesh *>(ob->geometry);
+        const int prim_offset = (params.top_level) ? mesh->prim_offset : 0;
+        const Mesh::Triangle t = mesh->get_triangle(pidx - prim_offset);
+        const float3 *vpos = &mesh->verts[0];
+        float4 *tri_verts = &pack.prim_tri_verts[pack.prim_tri_index[i]];
+
+        tri_verts[0] = float3_to_float4(vpos[t.v[0]]);
+        tri_verts[1] = float3_to_float4(vpos[t.v[1]]);
+        tri_verts[2] = float3_to_float4(vpos[t.v[2]]);
+      }
+
+      pack.prim_visibility[i] = ob->visibility_for_tracing();
+    }
+  });
+}
+
 /* Pack Instances */
 
 void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
@@ -87,6 +87,13 @@ class BVH {
   vector<Geometry *> geometry;
   vector<Object *> objects;
 
+  /* Surface area heuristic cost of the tree as it was built, and after the last refit. Refitting
+   * keeps the tree topology, so the cost grows as primitives move away from their original
+   * neighbours, which is used to decide when building the tree again pays off. Only computed
+   * for the BVH2 layout, zero otherwise. */
+  float build_sah_cost;
+  float refit_sah_cost;
+
   static BVH *create(const BVHParams &params,
                      const vector<Geometry *> &geometry,
                      const vector<Object *> &objects);
@@ -99,8 +106,15 @@ class BVH {
   {
   }
 
+  /* Update bounds for moved vertices, the primitives must be the same as when building. */
   void refit(Progress &progress);
 
+  /* Refit cost compared to the build cost is above the threshold, zero disables the test. */
+  bool refit_degraded(float threshold) const
+  {
+    return threshold > 0.0f && refit_sah_cost > build_sah_cost * threshold;
+  }
+
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
@@ -113,6 +127,9 @@ class BVH {
   void pack_primitives();
   void pack_triangle(int idx, float4 storage[3]);
 
+  /* Update vertices and visibility of already packed primitives, in parallel. */
+  void refit_pack_primitives();
+
   /* merge instance BVH's */
   void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
 
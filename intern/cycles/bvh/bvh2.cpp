@@ -23,6 +23,8 @@
 #include "bvh/bvh_node.h"
 #include "bvh/bvh_unaligned.h"
 
+#include "util/util_tbb.h"
+
 CCL_NAMESPACE_BEGIN
 
 BVH2::BVH2(const BVHParams &params_,
@@ -237,14 +239,16 @@ void BVH2::pack_nodes(const BVHNode *root)
 
 void BVH2::refit_nodes()
 {
-  assert(!params.top_level);
-
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, 0, bbox, visibility, sah);
+
+  const float area = bbox.safe_area();
+  refit_sah_cost = (area > 0.0f) ? sah / area : 0.0f;
 }
 
-void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH2::refit_node(int idx, bool leaf, int depth, BoundBox &bbox, uint &visibility, float &sah)
 {
   if (leaf) {
     /* refit leaf node */
@@ -253,6 +257,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c0 = data[0].x;
     const int c1 = data[0].y;
 
+    /* Only BVHs without instances are refit, so leaves always contain primitives. */
+    assert(c0 >= 0);
     BVH::refit_primitives(c0, c1, bbox, visibility);
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
@@ -262,6 +268,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     leaf_data[0].z = __uint_as_float(visibility);
     leaf_data[0].w = __uint_as_float(data[0].w);
     memcpy(&pack.leaf_nodes[idx], leaf_data, sizeof(float4) * BVH_NODE_LEAF_SIZE);
+
+    sah = bbox.safe_area() * params.cost(0, c1 - c0);
   }
   else {
     assert(idx + BVH_NODE_SIZE <= pack.nodes.size());
@@ -273,9 +281,24 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     /* refit inner node, set bbox from children */
     BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
     uint visibility0 = 0, visibility1 = 0;
-
-    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
-    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
+    float sah0 = 0.0f, sah1 = 0.0f;
+
+    /* Subtrees are independent, so the upper levels of large trees are refit in parallel. The
+     * depth limit keeps the number of tasks in the order of the number of threads. */
+    auto refit_child0 = [&] {
+      refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), depth + 1, bbox0, visibility0, sah0);
+    };
+    auto refit_child1 = [&] {
+      refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), depth + 1, bbox1, visibility1, sah1);
+    };
+
+    if (depth < REFIT_PARALLEL_DEPTH && pack.leaf_nodes.size() >= REFIT_PARALLEL_MIN_LEAVES) {
+      parallel_invoke(refit_child0, refit_child1);
+    }
+    else {
+      refit_child0();
+      refit_child1();
+    }
 
     if (is_unaligned) {
       Transform aligned_space = transform_identity();
@@ -289,6 +312,7 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+    sah = bbox.safe_area() * params.cost(2, 0) + sah0 + sah1;
   }
 }
 
@@ -85,7 +85,11 @@ class BVH2 : public BVH {
 
   /* refit */
   void refit_nodes() override;
-  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+  /* Sets sah to the cost of the subtree, scaled by its surface area. */
+  void refit_node(int idx, bool leaf, int depth, BoundBox &bbox, uint &visibility, float &sah);
+
+  /* Nodes above this depth are refit in parallel, for trees with enough leaves. */
+  enum { REFIT_PARALLEL_DEPTH = 8, REFIT_PARALLEL_MIN_LEAVES = 4096 };
 };
 
 CCL_NAMESPACE_END
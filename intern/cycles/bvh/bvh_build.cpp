@@ -54,9 +54,11 @@ BVHBuild::BVHBuild(const vector<Object *> &objects_,
       prim_object(prim_object_),
       prim_time(prim_time_),
       params(params_),
+      curve_strand_segments(params_.use_spatial_split ? 1 :
+                                                        max(params_.curve_strand_segments, 1)),
       progress(progress_),
       progress_start_time(0.0),
-      unaligned_heuristic(objects_)
+      unaligned_heuristic(objects_, curve_strand_segments)
 {
   spatial_min_overlap = 0.0f;
 }
@@ -170,6 +172,24 @@ void BVHBuild::add_reference_curves(BoundBox &root, BoundBox &center, Hair *hair
   for (uint j = 0; j < num_curves; j++) {
     const Hair::Curve curve = hair->get_curve(j);
     const float *curve_radius = &hair->curve_radius[0];
+    if (curve_attr_mP == NULL && curve_strand_segments > 1) {
+      /* Consecutive segments of static hair share a reference, which is expanded into one
+       * primitive per segment once the tree is built. */
+      for (int k = 0; k < curve.num_segments(); k += curve_strand_segments) {
+        const int num_segments = min(curve_strand_segments, curve.num_segments() - k);
+        BoundBox bounds = BoundBox::empty;
+        for (int s = k; s < k + num_segments; s++) {
+          curve.bounds_grow(s, &hair->curve_keys[0], curve_radius, bounds);
+        }
+        if (bounds.valid()) {
+          int packed_type = PRIMITIVE_PACK_SEGMENT(primitive_type, k);
+          references.push_back(BVHReference(bounds, j, i, packed_type));
+          root.grow(bounds);
+          center.grow(bounds.center2());
+        }
+      }
+      continue;
+    }
     for (int k = 0; k < curve.num_keys - 1; k++) {
       if (curve_attr_mP == NULL) {
         /* Really simple logic for static hair. */
@@ -439,6 +459,9 @@ BVHNode *BVHBuild::run()
       /*rotate(rootnode, 4, 5);*/
       rootnode->update_visibility();
       rootnode->update_time();
+      if (curve_strand_segments > 1) {
+        expand_curve_strands(rootnode);
+      }
     }
     if (rootnode != NULL) {
       VLOG(1) << "BVH build statistics:\n"
@@ -568,6 +591,87 @@ bool BVHBuild::range_within_max_leaf_size(const BVHRange &range,
          (num_motion_curves <= params.max_motion_curve_leaf_size);
 }
 
+/* Curve strands */
+
+/* Number of segments the primitive is expanded to, one for anything but static curves. */
+int BVHBuild::prim_num_segments(int prim) const
+{
+  const int type = prim_type[prim];
+  if (!(type & (PRIMITIVE_CURVE_RIBBON | PRIMITIVE_CURVE_THICK))) {
+    return 1;
+  }
+
+  const Hair *hair = static_cast<const Hair *>(objects[prim_object[prim]]->geometry);
+  const Hair::Curve curve = hair->get_curve(prim_index[prim]);
+  return min(curve_strand_segments, curve.num_segments() - PRIMITIVE_UNPACK_SEGMENT(type));
+}
+
+void BVHBuild::expand_curve_strands(BVHNode *root)
+{
+  size_t num_prims = 0;
+  for (size_t i = 0; i < prim_type.size(); i++) {
+    num_prims += prim_num_segments(i);
+  }
+
+  array<int> strand_prim_type, strand_prim_index, strand_prim_object;
+  array<float2> strand_prim_time;
+  strand_prim_type.reserve(num_prims);
+  strand_prim_index.reserve(num_prims);
+  strand_prim_object.reserve(num_prims);
+  if (need_prim_time) {
+    strand_prim_time.reserve(num_prims);
+  }
+
+  expand_curve_strands(
+      root, strand_prim_type, strand_prim_index, strand_prim_object, strand_prim_time);
+
+  prim_type.steal_data(strand_prim_type);
+  prim_index.steal_data(strand_prim_index);
+  prim_object.steal_data(strand_prim_object);
+  if (need_prim_time) {
+    prim_time.steal_data(strand_prim_time);
+  }
+}
+
+void BVHBuild::expand_curve_strands(BVHNode *node,
+                                    array<int> &strand_prim_type,
+                                    array<int> &strand_prim_index,
+                                    array<int> &strand_prim_object,
+                                    array<float2> &strand_prim_time)
+{
+  if (!node->is_leaf()) {
+    for (int i = 0; i < node->num_children(); i++) {
+      expand_curve_strands(node->get_child(i),
+                           strand_prim_type,
+                           strand_prim_index,
+                           strand_prim_object,
+                           strand_prim_time);
+    }
+    return;
+  }
+
+  LeafNode *leaf = (LeafNode *)node;
+  if (leaf->lo == leaf->hi) {
+    return;
+  }
+
+  const int lo = strand_prim_type.size();
+  for (int i = leaf->lo; i < leaf->hi; i++) {
+    const int num_segments = prim_num_segments(i);
+    for (int s = 0; s < num_segments; s++) {
+      strand_prim_type.push_back_reserved(prim_type[i] + (s << PRIMITIVE_NUM_TOTAL));
+      strand_prim_index.push_back_reserved(prim_index[i]);
+      strand_prim_object.push_back_reserved(prim_object[i]);
+      if (need_prim_time) {
+        strand_prim_time.push_back_reserved(prim_time[i]);
+      }
+    }
+  }
+
+  leaf->lo = lo;
+  leaf->hi = strand_prim_type.size();
+}
+
 /* multithreaded binning builder */
 BVHNode *BVHBuild::build_node(const BVHObjectBinning &range, int level)
 {
@@ -84,6 +84,15 @@ class BVHBuild {
   bool range_within_max_leaf_size(const BVHRange &range,
                                   const vector<BVHReference> &references) const;
 
+  /* Curve strands. */
+  int prim_num_segments(int prim) const;
+  void expand_curve_strands(BVHNode *root);
+  void expand_curve_strands(BVHNode *node,
+                            array<int> &strand_prim_type,
+                            array<int> &strand_prim_index,
+                            array<int> &strand_prim_object,
+                            array<float2> &strand_prim_time);
+
   /* Threads. */
   enum { THREAD_TASK_SIZE = 4096 };
   void thread_build_node(InnerNode *node, int child, const BVHObjectBinning &range, int level);
@@ -116,6 +125,8 @@ class BVHBuild {
 
   /* Build parameters. */
   BVHParams params;
+  /* Segments per static curve reference, one when strands are not grouped. */
+  int curve_strand_segments;
 
   /* Progress reporting. */
   Progress &progress;
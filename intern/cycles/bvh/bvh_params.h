@@ -85,6 +85,11 @@ class BVHParams {
   /* Same as above, but for triangle primitives. */
   int num_motion_triangle_steps;
 
+  /* Group up to this many consecutive segments of a static curve into a single reference,
+   * which ends up in a leaf of its own. Fewer nodes are needed for long strands, and the kernel
+   * reuses control points between the segments of a leaf. Not supported with spatial splits. */
+  int curve_strand_segments;
+
   /* Same as in SceneParams. */
   int bvh_type;
 
@@ -119,6 +124,8 @@ class BVHParams {
     num_motion_curve_steps = 0;
     num_motion_triangle_steps = 0;
 
+    curve_strand_segments = 1;
+
     bvh_type = 0;
 
     curve_subdivisions = 4;
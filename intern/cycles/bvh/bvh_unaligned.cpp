@@ -27,7 +27,8 @@
 
 CCL_NAMESPACE_BEGIN
 
-BVHUnaligned::BVHUnaligned(const vector<Object *> &objects) : objects_(objects)
+BVHUnaligned::BVHUnaligned(const vector<Object *> &objects, int curve_strand_segments)
+    : objects_(objects), curve_strand_segments_(curve_strand_segments)
 {
 }
 
@@ -74,8 +75,10 @@ bool BVHUnaligned::compute_aligned_space(const BVHReference &ref, Transform *ali
     const int segment = PRIMITIVE_UNPACK_SEGMENT(packed_type);
     const Hair *hair = static_cast<const Hair *>(object->geometry);
     const Hair::Curve &curve = hair->get_curve(curve_index);
+    const int num_segments = min(curve_strand_segments_, curve.num_segments() - segment);
+    /* Orient along the whole strand piece, from the first to the last key. */
     const int key = curve.first_key + segment;
-    const float3 v1 = hair->curve_keys[key], v2 = hair->curve_keys[key + 1];
+    const float3 v1 = hair->curve_keys[key], v2 = hair->curve_keys[key + num_segments];
     float length;
     const float3 axis = normalize_len(v2 - v1, &length);
     if (length > 1e-6f) {
@@ -100,8 +103,10 @@ BoundBox BVHUnaligned::compute_aligned_prim_boundbox(const BVHReference &prim,
     const int segment = PRIMITIVE_UNPACK_SEGMENT(packed_type);
     const Hair *hair = static_cast<const Hair *>(object->geometry);
     const Hair::Curve &curve = hair->get_curve(curve_index);
-    curve.bounds_grow(
-        segment, &hair->curve_keys[0], &hair->curve_radius[0], aligned_space, bounds);
+    const int num_segments = min(curve_strand_segments_, curve.num_segments() - segment);
+    for (int i = segment; i < segment + num_segments; i++) {
+      curve.bounds_grow(i, &hair->curve_keys[0], &hair->curve_radius[0], aligned_space, bounds);
+    }
   }
   else {
     bounds = prim.bounds().transformed(&aligned_space);
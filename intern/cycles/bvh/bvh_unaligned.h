@@ -31,7 +31,7 @@ class Object;
 /* Helper class to perform calculations needed for unaligned nodes. */
 class BVHUnaligned {
  public:
-  BVHUnaligned(const vector<Object *> &objects);
+  BVHUnaligned(const vector<Object *> &objects, int curve_strand_segments = 1);
 
   /* Calculate alignment for the oriented node for a given range. */
   Transform compute_aligned_space(const BVHObjectBinning &range,
@@ -66,6 +66,9 @@ class BVHUnaligned {
  protected:
   /* List of objects BVH is being created for. */
   const vector<Object *> &objects_;
+
+  /* Number of segments in static curve references, see BVHParams. */
+  int curve_strand_segments_;
 };
 
 CCL_NAMESPACE_END
@@ -46,6 +46,7 @@
 #include "render/buffers.h"
 #include "render/coverage.h"
 
+#include "util/util_algorithm.h"
 #include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_function.h"
@@ -184,10 +185,34 @@ class CPUDevice : public Device {
 #endif
 
   bool use_split_kernel;
+  bool use_packet_tracing;
+
+  /* Copy of a global array or image on a NUMA node. */
+  struct NUMACopy {
+    const char *name;
+    bool is_global;
+    const void *host_pointer;
+    void *data;
+    size_t data_size;
+    size_t size;
+  };
+
+  /* Scene data is allocated by the main thread and ends up on a single node. With NUMA
+   * replication every node gets its own copy of the global arrays and of images up to
+   * NUMA_MAX_IMAGE_SIZE, and render threads are pinned to a node and read from its copies. */
+  struct NUMANode {
+    int node;
+    int num_processors;
+    map<const device_memory *, NUMACopy> copies;
+  };
+  vector<NUMANode> numa_nodes;
+  static const size_t NUMA_MAX_IMAGE_SIZE = 64 * 1024 * 1024;
 
   DeviceRequestedFeatures requested_features;
 
   KernelFunctions<void (*)(KernelGlobals *, float *, int, int, int, int, int)> path_trace_kernel;
+  KernelFunctions<void (*)(KernelGlobals *, float *, int, int, int, int, int, int, int)>
+      path_trace_packet_kernel;
   KernelFunctions<void (*)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int)>
       convert_to_half_float_kernel;
   KernelFunctions<void (*)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int)>
@@ -274,6 +299,7 @@ class CPUDevice : public Device {
         texture_info(this, "__texture_info", MEM_GLOBAL),
 #define REGISTER_KERNEL(name) name##_kernel(KERNEL_FUNCTIONS(name))
         REGISTER_KERNEL(path_trace),
+        REGISTER_KERNEL(path_trace_packet),
         REGISTER_KERNEL(convert_to_half_float),
         REGISTER_KERNEL(convert_to_byte),
         REGISTER_KERNEL(shader),
@@ -305,6 +331,13 @@ class CPUDevice : public Device {
     if (use_split_kernel) {
       VLOG(1) << "Will be using split kernel.";
     }
+    use_packet_tracing = DebugFlags().cpu.packet_tracing;
+    if (use_packet_tracing) {
+      VLOG(1) << "Will be using packet tracing for camera rays.";
+    }
+    if (DebugFlags().cpu.numa_replication) {
+      numa_nodes_init();
+    }
     need_texture_info = false;
 
 #define REGISTER_SPLIT_KERNEL(name) \
@@ -340,6 +373,12 @@ class CPUDevice : public Device {
   {
     task_pool.cancel();
     texture_info.free();
+
+    foreach (NUMANode &numa_node, numa_nodes) {
+      for (auto &it : numa_node.copies) {
+        system_cpu_numa_free(it.second.data, it.second.size);
+      }
+    }
   }
 
   virtual bool show_samples() const
@@ -471,10 +510,14 @@ class CPUDevice : public Device {
     mem.device_pointer = (device_ptr)mem.host_pointer;
     mem.device_size = mem.memory_size();
     stats.mem_alloc(mem.device_size);
+
+    numa_copy_alloc(mem, true);
   }
 
   void global_free(device_memory &mem)
   {
+    numa_copy_free(mem);
+
     if (mem.device_pointer) {
       mem.device_pointer = 0;
       stats.mem_free(mem.device_size);
@@ -499,12 +542,21 @@ class CPUDevice : public Device {
     }
 
     texture_info[slot] = mem.info;
-    texture_info[slot].data = (uint64_t)mem.host_pointer;
+    if (!mem.info.use_cache) {
+      /* Cached images point to their cache handle instead of the pixels. */
+      texture_info[slot].data = (uint64_t)mem.host_pointer;
+
+      if (mem.memory_size() <= NUMA_MAX_IMAGE_SIZE) {
+        numa_copy_alloc(mem, false);
+      }
+    }
     need_texture_info = true;
   }
 
   void tex_free(device_texture &mem)
   {
+    numa_copy_free(mem);
+
     if (mem.device_pointer) {
       mem.device_pointer = 0;
       stats.mem_free(mem.device_size);
@@ -522,10 +574,106 @@ class CPUDevice : public Device {
 #endif
   }
 
-  void thread_run(DeviceTask &task)
+  void numa_nodes_init()
+  {
+    const int num_nodes = system_cpu_num_numa_nodes();
+
+    for (int node = 0; node < num_nodes; node++) {
+      const int num_processors = system_cpu_num_numa_node_processors(node);
+
+      if (system_cpu_is_numa_node_available(node) && num_processors > 0) {
+        NUMANode numa_node;
+        numa_node.node = node;
+        numa_node.num_processors = num_processors;
+        numa_nodes.push_back(numa_node);
+      }
+    }
+
+    if (numa_nodes.size() > 1) {
+      VLOG(1) << "Will be replicating scene data on " << numa_nodes.size() << " NUMA nodes.";
+    }
+    else {
+      numa_nodes.clear();
+    }
+  }
+
+  void numa_copy_alloc(device_memory &mem, bool is_global)
+  {
+    if (numa_nodes.empty() || mem.host_pointer == NULL || mem.memory_size() == 0) {
+      return;
+    }
+
+    foreach (NUMANode &numa_node, numa_nodes) {
+      NUMACopy copy;
+      copy.name = mem.name;
+      copy.is_global = is_global;
+      copy.host_pointer = mem.host_pointer;
+      copy.data_size = mem.data_size;
+      copy.size = mem.memory_size();
+      copy.data = system_cpu_numa_alloc(copy.size, numa_node.node);
+      memcpy(copy.data, mem.host_pointer, copy.size);
+
+      if (&mem == &texture_info) {
+        /* Point to the images copied to the same node. */
+        TextureInfo *info = (TextureInfo *)copy.data;
+
+        for (size_t slot = 0; slot < texture_info.size(); slot++) {
+          for (auto &it : numa_node.copies) {
+            if (!it.second.is_global && (uint64_t)it.second.host_pointer == info[slot].data) {
+              info[slot].data = (uint64_t)it.second.data;
+              break;
+            }
+          }
+        }
+      }
+
+      numa_node.copies[&mem] = copy;
+      stats.mem_alloc(copy.size);
+    }
+  }
+
+  void numa_copy_free(const device_memory &mem)
+  {
+    foreach (NUMANode &numa_node, numa_nodes) {
+      auto it = numa_node.copies.find(&mem);
+
+      if (it != numa_node.copies.end()) {
+        system_cpu_numa_free(it->second.data, it->second.size);
+        stats.mem_free(it->second.size);
+        numa_node.copies.erase(it);
+      }
+    }
+  }
+
+  /* Index of the NUMA node for render thread, with threads distributed over the nodes in
+   * proportion to their number of processors. */
+  int numa_node_for_thread(int thread_index)
+  {
+    if (numa_nodes.empty()) {
+      return -1;
+    }
+
+    int num_processors = 0;
+    foreach (const NUMANode &numa_node, numa_nodes) {
+      num_processors += numa_node.num_processors;
+    }
+
+    thread_index %= num_processors;
+
+    for (size_t i = 0; i < numa_nodes.size(); i++) {
+      if (thread_index < numa_nodes[i].num_processors) {
+        return i;
+      }
+      thread_index -= numa_nodes[i].num_processors;
+    }
+
+    return -1;
+  }
+
+  void thread_run(DeviceTask &task, int numa_index)
   {
     if (task.type == DeviceTask::RENDER)
-      thread_render(task);
+      thread_render(task, numa_index);
     else if (task.type == DeviceTask::SHADER)
       thread_shader(task);
     else if (task.type == DeviceTask::FILM_CONVERT)
@@ -884,6 +1032,35 @@ class CPUDevice : public Device {
     }
   }
 
+  /* Pixels of a bake tile sorted by the primitive they sample, leaving out pixels outside of
+   * any primitive. Neighboring pixels in the texture often belong to unrelated primitives, so
+   * this keeps shader evaluation and geometry access for the same primitive together. */
+  void bake_pixel_order(const RenderTile &tile, KernelGlobals *kg, vector<int> &pixels)
+  {
+    const float *render_buffer = (const float *)tile.buffer;
+    vector<uint64_t> keys;
+    keys.reserve(tile.w * tile.h);
+
+    for (int y = 0; y < tile.h; y++) {
+      for (int x = 0; x < tile.w; x++) {
+        const int index = tile.offset + (tile.x + x) + (tile.y + y) * tile.stride;
+        const float *primitive = render_buffer + index * kernel_data.film.pass_stride +
+                                 kernel_data.film.pass_bake_primitive;
+        const uint prim = __float_as_uint(primitive[1]);
+        if (prim != (uint)-1) {
+          keys.push_back(((uint64_t)prim << 32) | (uint64_t)(x + y * tile.w));
+        }
+      }
+    }
+
+    sort(keys.begin(), keys.end());
+
+    pixels.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      pixels[i] = (int)(keys[i] & 0xffffffff);
+    }
+  }
+
   void render(DeviceTask &task, RenderTile &tile, KernelGlobals *kg)
   {
     const bool use_coverage = kernel_data.film.cryptomatte_passes & CRYPT_ACCURATE;
@@ -902,13 +1079,23 @@ class CPUDevice : public Device {
     /* Needed for Embree. */
     SIMD_SET_FLUSH_TO_ZERO;
 
+    vector<int> bake_pixels;
+    if (tile.task == RenderTile::BAKE) {
+      bake_pixel_order(tile, kg, bake_pixels);
+    }
+
     for (int sample = start_sample; sample < end_sample; sample++) {
       if (task.get_cancel() || task_pool.canceled()) {
         if (task.need_finish_queue == false)
           break;
       }
 
-      if (tile.task == RenderTile::PATH_TRACE) {
+      if (tile.task == RenderTile::PATH_TRACE && use_packet_tracing && !use_coverage) {
+        /* The kernel falls back to tracing one path at a time if the scene is not supported. */
+        path_trace_packet_kernel()(
+            kg, render_buffer, sample, tile.x, tile.y, tile.w, tile.h, tile.offset, tile.stride);
+      }
+      else if (tile.task == RenderTile::PATH_TRACE) {
         for (int y = tile.y; y < tile.y + tile.h; y++) {
           for (int x = tile.x; x < tile.x + tile.w; x++) {
             if (use_coverage) {
@@ -919,10 +1106,10 @@ class CPUDevice : public Device {
         }
       }
       else {
-        for (int y = tile.y; y < tile.y + tile.h; y++) {
-          for (int x = tile.x; x < tile.x + tile.w; x++) {
-            bake_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
-          }
+        foreach (const int pixel, bake_pixels) {
+          const int x = tile.x + pixel % tile.w;
+          const int y = tile.y + pixel / tile.w;
+          bake_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
         }
       }
       tile.sample = sample + 1;
@@ -1043,19 +1230,28 @@ class CPUDevice : public Device {
     denoising.run_denoising(&tile);
   }
 
-  void thread_render(DeviceTask &task)
+  void thread_render(DeviceTask &task, int numa_index)
   {
     if (task_pool.canceled()) {
       if (task.need_finish_queue == false)
         return;
     }
 
+    /* The thread is a shared TBB worker, so it is only pinned to the node when its affinity
+     * can be restored afterwards. */
+    SystemThreadAffinity thread_affinity;
+    const bool restore_affinity = (numa_index != -1) &&
+                                  system_cpu_thread_affinity_get(&thread_affinity);
+    if (restore_affinity) {
+      system_cpu_run_thread_on_node(numa_nodes[numa_index].node);
+    }
+
     /* allocate buffer for kernel globals */
     device_only_memory<KernelGlobals> kgbuffer(this, "kernel_globals");
     kgbuffer.alloc_to_device(1);
 
     KernelGlobals *kg = new ((void *)kgbuffer.device_pointer)
-        KernelGlobals(thread_kernel_globals_init());
+        KernelGlobals(thread_kernel_globals_init(numa_index));
 
     profiler.add_state(&kg->profiler);
 
@@ -1066,6 +1262,9 @@ class CPUDevice : public Device {
         thread_kernel_globals_free((KernelGlobals *)kgbuffer.device_pointer);
         kgbuffer.free();
         delete split_kernel;
+        if (restore_affinity) {
+          system_cpu_thread_affinity_set(&thread_affinity);
+        }
         return;
       }
     }
@@ -1115,6 +1314,10 @@ class CPUDevice : public Device {
     kgbuffer.free();
     delete split_kernel;
     delete denoising;
+
+    if (restore_affinity) {
+      system_cpu_thread_affinity_set(&thread_affinity);
+    }
   }
 
   void thread_denoise(DeviceTask &task)
@@ -1233,10 +1436,16 @@ class CPUDevice : public Device {
       task.split(tasks, info.cpu_threads);
     }
 
+    int thread_index = 0;
+
     foreach (DeviceTask &task, tasks) {
+      const int numa_index = (task.type == DeviceTask::RENDER) ?
+                                 numa_node_for_thread(thread_index++) :
+                                 -1;
+
       task_pool.push([=] {
         DeviceTask task_copy = task;
-        thread_run(task_copy);
+        thread_run(task_copy, numa_index);
       });
     }
   }
@@ -1252,9 +1461,19 @@ class CPUDevice : public Device {
   }
 
  protected:
-  inline KernelGlobals thread_kernel_globals_init()
+  inline KernelGlobals thread_kernel_globals_init(int numa_index = -1)
   {
     KernelGlobals kg = kernel_globals;
+
+    if (numa_index != -1) {
+      for (auto &it : numa_nodes[numa_index].copies) {
+        const NUMACopy &copy = it.second;
+        if (copy.is_global) {
+          kernel_global_memory_copy(&kg, copy.name, copy.data, copy.data_size);
+        }
+      }
+    }
+
     kg.transparent_shadow_intersections = NULL;
     const int decoupled_count = sizeof(kg.decoupled_volume_steps) /
                                 sizeof(*kg.decoupled_volume_steps);
@@ -1431,6 +1650,7 @@ void device_cpu_info(vector<DeviceInfo> &devices)
   info.id = "CPU";
   info.num = 0;
   info.has_volume_decoupled = true;
+  info.has_sparse_volumes = true;
   info.has_adaptive_stop_per_sample = true;
   info.has_osl = true;
   info.has_half_images = true;
@@ -222,6 +222,37 @@ void *device_texture::alloc(const size_t width, const size_t height, const size_
   info.width = width;
   info.height = height;
   info.depth = depth;
+  info.use_sparse_grid = 0;
+
+  return host_pointer;
+}
+
+void *device_texture::alloc_sparse_grid(const size_t width,
+                                        const size_t height,
+                                        const size_t depth,
+                                        const size_t num_tiles)
+{
+  /* Size in number of voxels, rounded up so the tile table fits. */
+  const size_t voxel_size = data_elements * datatype_size(data_type);
+  const size_t pool_offset = sparse_grid_pool_offset(width, height, depth);
+  const size_t new_size = divide_up(pool_offset, voxel_size) + num_tiles * SPARSE_TILE_VOXELS;
+
+  if (new_size != data_size) {
+    device_free();
+    host_free();
+    host_pointer = host_alloc(voxel_size * new_size);
+    assert(device_pointer == 0);
+  }
+
+  data_size = new_size;
+  data_width = width;
+  data_height = height;
+  data_depth = depth;
+
+  info.width = width;
+  info.height = height;
+  info.depth = depth;
+  info.use_sparse_grid = 1;
 
   return host_pointer;
 }
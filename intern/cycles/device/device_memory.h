@@ -400,6 +400,20 @@ template<typename T> class device_vector : public device_memory {
     assert(device_pointer == 0);
   }
 
+  /* Give data back to an array, the inverse of steal_data. */
+  void give_data(array<T> &to)
+  {
+    device_free();
+
+    to.set_data((T *)host_pointer, data_size);
+    data_size = 0;
+    data_width = 0;
+    data_height = 0;
+    data_depth = 0;
+    host_pointer = 0;
+    assert(device_pointer == 0);
+  }
+
   /* Free device and host memory. */
   void free()
   {
@@ -526,6 +540,11 @@ class device_texture : public device_memory {
   ~device_texture();
 
   void *alloc(const size_t width, const size_t height, const size_t depth = 0);
+  /* Allocate a 3D image stored as a sparse grid with num_tiles tiles, see util_texture.h. */
+  void *alloc_sparse_grid(const size_t width,
+                          const size_t height,
+                          const size_t depth,
+                          const size_t num_tiles);
   void copy_to_device();
 
   uint slot;
@@ -129,6 +129,12 @@ CCL_NAMESPACE_BEGIN
 #    endif
 #  endif /* __VOLUME_RECORD_ALL__ */
 
+/* Packet traversal for coherent rays */
+
+#  if defined(__BVH_PACKET__)
+#    include "kernel/bvh/bvh_packet.h"
+#  endif /* __BVH_PACKET__ */
+
 #  undef BVH_FEATURE
 #  undef BVH_NAME_JOIN
 #  undef BVH_NAME_EVAL
@@ -151,12 +157,26 @@ ccl_device_inline bool scene_intersect_valid(const Ray *ray)
   return isfinite_safe(ray->P.x) && isfinite_safe(ray->D.x) && len_squared(ray->D) != 0.0f;
 }
 
+#ifdef __KERNEL_CPU__
+ccl_device_inline ProfilingCounter scene_intersect_profiling_counter(const uint visibility)
+{
+  if (visibility & PATH_RAY_SHADOW) {
+    return PROFILING_COUNTER_SHADOW_RAYS;
+  }
+  else if (visibility & PATH_RAY_CAMERA) {
+    return PROFILING_COUNTER_CAMERA_RAYS;
+  }
+  return PROFILING_COUNTER_INDIRECT_RAYS;
+}
+#endif
+
 ccl_device_intersect bool scene_intersect(KernelGlobals *kg,
                                           const Ray *ray,
                                           const uint visibility,
                                           Intersection *isect)
 {
   PROFILING_INIT(kg, PROFILING_INTERSECT);
+  PROFILING_COUNT(kg, scene_intersect_profiling_counter(visibility), 1);
 
 #ifdef __KERNEL_OPTIX__
   uint p0 = 0;
@@ -236,6 +256,57 @@ ccl_device_intersect bool scene_intersect(KernelGlobals *kg,
 #endif   /* __KERNEL_OPTIX__ */
 }
 
+#ifdef __BVH_PACKET__
+/* Packet traversal only supports the BVH2 layout, and the rays of a packet can only be traced
+ * together as long as they don't enter instances. */
+ccl_device_inline bool scene_intersect_packet_supported(KernelGlobals *kg)
+{
+  return kernel_data.bvh.bvh_layout == BVH_LAYOUT_BVH2 && !kernel_data.bvh.have_motion &&
+         !kernel_data.bvh.have_curves;
+}
+
+/* Intersect up to BVH_PACKET_SIZE rays, in the bits of ray_mask. Rays that miss are returned
+ * with isect->prim set to PRIM_NONE. */
+ccl_device_intersect void scene_intersect_packet(KernelGlobals *kg,
+                                                 const Ray *rays,
+                                                 uint ray_mask,
+                                                 const uint visibility,
+                                                 Intersection *isects)
+{
+  PROFILING_INIT(kg, PROFILING_INTERSECT);
+
+  uint packet_mask = 0;
+  for (int i = 0; i < BVH_PACKET_SIZE; i++) {
+    if (!(ray_mask & (1 << i))) {
+      continue;
+    }
+
+    if (scene_intersect_valid(&rays[i])) {
+      packet_mask |= (1 << i);
+    }
+    else {
+      isects[i].t = rays[i].t;
+      isects[i].prim = PRIM_NONE;
+      isects[i].object = OBJECT_NONE;
+    }
+  }
+
+  if (packet_mask == 0) {
+    return;
+  }
+
+  /* Rays the packet traversal could not handle are traced again on their own. */
+  uint fallback_mask = bvh_intersect_packet(kg, rays, isects, packet_mask, visibility);
+  PROFILING_COUNT(kg,
+                  scene_intersect_profiling_counter(visibility),
+                  __popcnt(packet_mask & ~fallback_mask));
+  while (fallback_mask) {
+    const int i = __bscf(fallback_mask);
+    scene_intersect(kg, &rays[i], visibility, &isects[i]);
+  }
+}
+#endif /* __BVH_PACKET__ */
+
 #ifdef __BVH_LOCAL__
 ccl_device_intersect bool scene_intersect_local(KernelGlobals *kg,
                                                 const Ray *ray,
@@ -245,6 +316,7 @@ ccl_device_intersect bool scene_intersect_local(KernelGlobals *kg,
                                                 int max_hits)
 {
   PROFILING_INIT(kg, PROFILING_INTERSECT_LOCAL);
+  PROFILING_COUNT(kg, PROFILING_COUNTER_LOCAL_RAYS, 1);
 
 #  ifdef __KERNEL_OPTIX__
   uint p0 = ((uint64_t)lcg_state) & 0xFFFFFFFF;
@@ -359,6 +431,7 @@ ccl_device_intersect bool scene_intersect_shadow_all(KernelGlobals *kg,
                                                      uint *num_hits)
 {
   PROFILING_INIT(kg, PROFILING_INTERSECT_SHADOW_ALL);
+  PROFILING_COUNT(kg, PROFILING_COUNTER_SHADOW_RAYS, 1);
 
 #  ifdef __KERNEL_OPTIX__
   uint p0 = ((uint64_t)isect) & 0xFFFFFFFF;
@@ -443,6 +516,7 @@ ccl_device_intersect bool scene_intersect_volume(KernelGlobals *kg,
                                                  const uint visibility)
 {
   PROFILING_INIT(kg, PROFILING_INTERSECT_VOLUME);
+  PROFILING_COUNT(kg, PROFILING_COUNTER_VOLUME_RAYS, 1);
 
 #  ifdef __KERNEL_OPTIX__
   uint p0 = 0;
@@ -503,6 +577,7 @@ ccl_device_intersect uint scene_intersect_volume_all(KernelGlobals *kg,
                                                      const uint visibility)
 {
   PROFILING_INIT(kg, PROFILING_INTERSECT_VOLUME_ALL);
+  PROFILING_COUNT(kg, PROFILING_COUNTER_VOLUME_RAYS, 1);
 
   if (!scene_intersect_valid(ray)) {
     return false;
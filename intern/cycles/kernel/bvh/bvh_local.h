@@ -53,6 +53,7 @@ ccl_device_inline
   /* traversal stack in CUDA thread-local memory */
   int traversal_stack[BVH_STACK_SIZE];
   traversal_stack[0] = ENTRYPOINT_SENTINEL;
+  PROFILING_COUNT_INIT(kg, PROFILING_COUNTER_BVH_NODES);
 
   /* traversal variables in registers */
   int stack_ptr = 0;
@@ -103,6 +104,7 @@ ccl_device_inline
 
         node_addr = __float_as_int(cnodes.z);
         node_addr_child1 = __float_as_int(cnodes.w);
+        PROFILING_COUNT_NEXT();
 
         if (traverse_mask == 3) {
           /* Both children were intersected, push the farther one. */
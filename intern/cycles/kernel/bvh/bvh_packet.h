@@ -0,0 +1,242 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Packet BVH traversal
+ *
+ * Traverses a packet of coherent rays through the BVH2 together, testing nodes against four
+ * rays at a time with SSE. A node is visited when any ray of the packet hits it, with a bit mask
+ * of the rays that did, so the node data is fetched once for the whole packet. Leaves are
+ * intersected one ray at a time.
+ *
+ * Only triangles in the scene BVH are supported. Rays reaching instances or any other type of
+ * primitive are returned in a mask, and need to be traced with the regular traversal. */
+
+#define BVH_PACKET_GROUPS (BVH_PACKET_SIZE / 4)
+
+typedef struct BVHPacket {
+  ssef P[3][BVH_PACKET_GROUPS];
+  ssef idir[3][BVH_PACKET_GROUPS];
+  ssef t[BVH_PACKET_GROUPS];
+  float3 dir[BVH_PACKET_SIZE];
+} BVHPacket;
+
+/* Returns the rays in mask hitting each child of the node, and the rays hitting both with the
+ * second child closer. */
+ccl_device_forceinline void bvh_packet_node_intersect(KernelGlobals *kg,
+                                                      const BVHPacket *packet,
+                                                      const int node_addr,
+                                                      const uint visibility,
+                                                      const uint mask,
+                                                      uint *mask0,
+                                                      uint *mask1,
+                                                      uint *mask_closer1)
+{
+  const float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+  const float4 node0 = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
+  const float4 node1 = kernel_tex_fetch(__bvh_nodes, node_addr + 2);
+  const float4 node2 = kernel_tex_fetch(__bvh_nodes, node_addr + 3);
+
+  const bool visible0 = (__float_as_uint(cnodes.x) & visibility) != 0;
+  const bool visible1 = (__float_as_uint(cnodes.y) & visibility) != 0;
+
+  *mask0 = 0;
+  *mask1 = 0;
+  *mask_closer1 = 0;
+
+  for (int g = 0; g < BVH_PACKET_GROUPS; g++) {
+    if (((mask >> (g * 4)) & 0xf) == 0) {
+      continue;
+    }
+
+    const ssef &Px = packet->P[0][g], &Py = packet->P[1][g], &Pz = packet->P[2][g];
+    const ssef &idirx = packet->idir[0][g], &idiry = packet->idir[1][g],
+               &idirz = packet->idir[2][g];
+
+    const ssef c0lox = (ssef(node0.x) - Px) * idirx;
+    const ssef c0hix = (ssef(node0.z) - Px) * idirx;
+    const ssef c0loy = (ssef(node1.x) - Py) * idiry;
+    const ssef c0hiy = (ssef(node1.z) - Py) * idiry;
+    const ssef c0loz = (ssef(node2.x) - Pz) * idirz;
+    const ssef c0hiz = (ssef(node2.z) - Pz) * idirz;
+    const ssef c0min = max(max(ssef(0.0f), min(c0lox, c0hix)),
+                           max(min(c0loy, c0hiy), min(c0loz, c0hiz)));
+    const ssef c0max = min(min(packet->t[g], max(c0lox, c0hix)),
+                           min(max(c0loy, c0hiy), max(c0loz, c0hiz)));
+
+    const ssef c1lox = (ssef(node0.y) - Px) * idirx;
+    const ssef c1hix = (ssef(node0.w) - Px) * idirx;
+    const ssef c1loy = (ssef(node1.y) - Py) * idiry;
+    const ssef c1hiy = (ssef(node1.w) - Py) * idiry;
+    const ssef c1loz = (ssef(node2.y) - Pz) * idirz;
+    const ssef c1hiz = (ssef(node2.w) - Pz) * idirz;
+    const ssef c1min = max(max(ssef(0.0f), min(c1lox, c1hix)),
+                           max(min(c1loy, c1hiy), min(c1loz, c1hiz)));
+    const ssef c1max = min(min(packet->t[g], max(c1lox, c1hix)),
+                           min(max(c1loy, c1hiy), max(c1loz, c1hiz)));
+
+    const uint hit0 = visible0 ? (uint)movemask(c0max >= c0min) : 0;
+    const uint hit1 = visible1 ? (uint)movemask(c1max >= c1min) : 0;
+    const uint closer1 = (uint)movemask(c1min < c0min);
+
+    *mask0 |= hit0 << (g * 4);
+    *mask1 |= hit1 << (g * 4);
+    *mask_closer1 |= (hit0 & hit1 & closer1) << (g * 4);
+  }
+
+  *mask0 &= mask;
+  *mask1 &= mask;
+  *mask_closer1 &= mask;
+}
+
+/* Find the closest intersection of the rays in active_mask. Returns the mask of rays that
+ * could not be traced by the packet traversal. */
+ccl_device_noinline uint bvh_intersect_packet(KernelGlobals *kg,
+                                              const Ray *rays,
+                                              Intersection *isects,
+                                              uint active_mask,
+                                              const uint visibility)
+{
+  BVHPacket packet;
+
+  for (int i = 0; i < BVH_PACKET_SIZE; i++) {
+    const int g = i / 4, lane = i % 4;
+
+    if (!(active_mask & (1 << i))) {
+      /* Inactive lanes are masked out, any value that is not NaN will do. */
+      for (int axis = 0; axis < 3; axis++) {
+        packet.P[axis][g][lane] = 0.0f;
+        packet.idir[axis][g][lane] = 1.0f;
+      }
+      packet.t[g][lane] = -1.0f;
+      continue;
+    }
+
+    const Ray *ray = &rays[i];
+    const float3 dir = bvh_clamp_direction(ray->D);
+    const float3 idir = bvh_inverse_direction(dir);
+
+    packet.P[0][g][lane] = ray->P.x;
+    packet.P[1][g][lane] = ray->P.y;
+    packet.P[2][g][lane] = ray->P.z;
+    packet.idir[0][g][lane] = idir.x;
+    packet.idir[1][g][lane] = idir.y;
+    packet.idir[2][g][lane] = idir.z;
+    packet.t[g][lane] = ray->t;
+    packet.dir[i] = dir;
+
+    Intersection *isect = &isects[i];
+    isect->t = ray->t;
+    isect->u = 0.0f;
+    isect->v = 0.0f;
+    isect->prim = PRIM_NONE;
+    isect->object = OBJECT_NONE;
+    BVH_DEBUG_INIT();
+  }
+
+  /* Traversal stack, with the mask of rays that still need to visit each node. */
+  int traversal_stack[BVH_STACK_SIZE];
+  uint mask_stack[BVH_STACK_SIZE];
+  traversal_stack[0] = ENTRYPOINT_SENTINEL;
+  mask_stack[0] = 0;
+  PROFILING_COUNT_INIT(kg, PROFILING_COUNTER_BVH_NODES);
+
+  int stack_ptr = 0;
+  int node_addr = kernel_data.bvh.root;
+  uint mask = active_mask;
+  uint fallback_mask = 0;
+
+  while (node_addr != ENTRYPOINT_SENTINEL) {
+    if (node_addr >= 0) {
+      /* Internal node. */
+      uint mask0, mask1, mask_closer1;
+      bvh_packet_node_intersect(
+          kg, &packet, node_addr, visibility, mask, &mask0, &mask1, &mask_closer1);
+
+      const float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+      int node_addr_child0 = __float_as_int(cnodes.z);
+      int node_addr_child1 = __float_as_int(cnodes.w);
+      PROFILING_COUNT_NEXT();
+
+      if (mask0 && mask1) {
+        /* Visit the child closest to most rays first. */
+        if (2 * __popcnt(mask_closer1) > __popcnt(mask0 & mask1)) {
+          int tmp_addr = node_addr_child0;
+          node_addr_child0 = node_addr_child1;
+          node_addr_child1 = tmp_addr;
+          uint tmp_mask = mask0;
+          mask0 = mask1;
+          mask1 = tmp_mask;
+        }
+
+        ++stack_ptr;
+        kernel_assert(stack_ptr < BVH_STACK_SIZE);
+        traversal_stack[stack_ptr] = node_addr_child1;
+        mask_stack[stack_ptr] = mask1;
+
+        node_addr = node_addr_child0;
+        mask = mask0;
+        continue;
+      }
+      else if (mask0) {
+        node_addr = node_addr_child0;
+        mask = mask0;
+        continue;
+      }
+      else if (mask1) {
+        node_addr = node_addr_child1;
+        mask = mask1;
+        continue;
+      }
+    }
+    else {
+      /* Leaf node. */
+      const float4 leaf = kernel_tex_fetch(__bvh_leaf_nodes, (-node_addr - 1));
+      const int prim_addr_start = __float_as_int(leaf.x);
+      const int prim_addr_end = __float_as_int(leaf.y);
+      const uint type = __float_as_int(leaf.w);
+
+      if (prim_addr_start >= 0 && (type & PRIMITIVE_ALL) == PRIMITIVE_TRIANGLE) {
+        uint ray_mask = mask;
+        while (ray_mask) {
+          const int i = __bscf(ray_mask);
+          Intersection *isect = &isects[i];
+
+          for (int prim_addr = prim_addr_start; prim_addr < prim_addr_end; prim_addr++) {
+            BVH_DEBUG_NEXT_INTERSECTION();
+            kernel_assert(kernel_tex_fetch(__prim_type, prim_addr) == type);
+            triangle_intersect(
+                kg, isect, rays[i].P, packet.dir[i], visibility, OBJECT_NONE, prim_addr);
+          }
+
+          packet.t[i / 4][i % 4] = isect->t;
+        }
+      }
+      else {
+        /* Instances, curves and motion triangles. */
+        fallback_mask |= mask;
+      }
+    }
+
+    /* Pop, skipping nodes that only rays which were handed to the fallback still need. */
+    do {
+      node_addr = traversal_stack[stack_ptr];
+      mask = mask_stack[stack_ptr] & ~fallback_mask;
+      --stack_ptr;
+    } while (node_addr != ENTRYPOINT_SENTINEL && mask == 0);
+  }
+
+  return fallback_mask;
+}
@@ -19,6 +19,24 @@ CCL_NAMESPACE_BEGIN
 #define load4_a(buf, ofs) (*((float4 *)((buf) + (ofs))))
 #define load4_u(buf, ofs) load_float4((buf) + (ofs))
 
+#ifdef __KERNEL_AVX2__
+/* With AVX2 the loops below handle eight pixels at a time. Rows are only padded to a multiple
+ * of four pixels, so the eight pixel loops stop at the padded row end and the four pixel loops
+ * finish the rest of the row. Only four pixels are aligned, so all eight pixel loads are
+ * unaligned. */
+#  define load8_u(buf, ofs) avxf(_mm256_loadu_ps((buf) + (ofs)))
+#  define store8_u(buf, ofs, val) _mm256_storeu_ps((buf) + (ofs), (val).m256)
+
+/* Zero pixels outside of [lowx, highx). */
+ccl_device_inline avxf nlm_mask8(int x, int lowx, int highx, const avxf &val)
+{
+  const avxf x8 = avxf((float)x) + avxf(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+  const __m256 active = _mm256_and_ps(_mm256_cmp_ps(x8, avxf((float)lowx), _CMP_GE_OQ),
+                                      _mm256_cmp_ps(x8, avxf((float)highx), _CMP_LT_OQ));
+  return _mm256_and_ps(active, val);
+}
+#endif
+
 ccl_device_inline void kernel_filter_nlm_calc_difference(int dx,
                                                          int dy,
                                                          const float *ccl_restrict weight_image,
@@ -42,7 +60,30 @@ ccl_device_inline void kernel_filter_nlm_calc_difference(int dx,
   for (int y = rect.y; y < rect.w; y++) {
     int idx_p = y * stride + aligned_lowx;
     int idx_q = (y + dy) * stride + aligned_lowx + dx + frame_offset;
-    for (int x = aligned_lowx; x < rect.z; x += 4, idx_p += 4, idx_q += 4) {
+    int x = aligned_lowx;
+#ifdef __KERNEL_AVX2__
+    const avxf channel_fac8(1.0f / numChannels);
+    for (; x + 8 <= round_up(rect.z, 4); x += 8, idx_p += 8, idx_q += 8) {
+      avxf diff(0.0f);
+      avxf scale_fac(1.0f);
+      if (scale_image) {
+        scale_fac = min(max(load8_u(scale_image, idx_p) / load8_u(scale_image, idx_q),
+                            avxf(0.25f)),
+                        avxf(4.0f));
+      }
+      for (int c = 0, chan_ofs = 0; c < numChannels; c++, chan_ofs += channel_offset) {
+        const avxf color_p = load8_u(weight_image, idx_p + chan_ofs);
+        const avxf color_q = scale_fac * load8_u(weight_image, idx_q + chan_ofs);
+        const avxf cdiff = color_p - color_q;
+        const avxf var_p = load8_u(variance_image, idx_p + chan_ofs);
+        const avxf var_q = scale_fac * scale_fac * load8_u(variance_image, idx_q + chan_ofs);
+        diff = diff + (cdiff * cdiff - a * (var_p + min(var_p, var_q))) /
+                          (avxf(1e-8f) + k_2 * (var_p + var_q));
+      }
+      store8_u(difference_image, idx_p, diff * channel_fac8);
+    }
+#endif
+    for (; x < rect.z; x += 4, idx_p += 4, idx_q += 4) {
       float4 diff = make_float4(0.0f);
       float4 scale_fac;
       if (scale_image) {
@@ -75,17 +116,24 @@ ccl_device_inline void kernel_filter_nlm_blur(
   for (int y = rect.y; y < rect.w; y++) {
     const int low = max(rect.y, y - f);
     const int high = min(rect.w, y + f + 1);
-    for (int x = aligned_lowx; x < rect.z; x += 4) {
-      load4_a(out_image, y * stride + x) = make_float4(0.0f);
-    }
-    for (int y1 = low; y1 < high; y1++) {
-      for (int x = aligned_lowx; x < rect.z; x += 4) {
-        load4_a(out_image, y * stride + x) += load4_a(difference_image, y1 * stride + x);
+    const float fac = 1.0f / (high - low);
+    int x = aligned_lowx;
+#ifdef __KERNEL_AVX2__
+    /* Sum in registers, the rows of the window are read once per eight pixels. */
+    for (; x + 8 <= round_up(rect.z, 4); x += 8) {
+      avxf sum(0.0f);
+      for (int y1 = low; y1 < high; y1++) {
+        sum = sum + load8_u(difference_image, y1 * stride + x);
       }
+      store8_u(out_image, y * stride + x, sum * fac);
     }
-    float fac = 1.0f / (high - low);
-    for (int x = aligned_lowx; x < rect.z; x += 4) {
-      load4_a(out_image, y * stride + x) *= fac;
+#endif
+    for (; x < rect.z; x += 4) {
+      float4 sum = make_float4(0.0f);
+      for (int y1 = low; y1 < high; y1++) {
+        sum += load4_a(difference_image, y1 * stride + x);
+      }
+      load4_a(out_image, y * stride + x) = sum * fac;
     }
   }
 }
@@ -106,7 +154,17 @@ ccl_device_inline void nlm_blur_horizontal(
     int4 lowx4 = make_int4(rect.x - min(0, dx));
     int4 highx4 = make_int4(rect.z - max(0, dx));
     for (int y = rect.y; y < rect.w; y++) {
-      for (int x = aligned_lowx; x < highx; x += 4) {
+      int x = aligned_lowx;
+#ifdef __KERNEL_AVX2__
+      for (; x + 8 <= round_up(highx, 4); x += 8) {
+        const avxf diff = load8_u(difference_image, y * stride + x + dx);
+        const avxf out = load8_u(out_image, y * stride + x);
+        store8_u(out_image,
+                 y * stride + x,
+                 out + nlm_mask8(x, rect.x - min(0, dx), rect.z - max(0, dx), diff));
+      }
+#endif
+      for (; x < highx; x += 4) {
         int4 x4 = make_int4(x) + make_int4(0, 1, 2, 3);
         int4 active = (x4 >= lowx4) & (x4 < highx4);
 
@@ -118,7 +176,16 @@ ccl_device_inline void nlm_blur_horizontal(
 
   aligned_lowx = round_down(rect.x, 4);
   for (int y = rect.y; y < rect.w; y++) {
-    for (int x = aligned_lowx; x < rect.z; x += 4) {
+    int x = aligned_lowx;
+#ifdef __KERNEL_AVX2__
+    for (; x + 8 <= round_up(rect.z, 4); x += 8) {
+      const avxf x8 = avxf((float)x) + avxf(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+      const avxf low = max(avxf((float)rect.x), x8 - avxf((float)f));
+      const avxf high = min(avxf((float)rect.z), x8 + avxf((float)(f + 1)));
+      store8_u(out_image, y * stride + x, load8_u(out_image, y * stride + x) / (high - low));
+    }
+#endif
+    for (; x < rect.z; x += 4) {
       float4 x4 = make_float4(x) + make_float4(0.0f, 1.0f, 2.0f, 3.0f);
       float4 low = max(make_float4(rect.x), x4 - make_float4(f));
       float4 high = min(make_float4(rect.z), x4 + make_float4(f + 1));
@@ -134,7 +201,15 @@ ccl_device_inline void kernel_filter_nlm_calc_weight(
 
   int aligned_lowx = round_down(rect.x, 4);
   for (int y = rect.y; y < rect.w; y++) {
-    for (int x = aligned_lowx; x < rect.z; x += 4) {
+    int x = aligned_lowx;
+#ifdef __KERNEL_AVX2__
+    for (; x + 8 <= round_up(rect.z, 4); x += 8) {
+      store8_u(out_image,
+               y * stride + x,
+               fast_expf8(avxf(0.0f) - max(load8_u(out_image, y * stride + x), avxf(0.0f))));
+    }
+#endif
+    for (; x < rect.z; x += 4) {
       load4_a(out_image, y * stride + x) = fast_expf4(
           -max(load4_a(out_image, y * stride + x), make_float4(0.0f)));
     }
@@ -157,7 +232,28 @@ ccl_device_inline void kernel_filter_nlm_update_output(int dx,
 
   int aligned_lowx = round_down(rect.x, 4);
   for (int y = rect.y; y < rect.w; y++) {
-    for (int x = aligned_lowx; x < rect.z; x += 4) {
+    int x = aligned_lowx;
+#ifdef __KERNEL_AVX2__
+    for (; x + 8 <= round_up(rect.z, 4); x += 8) {
+      const int idx_p = y * stride + x, idx_q = (y + dy) * stride + (x + dx);
+
+      const avxf weight = load8_u(temp_image, idx_p);
+      store8_u(
+          accum_image, idx_p, load8_u(accum_image, idx_p) + nlm_mask8(x, rect.x, rect.z, weight));
+
+      avxf val = load8_u(image, idx_q);
+      if (channel_offset) {
+        val = val + load8_u(image, idx_q + channel_offset);
+        val = val + load8_u(image, idx_q + 2 * channel_offset);
+        val = val * (1.0f / 3.0f);
+      }
+
+      store8_u(out_image,
+               idx_p,
+               load8_u(out_image, idx_p) + nlm_mask8(x, rect.x, rect.z, weight * val));
+    }
+#endif
+    for (; x < rect.z; x += 4) {
       int4 x4 = make_int4(x) + make_int4(0, 1, 2, 3);
       int4 active = (x4 >= make_int4(rect.x)) & (x4 < make_int4(rect.z));
 
@@ -250,5 +346,9 @@ ccl_device_inline void kernel_filter_nlm_normalize(float *out_image,
 
 #undef load4_a
 #undef load4_u
+#ifdef __KERNEL_AVX2__
+#  undef load8_u
+#  undef store8_u
+#endif
 
 CCL_NAMESPACE_END
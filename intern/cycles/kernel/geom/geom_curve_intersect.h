@@ -617,6 +617,23 @@ ccl_device_inline bool ribbon_intersect(const float3 ray_org,
   return false;
 }
 
+ccl_device_forceinline bool curve_intersect_shape(KernelGlobals *kg,
+                                                  Intersection *isect,
+                                                  const float3 P,
+                                                  const float3 dir,
+                                                  float4 curve[4],
+                                                  int type)
+{
+  if (type & (PRIMITIVE_CURVE_RIBBON | PRIMITIVE_MOTION_CURVE_RIBBON)) {
+    /* todo: adaptive number of subdivisions could help performance here. */
+    const int subdivisions = kernel_data.bvh.curve_subdivisions;
+    return ribbon_intersect(P, dir, isect->t, subdivisions, curve, isect);
+  }
+  else {
+    return curve_intersect_recursive(P, dir, curve, isect);
+  }
+}
+
 ccl_device_forceinline bool curve_intersect(KernelGlobals *kg,
                                             Intersection *isect,
                                             const float3 P,
@@ -667,28 +684,83 @@ ccl_device_forceinline bool curve_intersect(KernelGlobals *kg,
   }
 #  endif
 
-  if (type & (PRIMITIVE_CURVE_RIBBON | PRIMITIVE_MOTION_CURVE_RIBBON)) {
-    /* todo: adaptive number of subdivisions could help performance here. */
-    const int subdivisions = kernel_data.bvh.curve_subdivisions;
-    if (ribbon_intersect(P, dir, isect->t, subdivisions, curve, isect)) {
-      isect->prim = curveAddr;
-      isect->object = object;
-      isect->type = type;
-      return true;
-    }
+  if (curve_intersect_shape(kg, isect, P, dir, curve, type)) {
+    isect->prim = curveAddr;
+    isect->object = object;
+    isect->type = type;
+    return true;
+  }
 
-    return false;
+  return false;
+}
+
+/* Control points of the last intersected static curve segment. Leaves built from curve strands
+ * hold consecutive segments of the same curve, which share three of their four control points
+ * with the previous segment, so only one key needs to be fetched per segment. */
+typedef struct CurveSegmentKeys {
+  float4 curve[4];
+  int prim;
+  int k1;
+} CurveSegmentKeys;
+
+ccl_device_inline void curve_segment_keys_init(CurveSegmentKeys *keys)
+{
+  keys->prim = PRIM_NONE;
+  keys->k1 = -1;
+}
+
+/* Same as curve_intersect for static curves, reusing control points from the previous call. */
+ccl_device_forceinline bool curve_intersect_strand(KernelGlobals *kg,
+                                                   Intersection *isect,
+                                                   const float3 P,
+                                                   const float3 dir,
+                                                   uint visibility,
+                                                   int object,
+                                                   int curveAddr,
+                                                   int type,
+                                                   CurveSegmentKeys *keys)
+{
+  const int segment = PRIMITIVE_UNPACK_SEGMENT(type);
+  const int prim = kernel_tex_fetch(__prim_index, curveAddr);
+
+  const float4 v00 = kernel_tex_fetch(__curves, prim);
+
+  const int k0 = __float_as_int(v00.x) + segment;
+  const int k1 = k0 + 1;
+  const int kb = min(k1 + 1, __float_as_int(v00.x) + __float_as_int(v00.y) - 1);
+
+  if (prim == keys->prim && k0 == keys->k1) {
+    /* Next segment of the same curve. */
+    keys->curve[0] = keys->curve[1];
+    keys->curve[1] = keys->curve[2];
+    keys->curve[2] = keys->curve[3];
+    keys->curve[3] = kernel_tex_fetch(__curve_keys, kb);
   }
   else {
-    if (curve_intersect_recursive(P, dir, curve, isect)) {
-      isect->prim = curveAddr;
-      isect->object = object;
-      isect->type = type;
-      return true;
-    }
+    const int ka = max(k0 - 1, __float_as_int(v00.x));
+    keys->curve[0] = kernel_tex_fetch(__curve_keys, ka);
+    keys->curve[1] = kernel_tex_fetch(__curve_keys, k0);
+    keys->curve[2] = kernel_tex_fetch(__curve_keys, k1);
+    keys->curve[3] = kernel_tex_fetch(__curve_keys, kb);
+  }
+
+  keys->prim = prim;
+  keys->k1 = k1;
 
+#  ifdef __VISIBILITY_FLAG__
+  if (!(kernel_tex_fetch(__prim_visibility, curveAddr) & visibility)) {
     return false;
   }
+#  endif
+
+  if (curve_intersect_shape(kg, isect, P, dir, keys->curve, type)) {
+    isect->prim = curveAddr;
+    isect->object = object;
+    isect->type = type;
+    return true;
+  }
+
+  return false;
 }
 
 ccl_device_inline void curve_shader_setup(KernelGlobals *kg,
@@ -78,7 +78,8 @@ ccl_device_inline Transform object_fetch_transform_motion(KernelGlobals *kg,
 {
   const uint motion_offset = kernel_tex_fetch(__objects, object).motion_offset;
   const ccl_global DecomposedTransform *motion = &kernel_tex_fetch(__object_motion, motion_offset);
-  const uint num_steps = kernel_tex_fetch(__objects, object).numsteps * 2 + 1;
+  const int geometry = kernel_tex_fetch(__objects, object).geometry;
+  const uint num_steps = kernel_tex_fetch(__object_geometry, geometry).numsteps * 2 + 1;
 
   Transform tfm;
   transform_motion_array_interpolate(&tfm, motion, num_steps, time);
@@ -228,8 +229,10 @@ ccl_device_inline float3 object_color(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return make_float3(0.0f, 0.0f, 0.0f);
 
-  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects, object);
-  return make_float3(kobject->color[0], kobject->color[1], kobject->color[2]);
+  const int attributes = kernel_tex_fetch(__objects, object).attributes;
+  const ccl_global KernelObjectAttributes *kattr = &kernel_tex_fetch(__object_attributes,
+                                                                    attributes);
+  return make_float3(kattr->color[0], kattr->color[1], kattr->color[2]);
 }
 
 /* Pass ID number of object */
@@ -239,7 +242,8 @@ ccl_device_inline float object_pass_id(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0.0f;
 
-  return kernel_tex_fetch(__objects, object).pass_id;
+  const int attributes = kernel_tex_fetch(__objects, object).attributes;
+  return kernel_tex_fetch(__object_attributes, attributes).pass_id;
 }
 
 /* Per lamp random number for shader variation */
@@ -279,9 +283,11 @@ ccl_device_inline float3 object_dupli_generated(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return make_float3(0.0f, 0.0f, 0.0f);
 
-  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects, object);
+  const int attributes = kernel_tex_fetch(__objects, object).attributes;
+  const ccl_global KernelObjectAttributes *kattr = &kernel_tex_fetch(__object_attributes,
+                                                                    attributes);
   return make_float3(
-      kobject->dupli_generated[0], kobject->dupli_generated[1], kobject->dupli_generated[2]);
+      kattr->dupli_generated[0], kattr->dupli_generated[1], kattr->dupli_generated[2]);
 }
 
 /* UV texture coordinate on surface from where object was instanced */
@@ -291,8 +297,10 @@ ccl_device_inline float3 object_dupli_uv(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return make_float3(0.0f, 0.0f, 0.0f);
 
-  const ccl_global KernelObject *kobject = &kernel_tex_fetch(__objects, object);
-  return make_float3(kobject->dupli_uv[0], kobject->dupli_uv[1], 0.0f);
+  const int attributes = kernel_tex_fetch(__objects, object).attributes;
+  const ccl_global KernelObjectAttributes *kattr = &kernel_tex_fetch(__object_attributes,
+                                                                    attributes);
+  return make_float3(kattr->dupli_uv[0], kattr->dupli_uv[1], 0.0f);
 }
 
 /* Information about mesh for motion blurred triangles and curves */
@@ -300,14 +308,16 @@ ccl_device_inline float3 object_dupli_uv(KernelGlobals *kg, int object)
 ccl_device_inline void object_motion_info(
     KernelGlobals *kg, int object, int *numsteps, int *numverts, int *numkeys)
 {
+  const int geometry = kernel_tex_fetch(__objects, object).geometry;
+
   if (numkeys) {
-    *numkeys = kernel_tex_fetch(__objects, object).numkeys;
+    *numkeys = kernel_tex_fetch(__object_geometry, geometry).numkeys;
   }
 
   if (numsteps)
-    *numsteps = kernel_tex_fetch(__objects, object).numsteps;
+    *numsteps = kernel_tex_fetch(__object_geometry, geometry).numsteps;
   if (numverts)
-    *numverts = kernel_tex_fetch(__objects, object).numverts;
+    *numverts = kernel_tex_fetch(__object_geometry, geometry).numverts;
 }
 
 /* Offset to an objects patch map */
@@ -317,7 +327,8 @@ ccl_device_inline uint object_patch_map_offset(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0;
 
-  return kernel_tex_fetch(__objects, object).patch_map_offset;
+  const int geometry = kernel_tex_fetch(__objects, object).geometry;
+  return kernel_tex_fetch(__object_geometry, geometry).patch_map_offset;
 }
 
 /* Volume step size */
@@ -354,7 +365,8 @@ ccl_device_inline float object_cryptomatte_id(KernelGlobals *kg, int object)
   if (object == OBJECT_NONE)
     return 0.0f;
 
-  return kernel_tex_fetch(__objects, object).cryptomatte_object;
+  const int attributes = kernel_tex_fetch(__objects, object).attributes;
+  return kernel_tex_fetch(__object_attributes, attributes).cryptomatte_object;
 }
 
 ccl_device_inline float object_cryptomatte_asset_id(KernelGlobals *kg, int object)
@@ -362,7 +374,8 @@ ccl_device_inline float object_cryptomatte_asset_id(KernelGlobals *kg, int objec
   if (object == OBJECT_NONE)
     return 0;
 
-  return kernel_tex_fetch(__objects, object).cryptomatte_asset;
+  const int attributes = kernel_tex_fetch(__objects, object).attributes;
+  return kernel_tex_fetch(__object_attributes, attributes).cryptomatte_asset;
 }
 
 /* Particle data from which object was instanced */
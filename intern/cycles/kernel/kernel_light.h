@@ -15,6 +15,7 @@
  */
 
 #include "kernel_light_background.h"
+#include "kernel_light_tree.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -292,6 +293,7 @@ ccl_device bool lamp_light_eval(
   }
 
   ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= light_tree_lamp_pdf_scale(kg, lamp, P);
 
   return true;
 }
@@ -651,6 +653,24 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     }
 
     lamp = -prim - 1;
+
+    if (light_tree_contains_lamp(kg, lamp)) {
+      /* The distribution picked one of the lamps in the tree, pick which one by its estimated
+       * contribution at the shading point. */
+      float tree_pdf;
+      lamp = light_tree_sample(kg, P, &randu, &tree_pdf);
+
+      if (lamp < 0 || UNLIKELY(light_select_reached_max_bounces(kg, lamp, bounce))) {
+        return false;
+      }
+
+      if (!lamp_light_sample(kg, lamp, randu, randv, P, ls)) {
+        return false;
+      }
+
+      ls->pdf *= kernel_data.integrator.num_light_tree_lamps * tree_pdf;
+      return true;
+    }
   }
 
   if (UNLIKELY(light_select_reached_max_bounces(kg, lamp, bounce))) {
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Hierarchy over point, spot and area lamps, used to pick a lamp proportional to its estimated
+ * contribution at the shading point instead of uniformly. The flat light distribution still
+ * decides between mesh lights, distant lights and the lamps in the tree, the tree then only
+ * decides which of its lamps is used. */
+
+/* Conservative estimate of the light arriving at P from the lamps below a node, after
+ * "Importance Sampling of Many Lights with Adaptive Tree Splitting" by Conty Estevez and Kulla.
+ * Only returns zero when none of the lamps can emit towards P. */
+ccl_device float light_tree_node_importance(const ccl_global KernelLightTreeNode *knode, float3 P)
+{
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius = 0.5f * len(bbox_max - bbox_min);
+
+  float distance;
+  const float3 D = normalize_len(P - centroid, &distance);
+
+  /* Inside the bounding sphere every direction is possible, and the distance is clamped so
+   * nearby lamps do not get arbitrarily high importance. */
+  if (distance <= radius) {
+    return (radius > 0.0f) ? knode->energy / (radius * radius) : knode->energy;
+  }
+
+  /* Angle between the axis and the direction to P, minus the spread of the normals and the
+   * angle subtended by the bounds. */
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+  const float theta = safe_acosf(dot(axis, D));
+  const float theta_u = safe_asinf(radius / distance);
+  const float theta_prime = max(theta - knode->theta_o - theta_u, 0.0f);
+
+  if (theta_prime >= knode->theta_e) {
+    return 0.0f;
+  }
+
+  return knode->energy * cosf(theta_prime) / (distance * distance);
+}
+
+ccl_device_inline void light_tree_children_importance(KernelGlobals *kg,
+                                                      const ccl_global KernelLightTreeNode *knode,
+                                                      float3 P,
+                                                      float *importance_left,
+                                                      float *importance_right)
+{
+  *importance_left = light_tree_node_importance(
+      &kernel_tex_fetch(__light_tree_nodes, knode->child[0]), P);
+  *importance_right = light_tree_node_importance(
+      &kernel_tex_fetch(__light_tree_nodes, knode->child[1]), P);
+}
+
+/* Descend from the root picking children by importance. Returns the lamp index, or -1 when no
+ * lamp in the tree can contribute to P. The random number is rescaled at every level so the
+ * remainder can be reused for sampling the lamp itself. */
+ccl_device int light_tree_sample(KernelGlobals *kg, float3 P, float *randu, float *pdf)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, 0);
+  float tree_pdf = 1.0f;
+  float r = *randu;
+
+  while (knode->lamp < 0) {
+    float importance_left, importance_right;
+    light_tree_children_importance(kg, knode, P, &importance_left, &importance_right);
+
+    const float total = importance_left + importance_right;
+    if (total == 0.0f) {
+      return -1;
+    }
+
+    const float prob_left = importance_left / total;
+    const float prob_right = importance_right / total;
+
+    if (r < prob_left || prob_right == 0.0f) {
+      r = r / prob_left;
+      tree_pdf *= prob_left;
+      knode = &kernel_tex_fetch(__light_tree_nodes, knode->child[0]);
+    }
+    else {
+      r = (r - prob_left) / prob_right;
+      tree_pdf *= prob_right;
+      knode = &kernel_tex_fetch(__light_tree_nodes, knode->child[1]);
+    }
+  }
+
+  *randu = min(r, 1.0f);
+  *pdf = tree_pdf;
+  return knode->lamp;
+}
+
+/* Probability of light_tree_sample picking the lamp, walking from its leaf up to the root. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, int lamp, float3 P)
+{
+  int index = (int)kernel_tex_fetch(__light_tree_leaf, lamp);
+  float pdf = 1.0f;
+
+  while (index > 0) {
+    const int parent = kernel_tex_fetch(__light_tree_nodes, index).parent;
+    const ccl_global KernelLightTreeNode *kparent = &kernel_tex_fetch(__light_tree_nodes, parent);
+
+    float importance_left, importance_right;
+    light_tree_children_importance(kg, kparent, P, &importance_left, &importance_right);
+
+    const float total = importance_left + importance_right;
+    if (total == 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= ((kparent->child[0] == index) ? importance_left : importance_right) / total;
+    index = parent;
+  }
+
+  return pdf;
+}
+
+ccl_device_inline bool light_tree_contains_lamp(KernelGlobals *kg, int lamp)
+{
+  return kernel_data.integrator.use_light_tree &&
+         (int)kernel_tex_fetch(__light_tree_leaf, lamp) != -1;
+}
+
+/* The lamp pdf computed from pdf_lights assumes every lamp is picked with equal probability.
+ * For lamps in the tree, this factor converts it to the probability of the tree. */
+ccl_device float light_tree_lamp_pdf_scale(KernelGlobals *kg, int lamp, float3 P)
+{
+  if (!light_tree_contains_lamp(kg, lamp)) {
+    return 1.0f;
+  }
+
+  return kernel_data.integrator.num_light_tree_lamps * light_tree_pdf(kg, lamp, P);
+}
+
+CCL_NAMESPACE_END
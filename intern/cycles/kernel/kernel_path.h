@@ -50,6 +50,10 @@
 #include "kernel/kernel_path_surface.h"
 #include "kernel/kernel_path_volume.h"
 #include "kernel/kernel_path_subsurface.h"
+
+#ifdef __BVH_PACKET__
+#  include "kernel/kernel_path_packet.h"
+#endif
 // clang-format on
 
 CCL_NAMESPACE_BEGIN
@@ -520,7 +524,8 @@ ccl_device_forceinline void kernel_path_integrate(KernelGlobals *kg,
                                                   Ray *ray,
                                                   PathRadiance *L,
                                                   ccl_global float *buffer,
-                                                  ShaderData *emission_sd)
+                                                  ShaderData *emission_sd,
+                                                  const Intersection *camera_isect)
 {
   PROFILING_INIT(kg, PROFILING_PATH_INTEGRATE);
 
@@ -536,9 +541,20 @@ ccl_device_forceinline void kernel_path_integrate(KernelGlobals *kg,
 
     /* path iteration */
     for (;;) {
-      /* Find intersection with objects in scene. */
+      /* Find intersection with objects in scene, unless the camera ray was already traced. */
       Intersection isect;
-      bool hit = kernel_path_scene_intersect(kg, state, ray, &isect, L);
+      bool hit;
+      if (camera_isect) {
+        isect = *camera_isect;
+        hit = (isect.prim != PRIM_NONE);
+        camera_isect = NULL;
+#  ifdef __KERNEL_DEBUG__
+        L->debug_data.num_ray_bounces++;
+#  endif
+      }
+      else {
+        hit = kernel_path_scene_intersect(kg, state, ray, &isect, L);
+      }
 
       /* Find intersection with lamps and compute emission for MIS. */
       kernel_path_lamp_emission(kg, state, ray, throughput, &isect, &sd, L);
@@ -699,11 +715,116 @@ ccl_device void kernel_path_trace(
 #  endif
 
   /* Integrate. */
-  kernel_path_integrate(kg, &state, throughput, &ray, &L, buffer, emission_sd);
+  kernel_path_integrate(kg, &state, throughput, &ray, &L, buffer, emission_sd, NULL);
 
   kernel_write_result(kg, buffer, sample, &L);
 }
 
+#  ifdef __BVH_PACKET__
+
+/* Same as kernel_path_trace for a block of up to PATH_PACKET_WIDTH by PATH_PACKET_HEIGHT pixels,
+ * finding the first intersection of all camera rays with packet traversal. Shading and all
+ * further bounces are done one path at a time, with paths ordered by the shader they hit. */
+ccl_device void kernel_path_trace_packet(KernelGlobals *kg,
+                                         ccl_global float *buffer,
+                                         int sample,
+                                         int x,
+                                         int y,
+                                         int w,
+                                         int h,
+                                         int offset,
+                                         int stride)
+{
+  PROFILING_INIT(kg, PROFILING_RAY_SETUP);
+
+  kernel_assert(w <= PATH_PACKET_WIDTH && h <= PATH_PACKET_HEIGHT);
+
+  const int pass_stride = kernel_data.film.pass_stride;
+
+  ShaderDataTinyStorage emission_sd_storage;
+  ShaderData *emission_sd = AS_SHADER_DATA(&emission_sd_storage);
+
+  Ray rays[BVH_PACKET_SIZE];
+  PathState states[BVH_PACKET_SIZE];
+  Intersection isects[BVH_PACKET_SIZE];
+  ccl_global float *buffers[BVH_PACKET_SIZE];
+  uint active_mask = 0;
+  uint packet_mask = 0;
+  uint packet_visibility = 0;
+
+  /* Initialize random numbers, sample rays and initialize states. */
+  for (int i = 0; i < w * h; i++) {
+    const int px = x + i % w;
+    const int py = y + i / w;
+
+    buffers[i] = buffer + (offset + px + py * stride) * pass_stride;
+
+    if (kernel_data.film.pass_adaptive_aux_buffer) {
+      ccl_global float4 *aux = (ccl_global float4 *)(buffers[i] +
+                                                     kernel_data.film.pass_adaptive_aux_buffer);
+      if ((*aux).w > 0.0f) {
+        continue;
+      }
+    }
+
+    uint rng_hash;
+    kernel_path_trace_setup(kg, sample, px, py, &rng_hash, &rays[i]);
+
+    if (rays[i].t == 0.0f) {
+      continue;
+    }
+
+    path_state_init(kg, emission_sd, &states[i], rng_hash, sample, &rays[i]);
+    active_mask |= (1 << i);
+
+    /* Camera rays normally all have the same visibility, any that don't are traced on their
+     * own during integration. */
+    if (path_state_ao_bounce(kg, &states[i])) {
+      continue;
+    }
+
+    const uint visibility = path_state_ray_visibility(kg, &states[i]);
+    if (packet_mask == 0) {
+      packet_visibility = visibility;
+    }
+    if (visibility == packet_visibility) {
+      packet_mask |= (1 << i);
+    }
+  }
+
+  if (packet_mask) {
+    scene_intersect_packet(kg, rays, packet_mask, packet_visibility, isects);
+  }
+
+  int order[BVH_PACKET_SIZE];
+  const int num_paths = kernel_path_packet_sort_by_shader(
+      kg, isects, active_mask, packet_mask, order);
+
+  /* Integrate. */
+  for (int j = 0; j < num_paths; j++) {
+    const int i = order[j];
+    const bool in_packet = (packet_mask & (1 << i)) != 0;
+
+    float3 throughput = make_float3(1.0f, 1.0f, 1.0f);
+
+    PathRadiance L;
+    path_radiance_init(kg, &L);
+
+    kernel_path_integrate(kg,
+                          &states[i],
+                          throughput,
+                          &rays[i],
+                          &L,
+                          buffers[i],
+                          emission_sd,
+                          in_packet ? &isects[i] : NULL);
+
+    kernel_write_result(kg, buffers[i], sample, &L);
+  }
+}
+
+#  endif /* __BVH_PACKET__ */
+
 #endif /* __SPLIT_KERNEL__ */
 
 CCL_NAMESPACE_END
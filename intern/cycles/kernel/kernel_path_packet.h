@@ -0,0 +1,77 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Block of pixels traced as one packet, square to keep the camera rays coherent. */
+#define PATH_PACKET_WIDTH 4
+#define PATH_PACKET_HEIGHT (BVH_PACKET_SIZE / PATH_PACKET_WIDTH)
+
+/* Key to order the paths of a packet by, the shader of the camera ray hit. Rays that miss shade
+ * the background and go after all surfaces. Rays that were not traced in the packet have no
+ * intersection yet and go last, in scanline order. */
+ccl_device_inline uint kernel_path_packet_shader_key(KernelGlobals *kg,
+                                                     const Intersection *isect,
+                                                     const bool in_packet)
+{
+  if (!in_packet) {
+    return 0xffffffff;
+  }
+  else if (isect->prim == PRIM_NONE) {
+    return 0xfffffffe;
+  }
+
+  /* Same lookup as shader_setup_from_ray, isect->prim is the primitive address in the BVH for
+   * both instanced and non-instanced hits. */
+  const int prim = kernel_tex_fetch(__prim_index, isect->prim);
+#ifdef __HAIR__
+  if (isect->type & PRIMITIVE_ALL_CURVE) {
+    return __float_as_int(kernel_tex_fetch(__curves, prim).z) & SHADER_MASK;
+  }
+#endif
+  return kernel_tex_fetch(__tri_shader, prim) & SHADER_MASK;
+}
+
+/* Order the paths in active_mask by shader of their first hit, so the camera rays hitting the
+ * same shader are shaded one after the other. Keeps the shader program, its textures and for OSL
+ * the compiled shader group warm in the caches. Returns the number of paths. */
+ccl_device_inline int kernel_path_packet_sort_by_shader(KernelGlobals *kg,
+                                                        const Intersection *isects,
+                                                        uint active_mask,
+                                                        const uint packet_mask,
+                                                        int *order)
+{
+  uint keys[BVH_PACKET_SIZE];
+  int num_paths = 0;
+
+  /* Insertion sort, stable so paths with the same shader stay in scanline order. */
+  while (active_mask) {
+    const int i = __bscf(active_mask);
+    const uint key = kernel_path_packet_shader_key(kg, &isects[i], (packet_mask & (1 << i)) != 0);
+
+    int j = num_paths++;
+    for (; j > 0 && keys[j - 1] > key; j--) {
+      keys[j] = keys[j - 1];
+      order[j] = order[j - 1];
+    }
+    keys[j] = key;
+    order[j] = i;
+  }
+
+  return num_paths;
+}
+
+CCL_NAMESPACE_END
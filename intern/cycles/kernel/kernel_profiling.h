@@ -34,11 +34,25 @@ CCL_NAMESPACE_BEGIN
     if ((object) != PRIM_NONE) { \
       profiling_helper.set_object(object); \
     }
+#  define PROFILING_CLOSURE(kg, type) (kg)->profiler.closure = (type)
+#  define PROFILING_COUNT(kg, counter, n) (kg)->profiler.count(counter, n)
+/* Counting steps of a loop, the total is added when leaving the scope. */
+#  define PROFILING_COUNT_INIT(kg, counter) \
+    ProfilingCountHelper profiling_count_helper((kg)->profiler.counter_storage(counter))
+#  define PROFILING_COUNT_SVM_NODES_INIT(kg, shader) \
+    ProfilingCountHelper profiling_count_helper( \
+        (kg)->profiler.shader_svm_nodes_storage((shader)&SHADER_MASK))
+#  define PROFILING_COUNT_NEXT() ++profiling_count_helper.count
 #else
 #  define PROFILING_INIT(kg, event)
 #  define PROFILING_EVENT(event)
 #  define PROFILING_SHADER(shader)
 #  define PROFILING_OBJECT(object)
+#  define PROFILING_CLOSURE(kg, type)
+#  define PROFILING_COUNT(kg, counter, n)
+#  define PROFILING_COUNT_INIT(kg, counter)
+#  define PROFILING_COUNT_SVM_NODES_INIT(kg, shader)
+#  define PROFILING_COUNT_NEXT()
 #endif /* __KERNEL_CPU__ */
 
 CCL_NAMESPACE_END
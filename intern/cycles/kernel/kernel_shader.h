@@ -565,6 +565,7 @@ ccl_device_inline void _shader_bsdf_multi_eval(KernelGlobals *kg,
     const ShaderClosure *sc = &sd->closure[i];
 
     if (sc != skip_sc && CLOSURE_IS_BSDF(sc->type)) {
+      PROFILING_CLOSURE(kg, sc->type);
       float bsdf_pdf = 0.0f;
       float3 eval = bsdf_eval(kg, sd, sc, omega_in, &bsdf_pdf);
 
@@ -591,6 +592,7 @@ ccl_device_inline void _shader_bsdf_multi_eval_branched(KernelGlobals *kg,
   for (int i = 0; i < sd->num_closure; i++) {
     const ShaderClosure *sc = &sd->closure[i];
     if (CLOSURE_IS_BSDF(sc->type)) {
+      PROFILING_CLOSURE(kg, sc->type);
       float bsdf_pdf = 0.0f;
       float3 eval = bsdf_eval(kg, sd, sc, omega_in, &bsdf_pdf);
       if (bsdf_pdf != 0.0f) {
@@ -759,6 +761,7 @@ ccl_device_inline int shader_bsdf_sample(KernelGlobals *kg,
   int label;
   float3 eval = make_float3(0.0f, 0.0f, 0.0f);
 
+  PROFILING_CLOSURE(kg, sc->type);
   *pdf = 0.0f;
   label = bsdf_sample(kg, sd, sc, randu, randv, &eval, omega_in, domega_in, pdf);
 
@@ -785,6 +788,7 @@ ccl_device int shader_bsdf_sample_closure(KernelGlobals *kg,
                                           float *pdf)
 {
   PROFILING_INIT(kg, PROFILING_CLOSURE_SAMPLE);
+  PROFILING_CLOSURE(kg, sc->type);
 
   int label;
   float3 eval = make_float3(0.0f, 0.0f, 0.0f);
@@ -1190,6 +1194,7 @@ ccl_device int shader_volume_phase_sample(KernelGlobals *kg,
   int label;
   float3 eval = make_float3(0.0f, 0.0f, 0.0f);
 
+  PROFILING_CLOSURE(kg, sc->type);
   *pdf = 0.0f;
   label = volume_phase_sample(sd, sc, randu, randv, &eval, omega_in, domega_in, pdf);
 
@@ -1211,6 +1216,7 @@ ccl_device int shader_phase_sample_closure(KernelGlobals *kg,
                                            float *pdf)
 {
   PROFILING_INIT(kg, PROFILING_CLOSURE_VOLUME_SAMPLE);
+  PROFILING_CLOSURE(kg, sc->type);
 
   int label;
   float3 eval = make_float3(0.0f, 0.0f, 0.0f);
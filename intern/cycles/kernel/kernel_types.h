@@ -63,6 +63,9 @@ CCL_NAMESPACE_BEGIN
 
 #define VOLUME_STACK_SIZE 32
 
+/* Number of rays traced together by packet BVH traversal. */
+#define BVH_PACKET_SIZE 16
+
 /* Split kernel constants */
 #define WORK_POOL_SIZE_GPU 64
 #define WORK_POOL_SIZE_CPU 1
@@ -128,6 +131,9 @@ CCL_NAMESPACE_BEGIN
 #  endif
 #  define __VOLUME_DECOUPLED__
 #  define __VOLUME_RECORD_ALL__
+#  ifdef __KERNEL_SSE2__
+#    define __BVH_PACKET__
+#  endif
 #endif /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_CUDA__
@@ -1389,7 +1395,9 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1, pad2;
+  /* light tree */
+  int use_light_tree;
+  int num_light_tree_lamps;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1457,34 +1465,53 @@ static_assert_align(KernelData, 16);
 
 /* Kernel data structures. */
 
+/* Per instance object data. Data that is the same for many instances is stored once in the
+ * shared object attribute and geometry arrays, to keep memory usage low for scenes with many
+ * instances. */
 typedef struct KernelObject {
   Transform tfm;
   Transform itfm;
 
   float surface_area;
-  float pass_id;
   float random_number;
-  float color[3];
   int particle_index;
+  uint motion_offset;
+
+  /* Index into the object attributes and geometry arrays. */
+  int attributes;
+  int geometry;
+
+  float shadow_terminator_offset;
+  float pad1;
+} KernelObject;
+static_assert_align(KernelObject, 16);
+
+/* Object attributes, shared between all instances that have the same values. */
+typedef struct KernelObjectAttributes {
+  float color[3];
+  float pass_id;
 
   float dupli_generated[3];
+  float cryptomatte_object;
+
   float dupli_uv[2];
+  float cryptomatte_asset;
+  float pad1;
+} KernelObjectAttributes;
+static_assert_align(KernelObjectAttributes, 16);
 
+/* Geometry data, shared between all instances of the geometry. */
+typedef struct KernelGeometry {
   int numkeys;
   int numsteps;
   int numverts;
 
   uint patch_map_offset;
   uint attribute_map_offset;
-  uint motion_offset;
-
-  float cryptomatte_object;
-  float cryptomatte_asset;
 
-  float shadow_terminator_offset;
-  float pad1, pad2, pad3;
-} KernelObject;
-static_assert_align(KernelObject, 16);
+  int pad1, pad2, pad3;
+} KernelGeometry;
+static_assert_align(KernelGeometry, 16);
 
 typedef struct KernelSpotLight {
   float radius;
@@ -1548,6 +1575,24 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Node of the light tree, bounding the position, orientation and energy of the lamps below it.
+ * Leaf nodes hold a single lamp, inner nodes always have two children. */
+typedef struct KernelLightTreeNode {
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  /* Angle around the axis bounding the normals of the lamps. */
+  float theta_o;
+  float axis[3];
+  /* Angle around the normals into which the lamps emit. */
+  float theta_e;
+  int child[2];
+  int parent;
+  /* Index into the lights array for leaf nodes, -1 for inner nodes. */
+  int lamp;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
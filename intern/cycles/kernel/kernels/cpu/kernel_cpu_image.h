@@ -88,6 +88,28 @@ template<typename T> struct TextureInterpolator {
     return read(data[y * width + x]);
   }
 
+  /* Read a voxel of a 3D image, stored either densely or as a sparse grid. */
+  static ccl_always_inline float4 read_3d(const TextureInfo &info, int x, int y, int z)
+  {
+    const int width = info.width;
+    const int height = info.height;
+
+    if (info.use_sparse_grid) {
+      const int *tiles = (const int *)info.data;
+      const int tile = tiles[sparse_grid_tile_index(x, y, z, width, height)];
+      if (tile == SPARSE_TILE_EMPTY) {
+        return make_float4(0.0f, 0.0f, 0.0f, 1.0f);
+      }
+
+      const T *pool = (const T *)((const char *)info.data +
+                                  sparse_grid_pool_offset(width, height, info.depth));
+      return read(pool[(size_t)tile * SPARSE_TILE_VOXELS + sparse_grid_voxel_index(x, y, z)]);
+    }
+
+    const T *data = (const T *)info.data;
+    return read(data[x + y * width + z * width * height]);
+  }
+
   static ccl_always_inline int wrap_periodic(int x, int width)
   {
     x %= width;
@@ -288,8 +310,7 @@ template<typename T> struct TextureInterpolator {
         return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
 
-    const T *data = (const T *)info.data;
-    return read(data[ix + iy * width + iz * width * height]);
+    return read_3d(info, ix, iy, iz);
   }
 
   static ccl_always_inline float4 interp_3d_linear(const TextureInfo &info,
@@ -336,19 +357,17 @@ template<typename T> struct TextureInterpolator {
         return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
 
-    const T *data = (const T *)info.data;
     float4 r;
 
-    r = (1.0f - tz) * (1.0f - ty) * (1.0f - tx) *
-        read(data[ix + iy * width + iz * width * height]);
-    r += (1.0f - tz) * (1.0f - ty) * tx * read(data[nix + iy * width + iz * width * height]);
-    r += (1.0f - tz) * ty * (1.0f - tx) * read(data[ix + niy * width + iz * width * height]);
-    r += (1.0f - tz) * ty * tx * read(data[nix + niy * width + iz * width * height]);
+    r = (1.0f - tz) * (1.0f - ty) * (1.0f - tx) * read_3d(info, ix, iy, iz);
+    r += (1.0f - tz) * (1.0f - ty) * tx * read_3d(info, nix, iy, iz);
+    r += (1.0f - tz) * ty * (1.0f - tx) * read_3d(info, ix, niy, iz);
+    r += (1.0f - tz) * ty * tx * read_3d(info, nix, niy, iz);
 
-    r += tz * (1.0f - ty) * (1.0f - tx) * read(data[ix + iy * width + niz * width * height]);
-    r += tz * (1.0f - ty) * tx * read(data[nix + iy * width + niz * width * height]);
-    r += tz * ty * (1.0f - tx) * read(data[ix + niy * width + niz * width * height]);
-    r += tz * ty * tx * read(data[nix + niy * width + niz * width * height]);
+    r += tz * (1.0f - ty) * (1.0f - tx) * read_3d(info, ix, iy, niz);
+    r += tz * (1.0f - ty) * tx * read_3d(info, nix, iy, niz);
+    r += tz * ty * (1.0f - tx) * read_3d(info, ix, niy, niz);
+    r += tz * ty * tx * read_3d(info, nix, niy, niz);
 
     return r;
   }
@@ -424,15 +443,14 @@ template<typename T> struct TextureInterpolator {
     }
 
     const int xc[4] = {pix, ix, nix, nnix};
-    const int yc[4] = {width * piy, width * iy, width * niy, width * nniy};
-    const int zc[4] = {
-        width * height * piz, width * height * iz, width * height * niz, width * height * nniz};
+    const int yc[4] = {piy, iy, niy, nniy};
+    const int zc[4] = {piz, iz, niz, nniz};
     float u[4], v[4], w[4];
 
     /* Some helper macro to keep code reasonable size,
      * let compiler to inline all the matrix multiplications.
      */
-#define DATA(x, y, z) (read(data[xc[x] + yc[y] + zc[z]]))
+#define DATA(x, y, z) (read_3d(info, xc[x], yc[y], zc[z]))
 #define COL_TERM(col, row) \
   (v[col] * (u[0] * DATA(0, col, row) + u[1] * DATA(1, col, row) + u[2] * DATA(2, col, row) + \
              u[3] * DATA(3, col, row)))
@@ -444,7 +462,6 @@ template<typename T> struct TextureInterpolator {
     SET_CUBIC_SPLINE_WEIGHTS(w, tz);
 
     /* Actual interpolation. */
-    const T *data = (const T *)info.data;
     return ROW_TERM(0) + ROW_TERM(1) + ROW_TERM(2) + ROW_TERM(3);
 
 #undef COL_TERM
@@ -470,10 +487,25 @@ template<typename T> struct TextureInterpolator {
 #undef SET_CUBIC_SPLINE_WEIGHTS
 };
 
+/* Lookup in the image cache, the derivatives select the mip level. */
+ccl_device float4 kernel_tex_image_interp_cache(
+    const TextureInfo &info, float x, float y, float2 duv_dx, float2 duv_dy)
+{
+  const TextureCacheHandle *handle = (const TextureCacheHandle *)info.data;
+  float result[4];
+  handle->lookup(handle, x, y, duv_dx.x, duv_dx.y, duv_dy.x, duv_dy.y, result);
+  return make_float4(result[0], result[1], result[2], result[3]);
+}
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (info.use_cache) {
+    return kernel_tex_image_interp_cache(
+        info, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f));
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -498,6 +530,20 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Same as kernel_tex_image_interp, with derivatives of the texture coordinates for filtering
+ * images read through the image cache. */
+ccl_device float4 kernel_tex_image_interp_filtered(
+    KernelGlobals *kg, int id, float x, float y, float2 duv_dx, float2 duv_dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (info.use_cache) {
+    return kernel_tex_image_interp_cache(info, x, y, duv_dx, duv_dy);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
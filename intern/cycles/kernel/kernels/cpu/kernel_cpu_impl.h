@@ -98,6 +98,46 @@ void KERNEL_FUNCTION_FULL_NAME(path_trace)(
 #  endif /* KERNEL_STUB */
 }
 
+void KERNEL_FUNCTION_FULL_NAME(path_trace_packet)(KernelGlobals *kg,
+                                                  float *buffer,
+                                                  int sample,
+                                                  int x,
+                                                  int y,
+                                                  int w,
+                                                  int h,
+                                                  int offset,
+                                                  int stride)
+{
+#  ifdef KERNEL_STUB
+  STUB_ASSERT(KERNEL_ARCH, path_trace_packet);
+#  else
+#    ifdef __BVH_PACKET__
+  if (!kernel_data.integrator.branched && scene_intersect_packet_supported(kg)) {
+    for (int py = y; py < y + h; py += PATH_PACKET_HEIGHT) {
+      for (int px = x; px < x + w; px += PATH_PACKET_WIDTH) {
+        kernel_path_trace_packet(kg,
+                                 buffer,
+                                 sample,
+                                 px,
+                                 py,
+                                 min(PATH_PACKET_WIDTH, x + w - px),
+                                 min(PATH_PACKET_HEIGHT, y + h - py),
+                                 offset,
+                                 stride);
+      }
+    }
+    return;
+  }
+#    endif /* __BVH_PACKET__ */
+
+  for (int py = y; py < y + h; py++) {
+    for (int px = x; px < x + w; px++) {
+      KERNEL_FUNCTION_FULL_NAME(path_trace)(kg, buffer, sample, px, py, offset, stride);
+    }
+  }
+#  endif /* KERNEL_STUB */
+}
+
 /* Film */
 
 void KERNEL_FUNCTION_FULL_NAME(convert_to_byte)(KernelGlobals *kg,
@@ -226,9 +226,11 @@ ccl_device_noinline void svm_eval_nodes(KernelGlobals *kg,
 {
   float stack[SVM_STACK_SIZE];
   int offset = sd->shader & SHADER_MASK;
+  PROFILING_COUNT_SVM_NODES_INIT(kg, sd->shader);
 
   while (1) {
     uint4 node = read_node(kg, &offset);
+    PROFILING_COUNT_NEXT();
 
     switch (node.x) {
       case NODE_END:
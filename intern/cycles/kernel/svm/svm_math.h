@@ -27,9 +27,16 @@ ccl_device void svm_node_math(KernelGlobals *kg,
   uint a_stack_offset, b_stack_offset, c_stack_offset;
   svm_unpack_node_uchar3(inputs_stack_offsets, &a_stack_offset, &b_stack_offset, &c_stack_offset);
 
-  float a = stack_load_float(stack, a_stack_offset);
-  float b = stack_load_float(stack, b_stack_offset);
-  float c = stack_load_float(stack, c_stack_offset);
+  /* Constant operands are stored in the next node, saving a value node for each of them. */
+  uint4 defaults = make_uint4(0, 0, 0, 0);
+  if (!stack_valid(a_stack_offset) || !stack_valid(b_stack_offset) ||
+      !stack_valid(c_stack_offset)) {
+    defaults = read_node(kg, offset);
+  }
+
+  float a = stack_load_float_default(stack, a_stack_offset, defaults.x);
+  float b = stack_load_float_default(stack, b_stack_offset, defaults.y);
+  float c = stack_load_float_default(stack, c_stack_offset, defaults.z);
   float result = svm_math((NodeMathType)type, a, b, c);
 
   stack_store_float(stack, result_stack_offset, result);
@@ -49,13 +56,7 @@ ccl_device void svm_node_vector_math(KernelGlobals *kg,
       inputs_stack_offsets, &a_stack_offset, &b_stack_offset, &scale_stack_offset);
   svm_unpack_node_uchar2(outputs_stack_offsets, &value_stack_offset, &vector_stack_offset);
 
-  float3 a = stack_load_float3(stack, a_stack_offset);
-  float3 b = stack_load_float3(stack, b_stack_offset);
   float3 c = make_float3(0.0f, 0.0f, 0.0f);
-  float scale = stack_load_float(stack, scale_stack_offset);
-
-  float value;
-  float3 vector;
 
   /* 3 Vector Operators */
   if (type == NODE_VECTOR_MATH_WRAP) {
@@ -63,6 +64,17 @@ ccl_device void svm_node_vector_math(KernelGlobals *kg,
     c = stack_load_float3(stack, extra_node.x);
   }
 
+  /* Constant operands are stored in the following nodes, in this order. */
+  float3 a = stack_valid(a_stack_offset) ? stack_load_float3(stack, a_stack_offset) :
+                                           float4_to_float3(read_node_float(kg, offset));
+  float3 b = stack_valid(b_stack_offset) ? stack_load_float3(stack, b_stack_offset) :
+                                           float4_to_float3(read_node_float(kg, offset));
+  float scale = stack_valid(scale_stack_offset) ? stack_load_float(stack, scale_stack_offset) :
+                                                  __uint_as_float(read_node(kg, offset).x);
+
+  float value;
+  float3 vector;
+
   svm_vector_math(&value, &vector, (NodeVectorMathType)type, a, b, c, scale);
 
   if (stack_valid(value_stack_offset))
@@ -40,6 +40,8 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_task.h"
+#include "util/util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -71,6 +73,7 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
 
   bvh = NULL;
   attr_map_offset = 0;
+  index = 0;
   optix_prim_offset = 0;
   prim_offset = 0;
 }
@@ -192,15 +195,25 @@ void Geometry::compute_bvh(
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    bool rebuild = (bvh == NULL || need_update_rebuild);
+
+    if (!rebuild) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->geometry = geometry;
       bvh->objects = objects;
 
       bvh->refit(*progress);
+
+      /* Vertices moved too far from how the tree grouped them. */
+      if (bvh->refit_degraded(params->bvh_refit_threshold)) {
+        VLOG(2) << "Rebuilding BVH of " << name << ", refit cost " << bvh->refit_sah_cost
+                << " built cost " << bvh->build_sah_cost << ".";
+        rebuild = true;
+      }
     }
-    else {
+
+    if (rebuild) {
       progress->set_status(msg, "Building BVH");
 
       BVHParams bparams;
@@ -210,6 +223,7 @@ void Geometry::compute_bvh(
                                     params->use_bvh_unaligned_nodes;
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
+      bparams.curve_strand_segments = params->bvh_curve_strand_segments;
       bparams.bvh_type = params->bvh_type;
       bparams.curve_subdivisions = params->curve_subdivisions();
 
@@ -263,10 +277,12 @@ GeometryManager::GeometryManager()
 {
   need_update = true;
   need_flags_update = true;
+  scene_bvh = NULL;
 }
 
 GeometryManager::~GeometryManager()
 {
+  delete scene_bvh;
 }
 
 void GeometryManager::update_osl_attributes(Device *device,
@@ -513,6 +529,7 @@ static void update_attribute_element_offset(Geometry *geom,
                                             size_t &attr_float3_offset,
                                             device_vector<uchar4> &attr_uchar4,
                                             size_t &attr_uchar4_offset,
+                                            bool copy_data,
                                             Attribute *mattr,
                                             AttributePrimitive prim,
                                             TypeDesc &type,
@@ -540,8 +557,10 @@ static void update_attribute_element_offset(Geometry *geom,
       offset = attr_uchar4_offset;
 
       assert(attr_uchar4.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_uchar4[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_uchar4[offset + k] = data[k];
+        }
       }
       attr_uchar4_offset += size;
     }
@@ -550,8 +569,10 @@ static void update_attribute_element_offset(Geometry *geom,
       offset = attr_float_offset;
 
       assert(attr_float.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_float[offset + k] = data[k];
+        }
       }
       attr_float_offset += size;
     }
@@ -560,8 +581,10 @@ static void update_attribute_element_offset(Geometry *geom,
       offset = attr_float2_offset;
 
       assert(attr_float2.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float2[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_float2[offset + k] = data[k];
+        }
       }
       attr_float2_offset += size;
     }
@@ -570,8 +593,10 @@ static void update_attribute_element_offset(Geometry *geom,
       offset = attr_float3_offset;
 
       assert(attr_float3.size() >= offset + size * 3);
-      for (size_t k = 0; k < size * 3; k++) {
-        attr_float3[offset + k] = (&tfm->x)[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size * 3; k++) {
+          attr_float3[offset + k] = (&tfm->x)[k];
+        }
       }
       attr_float3_offset += size * 3;
     }
@@ -580,8 +605,10 @@ static void update_attribute_element_offset(Geometry *geom,
       offset = attr_float3_offset;
 
       assert(attr_float3.size() >= offset + size);
-      for (size_t k = 0; k < size; k++) {
-        attr_float3[offset + k] = data[k];
+      if (copy_data) {
+        for (size_t k = 0; k < size; k++) {
+          attr_float3[offset + k] = data[k];
+        }
       }
       attr_float3_offset += size;
     }
@@ -632,6 +659,8 @@ static void update_attribute_element_offset(Geometry *geom,
 void GeometryManager::device_update_attributes(Device *device,
                                                DeviceScene *dscene,
                                                Scene *scene,
+                                               bool pack_all,
+                                               const vector<bool> &geom_modified,
                                                Progress &progress)
 {
   progress.set_status("Updating Mesh", "Computing attributes");
@@ -656,15 +685,26 @@ void GeometryManager::device_update_attributes(Device *device,
    * maps next */
 
   /* Pre-allocate attributes to avoid arrays re-allocation which would
-   * take 2x of overall attribute memory usage.
+   * take 2x of overall attribute memory usage. The start of every geometry
+   * in the arrays is recorded, so they can be filled in parallel.
    */
   size_t attr_float_size = 0;
   size_t attr_float2_size = 0;
   size_t attr_float3_size = 0;
   size_t attr_uchar4_size = 0;
+
+  vector<size_t> layout;
+  layout.reserve(scene->geometry.size() * 4);
+
   for (size_t i = 0; i < scene->geometry.size(); i++) {
     Geometry *geom = scene->geometry[i];
     AttributeRequestSet &attributes = geom_attributes[i];
+
+    layout.push_back(attr_float_size);
+    layout.push_back(attr_float2_size);
+    layout.push_back(attr_float3_size);
+    layout.push_back(attr_uchar4_size);
+
     foreach (AttributeRequest &req, attributes.requests) {
       Attribute *attr = geom->attributes.find(req);
 
@@ -691,62 +731,85 @@ void GeometryManager::device_update_attributes(Device *device,
     }
   }
 
+  layout.push_back(attr_float_size);
+  layout.push_back(attr_float2_size);
+  layout.push_back(attr_float3_size);
+  layout.push_back(attr_uchar4_size);
+
+  /* With the same layout as the previous update, unmodified geometry is still in the arrays. */
+  if (layout != packed_attribute_layout) {
+    pack_all = true;
+    packed_attribute_layout.swap(layout);
+  }
+
   dscene->attributes_float.alloc(attr_float_size);
   dscene->attributes_float2.alloc(attr_float2_size);
   dscene->attributes_float3.alloc(attr_float3_size);
   dscene->attributes_uchar4.alloc(attr_uchar4_size);
 
-  size_t attr_float_offset = 0;
-  size_t attr_float2_offset = 0;
-  size_t attr_float3_offset = 0;
-  size_t attr_uchar4_offset = 0;
-
-  /* Fill in attributes. */
+  /* Fill in attributes. Descriptors are computed for all geometry, data is only copied for
+   * geometry that needs to be packed. */
+  bool any_packed = false;
   for (size_t i = 0; i < scene->geometry.size(); i++) {
-    Geometry *geom = scene->geometry[i];
-    AttributeRequestSet &attributes = geom_attributes[i];
-
-    /* todo: we now store std and name attributes from requests even if
-     * they actually refer to the same mesh attributes, optimize */
-    foreach (AttributeRequest &req, attributes.requests) {
-      Attribute *attr = geom->attributes.find(req);
-      update_attribute_element_offset(geom,
-                                      dscene->attributes_float,
-                                      attr_float_offset,
-                                      dscene->attributes_float2,
-                                      attr_float2_offset,
-                                      dscene->attributes_float3,
-                                      attr_float3_offset,
-                                      dscene->attributes_uchar4,
-                                      attr_uchar4_offset,
-                                      attr,
-                                      ATTR_PRIM_GEOMETRY,
-                                      req.type,
-                                      req.desc);
-
-      if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        Attribute *subd_attr = mesh->subd_attributes.find(req);
+    any_packed |= pack_all || geom_modified[i];
+  }
 
-        update_attribute_element_offset(mesh,
-                                        dscene->attributes_float,
-                                        attr_float_offset,
-                                        dscene->attributes_float2,
-                                        attr_float2_offset,
-                                        dscene->attributes_float3,
-                                        attr_float3_offset,
-                                        dscene->attributes_uchar4,
-                                        attr_uchar4_offset,
-                                        subd_attr,
-                                        ATTR_PRIM_SUBD,
-                                        req.subd_type,
-                                        req.subd_desc);
-      }
+  parallel_for(
+      blocked_range<size_t>(0, scene->geometry.size(), 1), [&](const blocked_range<size_t> &r) {
+        for (size_t i = r.begin(); i != r.end(); i++) {
+          Geometry *geom = scene->geometry[i];
+          AttributeRequestSet &attributes = geom_attributes[i];
+          const bool copy_data = pack_all || geom_modified[i];
+
+          size_t attr_float_offset = packed_attribute_layout[i * 4 + 0];
+          size_t attr_float2_offset = packed_attribute_layout[i * 4 + 1];
+          size_t attr_float3_offset = packed_attribute_layout[i * 4 + 2];
+          size_t attr_uchar4_offset = packed_attribute_layout[i * 4 + 3];
+
+          /* todo: we now store std and name attributes from requests even if
+           * they actually refer to the same mesh attributes, optimize */
+          foreach (AttributeRequest &req, attributes.requests) {
+            Attribute *attr = geom->attributes.find(req);
+            update_attribute_element_offset(geom,
+                                            dscene->attributes_float,
+                                            attr_float_offset,
+                                            dscene->attributes_float2,
+                                            attr_float2_offset,
+                                            dscene->attributes_float3,
+                                            attr_float3_offset,
+                                            dscene->attributes_uchar4,
+                                            attr_uchar4_offset,
+                                            copy_data,
+                                            attr,
+                                            ATTR_PRIM_GEOMETRY,
+                                            req.type,
+                                            req.desc);
+
+            if (geom->type == Geometry::MESH) {
+              Mesh *mesh = static_cast<Mesh *>(geom);
+              Attribute *subd_attr = mesh->subd_attributes.find(req);
+
+              update_attribute_element_offset(mesh,
+                                              dscene->attributes_float,
+                                              attr_float_offset,
+                                              dscene->attributes_float2,
+                                              attr_float2_offset,
+                                              dscene->attributes_float3,
+                                              attr_float3_offset,
+                                              dscene->attributes_uchar4,
+                                              attr_uchar4_offset,
+                                              copy_data,
+                                              subd_attr,
+                                              ATTR_PRIM_SUBD,
+                                              req.subd_type,
+                                              req.subd_desc);
+            }
+          }
+        }
+      });
 
-      if (progress.get_cancel())
-        return;
-    }
-  }
+  if (progress.get_cancel())
+    return;
 
   /* create attribute lookup maps */
   if (scene->shader_manager->use_osl())
@@ -760,17 +823,19 @@ void GeometryManager::device_update_attributes(Device *device,
   /* copy to device */
   progress.set_status("Updating Mesh", "Copying Attributes to device");
 
-  if (dscene->attributes_float.size()) {
-    dscene->attributes_float.copy_to_device();
-  }
-  if (dscene->attributes_float2.size()) {
-    dscene->attributes_float2.copy_to_device();
-  }
-  if (dscene->attributes_float3.size()) {
-    dscene->attributes_float3.copy_to_device();
-  }
-  if (dscene->attributes_uchar4.size()) {
-    dscene->attributes_uchar4.copy_to_device();
+  if (any_packed) {
+    if (dscene->attributes_float.size()) {
+      dscene->attributes_float.copy_to_device();
+    }
+    if (dscene->attributes_float2.size()) {
+      dscene->attributes_float2.copy_to_device();
+    }
+    if (dscene->attributes_float3.size()) {
+      dscene->attributes_float3.copy_to_device();
+    }
+    if (dscene->attributes_uchar4.size()) {
+      dscene->attributes_uchar4.copy_to_device();
+    }
   }
 
   if (progress.get_cancel())
@@ -781,8 +846,15 @@ void GeometryManager::device_update_attributes(Device *device,
   scene->object_manager->device_update_mesh_offsets(device, dscene, scene);
 }
 
-void GeometryManager::mesh_calc_offset(Scene *scene)
+bool GeometryManager::mesh_calc_offset(Scene *scene)
 {
+  /* Shader ids are packed along with the geometry, so they are part of the layout. */
+  vector<size_t> layout;
+  layout.reserve(scene->shaders.size() + scene->geometry.size() * 8);
+  foreach (Shader *shader, scene->shaders) {
+    layout.push_back((size_t)shader);
+  }
+
   size_t vert_size = 0;
   size_t tri_size = 0;
 
@@ -838,11 +910,33 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
       hair->optix_prim_offset = optix_prim_size;
       optix_prim_size += hair->num_segments();
     }
+
+    /* Offsets of the following geometry in all arrays are determined by these. */
+    layout.push_back((size_t)geom);
+    layout.push_back(vert_size);
+    layout.push_back(tri_size);
+    layout.push_back(curve_key_size);
+    layout.push_back(curve_size);
+    layout.push_back(patch_size);
+    layout.push_back(face_size);
+    layout.push_back(corner_size);
   }
+
+  if (layout == packed_mesh_layout) {
+    return false;
+  }
+
+  packed_mesh_layout.swap(layout);
+  return true;
 }
 
-void GeometryManager::device_update_mesh(
-    Device *, DeviceScene *dscene, Scene *scene, bool for_displacement, Progress &progress)
+void GeometryManager::device_update_mesh(Device *,
+                                         DeviceScene *dscene,
+                                         Scene *scene,
+                                         bool for_displacement,
+                                         bool pack_all,
+                                         const vector<bool> &geom_modified,
+                                         Progress &progress)
 {
   /* Count. */
   size_t vert_size = 0;
@@ -879,6 +973,17 @@ void GeometryManager::device_update_mesh(
     }
   }
 
+  /* Geometry to pack, with a stable layout the arrays still hold the other geometry. */
+  vector<Geometry *> pack_geometry;
+  for (size_t i = 0; i < scene->geometry.size(); i++) {
+    if (pack_all || geom_modified[i]) {
+      pack_geometry.push_back(scene->geometry[i]);
+    }
+  }
+
+  /* Parallel packing, per geometry since they write to separate ranges of the arrays. */
+  static const int PRIMS_PER_TASK = 4096;
+
   /* Create mapping from triangle to primitive triangle array. */
   vector<uint> tri_prim_index(tri_size);
   if (for_displacement) {
@@ -897,11 +1002,14 @@ void GeometryManager::device_update_mesh(
     }
   }
   else {
-    for (size_t i = 0; i < dscene->prim_index.size(); ++i) {
-      if ((dscene->prim_type[i] & PRIMITIVE_ALL_TRIANGLE) != 0) {
-        tri_prim_index[dscene->prim_index[i]] = dscene->prim_tri_index[i];
-      }
-    }
+    parallel_for(blocked_range<size_t>(0, dscene->prim_index.size(), PRIMS_PER_TASK),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     if ((dscene->prim_type[i] & PRIMITIVE_ALL_TRIANGLE) != 0) {
+                       tri_prim_index[dscene->prim_index[i]] = dscene->prim_tri_index[i];
+                     }
+                   }
+                 });
   }
 
   /* Fill in all the arrays. */
@@ -915,76 +1023,115 @@ void GeometryManager::device_update_mesh(
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
-        mesh->pack_normals(&vnormal[mesh->vert_offset]);
-        mesh->pack_verts(tri_prim_index,
-                         &tri_vindex[mesh->prim_offset],
-                         &tri_patch[mesh->prim_offset],
-                         &tri_patch_uv[mesh->vert_offset],
-                         mesh->vert_offset,
-                         mesh->prim_offset);
-        if (progress.get_cancel())
-          return;
-      }
+    parallel_for(blocked_range<size_t>(0, pack_geometry.size(), 1),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     if (pack_geometry[i]->type != Geometry::MESH || progress.get_cancel()) {
+                       continue;
+                     }
+
+                     Mesh *mesh = static_cast<Mesh *>(pack_geometry[i]);
+                     mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+                     mesh->pack_normals(&vnormal[mesh->vert_offset]);
+                     mesh->pack_verts(tri_prim_index,
+                                      &tri_vindex[mesh->prim_offset],
+                                      &tri_patch[mesh->prim_offset],
+                                      &tri_patch_uv[mesh->vert_offset],
+                                      mesh->vert_offset,
+                                      mesh->prim_offset);
+                   }
+                 });
+
+    if (!pack_all) {
+      /* The BVH is rebuilt on every update and may reorder the primitives, so the primitive
+       * index of unmodified meshes needs to be updated as well. */
+      parallel_for(blocked_range<size_t>(0, scene->geometry.size(), 1),
+                   [&](const blocked_range<size_t> &r) {
+                     for (size_t i = r.begin(); i != r.end(); i++) {
+                       if (geom_modified[i] || scene->geometry[i]->type != Geometry::MESH) {
+                         continue;
+                       }
+
+                       Mesh *mesh = static_cast<Mesh *>(scene->geometry[i]);
+                       const size_t triangles_size = mesh->num_triangles();
+                       for (size_t j = 0; j < triangles_size; j++) {
+                         tri_vindex[mesh->prim_offset + j].w =
+                             tri_prim_index[mesh->prim_offset + j];
+                       }
+                     }
+                   });
     }
 
+    if (progress.get_cancel())
+      return;
+
     /* vertex coordinates */
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
-    dscene->tri_shader.copy_to_device();
-    dscene->tri_vnormal.copy_to_device();
+    if (!pack_geometry.empty()) {
+      dscene->tri_shader.copy_to_device();
+      dscene->tri_vnormal.copy_to_device();
+      dscene->tri_patch.copy_to_device();
+      dscene->tri_patch_uv.copy_to_device();
+    }
     dscene->tri_vindex.copy_to_device();
-    dscene->tri_patch.copy_to_device();
-    dscene->tri_patch_uv.copy_to_device();
   }
 
-  if (curve_size != 0) {
+  if (curve_size != 0 && !pack_geometry.empty()) {
     progress.set_status("Updating Mesh", "Copying Strands to device");
 
     float4 *curve_keys = dscene->curve_keys.alloc(curve_key_size);
     float4 *curves = dscene->curves.alloc(curve_size);
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->type == Geometry::HAIR) {
-        Hair *hair = static_cast<Hair *>(geom);
-        hair->pack_curves(scene,
-                          &curve_keys[hair->curvekey_offset],
-                          &curves[hair->prim_offset],
-                          hair->curvekey_offset);
-        if (progress.get_cancel())
-          return;
-      }
-    }
+    parallel_for(blocked_range<size_t>(0, pack_geometry.size(), 1),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     if (pack_geometry[i]->type != Geometry::HAIR || progress.get_cancel()) {
+                       continue;
+                     }
+
+                     Hair *hair = static_cast<Hair *>(pack_geometry[i]);
+                     hair->pack_curves(scene,
+                                       &curve_keys[hair->curvekey_offset],
+                                       &curves[hair->prim_offset],
+                                       hair->curvekey_offset);
+                   }
+                 });
+
+    if (progress.get_cancel())
+      return;
 
     dscene->curve_keys.copy_to_device();
     dscene->curves.copy_to_device();
   }
 
-  if (patch_size != 0) {
+  if (patch_size != 0 && !pack_geometry.empty()) {
     progress.set_status("Updating Mesh", "Copying Patches to device");
 
     uint *patch_data = dscene->patches.alloc(patch_size);
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        mesh->pack_patches(&patch_data[mesh->patch_offset],
-                           mesh->vert_offset,
-                           mesh->face_offset,
-                           mesh->corner_offset);
+    parallel_for(blocked_range<size_t>(0, pack_geometry.size(), 1),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     if (pack_geometry[i]->type != Geometry::MESH || progress.get_cancel()) {
+                       continue;
+                     }
+
+                     Mesh *mesh = static_cast<Mesh *>(pack_geometry[i]);
+                     mesh->pack_patches(&patch_data[mesh->patch_offset],
+                                        mesh->vert_offset,
+                                        mesh->face_offset,
+                                        mesh->corner_offset);
+
+                     if (mesh->patch_table) {
+                       mesh->patch_table->copy_adjusting_offsets(
+                           &patch_data[mesh->patch_table_offset], mesh->patch_table_offset);
+                     }
+                   }
+                 });
 
-        if (mesh->patch_table) {
-          mesh->patch_table->copy_adjusting_offsets(&patch_data[mesh->patch_table_offset],
-                                                    mesh->patch_table_offset);
-        }
-
-        if (progress.get_cancel())
-          return;
-      }
-    }
+    if (progress.get_cancel())
+      return;
 
     dscene->patches.copy_to_device();
   }
@@ -1007,14 +1154,8 @@ void GeometryManager::device_update_mesh(
   }
 }
 
-void GeometryManager::device_update_bvh(Device *device,
-                                        DeviceScene *dscene,
-                                        Scene *scene,
-                                        Progress &progress)
+static BVHParams scene_bvh_params(Device *device, DeviceScene *dscene, Scene *scene)
 {
-  /* bvh build */
-  progress.set_status("Updating Scene BVH", "Building");
-
   BVHParams bparams;
   bparams.top_level = true;
   bparams.bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
@@ -1024,23 +1165,144 @@ void GeometryManager::device_update_bvh(Device *device,
                                 scene->params.use_bvh_unaligned_nodes;
   bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
+  bparams.curve_strand_segments = scene->params.bvh_curve_strand_segments;
   bparams.bvh_type = scene->params.bvh_type;
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
+  return bparams;
+}
 
-  VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
+/* Only BVH2 can be refit, and only without instances since their nodes are copies of the
+ * geometry BVH nodes. In practice this is the static BVH used for final renders. */
+static bool scene_bvh_can_refit(const BVHParams &bparams, Scene *scene)
+{
+  if (bparams.bvh_layout != BVH_LAYOUT_BVH2 || scene->params.bvh_refit_threshold <= 0.0f) {
+    return false;
+  }
 
-  BVH *bvh = BVH::create(bparams, scene->geometry, scene->objects);
-  bvh->build(progress, &device->stats);
+  foreach (Object *object, scene->objects) {
+    if (object->geometry->need_build_bvh(bparams.bvh_layout)) {
+      return false;
+    }
+  }
 
-  if (progress.get_cancel()) {
-#ifdef WITH_EMBREE
-    if (dscene->data.bvh.scene) {
-      BVHEmbree::destroy(dscene->data.bvh.scene);
-      dscene->data.bvh.scene = NULL;
+  return true;
+}
+
+bool GeometryManager::device_can_refit_bvh(Device *device,
+                                           DeviceScene *dscene,
+                                           Scene *scene,
+                                           bool pack_all)
+{
+  if (scene_bvh == NULL || pack_all) {
+    return false;
+  }
+
+  /* Same objects, geometry and primitives as when the BVH was built. Objects becoming visible
+   * or hidden for tracing are tested once their bounds are known. */
+  const BVHParams bparams = scene_bvh_params(device, dscene, scene);
+  if (!scene_bvh_can_refit(bparams, scene) ||
+      bparams.use_unaligned_nodes != scene_bvh->params.use_unaligned_nodes ||
+      scene->objects != scene_bvh->objects || scene->geometry != scene_bvh->geometry) {
+    return false;
+  }
+
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    if (scene->objects[i]->geometry != scene_bvh_object_geometry[i]) {
+      return false;
     }
+  }
+
+  foreach (Geometry *geom, scene->geometry) {
+    if (geom->need_update_rebuild) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Take the packed arrays back from the device scene, to update them in place. Returns false
+ * when they do not match the BVH, in which case it must be built again. */
+static bool scene_bvh_reclaim(BVH *bvh, DeviceScene *dscene)
+{
+  PackedBVH &pack = bvh->pack;
+  dscene->bvh_nodes.give_data(pack.nodes);
+  dscene->bvh_leaf_nodes.give_data(pack.leaf_nodes);
+  dscene->object_node.give_data(pack.object_node);
+  dscene->prim_tri_index.give_data(pack.prim_tri_index);
+  dscene->prim_tri_verts.give_data(pack.prim_tri_verts);
+  dscene->prim_type.give_data(pack.prim_type);
+  dscene->prim_visibility.give_data(pack.prim_visibility);
+  dscene->prim_index.give_data(pack.prim_index);
+  dscene->prim_object.give_data(pack.prim_object);
+  dscene->prim_time.give_data(pack.prim_time);
+
+  const size_t num_prims = pack.prim_index.size();
+  return !pack.leaf_nodes.empty() && (pack.root_index == -1 || !pack.nodes.empty()) &&
+         pack.prim_object.size() == num_prims && pack.prim_type.size() == num_prims &&
+         pack.prim_visibility.size() == num_prims && pack.prim_tri_index.size() == num_prims;
+}
+
+void GeometryManager::device_update_bvh(
+    Device *device, DeviceScene *dscene, Scene *scene, bool refit, Progress &progress)
+{
+  const BVHParams bparams = scene_bvh_params(device, dscene, scene);
+
+  BVH *bvh = NULL;
+
+  if (refit && scene_bvh) {
+    bool traceable_modified = false;
+    for (size_t i = 0; i < scene->objects.size(); i++) {
+      if (scene->objects[i]->is_traceable() != scene_bvh_object_traceable[i]) {
+        traceable_modified = true;
+      }
+    }
+
+    if (!traceable_modified && scene_bvh_reclaim(scene_bvh, dscene)) {
+      progress.set_status("Updating Scene BVH", "Refitting");
+
+      bvh = scene_bvh;
+      scene_bvh = NULL;
+      bvh->refit(progress);
+
+      if (progress.get_cancel()) {
+        delete bvh;
+        return;
+      }
+
+      if (bvh->refit_degraded(scene->params.bvh_refit_threshold)) {
+        VLOG(1) << "Rebuilding scene BVH, refit cost " << bvh->refit_sah_cost << " built cost "
+                << bvh->build_sah_cost << ".";
+        delete bvh;
+        bvh = NULL;
+      }
+    }
+  }
+
+  /* Arrays taken back from the device are freed with the BVH, the device scene arrays are
+   * replaced by the new BVH. */
+  delete scene_bvh;
+  scene_bvh = NULL;
+
+  if (bvh == NULL) {
+    /* bvh build */
+    progress.set_status("Updating Scene BVH", "Building");
+
+    VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
+
+    bvh = BVH::create(bparams, scene->geometry, scene->objects);
+    bvh->build(progress, &device->stats);
+
+    if (progress.get_cancel()) {
+#ifdef WITH_EMBREE
+      if (dscene->data.bvh.scene) {
+        BVHEmbree::destroy(dscene->data.bvh.scene);
+        dscene->data.bvh.scene = NULL;
+      }
 #endif
-    delete bvh;
-    return;
+      delete bvh;
+      return;
+    }
   }
 
   /* copy to device */
@@ -1096,7 +1358,20 @@ void GeometryManager::device_update_bvh(Device *device,
 
   bvh->copy_to_device(progress, dscene);
 
-  delete bvh;
+  /* Keep the BVH for refitting in the next update, its arrays are owned by the device scene
+   * until then. */
+  if (scene_bvh_can_refit(bparams, scene)) {
+    scene_bvh = bvh;
+    scene_bvh_object_geometry.resize(scene->objects.size());
+    scene_bvh_object_traceable.resize(scene->objects.size());
+    for (size_t i = 0; i < scene->objects.size(); i++) {
+      scene_bvh_object_geometry[i] = scene->objects[i]->geometry;
+      scene_bvh_object_traceable[i] = scene->objects[i]->is_traceable();
+    }
+  }
+  else {
+    delete bvh;
+  }
 }
 
 void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Progress &progress)
@@ -1285,6 +1560,7 @@ void GeometryManager::device_update(Device *device,
         progress.set_status("Updating Mesh", msg);
 
         mesh->subd_params->camera = dicing_camera;
+        mesh->subd_params->use_cache = !scene->params.background;
         DiagSplit dsplit(*mesh->subd_params);
         mesh->tessellate(&dsplit);
 
@@ -1305,17 +1581,35 @@ void GeometryManager::device_update(Device *device,
     scene->object_manager->device_update_flags(device, dscene, scene, progress, false);
   }
 
-  /* Device update. */
-  device_free(device, dscene);
+  /* Geometry that changed since the previous update, BVH building clears the update flags. */
+  vector<bool> geom_modified(scene->geometry.size());
+  for (size_t i = 0; i < scene->geometry.size(); i++) {
+    geom_modified[i] = scene->geometry[i]->need_update;
+  }
 
-  mesh_calc_offset(scene);
+  /* Device update. Displacement needs the arrays filled for the displacement kernels first, in
+   * all other cases geometry keeps its place in the arrays as long as the layout is the same, so
+   * only modified geometry needs to be packed again. The same goes for the scene BVH, which is
+   * refit when only vertices moved. */
   if (true_displacement_used) {
-    device_update_mesh(device, dscene, scene, true, progress);
+    device_free(device, dscene);
+  }
+
+  bool pack_all = mesh_calc_offset(scene);
+  const bool refit_bvh = !true_displacement_used &&
+                         device_can_refit_bvh(device, dscene, scene, pack_all);
+  if (!refit_bvh) {
+    device_free_bvh(device, dscene);
+  }
+
+  if (true_displacement_used) {
+    pack_all = true;
+    device_update_mesh(device, dscene, scene, true, pack_all, geom_modified, progress);
   }
   if (progress.get_cancel())
     return;
 
-  device_update_attributes(device, dscene, scene, progress);
+  device_update_attributes(device, dscene, scene, pack_all, geom_modified, progress);
   if (progress.get_cancel())
     return;
 
@@ -1347,11 +1641,12 @@ void GeometryManager::device_update(Device *device,
   if (displacement_done) {
     device_free(device, dscene);
 
-    device_update_attributes(device, dscene, scene, progress);
+    device_update_attributes(device, dscene, scene, true, geom_modified, progress);
     if (progress.get_cancel())
       return;
   }
 
+  scoped_timer bvh_timer;
   TaskPool pool;
 
   size_t i = 0;
@@ -1368,6 +1663,7 @@ void GeometryManager::device_update(Device *device,
   TaskPool::Summary summary;
   pool.wait_work(&summary);
   VLOG(2) << "Objects BVH build pool statistics:\n" << summary.full_report();
+  scene->times.bvh_build += bvh_timer.get_time();
 
   foreach (Shader *shader, scene->shaders) {
     shader->need_update_geometry = false;
@@ -1385,11 +1681,15 @@ void GeometryManager::device_update(Device *device,
   if (progress.get_cancel())
     return;
 
-  device_update_bvh(device, dscene, scene, progress);
+  {
+    scoped_timer scene_bvh_timer;
+    device_update_bvh(device, dscene, scene, refit_bvh, progress);
+    scene->times.bvh_build += scene_bvh_timer.get_time();
+  }
   if (progress.get_cancel())
     return;
 
-  device_update_mesh(device, dscene, scene, false, progress);
+  device_update_mesh(device, dscene, scene, false, pack_all, geom_modified, progress);
   if (progress.get_cancel())
     return;
 
@@ -1406,7 +1706,7 @@ void GeometryManager::device_update(Device *device,
   }
 }
 
-void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+void GeometryManager::device_free_bvh(Device *, DeviceScene *dscene)
 {
 #ifdef WITH_EMBREE
   if (dscene->data.bvh.scene) {
@@ -1426,6 +1726,18 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->prim_index.free();
   dscene->prim_object.free();
   dscene->prim_time.free();
+
+  delete scene_bvh;
+  scene_bvh = NULL;
+
+  /* Signal for shaders like displacement not to do ray tracing. */
+  dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
+}
+
+void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+{
+  device_free_bvh(device, dscene);
+
   dscene->tri_shader.free();
   dscene->tri_vnormal.free();
   dscene->tri_vindex.free();
@@ -1440,8 +1752,8 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->attributes_float3.free();
   dscene->attributes_uchar4.free();
 
-  /* Signal for shaders like displacement not to do ray tracing. */
-  dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
+  packed_mesh_layout.clear();
+  packed_attribute_layout.clear();
 
 #ifdef WITH_OSL
   OSLGlobals *og = (OSLGlobals *)device->osl_memory();
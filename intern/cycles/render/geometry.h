@@ -78,6 +78,8 @@ class Geometry : public Node {
   /* BVH */
   BVH *bvh;
   size_t attr_map_offset;
+  /* Index in the kernel geometry array shared by all instances, set in device_update. */
+  int index;
   size_t prim_offset;
   size_t optix_prim_offset;
 
@@ -177,27 +179,54 @@ class GeometryManager {
                              Scene *scene,
                              vector<AttributeRequestSet> &geom_attributes);
 
-  /* Compute verts/triangles/curves offsets in global arrays. */
-  void mesh_calc_offset(Scene *scene);
+  /* Compute verts/triangles/curves offsets in global arrays. Returns true when they differ from
+   * the previous update, and all geometry needs to be packed again. */
+  bool mesh_calc_offset(Scene *scene);
 
   void device_update_object(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
 
+  /* Geometry is packed into the device arrays in parallel. Unless pack_all is set, only geometry
+   * marked in geom_modified is packed, the arrays still hold the data of the other geometry. */
   void device_update_mesh(Device *device,
                           DeviceScene *dscene,
                           Scene *scene,
                           bool for_displacement,
+                          bool pack_all,
+                          const vector<bool> &geom_modified,
                           Progress &progress);
 
   void device_update_attributes(Device *device,
                                 DeviceScene *dscene,
                                 Scene *scene,
+                                bool pack_all,
+                                const vector<bool> &geom_modified,
                                 Progress &progress);
 
-  void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
+  /* Free the scene BVH, keeping the packed geometry arrays. */
+  void device_free_bvh(Device *device, DeviceScene *dscene);
+
+  /* Test if the scene BVH from the previous update can be refit for this update. Its arrays
+   * stay in the device scene until the refit, so cancelling before it keeps them intact.
+   * Returns false when it needs to be built again. */
+  bool device_can_refit_bvh(Device *device, DeviceScene *dscene, Scene *scene, bool pack_all);
+
+  void device_update_bvh(
+      Device *device, DeviceScene *dscene, Scene *scene, bool refit, Progress &progress);
 
   void device_update_displacement_images(Device *device, Scene *scene, Progress &progress);
 
   void device_update_volume_images(Device *device, Scene *scene, Progress &progress);
+
+  /* Sizes and shader ids the device arrays were packed with, to detect when geometry can keep
+   * its offsets. Cleared when the arrays are freed. */
+  vector<size_t> packed_mesh_layout;
+  vector<size_t> packed_attribute_layout;
+
+  /* Scene BVH kept for refitting, with the geometry and tracing visibility of objects it was
+   * built with. Its packed arrays are owned by the device scene between updates. */
+  BVH *scene_bvh;
+  vector<Geometry *> scene_bvh_object_geometry;
+  vector<bool> scene_bvh_object_traceable;
 };
 
 CCL_NAMESPACE_END
@@ -383,6 +383,9 @@ void ShaderGraph::finalize(Scene *scene, bool do_bump, bool do_simplify, bool bu
     if (do_bump)
       bump_from_displacement(bump_in_object_space);
 
+    if (scene->image_manager->use_texture_cache() && !scene->shader_manager->use_osl())
+      refine_image_differentials(scene);
+
     ShaderInput *surface_in = output()->input("Surface");
     ShaderInput *volume_in = output()->input("Volume");
 
@@ -953,6 +956,69 @@ void ShaderGraph::refine_bump_nodes()
   }
 }
 
+void ShaderGraph::refine_image_differentials(Scene *scene)
+{
+  /* images read through the image cache are filtered by the footprint of the
+   * lookup. like for bump nodes, we copy the sub-graph defining the texture
+   * coordinate twice, shifted by the ray differentials, so the kernel can
+   * compute the derivatives of the texture coordinate.
+   *
+   * nodes already used for bump evaluation are skipped, so the 3 bump samples
+   * use the same full resolution lookups and their difference stays smooth.
+   * image nodes sharing the same texture coordinate also share the copies. */
+
+  map<ShaderOutput *, pair<ShaderOutput *, ShaderOutput *>> vector_derivatives;
+
+  /* iterate over a copy, since nodes are added to the graph in the loop */
+  list<ShaderNode *> image_nodes;
+  foreach (ShaderNode *node, nodes) {
+    if (node->type == ImageTextureNode::node_type && node->bump == SHADER_BUMP_NONE) {
+      image_nodes.push_back(node);
+    }
+  }
+
+  foreach (ShaderNode *node, image_nodes) {
+    ImageTextureNode *image_node = (ImageTextureNode *)node;
+    ShaderInput *vector_in = image_node->input("Vector");
+    if (image_node->projection == NODE_IMAGE_PROJ_BOX || !vector_in->link) {
+      continue;
+    }
+    if (!image_node->use_texture_cache(scene, this)) {
+      continue;
+    }
+
+    ShaderOutput *out = vector_in->link;
+    pair<ShaderOutput *, ShaderOutput *> &derivatives = vector_derivatives[out];
+
+    if (derivatives.first == NULL) {
+      ShaderNodeSet nodes_vector;
+      ShaderNodeMap nodes_dx;
+      ShaderNodeMap nodes_dy;
+
+      find_dependencies(nodes_vector, vector_in);
+
+      copy_nodes(nodes_vector, nodes_dx);
+      copy_nodes(nodes_vector, nodes_dy);
+
+      foreach (NodePair &pair, nodes_dx)
+        pair.second->bump = SHADER_BUMP_DX;
+      foreach (NodePair &pair, nodes_dy)
+        pair.second->bump = SHADER_BUMP_DY;
+
+      foreach (NodePair &pair, nodes_dx)
+        add(pair.second);
+      foreach (NodePair &pair, nodes_dy)
+        add(pair.second);
+
+      derivatives.first = nodes_dx[out->parent]->output(out->name());
+      derivatives.second = nodes_dy[out->parent]->output(out->name());
+    }
+
+    connect(derivatives.first, image_node->input("Vector Dx"));
+    connect(derivatives.second, image_node->input("Vector Dy"));
+  }
+}
+
 void ShaderGraph::bump_from_displacement(bool use_object_space)
 {
   /* generate bump mapping automatically from displacement. bump mapping is
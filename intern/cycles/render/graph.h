@@ -42,6 +42,7 @@ class SVMCompiler;
 class OSLCompiler;
 class OutputNode;
 class ConstantFolder;
+class TextureMapping;
 class MD5Hash;
 
 /* Bump
@@ -220,6 +221,13 @@ class ShaderNode : public Node {
   {
     return false;
   }
+
+  /* Mapping applied to the vector input of texture nodes, NULL for other nodes. */
+  virtual TextureMapping *get_texture_mapping()
+  {
+    return NULL;
+  }
+
   vector<ShaderInput *> inputs;
   vector<ShaderOutput *> outputs;
 
@@ -355,6 +363,7 @@ class ShaderGraph {
   void break_cycles(ShaderNode *node, vector<bool> &visited, vector<bool> &on_stack);
   void bump_from_displacement(bool use_object_space);
   void refine_bump_nodes();
+  void refine_image_differentials(Scene *scene);
   void expand();
   void default_inputs(bool do_osl);
   void transform_multi_closure(ShaderNode *node, ShaderOutput *weight_out, bool volume);
@@ -17,6 +17,7 @@
 #include "render/image.h"
 #include "device/device.h"
 #include "render/colorspace.h"
+#include "render/image_cache.h"
 #include "render/image_oiio.h"
 #include "render/scene.h"
 #include "render/stats.h"
@@ -146,6 +147,21 @@ ImageMetaData ImageHandle::metadata()
   return img->metadata;
 }
 
+bool ImageHandle::use_texture_cache()
+{
+  if (tile_slots.empty() || !manager->use_texture_cache()) {
+    return false;
+  }
+
+  foreach (const int slot, tile_slots) {
+    if (!manager->cache_supported(manager->images[slot])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 int ImageHandle::svm_slot(const int tile_index) const
 {
   if (tile_index >= tile_slots.size()) {
@@ -243,6 +259,16 @@ ImageLoader::ImageLoader()
 {
 }
 
+size_t ImageLoader::sparse_grid_num_tiles(const ImageMetaData &)
+{
+  return 0;
+}
+
+bool ImageLoader::load_pixels_sparse_grid(const ImageMetaData &, void *)
+{
+  return false;
+}
+
 ustring ImageLoader::osl_filepath() const
 {
   return ustring();
@@ -260,7 +286,7 @@ bool ImageLoader::equals(const ImageLoader *a, const ImageLoader *b)
 
 /* Image Manager */
 
-ImageManager::ImageManager(const DeviceInfo &info)
+ImageManager::ImageManager(const DeviceInfo &info, const SceneParams &params)
 {
   need_update = true;
   osl_texture_system = NULL;
@@ -268,6 +294,12 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   has_half_images = info.has_half_images;
+  has_sparse_volumes = info.has_sparse_volumes;
+
+  /* The kernel can only call into the image cache when running on the CPU. */
+  if (params.use_texture_cache && info.type == DEVICE_CPU) {
+    image_cache.reset(new ImageCache(params.texture_cache_size, params.texture_auto_convert));
+  }
 }
 
 ImageManager::~ImageManager()
@@ -281,6 +313,11 @@ void ImageManager::set_osl_texture_system(void *texture_system)
   osl_texture_system = texture_system;
 }
 
+bool ImageManager::use_texture_cache() const
+{
+  return image_cache != NULL;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
   if (frame != animation_frame) {
@@ -410,6 +447,7 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_handle = NULL;
 
   images[slot] = img;
 
@@ -452,6 +490,106 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
+bool ImageManager::cache_supported(Image *img)
+{
+  /* Only images stored in files can be read on demand. */
+  if (img->loader->osl_filepath().empty()) {
+    return false;
+  }
+
+  /* Color space conversion, unassociated alpha and 3D images need the full image in memory.
+   * sRGB is converted by the image texture node, like it is for fully loaded images. */
+  load_image_metadata(img);
+  const ImageMetaData &metadata = img->metadata;
+  if (metadata.depth > 1) {
+    return false;
+  }
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+  if ((metadata.channels == 2 || metadata.channels == 4) && !image_associate_alpha(img)) {
+    return false;
+  }
+
+  return true;
+}
+
+bool ImageManager::cache_load_image(Image *img, int texture_limit)
+{
+  if (!image_cache || !cache_supported(img)) {
+    return false;
+  }
+
+  img->cache_handle = image_cache->add_texture(img->loader->osl_filepath().string(),
+                                               img->params.interpolation,
+                                               img->params.extension,
+                                               texture_limit);
+  return (img->cache_handle != NULL);
+}
+
+bool ImageManager::sparse_grid_load_image(Image *img, int texture_limit)
+{
+  if (!has_sparse_volumes) {
+    return false;
+  }
+
+  /* Only float volumes in scene linear, resizing and color space conversion need the
+   * dense image. */
+  const ImageMetaData &metadata = img->metadata;
+  if (metadata.depth <= 1 || metadata.colorspace != u_colorspace_raw) {
+    return false;
+  }
+  if (metadata.type != IMAGE_DATA_TYPE_FLOAT && metadata.type != IMAGE_DATA_TYPE_FLOAT4) {
+    return false;
+  }
+  const size_t max_size = max(max(metadata.width, metadata.height), metadata.depth);
+  if (texture_limit > 0 && max_size > texture_limit) {
+    return false;
+  }
+
+  const size_t num_tiles = img->loader->sparse_grid_num_tiles(metadata);
+  if (num_tiles == 0) {
+    return false;
+  }
+
+  float *pixels;
+  {
+    thread_scoped_lock device_lock(device_mutex);
+    pixels = (float *)img->mem->alloc_sparse_grid(
+        metadata.width, metadata.height, metadata.depth, num_tiles);
+  }
+
+  if (pixels == NULL || !img->loader->load_pixels_sparse_grid(metadata, pixels)) {
+    return false;
+  }
+
+  /* Make sure we don't have buggy values, same as for dense images. */
+  const int channels = (metadata.type == IMAGE_DATA_TYPE_FLOAT4) ? 4 : 1;
+  const size_t num_voxels = num_tiles * SPARSE_TILE_VOXELS;
+  float *pool = pixels + sparse_grid_pool_offset(metadata.width, metadata.height, metadata.depth) /
+                             sizeof(float);
+
+  for (size_t i = 0; i < num_voxels; i++) {
+    float *voxel = pool + i * channels;
+    bool is_finite = true;
+    for (int c = 0; c < channels; c++) {
+      is_finite &= isfinite(voxel[c]);
+    }
+    if (!is_finite) {
+      for (int c = 0; c < channels; c++) {
+        voxel[c] = 0.0f;
+      }
+    }
+  }
+
+  VLOG(1) << "Loaded " << img->loader->name() << " as sparse grid with " << num_tiles << " of "
+          << (size_t)sparse_grid_num_tiles(metadata.width) *
+                 sparse_grid_num_tiles(metadata.height) * sparse_grid_num_tiles(metadata.depth)
+          << " tiles.";
+
+  return true;
+}
+
 template<TypeDesc::BASETYPE FileFormat, typename StorageType>
 bool ImageManager::file_load_image(Image *img, int texture_limit)
 {
@@ -632,15 +770,30 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->cache_handle) {
+    image_cache->remove_texture(img->cache_handle);
+    img->cache_handle = NULL;
+  }
 
   img->mem = new device_texture(
       device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
   img->mem->info.use_transform_3d = img->metadata.use_transform_3d;
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
+  /* Images read through the image cache only get a placeholder pixel in device memory, the
+   * same as images that failed to load. The texture limit is applied by the cache lookups,
+   * which never read mip levels finer than the limit. */
+  const bool use_cache = cache_load_image(img, texture_limit);
+
+  /* Volumes that are mostly empty are stored as sparse grids where supported. */
+  const bool use_sparse_grid = !use_cache && sparse_grid_load_image(img, texture_limit);
+
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
-    if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
+  if (use_sparse_grid) {
+    /* Already loaded. */
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
+    if (use_cache || !file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       float *pixels = (float *)img->mem->alloc(1, 1);
@@ -652,7 +805,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
   else if (type == IMAGE_DATA_TYPE_FLOAT) {
-    if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
+    if (use_cache || !file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       float *pixels = (float *)img->mem->alloc(1, 1);
@@ -661,7 +814,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
   else if (type == IMAGE_DATA_TYPE_BYTE4) {
-    if (!file_load_image<TypeDesc::UINT8, uchar>(img, texture_limit)) {
+    if (use_cache || !file_load_image<TypeDesc::UINT8, uchar>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       uchar *pixels = (uchar *)img->mem->alloc(1, 1);
@@ -673,7 +826,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
   else if (type == IMAGE_DATA_TYPE_BYTE) {
-    if (!file_load_image<TypeDesc::UINT8, uchar>(img, texture_limit)) {
+    if (use_cache || !file_load_image<TypeDesc::UINT8, uchar>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       uchar *pixels = (uchar *)img->mem->alloc(1, 1);
@@ -682,7 +835,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
   else if (type == IMAGE_DATA_TYPE_HALF4) {
-    if (!file_load_image<TypeDesc::HALF, half>(img, texture_limit)) {
+    if (use_cache || !file_load_image<TypeDesc::HALF, half>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       half *pixels = (half *)img->mem->alloc(1, 1);
@@ -694,7 +847,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
   else if (type == IMAGE_DATA_TYPE_USHORT) {
-    if (!file_load_image<TypeDesc::USHORT, uint16_t>(img, texture_limit)) {
+    if (use_cache || !file_load_image<TypeDesc::USHORT, uint16_t>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       uint16_t *pixels = (uint16_t *)img->mem->alloc(1, 1);
@@ -703,7 +856,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
   else if (type == IMAGE_DATA_TYPE_USHORT4) {
-    if (!file_load_image<TypeDesc::USHORT, uint16_t>(img, texture_limit)) {
+    if (use_cache || !file_load_image<TypeDesc::USHORT, uint16_t>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       uint16_t *pixels = (uint16_t *)img->mem->alloc(1, 1);
@@ -715,7 +868,7 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
   else if (type == IMAGE_DATA_TYPE_HALF) {
-    if (!file_load_image<TypeDesc::HALF, half>(img, texture_limit)) {
+    if (use_cache || !file_load_image<TypeDesc::HALF, half>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
       half *pixels = (half *)img->mem->alloc(1, 1);
@@ -724,6 +877,11 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     }
   }
 
+  if (use_cache) {
+    img->mem->info.use_cache = 1;
+    img->mem->info.data = (uint64_t)img->cache_handle;
+  }
+
   {
     thread_scoped_lock device_lock(device_mutex);
     img->mem->copy_to_device();
@@ -755,6 +913,10 @@ void ImageManager::device_free_image(Device *, int slot)
     delete img->mem;
   }
 
+  if (img->cache_handle) {
+    image_cache->remove_texture(img->cache_handle);
+  }
+
   delete img->loader;
   delete img;
   images[slot] = NULL;
@@ -828,6 +990,10 @@ void ImageManager::device_free_builtin(Device *device)
 
 void ImageManager::device_free(Device *device)
 {
+  if (image_cache) {
+    VLOG(2) << image_cache->stats();
+  }
+
   for (size_t slot = 0; slot < images.size(); slot++) {
     device_free_image(device, slot);
   }
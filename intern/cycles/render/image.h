@@ -31,6 +31,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceInfo;
+class ImageCache;
 class ImageHandle;
 class ImageKey;
 class ImageMetaData;
@@ -38,6 +39,7 @@ class ImageManager;
 class Progress;
 class RenderStats;
 class Scene;
+class SceneParams;
 class ColorSpaceProcessor;
 
 /* Image Parameters */
@@ -111,6 +113,14 @@ class ImageLoader {
                            const size_t pixels_size,
                            const bool associate_alpha) = 0;
 
+  /* Optional sparse grid storage for 3D images. Returns the number of tiles that are not
+   * empty, or 0 to load the image densely. */
+  virtual size_t sparse_grid_num_tiles(const ImageMetaData &metadata);
+
+  /* Load the tile table followed by the non-empty tiles, as described in util_texture.h. Voxels
+   * of 4 channel images are RGBA. */
+  virtual bool load_pixels_sparse_grid(const ImageMetaData &metadata, void *pixels);
+
   /* Name for logs and stats. */
   virtual string name() const = 0;
 
@@ -146,6 +156,7 @@ class ImageHandle {
   int num_tiles();
 
   ImageMetaData metadata();
+  bool use_texture_cache();
   int svm_slot(const int tile_index = 0) const;
   device_texture *image_memory(const int tile_index = 0) const;
 
@@ -162,7 +173,7 @@ class ImageHandle {
  * texture images and 3D volume images. */
 class ImageManager {
  public:
-  explicit ImageManager(const DeviceInfo &info);
+  ImageManager(const DeviceInfo &info, const SceneParams &params);
   ~ImageManager();
 
   ImageHandle add_image(const string &filename, const ImageParams &params);
@@ -181,6 +192,10 @@ class ImageManager {
   void set_osl_texture_system(void *texture_system);
   bool set_animation_frame_update(int frame);
 
+  /* Image textures are read on demand through the image cache, and SVM needs to provide the
+   * derivatives of texture coordinates for mip level selection. */
+  bool use_texture_cache() const;
+
   void collect_statistics(RenderStats *stats);
 
   bool need_update;
@@ -197,6 +212,7 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    TextureCacheHandle *cache_handle;
 
     int users;
     thread_mutex mutex;
@@ -204,6 +220,7 @@ class ImageManager {
 
  private:
   bool has_half_images;
+  bool has_sparse_volumes;
 
   thread_mutex device_mutex;
   thread_mutex images_mutex;
@@ -211,6 +228,7 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  unique_ptr<ImageCache> image_cache;
 
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
@@ -221,6 +239,10 @@ class ImageManager {
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
 
+  bool cache_supported(Image *img);
+  bool cache_load_image(Image *img, int texture_limit);
+  bool sparse_grid_load_image(Image *img, int texture_limit);
+
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
 
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/image_cache.h"
+
+#include "util/util_image.h"
+#include "util/util_logging.h"
+#include "util/util_md5.h"
+#include "util/util_path.h"
+#include "util/util_unique_ptr.h"
+
+#include <OpenImageIO/imagebufalgo.h>
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Handle as seen by the kernel, with the state needed for lookups appended. */
+struct ImageCacheTexture : public TextureCacheHandle {
+  OIIO::TextureSystem *texture_system;
+  OIIO::TextureSystem::TextureHandle *oiio_handle;
+  OIIO::TextureOpt options;
+  ustring filepath;
+  /* Smallest footprint of a lookup, one texel along the longest side at the resolution of
+   * the texture limit. */
+  float min_footprint;
+};
+
+/* Lengthen a derivative shorter than the minimum footprint, keeping its direction. */
+void image_cache_clamp_footprint(float &ds, float &dt, const float min_footprint, bool du)
+{
+  const float len = sqrtf(ds * ds + dt * dt);
+  if (len >= min_footprint) {
+    return;
+  }
+  if (len > 0.0f) {
+    ds *= min_footprint / len;
+    dt *= min_footprint / len;
+  }
+  else {
+    ds = (du) ? min_footprint : 0.0f;
+    dt = (du) ? 0.0f : min_footprint;
+  }
+}
+
+void image_cache_lookup(const TextureCacheHandle *handle,
+                        float s,
+                        float t,
+                        float dsdx,
+                        float dtdx,
+                        float dsdy,
+                        float dtdy,
+                        float result[4])
+{
+  const ImageCacheTexture *texture = (const ImageCacheTexture *)handle;
+
+  if (texture->min_footprint > 0.0f) {
+    image_cache_clamp_footprint(dsdx, dtdx, texture->min_footprint, true);
+    image_cache_clamp_footprint(dsdy, dtdy, texture->min_footprint, false);
+  }
+
+  /* Options are modified by the lookup, so each lookup needs its own copy. The first row of
+   * Cycles images is the bottom one, OpenImageIO starts at the top. */
+  OIIO::TextureOpt options = texture->options;
+  const bool ok = texture->texture_system->texture(texture->oiio_handle,
+                                                   NULL,
+                                                   options,
+                                                   s,
+                                                   1.0f - t,
+                                                   dsdx,
+                                                   -dtdx,
+                                                   dsdy,
+                                                   -dtdy,
+                                                   4,
+                                                   result);
+
+  if (!ok) {
+    /* Clear the error, so it does not accumulate for every failed lookup. */
+    texture->texture_system->geterror();
+    result[0] = TEX_IMAGE_MISSING_R;
+    result[1] = TEX_IMAGE_MISSING_G;
+    result[2] = TEX_IMAGE_MISSING_B;
+    result[3] = TEX_IMAGE_MISSING_A;
+  }
+}
+
+OIIO::TextureOpt::Wrap image_cache_wrap(ExtensionType extension)
+{
+  switch (extension) {
+    case EXTENSION_REPEAT:
+      return OIIO::TextureOpt::WrapPeriodic;
+    case EXTENSION_EXTEND:
+      return OIIO::TextureOpt::WrapClamp;
+    case EXTENSION_CLIP:
+    case EXTENSION_NUM_TYPES:
+      break;
+  }
+  return OIIO::TextureOpt::WrapBlack;
+}
+
+OIIO::TextureOpt::InterpMode image_cache_interpolation(InterpolationType interpolation)
+{
+  switch (interpolation) {
+    case INTERPOLATION_CLOSEST:
+      return OIIO::TextureOpt::InterpClosest;
+    case INTERPOLATION_CUBIC:
+      return OIIO::TextureOpt::InterpBicubic;
+    case INTERPOLATION_SMART:
+      return OIIO::TextureOpt::InterpSmartBicubic;
+    case INTERPOLATION_NONE:
+    case INTERPOLATION_LINEAR:
+    case INTERPOLATION_NUM_TYPES:
+      break;
+  }
+  return OIIO::TextureOpt::InterpBilinear;
+}
+
+bool image_is_tiled_mipmap(const string &filepath)
+{
+  unique_ptr<ImageInput> in(ImageInput::create(filepath));
+  if (!in) {
+    return false;
+  }
+
+  ImageSpec spec;
+  if (!in->open(filepath, spec)) {
+    return false;
+  }
+
+  const bool is_tiled = (spec.tile_width > 0 && spec.tile_height > 0);
+  const bool has_mipmap = in->seek_subimage(0, 1, spec);
+  in->close();
+
+  return is_tiled && has_mipmap;
+}
+
+}  // namespace
+
+ImageCache::ImageCache(int cache_size_mb, bool auto_convert) : auto_convert(auto_convert)
+{
+  /* Not shared with OSL, which has its own memory budget and invalidation. */
+  texture_system = OIIO::TextureSystem::create(false);
+
+  texture_system->attribute("max_memory_MB", (float)max(cache_size_mb, 1));
+  texture_system->attribute("automip", 1);
+  texture_system->attribute("autotile", 64);
+  texture_system->attribute("accept_untiled", 1);
+  texture_system->attribute("gray_to_rgb", 1);
+}
+
+ImageCache::~ImageCache()
+{
+  texture_system->invalidate_all(true);
+  OIIO::TextureSystem::destroy(texture_system);
+}
+
+string ImageCache::tiled_filepath(const string &filepath)
+{
+  if (!auto_convert || image_is_tiled_mipmap(filepath)) {
+    return filepath;
+  }
+
+  /* Key on modification time as well, so edited images are converted again. */
+  const string key = string_printf(
+      "%s:%llu", filepath.c_str(), (unsigned long long)path_modified_time(filepath));
+  const string tx_filepath = path_cache_get(
+      path_join("textures", util_md5_string(key) + ".tx"));
+
+  /* The conversion is multithreaded itself, and serializing avoids converting the same file
+   * twice when it is used by multiple image slots. */
+  thread_scoped_lock lock(convert_mutex);
+
+  if (path_exists(tx_filepath)) {
+    return tx_filepath;
+  }
+
+  path_create_directories(tx_filepath);
+
+  ImageSpec config;
+  config.tile_width = 64;
+  config.tile_height = 64;
+  config.tile_depth = 1;
+
+  VLOG(1) << "Converting image " << filepath << " to tiled mipmap " << tx_filepath << ".";
+
+  if (!OIIO::ImageBufAlgo::make_texture(
+          OIIO::ImageBufAlgo::MakeTxTexture, filepath, tx_filepath, config)) {
+    VLOG(1) << "Failed to convert image " << filepath << ": " << OIIO::geterror();
+    path_remove(tx_filepath);
+    return filepath;
+  }
+
+  return tx_filepath;
+}
+
+TextureCacheHandle *ImageCache::add_texture(const string &filepath,
+                                            InterpolationType interpolation,
+                                            ExtensionType extension,
+                                            int texture_limit)
+{
+  const ustring cache_filepath(tiled_filepath(filepath));
+
+  OIIO::TextureSystem::TextureHandle *oiio_handle = texture_system->get_texture_handle(
+      cache_filepath);
+  if (!oiio_handle || !texture_system->good(oiio_handle)) {
+    texture_system->geterror();
+    return NULL;
+  }
+
+  ImageCacheTexture *texture = new ImageCacheTexture();
+  texture->lookup = image_cache_lookup;
+  texture->texture_system = texture_system;
+  texture->oiio_handle = oiio_handle;
+  texture->filepath = cache_filepath;
+  texture->options.swrap = image_cache_wrap(extension);
+  texture->options.twrap = texture->options.swrap;
+  texture->options.interpmode = image_cache_interpolation(interpolation);
+  /* Opaque alpha for images without an alpha channel, same as fully loaded images. */
+  texture->options.fill = 1.0f;
+  texture->min_footprint = 0.0f;
+
+  int resolution[2] = {0, 0};
+  if (texture_limit > 0 &&
+      texture_system->get_texture_info(oiio_handle,
+                                       NULL,
+                                       0,
+                                       ustring("resolution"),
+                                       TypeDesc(TypeDesc::INT, 2),
+                                       resolution)) {
+    if (max(resolution[0], resolution[1]) > texture_limit) {
+      texture->min_footprint = 1.0f / texture_limit;
+    }
+  }
+
+  return texture;
+}
+
+void ImageCache::remove_texture(TextureCacheHandle *handle)
+{
+  ImageCacheTexture *texture = (ImageCacheTexture *)handle;
+  texture_system->invalidate(texture->filepath);
+  delete texture;
+}
+
+string ImageCache::stats() const
+{
+  return texture_system->getstats(1, true);
+}
+
+CCL_NAMESPACE_END
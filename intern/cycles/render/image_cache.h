@@ -0,0 +1,63 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IMAGE_CACHE_H__
+#define __IMAGE_CACHE_H__
+
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_thread.h"
+
+#include <OpenImageIO/texture.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Image Cache
+ *
+ * Out-of-core storage for image textures rendered on the CPU. Instead of loading every image
+ * fully into memory, tiles of the mip level matching the lookup footprint are read on demand
+ * and kept in a cache of fixed size, evicting the least recently used tiles first. Images that
+ * are not tiled and mip-mapped yet can be converted once, the result is stored in the user
+ * cache directory and reused by later renders. */
+class ImageCache {
+ public:
+  ImageCache(int cache_size_mb, bool auto_convert);
+  ~ImageCache();
+
+  /* Returns NULL when the file can not be opened. The handle is valid until it is removed.
+   * With a texture limit, lookups are filtered as if the image was scaled down to fit it. */
+  TextureCacheHandle *add_texture(const string &filepath,
+                                  InterpolationType interpolation,
+                                  ExtensionType extension,
+                                  int texture_limit);
+  void remove_texture(TextureCacheHandle *handle);
+
+  /* Cache hits, tiles and memory usage, for logging. */
+  string stats() const;
+
+ protected:
+  /* Returns the path to read the image from, which is the original file when it is already
+   * tiled and mip-mapped or could not be converted. */
+  string tiled_filepath(const string &filepath);
+
+  OIIO::TextureSystem *texture_system;
+  bool auto_convert;
+  thread_mutex convert_mutex;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __IMAGE_CACHE_H__ */
@@ -21,8 +21,91 @@
 #  include <openvdb/tools/Dense.h>
 #endif
 
+#include "util/util_task.h"
+#include "util/util_texture.h"
+
 CCL_NAMESPACE_BEGIN
 
+#ifdef WITH_OPENVDB
+namespace {
+
+/* Mark the sparse grid tiles overlapping active voxels and tiles of the grid. Returns false
+ * when inactive voxels are not zero, since empty tiles are read as zero. */
+template<typename GridType>
+bool vdb_active_tiles(const openvdb::GridBase::ConstPtr &grid_base,
+                      const openvdb::CoordBBox &bbox,
+                      vector<int> &tiles)
+{
+  const GridType &grid = *openvdb::gridConstPtrCast<GridType>(grid_base);
+  if (grid.background() != openvdb::zeroVal<typename GridType::ValueType>()) {
+    return false;
+  }
+
+  const openvdb::Coord dim = bbox.dim();
+  const int tiles_x = sparse_grid_num_tiles(dim.x());
+  const int tiles_y = sparse_grid_num_tiles(dim.y());
+
+  for (typename GridType::ValueOnCIter iter = grid.cbeginValueOn(); iter; ++iter) {
+    openvdb::CoordBBox box;
+    iter.getBoundingBox(box);
+    box.intersect(bbox);
+    if (box.empty()) {
+      continue;
+    }
+
+    const openvdb::Coord min = box.min() - bbox.min();
+    const openvdb::Coord max = box.max() - bbox.min();
+    for (int z = min.z() / SPARSE_TILE_SIZE; z <= max.z() / SPARSE_TILE_SIZE; z++) {
+      for (int y = min.y() / SPARSE_TILE_SIZE; y <= max.y() / SPARSE_TILE_SIZE; y++) {
+        for (int x = min.x() / SPARSE_TILE_SIZE; x <= max.x() / SPARSE_TILE_SIZE; x++) {
+          tiles[x + (y + z * tiles_y) * tiles_x] = 0;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Copy one tile, voxels outside the grid bounding box are only padding. Tiles are copied from
+ * multiple threads, so each copy is serial. */
+template<typename GridType, typename VoxelType>
+void vdb_copy_tile(const openvdb::GridBase::ConstPtr &grid_base,
+                   const openvdb::CoordBBox &tile_bbox,
+                   VoxelType *voxels)
+{
+  openvdb::tools::Dense<VoxelType, openvdb::tools::LayoutXYZ> dense(tile_bbox, voxels);
+  openvdb::tools::copyToDense(*openvdb::gridConstPtrCast<GridType>(grid_base), dense, true);
+}
+
+template<typename GridType>
+void vdb_copy_scalar_tile(const openvdb::GridBase::ConstPtr &grid,
+                          const openvdb::CoordBBox &tile_bbox,
+                          float *voxels)
+{
+  vdb_copy_tile<GridType, float>(grid, tile_bbox, voxels);
+}
+
+template<typename GridType>
+void vdb_copy_vector_tile(const openvdb::GridBase::ConstPtr &grid,
+                          const openvdb::CoordBBox &tile_bbox,
+                          float *voxels)
+{
+  /* Expand to RGBA, the same as dense images. */
+  openvdb::Vec3f rgb[SPARSE_TILE_VOXELS];
+  vdb_copy_tile<GridType, openvdb::Vec3f>(grid, tile_bbox, rgb);
+
+  for (int i = 0; i < SPARSE_TILE_VOXELS; i++) {
+    voxels[i * 4 + 0] = rgb[i].x();
+    voxels[i * 4 + 1] = rgb[i].y();
+    voxels[i * 4 + 2] = rgb[i].z();
+    voxels[i * 4 + 3] = 1.0f;
+  }
+}
+
+}  // namespace
+#endif
+
 VDBImageLoader::VDBImageLoader(const string &grid_name) : grid_name(grid_name)
 {
 }
@@ -161,6 +244,137 @@ bool VDBImageLoader::load_pixels(const ImageMetaData &, void *pixels, const size
 #endif
 }
 
+size_t VDBImageLoader::sparse_grid_num_tiles(const ImageMetaData &metadata)
+{
+#ifdef WITH_OPENVDB
+  const size_t total_tiles = (size_t)ccl::sparse_grid_num_tiles(metadata.width) *
+                             ccl::sparse_grid_num_tiles(metadata.height) *
+                             ccl::sparse_grid_num_tiles(metadata.depth);
+  sparse_tiles.clear();
+  sparse_tiles.resize(total_tiles, SPARSE_TILE_EMPTY);
+
+  bool is_zero_background = false;
+  if (grid->isType<openvdb::FloatGrid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::FloatGrid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::Vec3fGrid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::Vec3fGrid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::BoolGrid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::BoolGrid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::DoubleGrid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::DoubleGrid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::Int32Grid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::Int32Grid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::Int64Grid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::Int64Grid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::Vec3IGrid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::Vec3IGrid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::Vec3dGrid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::Vec3dGrid>(grid, bbox, sparse_tiles);
+  }
+  else if (grid->isType<openvdb::MaskGrid>()) {
+    is_zero_background = vdb_active_tiles<openvdb::MaskGrid>(grid, bbox, sparse_tiles);
+  }
+
+  /* Assign pool indices to active tiles. */
+  size_t num_tiles = 0;
+  if (is_zero_background) {
+    for (size_t i = 0; i < total_tiles; i++) {
+      if (sparse_tiles[i] != SPARSE_TILE_EMPTY) {
+        sparse_tiles[i] = num_tiles++;
+      }
+    }
+  }
+
+  /* Only worth it when a good part of the volume is empty, the tile table and tiles reaching
+   * past the bounding box add some overhead. */
+  if (num_tiles == 0 || num_tiles * 2 > total_tiles) {
+    sparse_tiles.clear();
+    return 0;
+  }
+
+  return num_tiles;
+#else
+  (void)metadata;
+  return 0;
+#endif
+}
+
+bool VDBImageLoader::load_pixels_sparse_grid(const ImageMetaData &metadata, void *pixels)
+{
+#ifdef WITH_OPENVDB
+  if (sparse_tiles.empty()) {
+    return false;
+  }
+
+  const int tiles_x = ccl::sparse_grid_num_tiles(metadata.width);
+  const int tiles_y = ccl::sparse_grid_num_tiles(metadata.height);
+  const int channels = (metadata.type == IMAGE_DATA_TYPE_FLOAT4) ? 4 : 1;
+  const size_t pool_offset = sparse_grid_pool_offset(
+      metadata.width, metadata.height, metadata.depth);
+  float *pool = (float *)((char *)pixels + pool_offset);
+
+  const size_t total_tiles = sparse_tiles.size();
+  memcpy(pixels, sparse_tiles.data(), total_tiles * sizeof(int));
+
+  parallel_for(blocked_range<size_t>(0, total_tiles), [&](const blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); i++) {
+      const int tile = sparse_tiles[i];
+      if (tile == SPARSE_TILE_EMPTY) {
+        continue;
+      }
+
+      const int x = i % tiles_x, y = (i / tiles_x) % tiles_y, z = i / (tiles_x * tiles_y);
+      const openvdb::Coord tile_min = bbox.min() + openvdb::Coord(x * SPARSE_TILE_SIZE,
+                                                                  y * SPARSE_TILE_SIZE,
+                                                                  z * SPARSE_TILE_SIZE);
+      const openvdb::CoordBBox tile_bbox(tile_min, tile_min.offsetBy(SPARSE_TILE_SIZE - 1));
+      float *voxels = pool + (size_t)tile * SPARSE_TILE_VOXELS * channels;
+
+      if (grid->isType<openvdb::FloatGrid>()) {
+        vdb_copy_scalar_tile<openvdb::FloatGrid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::Vec3fGrid>()) {
+        vdb_copy_vector_tile<openvdb::Vec3fGrid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::BoolGrid>()) {
+        vdb_copy_scalar_tile<openvdb::BoolGrid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::DoubleGrid>()) {
+        vdb_copy_scalar_tile<openvdb::DoubleGrid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::Int32Grid>()) {
+        vdb_copy_scalar_tile<openvdb::Int32Grid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::Int64Grid>()) {
+        vdb_copy_scalar_tile<openvdb::Int64Grid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::Vec3IGrid>()) {
+        vdb_copy_vector_tile<openvdb::Vec3IGrid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::Vec3dGrid>()) {
+        vdb_copy_vector_tile<openvdb::Vec3dGrid>(grid, tile_bbox, voxels);
+      }
+      else if (grid->isType<openvdb::MaskGrid>()) {
+        vdb_copy_scalar_tile<openvdb::MaskGrid>(grid, tile_bbox, voxels);
+      }
+    }
+  });
+
+  return true;
+#else
+  (void)metadata;
+  (void)pixels;
+  return false;
+#endif
+}
+
 string VDBImageLoader::name() const
 {
   return grid_name;
@@ -182,6 +396,8 @@ void VDBImageLoader::cleanup()
 #ifdef WITH_OPENVDB
   /* Free OpenVDB grid memory as soon as we can. */
   grid.reset();
+  sparse_tiles.clear();
+  sparse_tiles.shrink_to_fit();
 #endif
 }
 
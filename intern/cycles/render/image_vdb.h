@@ -37,6 +37,10 @@ class VDBImageLoader : public ImageLoader {
                            const size_t pixels_size,
                            const bool associate_alpha) override;
 
+  virtual size_t sparse_grid_num_tiles(const ImageMetaData &metadata) override;
+
+  virtual bool load_pixels_sparse_grid(const ImageMetaData &metadata, void *pixels) override;
+
   virtual string name() const override;
 
   virtual bool equals(const ImageLoader &other) const override;
@@ -48,6 +52,8 @@ class VDBImageLoader : public ImageLoader {
 #ifdef WITH_OPENVDB
   openvdb::GridBase::ConstPtr grid;
   openvdb::CoordBBox bbox;
+  /* Sparse grid tile table, from sparse_grid_num_tiles(). */
+  vector<int> sparse_tiles;
 #endif
 };
 
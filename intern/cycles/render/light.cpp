@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -527,6 +528,69 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+void LightManager::device_update_tree(Device *,
+                                      DeviceScene *dscene,
+                                      Scene *scene,
+                                      Progress &progress)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->use_light_tree = false;
+  kintegrator->num_light_tree_lamps = 0;
+
+  /* Sampling all lights bypasses the distribution, so the tree would only skew MIS weights. */
+  Integrator *integrator = scene->integrator;
+  if (!integrator->use_light_tree || !kintegrator->use_direct_light ||
+      (integrator->method == Integrator::BRANCHED_PATH &&
+       (integrator->sample_all_lights_direct || integrator->sample_all_lights_indirect))) {
+    return;
+  }
+
+  progress.set_status("Updating Lights", "Building light tree");
+
+  vector<LightTreePrimitive> prims;
+  int num_lamps = 0;
+
+  foreach (Light *light, scene->lights) {
+    if (!light->is_enabled) {
+      continue;
+    }
+
+    LightTreePrimitive prim;
+    if (LightTreePrimitive::from_light(light, num_lamps, &prim)) {
+      prims.push_back(prim);
+    }
+    num_lamps++;
+  }
+
+  /* With a single local lamp there is nothing to choose between. */
+  if (prims.size() < 2) {
+    return;
+  }
+
+  double time_start = time_dt();
+  LightTree tree(prims, num_lamps);
+
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+  KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(nodes.size());
+  memcpy(knodes, nodes.data(), sizeof(KernelLightTreeNode) * nodes.size());
+
+  /* Lamps which are not in the tree have leaf -1, the kernel reads it back as int. */
+  const vector<int> &leaf_nodes = tree.get_leaf_nodes();
+  uint *kleaf_nodes = dscene->light_tree_leaf.alloc(leaf_nodes.size());
+  for (size_t i = 0; i < leaf_nodes.size(); i++) {
+    kleaf_nodes[i] = (uint)leaf_nodes[i];
+  }
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_leaf.copy_to_device();
+
+  kintegrator->use_light_tree = true;
+  kintegrator->num_light_tree_lamps = tree.num_lamps();
+
+  VLOG(1) << "Light tree with " << nodes.size() << " nodes over " << tree.num_lamps()
+          << " lamps built in " << time_dt() - time_start << " seconds.";
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -972,6 +1036,10 @@ void LightManager::device_update(Device *device,
   if (progress.get_cancel())
     return;
 
+  device_update_tree(device, dscene, scene, progress);
+  if (progress.get_cancel())
+    return;
+
   if (need_update_background) {
     device_update_background(device, dscene, scene, progress);
     if (progress.get_cancel())
@@ -995,6 +1063,8 @@ void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_ba
 {
   dscene->light_distribution.free();
   dscene->lights.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_leaf.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
     dscene->light_background_conditional_cdf.free();
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+#include "render/light.h"
+#include "render/shader.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Cone */
+
+LightTreeCone LightTreeCone::merge(const LightTreeCone &a, const LightTreeCone &b)
+{
+  /* Make a the cone with the widest spread of normals. */
+  if (b.theta_o > a.theta_o) {
+    return merge(b, a);
+  }
+
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  const float theta_e = max(a.theta_e, b.theta_e);
+
+  /* Cone b is contained in cone a. */
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return LightTreeCone(a.axis, a.theta_o, theta_e);
+  }
+
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  const float3 rotation_axis = cross(a.axis, b.axis);
+  if (theta_o >= M_PI_F || len_squared(rotation_axis) < 1e-12f) {
+    return LightTreeCone(a.axis, M_PI_F, theta_e);
+  }
+
+  /* Rotate the axis of a towards b, so the new cone just touches both. */
+  const float theta_r = theta_o - a.theta_o;
+  const float3 axis = rotate_around_axis(a.axis, normalize(rotation_axis), theta_r);
+  return LightTreeCone(normalize(axis), theta_o, theta_e);
+}
+
+/* Primitive */
+
+bool LightTreePrimitive::from_light(Light *light, int lamp, LightTreePrimitive *prim)
+{
+  prim->lamp = lamp;
+  prim->bbox = BoundBox::empty;
+
+  if (light->type == LIGHT_POINT || light->type == LIGHT_SPOT) {
+    prim->bbox.grow(light->co, light->size);
+
+    if (light->type == LIGHT_SPOT) {
+      prim->cone = LightTreeCone(safe_normalize(light->dir), 0.0f, 0.5f * light->spot_angle);
+    }
+    else {
+      prim->cone = LightTreeCone();
+    }
+  }
+  else if (light->type == LIGHT_AREA) {
+    const float3 axisu = light->axisu * (light->sizeu * light->size);
+    const float3 axisv = light->axisv * (light->sizev * light->size);
+
+    prim->bbox.grow(light->co + 0.5f * (axisu + axisv));
+    prim->bbox.grow(light->co + 0.5f * (axisu - axisv));
+    prim->bbox.grow(light->co - 0.5f * (axisu + axisv));
+    prim->bbox.grow(light->co - 0.5f * (axisu - axisv));
+
+    /* Area lights only emit from their front side. */
+    prim->cone = LightTreeCone(safe_normalize(light->dir), 0.0f, M_PI_2_F);
+  }
+  else {
+    /* Distant and background lights have no position to bound. */
+    return false;
+  }
+
+  /* Estimate the power from the strength, and from the emission shader when it is constant.
+   * Otherwise the shader is assumed to emit with unit strength. */
+  float3 emission = make_float3(1.0f, 1.0f, 1.0f);
+  if (light->shader) {
+    float3 constant_emission;
+    if (light->shader->is_constant_emission(&constant_emission)) {
+      emission = constant_emission;
+    }
+  }
+  prim->energy = average(fabs(light->strength * emission));
+
+  return true;
+}
+
+/* Tree */
+
+LightTree::LightTree(const vector<LightTreePrimitive> &prims_, int num_lamps)
+    : prims(prims_), leaf_nodes(num_lamps, -1)
+{
+  if (prims.empty()) {
+    return;
+  }
+
+  nodes.reserve(2 * prims.size() - 1);
+  recursive_build(-1, 0, prims.size());
+}
+
+int LightTree::recursive_build(int parent, int start, int end)
+{
+  /* Nodes are referred to by index, the array grows during the recursion. */
+  const int index = nodes.size();
+  nodes.push_back(KernelLightTreeNode());
+
+  BoundBox bbox = BoundBox::empty;
+  BoundBox centroid_bbox = BoundBox::empty;
+  LightTreeCone cone = prims[start].cone;
+  float energy = 0.0f;
+
+  for (int i = start; i < end; i++) {
+    bbox.grow(prims[i].bbox);
+    centroid_bbox.grow(prims[i].bbox.center());
+    cone = LightTreeCone::merge(cone, prims[i].cone);
+    energy += prims[i].energy;
+  }
+
+  KernelLightTreeNode &knode = nodes[index];
+  knode.bbox_min[0] = bbox.min.x;
+  knode.bbox_min[1] = bbox.min.y;
+  knode.bbox_min[2] = bbox.min.z;
+  knode.energy = energy;
+  knode.bbox_max[0] = bbox.max.x;
+  knode.bbox_max[1] = bbox.max.y;
+  knode.bbox_max[2] = bbox.max.z;
+  knode.theta_o = cone.theta_o;
+  knode.axis[0] = cone.axis.x;
+  knode.axis[1] = cone.axis.y;
+  knode.axis[2] = cone.axis.z;
+  knode.theta_e = cone.theta_e;
+  knode.child[0] = -1;
+  knode.child[1] = -1;
+  knode.parent = parent;
+  knode.lamp = -1;
+
+  if (end - start == 1) {
+    knode.lamp = prims[start].lamp;
+    leaf_nodes[prims[start].lamp] = index;
+    return index;
+  }
+
+  /* Split at the median centroid along the widest axis. This keeps the tree balanced, so the
+   * kernel traversal depth stays logarithmic in the number of lamps. */
+  const float3 extent = centroid_bbox.size();
+  int dim = 2;
+  if (extent.x >= extent.y && extent.x >= extent.z) {
+    dim = 0;
+  }
+  else if (extent.y >= extent.z) {
+    dim = 1;
+  }
+  const int middle = (start + end) / 2;
+
+  std::nth_element(prims.begin() + start,
+                   prims.begin() + middle,
+                   prims.begin() + end,
+                   [dim](const LightTreePrimitive &a, const LightTreePrimitive &b) {
+                     return a.bbox.center()[dim] < b.bbox.center()[dim];
+                   });
+
+  const int left = recursive_build(index, start, middle);
+  const int right = recursive_build(index, middle, end);
+
+  nodes[index].child[0] = left;
+  nodes[index].child[1] = right;
+
+  return index;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class Light;
+
+/* Cone bounding a set of emitter orientations, after "Importance Sampling of Many Lights with
+ * Adaptive Tree Splitting" by Alejandro Conty Estevez and Christopher Kulla. All normals lie
+ * within theta_o of the axis, and emission leaves each normal within theta_e. */
+
+struct LightTreeCone {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  LightTreeCone() : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(M_PI_F), theta_e(M_PI_2_F)
+  {
+  }
+
+  LightTreeCone(const float3 &axis, float theta_o, float theta_e)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e)
+  {
+  }
+
+  static LightTreeCone merge(const LightTreeCone &a, const LightTreeCone &b);
+};
+
+/* Single lamp as seen by the tree builder. */
+
+struct LightTreePrimitive {
+  /* Index into the device lights array. */
+  int lamp;
+  BoundBox bbox;
+  LightTreeCone cone;
+  float energy;
+
+  LightTreePrimitive() : lamp(-1), bbox(BoundBox::empty), energy(0.0f)
+  {
+  }
+
+  /* Returns false for lights without a position, which are not part of the tree. */
+  static bool from_light(Light *light, int lamp, LightTreePrimitive *prim);
+};
+
+/* Binary tree over the local lamps of the scene, flattened into the layout used by the kernel.
+ * The root is always the first node. */
+
+class LightTree {
+ public:
+  LightTree(const vector<LightTreePrimitive> &prims, int num_lamps);
+
+  const vector<KernelLightTreeNode> &get_nodes() const
+  {
+    return nodes;
+  }
+
+  /* Index of the leaf node of every lamp, -1 for lamps outside of the tree. */
+  const vector<int> &get_leaf_nodes() const
+  {
+    return leaf_nodes;
+  }
+
+  size_t num_lamps() const
+  {
+    return prims.size();
+  }
+
+ protected:
+  int recursive_build(int parent, int start, int end);
+
+  vector<LightTreePrimitive> prims;
+  vector<KernelLightTreeNode> nodes;
+  vector<int> leaf_nodes;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
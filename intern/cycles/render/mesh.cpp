@@ -153,6 +153,7 @@ Mesh::Mesh() : Geometry(node_type, Geometry::MESH), subd_attributes(this, ATTR_P
 
   subdivision_type = SUBDIVISION_NONE;
   subd_params = NULL;
+  subd_dice_cache = NULL;
 
   patch_table = NULL;
 }
@@ -161,6 +162,7 @@ Mesh::~Mesh()
 {
   delete patch_table;
   delete subd_params;
+  delete subd_dice_cache;
 }
 
 void Mesh::resize_mesh(int numverts, int numtris)
@@ -47,6 +47,7 @@ class SceneParams;
 class AttributeRequest;
 struct SubdParams;
 class DiagSplit;
+class DiceCache;
 struct PackedPatchTable;
 
 /* Mesh */
@@ -144,6 +145,8 @@ class Mesh : public Geometry {
   array<SubdEdgeCrease> subd_creases;
 
   SubdParams *subd_params;
+  /* Patch evaluations of the previous tessellation, kept when the mesh is cleared. */
+  DiceCache *subd_dice_cache;
 
   AttributeSet subd_attributes;
 
@@ -18,6 +18,7 @@
 #include "render/camera.h"
 #include "render/mesh.h"
 
+#include "subd/subd_dice.h"
 #include "subd/subd_patch.h"
 #include "subd/subd_patch_table.h"
 #include "subd/subd_split.h"
@@ -25,6 +26,7 @@
 #include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
+#include "util/util_murmurhash.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -161,9 +163,10 @@ class OsdData {
   Far::TopologyRefiner *refiner;
   Far::PatchTable *patch_table;
   Far::PatchMap *patch_map;
+  int max_isolation;
 
  public:
-  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL)
+  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL), max_isolation(0)
   {
   }
 
@@ -189,7 +192,7 @@ class OsdData {
         *mesh, Far::TopologyRefinerFactory<Mesh>::Options(type, options));
 
     /* adaptive refinement */
-    int max_isolation = calculate_max_isolation();
+    max_isolation = calculate_max_isolation();
     refiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(max_isolation));
 
     /* create patch table */
@@ -274,6 +277,11 @@ class OsdData {
     }
   }
 
+  int get_max_isolation() const
+  {
+    return max_isolation;
+  }
+
   int calculate_max_isolation()
   {
     /* loop over all edges to find longest in screen space */
@@ -366,8 +374,52 @@ struct OsdPatch : Patch {
 
 #endif
 
+/* Hash of the control mesh and settings that the patch evaluations depend on. Two 32 bit hashes
+ * with different seeds, to make a collision between edits of the same mesh unlikely. */
+static uint64_t dice_cache_key(const Mesh *mesh, const float3 *vN, int max_isolation)
+{
+  uint h0 = 0, h1 = 0x9e3779b9;
+
+  auto add = [&](const void *data, int size) {
+    h0 = util_murmur_hash3(data, size, h0);
+    h1 = util_murmur_hash3(data, size, h1);
+  };
+
+  const int type = mesh->subdivision_type;
+  add(&type, sizeof(type));
+  add(&max_isolation, sizeof(max_isolation));
+
+  /* Hash components individually, float3 may have an unused fourth component. */
+  for (size_t i = 0; i < mesh->verts.size(); i++) {
+    add(&mesh->verts[i].x, sizeof(float) * 3);
+    if (vN) {
+      add(&vN[i].x, sizeof(float) * 3);
+    }
+  }
+
+  for (size_t i = 0; i < mesh->subd_faces.size(); i++) {
+    const Mesh::SubdFace &face = mesh->subd_faces[i];
+    const int data[3] = {face.start_corner, face.num_corners, face.smooth};
+    add(data, sizeof(data));
+  }
+
+  if (mesh->subd_face_corners.size()) {
+    add(mesh->subd_face_corners.data(), sizeof(int) * mesh->subd_face_corners.size());
+  }
+
+  for (size_t i = 0; i < mesh->subd_creases.size(); i++) {
+    const Mesh::SubdEdgeCrease &crease = mesh->subd_creases[i];
+    add(crease.v, sizeof(crease.v));
+    add(&crease.crease, sizeof(crease.crease));
+  }
+
+  return ((uint64_t)h1 << 32) | h0;
+}
+
 void Mesh::tessellate(DiagSplit *split)
 {
+  int max_isolation = 0;
+
 #ifdef WITH_OPENSUBDIV
   OsdData osd_data;
   bool need_packed_patch_table = false;
@@ -375,6 +427,7 @@ void Mesh::tessellate(DiagSplit *split)
   if (subdivision_type == SUBDIVISION_CATMULL_CLARK) {
     if (subd_faces.size()) {
       osd_data.build_from_mesh(this);
+      max_isolation = osd_data.get_max_isolation();
     }
   }
   else
@@ -396,6 +449,20 @@ void Mesh::tessellate(DiagSplit *split)
   Attribute *attr_vN = subd_attributes.find(ATTR_STD_VERTEX_NORMAL);
   float3 *vN = (attr_vN) ? attr_vN->data_float3() : NULL;
 
+  /* Interactive renders tessellate again when the dicing camera moves, keep the patch
+   * evaluations around so only faces with different edge factors are evaluated again. */
+  if (subd_params && subd_params->use_cache) {
+    if (!subd_dice_cache) {
+      subd_dice_cache = new DiceCache();
+    }
+
+    subd_dice_cache->validate(dice_cache_key(this, vN, max_isolation), num_faces);
+  }
+  else {
+    delete subd_dice_cache;
+    subd_dice_cache = NULL;
+  }
+
   /* count patches */
   int num_patches = 0;
   for (int f = 0; f < num_faces; f++) {
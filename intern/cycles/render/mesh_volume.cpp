@@ -22,6 +22,7 @@
 #include "util/util_hash.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_texture.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -364,6 +365,23 @@ void VolumeMeshBuilder::convert_quads_to_tris(const vector<QuadData> &quads,
 struct VoxelAttributeGrid {
   float *data;
   int channels;
+  /* Tile table and tile pool of sparse grids, NULL for dense grids. */
+  const int *tiles;
+  const float *pool;
+
+  /* Returns NULL for voxels in empty tiles. */
+  const float *voxel(const int3 resolution, int x, int y, int z) const
+  {
+    if (tiles) {
+      const int tile = tiles[sparse_grid_tile_index(x, y, z, resolution.x, resolution.y)];
+      if (tile == SPARSE_TILE_EMPTY) {
+        return NULL;
+      }
+      return pool + ((size_t)tile * SPARSE_TILE_VOXELS + sparse_grid_voxel_index(x, y, z)) *
+                        channels;
+    }
+    return data + compute_voxel_index(resolution, x, y, z) * channels;
+  }
 };
 
 void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
@@ -401,6 +419,14 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
     VoxelAttributeGrid voxel_grid;
     voxel_grid.data = static_cast<float *>(image_memory->host_pointer);
     voxel_grid.channels = image_memory->data_elements;
+    voxel_grid.tiles = NULL;
+    voxel_grid.pool = NULL;
+    if (image_memory->info.use_sparse_grid) {
+      voxel_grid.tiles = static_cast<const int *>(image_memory->host_pointer);
+      voxel_grid.pool = voxel_grid.data +
+                        sparse_grid_pool_offset(resolution.x, resolution.y, resolution.z) /
+                            sizeof(float);
+    }
     voxel_grids.push_back(voxel_grid);
 
     /* TODO: support multiple transforms. */
@@ -463,19 +489,44 @@ void GeometryManager::create_volume_mesh(Mesh *mesh, Progress &progress)
   VolumeMeshBuilder builder(&volume_params);
   const float clipping = mesh->volume_clipping;
 
-  for (int z = 0; z < resolution.z; ++z) {
-    for (int y = 0; y < resolution.y; ++y) {
-      for (int x = 0; x < resolution.x; ++x) {
-        int64_t voxel_index = compute_voxel_index(resolution, x, y, z);
-
-        for (size_t i = 0; i < voxel_grids.size(); ++i) {
+  /* Visit voxels in blocks matching the sparse grid tiles, so tiles that are empty in every
+   * grid can be skipped entirely. Empty voxels are zero, so they are only inside the volume
+   * without any clipping. */
+  for (int tz = 0; tz < resolution.z; tz += SPARSE_TILE_SIZE) {
+    for (int ty = 0; ty < resolution.y; ty += SPARSE_TILE_SIZE) {
+      for (int tx = 0; tx < resolution.x; tx += SPARSE_TILE_SIZE) {
+        bool is_empty = (clipping > 0.0f);
+        for (size_t i = 0; i < voxel_grids.size() && is_empty; ++i) {
           const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
-          const int channels = voxel_grid.channels;
+          is_empty = (voxel_grid.tiles &&
+                      voxel_grid.tiles[sparse_grid_tile_index(
+                          tx, ty, tz, resolution.x, resolution.y)] == SPARSE_TILE_EMPTY);
+        }
+
+        if (is_empty) {
+          continue;
+        }
 
-          for (int c = 0; c < channels; c++) {
-            if (voxel_grid.data[voxel_index * channels + c] >= clipping) {
-              builder.add_node_with_padding(x, y, z);
-              break;
+        const int z_end = min(tz + SPARSE_TILE_SIZE, resolution.z);
+        const int y_end = min(ty + SPARSE_TILE_SIZE, resolution.y);
+        const int x_end = min(tx + SPARSE_TILE_SIZE, resolution.x);
+
+        for (int z = tz; z < z_end; ++z) {
+          for (int y = ty; y < y_end; ++y) {
+            for (int x = tx; x < x_end; ++x) {
+              for (size_t i = 0; i < voxel_grids.size(); ++i) {
+                const VoxelAttributeGrid &voxel_grid = voxel_grids[i];
+                const int channels = voxel_grid.channels;
+                const float *voxel = voxel_grid.voxel(resolution, x, y, z);
+
+                for (int c = 0; c < channels; c++) {
+                  const float value = (voxel) ? voxel[c] : 0.0f;
+                  if (value >= clipping) {
+                    builder.add_node_with_padding(x, y, z);
+                    break;
+                  }
+                }
+              }
             }
           }
         }
@@ -74,6 +74,7 @@ CCL_NAMESPACE_BEGIN
   SOCKET_ENUM(tex_mapping.projection, "Projection", mapping_projection_enum, TextureMapping::FLAT);
 
 TextureMapping::TextureMapping()
+    : input_transform(transform_identity()), use_input_transform(false)
 {
 }
 
@@ -131,11 +132,17 @@ Transform TextureMapping::compute_transform()
   /* projection last */
   mat = mat * mmat;
 
+  if (use_input_transform) {
+    mat = mat * input_transform;
+  }
+
   return mat;
 }
 
 bool TextureMapping::skip()
 {
+  if (use_input_transform)
+    return false;
   if (translation != make_float3(0.0f, 0.0f, 0.0f))
     return false;
   if (rotation != make_float3(0.0f, 0.0f, 0.0f))
@@ -247,6 +254,10 @@ NODE_DEFINE(ImageTextureNode)
   SOCKET_FLOAT(projection_blend, "Projection Blend", 0.0f);
 
   SOCKET_IN_POINT(vector, "Vector", make_float3(0.0f, 0.0f, 0.0f), SocketType::LINK_TEXTURE_UV);
+  /* Vector shifted by the ray differentials, connected by the shader graph when images are
+   * read through the image cache. */
+  SOCKET_IN_POINT(vector_dx, "Vector Dx", make_float3(0.0f, 0.0f, 0.0f), SocketType::SVM_INTERNAL);
+  SOCKET_IN_POINT(vector_dy, "Vector Dy", make_float3(0.0f, 0.0f, 0.0f), SocketType::SVM_INTERNAL);
 
   SOCKET_OUT_COLOR(color, "Color");
   SOCKET_OUT_FLOAT(alpha, "Alpha");
@@ -355,17 +366,34 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
   ShaderNode::attributes(shader, attributes);
 }
 
+void ImageTextureNode::add_image(Scene *scene, ShaderGraph *graph)
+{
+  if (handle.empty()) {
+    cull_tiles(scene, graph);
+    ImageManager *image_manager = scene->image_manager;
+    handle = image_manager->add_image(filename.string(), image_params(), tiles);
+  }
+}
+
+bool ImageTextureNode::use_texture_cache(Scene *scene, ShaderGraph *graph)
+{
+  if (!scene->image_manager->use_texture_cache()) {
+    return false;
+  }
+
+  add_image(scene, graph);
+  return handle.use_texture_cache();
+}
+
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
+  ShaderInput *vector_dx_in = input("Vector Dx");
+  ShaderInput *vector_dy_in = input("Vector Dy");
   ShaderOutput *color_out = output("Color");
   ShaderOutput *alpha_out = output("Alpha");
 
-  if (handle.empty()) {
-    cull_tiles(compiler.scene, compiler.current_graph);
-    ImageManager *image_manager = compiler.scene->image_manager;
-    handle = image_manager->add_image(filename.string(), image_params(), tiles);
-  }
+  add_image(compiler.scene, compiler.current_graph);
 
   /* All tiles have the same metadata. */
   const ImageMetaData metadata = handle.metadata();
@@ -398,6 +426,14 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
       num_nodes = divide_up(handle.num_tiles(), 2);
     }
 
+    int vector_dx_offset = SVM_STACK_INVALID;
+    int vector_dy_offset = SVM_STACK_INVALID;
+    if (vector_dx_in->link && vector_dy_in->link) {
+      vector_dx_offset = tex_mapping.compile_begin(compiler, vector_dx_in);
+      vector_dy_offset = tex_mapping.compile_begin(compiler, vector_dy_in);
+      flags |= NODE_IMAGE_USE_DIFFERENTIALS;
+    }
+
     compiler.add_node(NODE_TEX_IMAGE,
                       num_nodes,
                       compiler.encode_uchar4(vector_offset,
@@ -406,6 +442,12 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                              flags),
                       projection);
 
+    if (flags & NODE_IMAGE_USE_DIFFERENTIALS) {
+      compiler.add_node(vector_dx_offset, vector_dy_offset, 0, 0);
+      tex_mapping.compile_end(compiler, vector_dy_in, vector_dy_offset);
+      tex_mapping.compile_end(compiler, vector_dx_in, vector_dx_offset);
+    }
+
     if (num_nodes > 0) {
       for (int i = 0; i < num_nodes; i++) {
         int4 node;
@@ -1920,15 +1962,63 @@ MappingNode::MappingNode() : ShaderNode(node_type)
 {
 }
 
+Transform MappingNode::compute_transform()
+{
+  /* Without the normalization, all mapping types are affine in the vector, so the matrix is
+   * found by mapping the origin and the unit vectors. */
+  NodeMappingType affine_type = type;
+  float3 affine_scale = scale;
+  if (type == NODE_MAPPING_TYPE_NORMAL) {
+    affine_type = NODE_MAPPING_TYPE_VECTOR;
+    affine_scale = safe_divide_float3_float3(make_float3(1.0f, 1.0f, 1.0f), scale);
+  }
+
+  auto map = [&](float x, float y, float z) {
+    return svm_mapping(affine_type, make_float3(x, y, z), location, rotation, affine_scale);
+  };
+  const float3 origin = map(0.0f, 0.0f, 0.0f);
+  const float3 x = map(1.0f, 0.0f, 0.0f) - origin;
+  const float3 y = map(0.0f, 1.0f, 0.0f) - origin;
+  const float3 z = map(0.0f, 0.0f, 1.0f) - origin;
+
+  return make_transform(x.x, y.x, z.x, origin.x, x.y, y.y, z.y, origin.y, x.z, y.z, z.z, origin.z);
+}
+
 void MappingNode::constant_fold(const ConstantFolder &folder)
 {
   if (folder.all_inputs_constant()) {
     float3 result = svm_mapping((NodeMappingType)type, vector, location, rotation, scale);
     folder.make_constant(result);
+    return;
   }
-  else {
-    folder.fold_mapping((NodeMappingType)type);
+
+  folder.fold_mapping((NodeMappingType)type);
+
+  /* Merge into the texture mapping of a texture node that is the only user of the result, so
+   * both are applied with a single matrix. */
+  ShaderInput *vector_in = input("Vector");
+  if (type == NODE_MAPPING_TYPE_NORMAL || !vector_in->link || input("Location")->link ||
+      input("Rotation")->link || input("Scale")->link || folder.output->links.size() != 1) {
+    return;
   }
+
+  ShaderInput *texture_vector_in = folder.output->links[0];
+  TextureMapping *tex_mapping = texture_vector_in->parent->get_texture_mapping();
+  if (tex_mapping == NULL || texture_vector_in->name() != "Vector") {
+    return;
+  }
+
+  VLOG(1) << "Folding " << name << " into texture mapping of "
+          << texture_vector_in->parent->name << ".";
+
+  const Transform tfm = compute_transform();
+  tex_mapping->input_transform = (tex_mapping->use_input_transform) ?
+                                     tex_mapping->input_transform * tfm :
+                                     tfm;
+  tex_mapping->use_input_transform = true;
+
+  folder.graph->disconnect(texture_vector_in);
+  folder.graph->connect(vector_in->link, texture_vector_in);
 }
 
 void MappingNode::compile(SVMCompiler &compiler)
@@ -1939,6 +2029,27 @@ void MappingNode::compile(SVMCompiler &compiler)
   ShaderInput *scale_in = input("Scale");
   ShaderOutput *vector_out = output("Vector");
 
+  if (!location_in->link && !rotation_in->link && !scale_in->link) {
+    /* Constant parameters, avoid computing the rotation matrix for every evaluation. */
+    int vector_stack_offset = compiler.stack_assign(vector_in);
+    int result_stack_offset = compiler.stack_assign(vector_out);
+
+    const Transform tfm = compute_transform();
+    compiler.add_node(NODE_TEXTURE_MAPPING, vector_stack_offset, result_stack_offset);
+    compiler.add_node(tfm.x);
+    compiler.add_node(tfm.y);
+    compiler.add_node(tfm.z);
+
+    if (type == NODE_MAPPING_TYPE_NORMAL) {
+      compiler.add_node(
+          NODE_VECTOR_MATH,
+          NODE_VECTOR_MATH_NORMALIZE,
+          compiler.encode_uchar4(result_stack_offset, result_stack_offset, result_stack_offset),
+          compiler.encode_uchar4(SVM_STACK_INVALID, result_stack_offset));
+    }
+    return;
+  }
+
   int vector_stack_offset = compiler.stack_assign(vector_in);
   int location_stack_offset = compiler.stack_assign(location_in);
   int rotation_stack_offset = compiler.stack_assign(rotation_in);
@@ -5767,6 +5878,13 @@ void MapRangeNode::expand(ShaderGraph *graph)
   }
 }
 
+void MapRangeNode::constant_fold(const ConstantFolder &folder)
+{
+  if (folder.all_inputs_constant()) {
+    folder.make_constant(svm_map_range(type, value, from_min, from_max, to_min, to_max, steps));
+  }
+}
+
 void MapRangeNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *value_in = input("Value");
@@ -5782,7 +5900,7 @@ void MapRangeNode::compile(SVMCompiler &compiler)
   int from_max_stack_offset = compiler.stack_assign_if_linked(from_max_in);
   int to_min_stack_offset = compiler.stack_assign_if_linked(to_min_in);
   int to_max_stack_offset = compiler.stack_assign_if_linked(to_max_in);
-  int steps_stack_offset = compiler.stack_assign(steps_in);
+  int steps_stack_offset = compiler.stack_assign_if_linked(steps_in);
   int result_stack_offset = compiler.stack_assign(result_out);
 
   compiler.add_node(
@@ -6005,6 +6123,86 @@ void MathNode::constant_fold(const ConstantFolder &folder)
   }
   else {
     folder.fold_math(type);
+    if (!folder.output->links.empty()) {
+      fold_chain(folder);
+    }
+  }
+}
+
+/* Merge with the math node computing one of the operands, when this is its only user and the
+ * other operand is constant. Multiply followed by add becomes a single multiply add, and
+ * constants of consecutive add or multiply nodes are combined. */
+void MathNode::fold_chain(const ConstantFolder &folder)
+{
+  ShaderInput *value1_in = input("Value1");
+  ShaderInput *value2_in = input("Value2");
+  ShaderInput *value3_in = input("Value3");
+
+  ShaderInput *chain_in;
+  float constant;
+  if (value1_in->link && !value2_in->link) {
+    chain_in = value1_in;
+    constant = value2;
+  }
+  else if (value2_in->link && !value1_in->link && type != NODE_MATH_SUBTRACT) {
+    chain_in = value2_in;
+    constant = value1;
+  }
+  else {
+    return;
+  }
+
+  ShaderNode *chain_parent = chain_in->link->parent;
+  if (chain_parent->type != MathNode::node_type || chain_in->link->links.size() != 1) {
+    return;
+  }
+
+  MathNode *chain_node = (MathNode *)chain_parent;
+  ShaderInput *chain_value1_in = chain_node->input("Value1");
+  ShaderInput *chain_value2_in = chain_node->input("Value2");
+  ShaderGraph *graph = folder.graph;
+
+  if (chain_node->type == NODE_MATH_MULTIPLY &&
+      (type == NODE_MATH_ADD || type == NODE_MATH_SUBTRACT) && !value3_in->link) {
+    VLOG(1) << "Folding " << chain_node->name << " and " << name << " to multiply add.";
+
+    value3 = (type == NODE_MATH_SUBTRACT) ? -constant : constant;
+    type = NODE_MATH_MULTIPLY_ADD;
+
+    graph->disconnect(chain_in);
+    value1 = chain_node->value1;
+    value2 = chain_node->value2;
+    if (chain_value1_in->link) {
+      graph->connect(chain_value1_in->link, value1_in);
+    }
+    if (chain_value2_in->link) {
+      graph->connect(chain_value2_in->link, value2_in);
+    }
+  }
+  else if (chain_node->type == type && (type == NODE_MATH_ADD || type == NODE_MATH_MULTIPLY)) {
+    ShaderInput *operand_in;
+    float chain_constant;
+    if (!chain_value2_in->link) {
+      operand_in = chain_value1_in;
+      chain_constant = chain_node->value2;
+    }
+    else if (!chain_value1_in->link) {
+      operand_in = chain_value2_in;
+      chain_constant = chain_node->value1;
+    }
+    else {
+      return;
+    }
+
+    VLOG(1) << "Folding constants of " << chain_node->name << " into " << name << ".";
+
+    graph->disconnect(chain_in);
+    value2_in->set((type == NODE_MATH_ADD) ? constant + chain_constant :
+                                             constant * chain_constant);
+    value1_in->set(chain_node->get_float(operand_in->socket_type));
+    if (operand_in->link) {
+      graph->connect(operand_in->link, value1_in);
+    }
   }
 }
 
@@ -6015,9 +6213,9 @@ void MathNode::compile(SVMCompiler &compiler)
   ShaderInput *value3_in = input("Value3");
   ShaderOutput *value_out = output("Value");
 
-  int value1_stack_offset = compiler.stack_assign(value1_in);
-  int value2_stack_offset = compiler.stack_assign(value2_in);
-  int value3_stack_offset = compiler.stack_assign(value3_in);
+  int value1_stack_offset = compiler.stack_assign_if_linked(value1_in);
+  int value2_stack_offset = compiler.stack_assign_if_linked(value2_in);
+  int value3_stack_offset = compiler.stack_assign_if_linked(value3_in);
   int value_stack_offset = compiler.stack_assign(value_out);
 
   compiler.add_node(
@@ -6025,6 +6223,11 @@ void MathNode::compile(SVMCompiler &compiler)
       type,
       compiler.encode_uchar4(value1_stack_offset, value2_stack_offset, value3_stack_offset),
       value_stack_offset);
+
+  /* Constant operands are stored inline instead of in value nodes. */
+  if (!value1_in->link || !value2_in->link || !value3_in->link) {
+    compiler.add_node(__float_as_int(value1), __float_as_int(value2), __float_as_int(value3));
+  }
 }
 
 void MathNode::compile(OSLCompiler &compiler)
@@ -6112,9 +6315,9 @@ void VectorMathNode::compile(SVMCompiler &compiler)
   ShaderOutput *value_out = output("Value");
   ShaderOutput *vector_out = output("Vector");
 
-  int vector1_stack_offset = compiler.stack_assign(vector1_in);
-  int vector2_stack_offset = compiler.stack_assign(vector2_in);
-  int scale_stack_offset = compiler.stack_assign(scale_in);
+  int vector1_stack_offset = compiler.stack_assign_if_linked(vector1_in);
+  int vector2_stack_offset = compiler.stack_assign_if_linked(vector2_in);
+  int scale_stack_offset = compiler.stack_assign_if_linked(scale_in);
   int value_stack_offset = compiler.stack_assign_if_linked(value_out);
   int vector_stack_offset = compiler.stack_assign_if_linked(vector_out);
 
@@ -6136,6 +6339,18 @@ void VectorMathNode::compile(SVMCompiler &compiler)
         compiler.encode_uchar4(vector1_stack_offset, vector2_stack_offset, scale_stack_offset),
         compiler.encode_uchar4(value_stack_offset, vector_stack_offset));
   }
+
+  /* Constant operands are stored inline instead of in value nodes, in the order the kernel
+   * reads them. */
+  if (!vector1_in->link) {
+    compiler.add_node(float3_to_float4(vector1));
+  }
+  if (!vector2_in->link) {
+    compiler.add_node(float3_to_float4(vector2));
+  }
+  if (!scale_in->link) {
+    compiler.add_node(__float_as_int(scale));
+  }
 }
 
 void VectorMathNode::compile(OSLCompiler &compiler)
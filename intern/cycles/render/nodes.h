@@ -60,6 +60,11 @@ class TextureMapping {
 
   enum Projection { FLAT, CUBE, TUBE, SPHERE };
   Projection projection;
+
+  /* Transform of the vector before the mapping, from a mapping node merged into the texture
+   * node during constant folding. */
+  Transform input_transform;
+  bool use_input_transform;
 };
 
 /* Nodes */
@@ -69,6 +74,21 @@ class TextureNode : public ShaderNode {
   explicit TextureNode(const NodeType *node_type) : ShaderNode(node_type)
   {
   }
+
+  virtual TextureMapping *get_texture_mapping()
+  {
+    return &tex_mapping;
+  }
+
+  virtual bool equals(const ShaderNode &other)
+  {
+    const TextureNode &other_node = (const TextureNode &)other;
+    return ShaderNode::equals(other) &&
+           tex_mapping.use_input_transform == other_node.tex_mapping.use_input_transform &&
+           (!tex_mapping.use_input_transform ||
+            tex_mapping.input_transform == other_node.tex_mapping.input_transform);
+  }
+
   TextureMapping tex_mapping;
 };
 
@@ -117,10 +137,17 @@ class ImageTextureNode : public ImageSlotTextureNode {
   float projection_blend;
   bool animated;
   float3 vector;
+  float3 vector_dx;
+  float3 vector_dy;
   ccl::vector<int> tiles;
 
+  /* Whether the image is read through the image cache, which needs the derivatives of the
+   * texture coordinate for mip level selection. Adds the image to the scene if needed. */
+  bool use_texture_cache(Scene *scene, ShaderGraph *graph);
+
  protected:
   void cull_tiles(Scene *scene, ShaderGraph *graph);
+  void add_image(Scene *scene, ShaderGraph *graph);
 };
 
 class EnvironmentTextureNode : public ImageSlotTextureNode {
@@ -434,6 +461,10 @@ class MappingNode : public ShaderNode {
   }
   void constant_fold(const ConstantFolder &folder);
 
+  /* Affine transform equivalent to the mapping with the current location, rotation and scale,
+   * followed by normalization for the normal type. */
+  Transform compute_transform();
+
   float3 vector, location, rotation, scale;
   NodeMappingType type;
 };
@@ -1319,6 +1350,7 @@ class MapRangeNode : public ShaderNode {
     return NODE_GROUP_LEVEL_3;
   }
   void expand(ShaderGraph *graph);
+  void constant_fold(const ConstantFolder &folder);
 
   float value, from_min, from_max, to_min, to_max, steps;
   NodeMapRangeType type;
@@ -1352,6 +1384,9 @@ class MathNode : public ShaderNode {
   float value3;
   NodeMathType type;
   bool use_clamp;
+
+ protected:
+  void fold_chain(const ConstantFolder &folder);
 };
 
 class NormalNode : public ShaderNode {
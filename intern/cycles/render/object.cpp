@@ -65,6 +65,8 @@ struct UpdateObjectTransformState {
   /* Packed object arrays. Those will be filled in. */
   uint *object_flag;
   KernelObject *objects;
+  /* Attributes of every object, deduplicated after the parallel update. */
+  array<KernelObjectAttributes> object_attributes;
   Transform *object_motion_pass;
   DecomposedTransform *object_motion;
   float *object_volume_step;
@@ -351,6 +353,27 @@ int Object::get_device_index() const
 
 /* Object Manager */
 
+namespace {
+
+struct ObjectAttributesHash {
+  size_t operator()(const KernelObjectAttributes &attr) const
+  {
+    return util_murmur_hash3(&attr, sizeof(attr), 0);
+  }
+};
+
+struct ObjectAttributesEqual {
+  bool operator()(const KernelObjectAttributes &a, const KernelObjectAttributes &b) const
+  {
+    return memcmp(&a, &b, sizeof(a)) == 0;
+  }
+};
+
+typedef unordered_map<KernelObjectAttributes, int, ObjectAttributesHash, ObjectAttributesEqual>
+    ObjectAttributesMap;
+
+}  // namespace
+
 ObjectManager::ObjectManager()
 {
   need_update = true;
@@ -439,6 +462,7 @@ static float object_surface_area(UpdateObjectTransformState *state,
 void ObjectManager::device_update_object_transform(UpdateObjectTransformState *state, Object *ob)
 {
   KernelObject &kobject = state->objects[ob->index];
+  KernelObjectAttributes &kattr = state->object_attributes[ob->index];
   Transform *object_motion_pass = state->object_motion_pass;
 
   Geometry *geom = ob->geometry;
@@ -458,13 +482,16 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
   kobject.tfm = tfm;
   kobject.itfm = itfm;
   kobject.surface_area = object_surface_area(state, tfm, geom);
-  kobject.color[0] = color.x;
-  kobject.color[1] = color.y;
-  kobject.color[2] = color.z;
-  kobject.pass_id = pass_id;
   kobject.random_number = random_number;
   kobject.particle_index = particle_index;
   kobject.motion_offset = 0;
+  kobject.geometry = geom->index;
+  kobject.pad1 = 0.0f;
+
+  kattr.color[0] = color.x;
+  kattr.color[1] = color.y;
+  kattr.color[2] = color.z;
+  kattr.pass_id = pass_id;
 
   if (geom->use_motion_blur) {
     state->have_motion = true;
@@ -517,23 +544,19 @@ void ObjectManager::device_update_object_transform(UpdateObjectTransformState *s
     }
   }
 
-  /* Dupli object coords and motion info. */
-  kobject.dupli_generated[0] = ob->dupli_generated[0];
-  kobject.dupli_generated[1] = ob->dupli_generated[1];
-  kobject.dupli_generated[2] = ob->dupli_generated[2];
-  kobject.numkeys = (geom->type == Geometry::HAIR) ? static_cast<Hair *>(geom)->curve_keys.size() :
-                                                     0;
-  kobject.dupli_uv[0] = ob->dupli_uv[0];
-  kobject.dupli_uv[1] = ob->dupli_uv[1];
-  int totalsteps = geom->motion_steps;
-  kobject.numsteps = (totalsteps - 1) / 2;
-  kobject.numverts = (geom->type == Geometry::MESH) ? static_cast<Mesh *>(geom)->verts.size() : 0;
-  kobject.patch_map_offset = 0;
-  kobject.attribute_map_offset = 0;
+  /* Dupli object coords. */
+  kattr.dupli_generated[0] = ob->dupli_generated[0];
+  kattr.dupli_generated[1] = ob->dupli_generated[1];
+  kattr.dupli_generated[2] = ob->dupli_generated[2];
+  kattr.dupli_uv[0] = ob->dupli_uv[0];
+  kattr.dupli_uv[1] = ob->dupli_uv[1];
   uint32_t hash_name = util_murmur_hash3(ob->name.c_str(), ob->name.length(), 0);
   uint32_t hash_asset = util_murmur_hash3(ob->asset_name.c_str(), ob->asset_name.length(), 0);
-  kobject.cryptomatte_object = util_hash_to_float(hash_name);
-  kobject.cryptomatte_asset = util_hash_to_float(hash_asset);
+  kattr.cryptomatte_object = util_hash_to_float(hash_name);
+  kattr.cryptomatte_asset = util_hash_to_float(hash_asset);
+  /* Zero padding, the attributes are compared bytewise for deduplication. */
+  kattr.pad1 = 0.0f;
+
   kobject.shadow_terminator_offset = 1.0f / (1.0f - 0.5f * ob->shadow_terminator_offset);
 
   /* Object flag. */
@@ -559,6 +582,7 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
   state.queue_start_object = 0;
 
   state.objects = dscene->objects.alloc(scene->objects.size());
+  state.object_attributes.resize(scene->objects.size());
   state.object_flag = dscene->object_flag.alloc(scene->objects.size());
   state.object_volume_step = dscene->object_volume_step.alloc(scene->objects.size());
   state.object_motion = NULL;
@@ -609,7 +633,45 @@ void ObjectManager::device_update_transforms(DeviceScene *dscene, Scene *scene,
     return;
   }
 
+  /* Instances often share all attributes, for example copies of the same object scattered
+   * with the same color, so store every unique set of attributes only once. */
+  ObjectAttributesMap attributes_map;
+  vector<KernelObjectAttributes> unique_attributes;
+
+  for (size_t i = 0; i < scene->objects.size(); i++) {
+    const KernelObjectAttributes &kattr = state.object_attributes[i];
+    std::pair<ObjectAttributesMap::iterator, bool> it = attributes_map.insert(
+        std::make_pair(kattr, (int)unique_attributes.size()));
+    if (it.second) {
+      unique_attributes.push_back(kattr);
+    }
+    state.objects[i].attributes = it.first->second;
+  }
+
+  KernelObjectAttributes *object_attributes = dscene->object_attributes.alloc(
+      unique_attributes.size());
+  std::copy(unique_attributes.begin(), unique_attributes.end(), object_attributes);
+
+  VLOG(1) << "Total " << unique_attributes.size() << " unique object attributes for "
+          << scene->objects.size() << " objects.";
+
+  /* Geometry data shared by instances. Offsets are filled in device_update_mesh_offsets. */
+  KernelGeometry *object_geometry = dscene->object_geometry.alloc(scene->geometry.size());
+  foreach (Geometry *geom, scene->geometry) {
+    KernelGeometry &kgeom = object_geometry[geom->index];
+    kgeom.numkeys = (geom->type == Geometry::HAIR) ?
+                        static_cast<Hair *>(geom)->curve_keys.size() :
+                        0;
+    kgeom.numsteps = (geom->motion_steps - 1) / 2;
+    kgeom.numverts = (geom->type == Geometry::MESH) ? static_cast<Mesh *>(geom)->verts.size() :
+                                                      0;
+    kgeom.patch_map_offset = 0;
+    kgeom.attribute_map_offset = 0;
+  }
+
   dscene->objects.copy_to_device();
+  dscene->object_attributes.copy_to_device();
+  dscene->object_geometry.copy_to_device();
   if (state.need_motion == Scene::MOTION_PASS) {
     dscene->object_motion_pass.copy_to_device();
   }
@@ -642,6 +704,12 @@ void ObjectManager::device_update(Device *device,
     object->index = index++;
   }
 
+  /* Assign geometry IDs. */
+  index = 0;
+  foreach (Geometry *geom, scene->geometry) {
+    geom->index = index++;
+  }
+
   /* set object transform matrices, before applying static transforms */
   progress.set_status("Updating Objects", "Copying Transformations to device");
   device_update_transforms(dscene, scene, progress);
@@ -741,12 +809,12 @@ void ObjectManager::device_update_mesh_offsets(Device *, DeviceScene *dscene, Sc
     return;
   }
 
-  KernelObject *kobjects = dscene->objects.data();
+  KernelGeometry *kgeometry = dscene->object_geometry.data();
 
   bool update = false;
 
-  foreach (Object *object, scene->objects) {
-    Geometry *geom = object->geometry;
+  foreach (Geometry *geom, scene->geometry) {
+    KernelGeometry &kgeom = kgeometry[geom->index];
 
     if (geom->type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
@@ -755,27 +823,29 @@ void ObjectManager::device_update_mesh_offsets(Device *, DeviceScene *dscene, Sc
                                      mesh->patch_table->num_nodes * PATCH_NODE_SIZE) -
                                 mesh->patch_offset;
 
-        if (kobjects[object->index].patch_map_offset != patch_map_offset) {
-          kobjects[object->index].patch_map_offset = patch_map_offset;
+        if (kgeom.patch_map_offset != patch_map_offset) {
+          kgeom.patch_map_offset = patch_map_offset;
           update = true;
         }
       }
     }
 
-    if (kobjects[object->index].attribute_map_offset != geom->attr_map_offset) {
-      kobjects[object->index].attribute_map_offset = geom->attr_map_offset;
+    if (kgeom.attribute_map_offset != geom->attr_map_offset) {
+      kgeom.attribute_map_offset = geom->attr_map_offset;
       update = true;
     }
   }
 
   if (update) {
-    dscene->objects.copy_to_device();
+    dscene->object_geometry.copy_to_device();
   }
 }
 
 void ObjectManager::device_free(Device *, DeviceScene *dscene)
 {
   dscene->objects.free();
+  dscene->object_attributes.free();
+  dscene->object_geometry.free();
   dscene->object_motion_pass.free();
   dscene->object_motion.free();
   dscene->object_flag.free();
@@ -88,6 +88,8 @@ class DeviceScene {
 
   /* objects */
   device_vector<KernelObject> objects;
+  device_vector<KernelObjectAttributes> object_attributes;
+  device_vector<KernelGeometry> object_geometry;
   device_vector<Transform> object_motion_pass;
   device_vector<DecomposedTransform> object_motion;
   device_vector<uint> object_flag;
@@ -108,6 +110,8 @@ class DeviceScene {
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<uint> light_tree_leaf;
 
   /* particles */
   device_vector<KernelParticle> particles;
@@ -168,11 +172,23 @@ class SceneParams {
   bool use_bvh_spatial_split;
   bool use_bvh_unaligned_nodes;
   int num_bvh_time_steps;
+  /* Number of consecutive curve segments grouped into one BVH2 leaf. */
+  int bvh_curve_strand_segments;
+  /* BVHs of deforming geometry are refit instead of built again, until their surface area
+   * heuristic cost grows by this factor compared to the built tree. Zero disables refitting
+   * the scene BVH and the quality test for geometry BVHs. */
+  float bvh_refit_threshold;
   int hair_subdivisions;
   CurveShapeType hair_shape;
   bool persistent_data;
   int texture_limit;
 
+  /* Read image textures on demand through a tiled, mip-mapped cache instead of loading them
+   * fully into memory, only used when rendering on the CPU. */
+  bool use_texture_cache;
+  int texture_cache_size;
+  bool texture_auto_convert;
+
   bool background;
 
   SceneParams()
@@ -183,10 +199,15 @@ class SceneParams {
     use_bvh_spatial_split = false;
     use_bvh_unaligned_nodes = true;
     num_bvh_time_steps = 0;
+    bvh_curve_strand_segments = 4;
+    bvh_refit_threshold = 1.5f;
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     persistent_data = false;
     texture_limit = 0;
+    use_texture_cache = false;
+    texture_cache_size = 1024;
+    texture_auto_convert = true;
     background = true;
   }
 
@@ -197,8 +218,13 @@ class SceneParams {
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
+             bvh_curve_strand_segments == params.bvh_curve_strand_segments &&
+             bvh_refit_threshold == params.bvh_refit_threshold &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             use_texture_cache == params.use_texture_cache &&
+             texture_cache_size == params.texture_cache_size &&
+             texture_auto_convert == params.texture_auto_convert);
   }
 
   int curve_subdivisions()
@@ -208,6 +234,29 @@ class SceneParams {
   }
 };
 
+/* Scene Times
+ *
+ * Wall clock time spent in the phases of updating and rendering the scene, in seconds,
+ * accumulated since the scene was created. When denoising tiles during rendering, denoising
+ * is part of the render time. */
+
+class SceneTimes {
+ public:
+  /* Scene device update, excluding the BVH build. */
+  double update;
+  double bvh_build;
+  double render;
+  double denoise;
+
+  SceneTimes()
+  {
+    update = 0.0;
+    bvh_build = 0.0;
+    render = 0.0;
+    denoise = 0.0;
+  }
+};
+
 /* Scene */
 
 class Scene {
@@ -253,6 +302,9 @@ class Scene {
   /* parameters */
   SceneParams params;
 
+  /* timing, filled in by the geometry manager and session */
+  SceneTimes times;
+
   /* mutex must be locked manually by callers */
   thread_mutex mutex;
 
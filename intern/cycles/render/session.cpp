@@ -28,12 +28,14 @@
 #include "render/object.h"
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/tile_output.h"
 
 #include "util/util_foreach.h"
 #include "util/util_function.h"
 #include "util/util_logging.h"
 #include "util/util_math.h"
 #include "util/util_opengl.h"
+#include "util/util_path.h"
 #include "util/util_task.h"
 #include "util/util_time.h"
 
@@ -61,6 +63,16 @@ Session::Session(const SessionParams &params_)
 
   TaskScheduler::init(params.threads);
 
+  /* Each CPU thread renders its own tile in final renders, split the last tiles so that all
+   * threads keep working until the end of the frame. */
+  if (params.device.type == DEVICE_CPU && params.background) {
+    tile_manager.num_workers = TaskScheduler::num_threads();
+  }
+
+  /* Render tiles line up with the tiles of the output file, so file tiles can be written as soon
+   * as their render tile is done. */
+  tile_manager.align_top = !params.tile_output_path.empty();
+
   /* Create CPU/GPU devices. */
   device = Device::create(params.device, stats, profiler, params.background);
 
@@ -82,6 +94,8 @@ Session::Session(const SessionParams &params_)
 
   reset_time = 0.0;
   last_update_time = 0.0;
+  render_start_time = 0.0;
+  denoise_start_time = 0.0;
 
   delayed_reset.do_reset = false;
   delayed_reset.samples = 0;
@@ -283,7 +297,7 @@ void Session::run_gpu()
       /* update scene */
       scoped_timer update_timer;
       if (update_scene()) {
-        profiler.reset(scene->shaders.size(), scene->objects.size());
+        profiler.reset(scene->shaders.size(), scene->objects.size(), NBUILTIN_CLOSURES);
       }
       progress.add_skip_time(update_timer, params.background);
 
@@ -307,6 +321,7 @@ void Session::run_gpu()
       render(need_denoise);
 
       device->task_wait();
+      update_render_times();
 
       if (!device->error_message().empty())
         progress.set_cancel(device->error_message());
@@ -518,6 +533,18 @@ void Session::release_tile(RenderTile &rtile, const bool need_denoise)
       write_render_tile_cb(rtile);
     }
 
+    /* Stream to file before the tile buffers are freed, only possible when tiles are not
+     * accumulated into a full frame buffer. */
+    if (!params.tile_output_path.empty() && !buffers && params.progressive_refine == false) {
+      if (!tile_output) {
+        BufferParams output_params = tile_manager.state.buffer;
+        output_params.passes = rtile.buffers->params.passes;
+        tile_output.reset(new TileOutput(
+            params.tile_output_path, output_params, params.tile_size, "RenderLayer"));
+      }
+      tile_output->write_render_tile(rtile, scene->film->exposure);
+    }
+
     if (delete_tile) {
       delete rtile.buffers;
       tile_manager.state.tiles[rtile.tile_index].buffers = NULL;
@@ -701,7 +728,7 @@ void Session::run_cpu()
       /* update scene */
       scoped_timer update_timer;
       if (update_scene()) {
-        profiler.reset(scene->shaders.size(), scene->objects.size());
+        profiler.reset(scene->shaders.size(), scene->objects.size(), NBUILTIN_CLOSURES);
       }
       progress.add_skip_time(update_timer, params.background);
 
@@ -735,6 +762,7 @@ void Session::run_cpu()
     }
 
     device->task_wait();
+    update_render_times();
 
     {
       thread_scoped_lock reset_lock(delayed_reset.mutex);
@@ -876,6 +904,13 @@ void Session::run()
 
   profiler.stop();
 
+  /* Write remaining tiles and close the file. */
+  tile_output.reset();
+
+  if (!params.profiling_report_path.empty() && !progress.get_cancel()) {
+    write_statistics_report(params.profiling_report_path);
+  }
+
   /* progress update */
   if (progress.get_cancel())
     progress.set_status(progress.get_cancel_message());
@@ -1043,7 +1078,12 @@ bool Session::update_scene()
     bool new_kernels_needed = load_kernels(false);
 
     progress.set_status("Updating Scene");
+    scoped_timer update_timer;
+    const double bvh_build_time = scene->times.bvh_build;
     MEM_GUARDED_CALL(&progress, scene->device_update, device, progress);
+    /* BVH build time is recorded separately, don't count it twice. */
+    scene->times.update += update_timer.get_time() -
+                           (scene->times.bvh_build - bvh_build_time);
 
     DeviceKernelStatus kernel_switch_status = device->get_active_kernel_switch_state();
     bool kernel_switch_needed = kernel_switch_status == DEVICE_KERNEL_FEATURE_KERNEL_AVAILABLE ||
@@ -1165,6 +1205,8 @@ void Session::render(bool need_denoise)
     return; /* Avoid empty launches. */
   }
 
+  render_start_time = time_dt();
+
   /* Add path trace task. */
   DeviceTask task(DeviceTask::RENDER);
 
@@ -1206,6 +1248,7 @@ void Session::render(bool need_denoise)
       /* Schedule rendering and wait for it to finish. */
       device->task_add(task);
       device->task_wait();
+      denoise_start_time = time_dt();
 
       /* Then run denoising on the whole image at once. */
       task.type = DeviceTask::DENOISE_BUFFER;
@@ -1224,6 +1267,25 @@ void Session::render(bool need_denoise)
   device->task_add(task);
 }
 
+void Session::update_render_times()
+{
+  if (render_start_time == 0.0) {
+    return;
+  }
+
+  const double end_time = time_dt();
+  if (denoise_start_time != 0.0) {
+    scene->times.render += denoise_start_time - render_start_time;
+    scene->times.denoise += end_time - denoise_start_time;
+  }
+  else {
+    scene->times.render += end_time - render_start_time;
+  }
+
+  render_start_time = 0.0;
+  denoise_start_time = 0.0;
+}
+
 void Session::copy_to_display_buffer(int sample)
 {
   /* add film conversion task */
@@ -1314,6 +1376,24 @@ void Session::collect_statistics(RenderStats *render_stats)
   }
 }
 
+bool Session::write_statistics_report(const string &filepath)
+{
+  RenderStats stats;
+  {
+    thread_scoped_lock scene_lock(scene->mutex);
+    collect_statistics(&stats);
+  }
+
+  string report = stats.json_report();
+  if (!path_write_text(filepath, report)) {
+    VLOG(1) << "Failed to write render statistics to " << filepath << ".";
+    return false;
+  }
+
+  VLOG(1) << "Render statistics written to " << filepath << ".";
+  return true;
+}
+
 int Session::get_max_closure_count()
 {
   if (scene->shader_manager->use_osl()) {
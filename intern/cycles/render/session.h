@@ -26,6 +26,7 @@
 #include "util/util_progress.h"
 #include "util/util_stats.h"
 #include "util/util_thread.h"
+#include "util/util_unique_ptr.h"
 #include "util/util_vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -38,6 +39,7 @@ class DisplayBuffer;
 class Progress;
 class RenderBuffers;
 class Scene;
+class TileOutput;
 
 /* Session Parameters */
 
@@ -59,6 +61,10 @@ class SessionParams {
   bool adaptive_sampling;
 
   bool use_profiling;
+  /* Write render statistics as JSON to this file after rendering, when not empty. */
+  string profiling_report_path;
+  /* Stream finished tiles of background renders to this tiled EXR file, when not empty. */
+  string tile_output_path;
 
   bool display_buffer_linear;
 
@@ -112,6 +118,8 @@ class SessionParams {
              pixel_size == params.pixel_size && threads == params.threads &&
              adaptive_sampling == params.adaptive_sampling &&
              use_profiling == params.use_profiling &&
+             profiling_report_path == params.profiling_report_path &&
+             tile_output_path == params.tile_output_path &&
              display_buffer_linear == params.display_buffer_linear &&
              cancel_timeout == params.cancel_timeout && reset_timeout == params.reset_timeout &&
              text_timeout == params.text_timeout &&
@@ -166,6 +174,7 @@ class Session {
   float get_progress();
 
   void collect_statistics(RenderStats *stats);
+  bool write_statistics_report(const string &filepath);
 
  protected:
   struct DelayedReset {
@@ -180,6 +189,8 @@ class Session {
   void update_status_time(bool show_pause = false, bool show_done = false);
 
   void render(bool use_denoise);
+  /* Add the time of the last render, which must have finished, to the scene times. */
+  void update_render_times();
   void copy_to_display_buffer(int sample);
 
   void reset_(BufferParams &params, int samples);
@@ -215,6 +226,9 @@ class Session {
   thread_condition_variable pause_cond;
   thread_mutex pause_mutex;
   thread_mutex tile_mutex;
+
+  /* Created on the first finished tile when tile_output_path is set, protected by tile_mutex. */
+  unique_ptr<TileOutput> tile_output;
   thread_mutex buffers_mutex;
   thread_mutex display_mutex;
   thread_condition_variable denoising_cond;
@@ -226,6 +240,10 @@ class Session {
   double last_update_time;
   double last_display_time;
 
+  /* Start of the last render and of denoising the full buffers after it, or zero. */
+  double render_start_time;
+  double denoise_start_time;
+
   /* progressive refine */
   bool update_progressive_refine(bool cancel);
 
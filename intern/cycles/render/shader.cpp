@@ -297,6 +297,7 @@ void Shader::set_graph(ShaderGraph *graph_)
   /* assign graph */
   delete graph;
   graph = graph_;
+  svm_cache.reset();
 
   /* Store info here before graph optimization to make sure that
    * nodes that get optimized away still count. */
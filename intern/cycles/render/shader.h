@@ -33,6 +33,7 @@
 #include "util/util_string.h"
 #include "util/util_thread.h"
 #include "util/util_types.h"
+#include "util/util_unique_ptr.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -43,6 +44,7 @@ class Mesh;
 class Progress;
 class Scene;
 class ShaderGraph;
+class SVMShaderCache;
 struct float3;
 
 enum ShadingSystem { SHADINGSYSTEM_OSL, SHADINGSYSTEM_SVM };
@@ -132,6 +134,9 @@ class Shader : public Node {
   uint id;
   bool used;
 
+  /* SVM program compiled from the current graph, cleared when the graph is replaced. */
+  unique_ptr<SVMShaderCache> svm_cache;
+
 #ifdef WITH_OSL
   /* osl shading state references */
   OSL::ShaderGroupRef osl_surface_ref;
@@ -24,6 +24,53 @@ CCL_NAMESPACE_BEGIN
 
 static int kIndentNumSpaces = 2;
 
+/* JSON helpers. */
+
+string json_string(const string &str)
+{
+  string result = "\"";
+  foreach (const char c, str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          result += string_printf("\\u%04x", (int)c);
+        }
+        else {
+          result += c;
+        }
+        break;
+    }
+  }
+  return result + "\"";
+}
+
+string json_array(const vector<string> &values, int indent_level)
+{
+  if (values.empty()) {
+    return "[]";
+  }
+
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string inner_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+  string result = "[\n";
+  for (size_t i = 0; i < values.size(); i++) {
+    result += inner_indent + values[i] + ((i + 1 < values.size()) ? ",\n" : "\n");
+  }
+  return result + indent + "]";
+}
+
 /* Named size entry. */
 
 namespace {
@@ -45,6 +92,105 @@ bool namedSampleCountPairComparator(const NamedSampleCountPair &a, const NamedSa
   return a.samples > b.samples;
 }
 
+const char *closure_type_name(ClosureType type)
+{
+  switch (type) {
+    case CLOSURE_NONE_ID:
+      return "None";
+    case CLOSURE_BSDF_ID:
+      return "BSDF";
+    case CLOSURE_BSDF_DIFFUSE_ID:
+      return "Diffuse";
+    case CLOSURE_BSDF_OREN_NAYAR_ID:
+      return "Oren-Nayar";
+    case CLOSURE_BSDF_DIFFUSE_RAMP_ID:
+      return "Diffuse Ramp";
+    case CLOSURE_BSDF_PRINCIPLED_DIFFUSE_ID:
+      return "Principled Diffuse";
+    case CLOSURE_BSDF_PRINCIPLED_SHEEN_ID:
+      return "Principled Sheen";
+    case CLOSURE_BSDF_DIFFUSE_TOON_ID:
+      return "Diffuse Toon";
+    case CLOSURE_BSDF_TRANSLUCENT_ID:
+      return "Translucent";
+    case CLOSURE_BSDF_REFLECTION_ID:
+      return "Reflection";
+    case CLOSURE_BSDF_MICROFACET_GGX_ID:
+      return "GGX";
+    case CLOSURE_BSDF_MICROFACET_GGX_FRESNEL_ID:
+      return "GGX Fresnel";
+    case CLOSURE_BSDF_MICROFACET_GGX_CLEARCOAT_ID:
+      return "GGX Clearcoat";
+    case CLOSURE_BSDF_MICROFACET_BECKMANN_ID:
+      return "Beckmann";
+    case CLOSURE_BSDF_MICROFACET_MULTI_GGX_ID:
+      return "Multiscatter GGX";
+    case CLOSURE_BSDF_MICROFACET_MULTI_GGX_FRESNEL_ID:
+      return "Multiscatter GGX Fresnel";
+    case CLOSURE_BSDF_ASHIKHMIN_SHIRLEY_ID:
+      return "Ashikhmin-Shirley";
+    case CLOSURE_BSDF_ASHIKHMIN_VELVET_ID:
+      return "Velvet";
+    case CLOSURE_BSDF_PHONG_RAMP_ID:
+      return "Phong Ramp";
+    case CLOSURE_BSDF_GLOSSY_TOON_ID:
+      return "Glossy Toon";
+    case CLOSURE_BSDF_HAIR_REFLECTION_ID:
+      return "Hair Reflection";
+    case CLOSURE_BSDF_REFRACTION_ID:
+      return "Refraction";
+    case CLOSURE_BSDF_MICROFACET_BECKMANN_REFRACTION_ID:
+      return "Beckmann Refraction";
+    case CLOSURE_BSDF_MICROFACET_GGX_REFRACTION_ID:
+      return "GGX Refraction";
+    case CLOSURE_BSDF_MICROFACET_MULTI_GGX_GLASS_ID:
+      return "Multiscatter GGX Glass";
+    case CLOSURE_BSDF_MICROFACET_BECKMANN_GLASS_ID:
+      return "Beckmann Glass";
+    case CLOSURE_BSDF_MICROFACET_GGX_GLASS_ID:
+      return "GGX Glass";
+    case CLOSURE_BSDF_MICROFACET_MULTI_GGX_GLASS_FRESNEL_ID:
+      return "Multiscatter GGX Glass Fresnel";
+    case CLOSURE_BSDF_SHARP_GLASS_ID:
+      return "Sharp Glass";
+    case CLOSURE_BSDF_HAIR_PRINCIPLED_ID:
+      return "Principled Hair";
+    case CLOSURE_BSDF_HAIR_TRANSMISSION_ID:
+      return "Hair Transmission";
+    case CLOSURE_BSDF_BSSRDF_ID:
+      return "BSSRDF Diffuse";
+    case CLOSURE_BSDF_BSSRDF_PRINCIPLED_ID:
+      return "BSSRDF Principled Diffuse";
+    case CLOSURE_BSDF_TRANSPARENT_ID:
+      return "Transparent";
+    case CLOSURE_BSSRDF_CUBIC_ID:
+      return "Cubic BSSRDF";
+    case CLOSURE_BSSRDF_GAUSSIAN_ID:
+      return "Gaussian BSSRDF";
+    case CLOSURE_BSSRDF_PRINCIPLED_ID:
+      return "Principled BSSRDF";
+    case CLOSURE_BSSRDF_BURLEY_ID:
+      return "Burley BSSRDF";
+    case CLOSURE_BSSRDF_RANDOM_WALK_ID:
+      return "Random Walk BSSRDF";
+    case CLOSURE_BSSRDF_PRINCIPLED_RANDOM_WALK_ID:
+      return "Principled Random Walk BSSRDF";
+    case CLOSURE_HOLDOUT_ID:
+      return "Holdout";
+    case CLOSURE_VOLUME_ID:
+      return "Volume";
+    case CLOSURE_VOLUME_ABSORPTION_ID:
+      return "Volume Absorption";
+    case CLOSURE_VOLUME_HENYEY_GREENSTEIN_ID:
+      return "Henyey-Greenstein";
+    case CLOSURE_BSDF_PRINCIPLED_ID:
+      return "Principled";
+    case NBUILTIN_CLOSURES:
+      break;
+  }
+  return "Unknown";
+}
+
 }  // namespace
 
 NamedSizeEntry::NamedSizeEntry() : name(""), size(0)
@@ -87,6 +233,27 @@ string NamedSizeStats::full_report(int indent_level)
   return result;
 }
 
+string NamedSizeStats::json_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string inner_indent = indent + string(kIndentNumSpaces, ' ');
+
+  sort(entries.begin(), entries.end(), namedSizeEntryComparator);
+  vector<string> values;
+  foreach (const NamedSizeEntry &entry, entries) {
+    values.push_back(string_printf("{\"name\": %s, \"size\": %llu}",
+                                   json_string(entry.name).c_str(),
+                                   (unsigned long long)entry.size));
+  }
+
+  string result = "{\n";
+  result += string_printf("%s\"total_size\": %llu,\n",
+                          inner_indent.c_str(),
+                          (unsigned long long)total_size);
+  result += inner_indent + "\"entries\": " + json_array(values, indent_level + 1) + "\n";
+  return result + indent + "}";
+}
+
 /* Named time sample statistics. */
 
 NamedNestedSampleStats::NamedNestedSampleStats() : name(""), self_samples(0), sum_samples(0)
@@ -142,10 +309,36 @@ string NamedNestedSampleStats::full_report(int indent_level, uint64_t total_samp
   return result;
 }
 
+string NamedNestedSampleStats::json_report(int indent_level)
+{
+  update_sum();
+
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string inner_indent = indent + string(kIndentNumSpaces, ' ');
+
+  sort(entries.begin(), entries.end(), namedTimeSampleEntryComparator);
+  vector<string> values;
+  foreach (NamedNestedSampleStats &entry, entries) {
+    values.push_back(entry.json_report(indent_level + 2));
+  }
+
+  string result = "{\n";
+  result += inner_indent + "\"name\": " + json_string(name) + ",\n";
+  result += string_printf(
+      "%s\"total_seconds\": %.3f,\n", inner_indent.c_str(), sum_samples * 0.001);
+  result += string_printf(
+      "%s\"self_seconds\": %.3f,\n", inner_indent.c_str(), self_samples * 0.001);
+  result += inner_indent + "\"entries\": " + json_array(values, indent_level + 1) + "\n";
+  return result + indent + "}";
+}
+
 /* Named sample count pairs. */
 
-NamedSampleCountPair::NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits)
-    : name(name), samples(samples), hits(hits)
+NamedSampleCountPair::NamedSampleCountPair(const ustring &name,
+                                           uint64_t samples,
+                                           uint64_t hits,
+                                           uint64_t nodes)
+    : name(name), samples(samples), hits(hits), nodes(nodes)
 {
 }
 
@@ -153,49 +346,121 @@ NamedSampleCountStats::NamedSampleCountStats()
 {
 }
 
-void NamedSampleCountStats::add(const ustring &name, uint64_t samples, uint64_t hits)
+void NamedSampleCountStats::add(const ustring &name,
+                                uint64_t samples,
+                                uint64_t hits,
+                                uint64_t nodes)
 {
   entry_map::iterator entry = entries.find(name);
   if (entry != entries.end()) {
     entry->second.samples += samples;
     entry->second.hits += hits;
+    entry->second.nodes += nodes;
     return;
   }
-  entries.emplace(name, NamedSampleCountPair(name, samples, hits));
+  entries.emplace(name, NamedSampleCountPair(name, samples, hits, nodes));
+}
+
+vector<NamedSampleCountPair> NamedSampleCountStats::sorted_entries()
+{
+  vector<NamedSampleCountPair> result;
+  result.reserve(entries.size());
+  foreach (entry_map::const_reference entry, entries) {
+    result.push_back(entry.second);
+  }
+  sort(result.begin(), result.end(), namedSampleCountPairComparator);
+  return result;
 }
 
 string NamedSampleCountStats::full_report(int indent_level)
 {
   const string indent(indent_level * kIndentNumSpaces, ' ');
 
-  vector<NamedSampleCountPair> sorted_entries;
-  sorted_entries.reserve(entries.size());
+  const vector<NamedSampleCountPair> sorted = sorted_entries();
 
   uint64_t total_hits = 0, total_samples = 0;
-  foreach (entry_map::const_reference entry, entries) {
-    const NamedSampleCountPair &pair = entry.second;
-
-    total_hits += pair.hits;
-    total_samples += pair.samples;
-
-    sorted_entries.push_back(pair);
+  foreach (const NamedSampleCountPair &entry, sorted) {
+    total_hits += entry.hits;
+    total_samples += entry.samples;
   }
   const double avg_samples_per_hit = ((double)total_samples) / total_hits;
 
-  sort(sorted_entries.begin(), sorted_entries.end(), namedSampleCountPairComparator);
-
   string result = "";
-  foreach (const NamedSampleCountPair &entry, sorted_entries) {
+  foreach (const NamedSampleCountPair &entry, sorted) {
     const double seconds = entry.samples * 0.001;
     const double relative = ((double)entry.samples) / (entry.hits * avg_samples_per_hit);
 
     result += indent +
               string_printf(
-                  "%-32s: %.2fs (Relative cost: %.2f)\n", entry.name.c_str(), seconds, relative);
+                  "%-32s: %.2fs (Relative cost: %.2f)", entry.name.c_str(), seconds, relative);
+    if (entry.nodes > 0) {
+      result += string_printf(", %.1f SVM nodes per hit", ((double)entry.nodes) / entry.hits);
+    }
+    result += "\n";
   }
   return result;
 }
 
+string NamedSampleCountStats::json_report(int indent_level)
+{
+  const vector<NamedSampleCountPair> sorted = sorted_entries();
+
+  uint64_t total_hits = 0, total_samples = 0;
+  foreach (const NamedSampleCountPair &entry, sorted) {
+    total_hits += entry.hits;
+    total_samples += entry.samples;
+  }
+  const double avg_samples_per_hit = ((double)total_samples) / total_hits;
+
+  vector<string> values;
+  foreach (const NamedSampleCountPair &entry, sorted) {
+    const double relative = ((double)entry.samples) / (entry.hits * avg_samples_per_hit);
+    values.push_back(string_printf(
+        "{\"name\": %s, \"seconds\": %.3f, \"hits\": %llu, \"relative_cost\": %.3f, "
+        "\"svm_nodes\": %llu}",
+        json_string(entry.name.string()).c_str(),
+        entry.samples * 0.001,
+        (unsigned long long)entry.hits,
+        relative,
+        (unsigned long long)entry.nodes));
+  }
+  return json_array(values, indent_level);
+}
+
+/* Named counts. */
+
+NamedCountStats::NamedCountStats()
+{
+}
+
+void NamedCountStats::add_entry(const string &name, uint64_t count)
+{
+  entries.push_back(NamedSizeEntry(name, count));
+}
+
+string NamedCountStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  string result = "";
+  foreach (const NamedSizeEntry &entry, entries) {
+    result += indent + string_printf("%-32s: %s\n",
+                                     entry.name.c_str(),
+                                     string_human_readable_number(entry.size).c_str());
+  }
+  return result;
+}
+
+string NamedCountStats::json_report(int indent_level)
+{
+  vector<string> values;
+  foreach (const NamedSizeEntry &entry, entries) {
+    values.push_back(string_printf("{\"name\": %s, \"count\": %llu}",
+                                   json_string(entry.name).c_str(),
+                                   (unsigned long long)entry.size));
+  }
+  return json_array(values, indent_level);
+}
+
 /* Mesh statistics. */
 
 MeshStats::MeshStats()
@@ -210,6 +475,14 @@ string MeshStats::full_report(int indent_level)
   return result;
 }
 
+string MeshStats::json_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string inner_indent = indent + string(kIndentNumSpaces, ' ');
+  return "{\n" + inner_indent + "\"geometry\": " + geometry.json_report(indent_level + 1) +
+         "\n" + indent + "}";
+}
+
 /* Image statistics. */
 
 ImageStats::ImageStats()
@@ -224,6 +497,14 @@ string ImageStats::full_report(int indent_level)
   return result;
 }
 
+string ImageStats::json_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string inner_indent = indent + string(kIndentNumSpaces, ' ');
+  return "{\n" + inner_indent + "\"textures\": " + textures.json_report(indent_level + 1) +
+         "\n" + indent + "}";
+}
+
 /* Overall statistics. */
 
 RenderStats::RenderStats()
@@ -284,11 +565,27 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
   prefilter.add_entry("Detect Outliers", prof.get_event(PROFILING_DENOISING_DETECT_OUTLIERS));
   prefilter.add_entry("Combine Halves", prof.get_event(PROFILING_DENOISING_COMBINE_HALVES));
 
+  closures = NamedNestedSampleStats("Total closure time", 0);
+  for (int type = 0; type < NBUILTIN_CLOSURES; type++) {
+    const uint64_t samples = prof.get_closure(type);
+    if (samples > 0) {
+      closures.add_entry(closure_type_name((ClosureType)type), samples);
+    }
+  }
+
+  counters.entries.clear();
+  counters.add_entry("Camera rays", prof.get_counter(PROFILING_COUNTER_CAMERA_RAYS));
+  counters.add_entry("Indirect rays", prof.get_counter(PROFILING_COUNTER_INDIRECT_RAYS));
+  counters.add_entry("Shadow rays", prof.get_counter(PROFILING_COUNTER_SHADOW_RAYS));
+  counters.add_entry("Local rays", prof.get_counter(PROFILING_COUNTER_LOCAL_RAYS));
+  counters.add_entry("Volume rays", prof.get_counter(PROFILING_COUNTER_VOLUME_RAYS));
+  counters.add_entry("BVH nodes visited", prof.get_counter(PROFILING_COUNTER_BVH_NODES));
+
   shaders.entries.clear();
   foreach (Shader *shader, scene->shaders) {
     uint64_t samples, hits;
     if (prof.get_shader(shader->id, samples, hits)) {
-      shaders.add(shader->name, samples, hits);
+      shaders.add(shader->name, samples, hits, prof.get_shader_svm_nodes(shader->id));
     }
   }
 
@@ -303,13 +600,21 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
 
 string RenderStats::full_report()
 {
+  const string indent(kIndentNumSpaces, ' ');
   string result = "";
   result += "Mesh statistics:\n" + mesh.full_report(1);
   result += "Image statistics:\n" + image.full_report(1);
+  result += "Time statistics:\n";
+  result += indent + string_printf("%-32s: %.2fs\n", "Scene update", times.update);
+  result += indent + string_printf("%-32s: %.2fs\n", "BVH build", times.bvh_build);
+  result += indent + string_printf("%-32s: %.2fs\n", "Render", times.render);
+  result += indent + string_printf("%-32s: %.2fs\n", "Denoise", times.denoise);
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
     result += "Object statistics:\n" + objects.full_report(1);
+    result += "Closure statistics:\n" + closures.full_report(1);
+    result += "Counters:\n" + counters.full_report(1);
   }
   else {
     result += "Profiling information not available (only works with CPU rendering)";
@@ -317,4 +622,28 @@ string RenderStats::full_report()
   return result;
 }
 
+string RenderStats::json_report()
+{
+  const string indent(kIndentNumSpaces, ' ');
+  string result = "{\n";
+  result += indent + "\"mesh\": " + mesh.json_report(1) + ",\n";
+  result += indent + "\"image\": " + image.json_report(1) + ",\n";
+  result += indent + "\"times\": " +
+            string_printf("{\"update_seconds\": %.3f, \"bvh_build_seconds\": %.3f, "
+                          "\"render_seconds\": %.3f, \"denoise_seconds\": %.3f}",
+                          times.update,
+                          times.bvh_build,
+                          times.render,
+                          times.denoise);
+  if (has_profiling) {
+    result += ",\n";
+    result += indent + "\"kernel\": " + kernel.json_report(1) + ",\n";
+    result += indent + "\"shaders\": " + shaders.json_report(1) + ",\n";
+    result += indent + "\"objects\": " + objects.json_report(1) + ",\n";
+    result += indent + "\"closures\": " + closures.json_report(1) + ",\n";
+    result += indent + "\"counters\": " + counters.json_report(1);
+  }
+  return result + "\n}\n";
+}
+
 CCL_NAMESPACE_END
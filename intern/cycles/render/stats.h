@@ -25,6 +25,11 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Quoted JSON string, with control characters escaped. */
+string json_string(const string &str);
+/* JSON array of values which are already formatted, one per line. */
+string json_array(const vector<string> &values, int indent_level);
+
 /* Named statistics entry, which corresponds to a size. There is no real
  * semantic around the units of size, it just should be the same for all
  * entries.
@@ -55,6 +60,9 @@ class NamedSizeStats {
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
 
+  /* Generate report as JSON object. */
+  string json_report(int indent_level = 0);
+
   /* Total size of all entries. */
   size_t total_size;
 
@@ -75,6 +83,7 @@ class NamedNestedSampleStats {
   void update_sum();
 
   string full_report(int indent_level = 0, uint64_t total_samples = 0);
+  string json_report(int indent_level = 0);
 
   string name;
 
@@ -90,11 +99,13 @@ class NamedNestedSampleStats {
  * This allows to estimate the time spent per item. */
 class NamedSampleCountPair {
  public:
-  NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits);
+  NamedSampleCountPair(const ustring &name, uint64_t samples, uint64_t hits, uint64_t nodes);
 
   ustring name;
   uint64_t samples;
   uint64_t hits;
+  /* Number of SVM nodes evaluated, for shaders. */
+  uint64_t nodes;
 };
 
 /* Contains statistics about pairs of samples and counts as described above. */
@@ -103,10 +114,28 @@ class NamedSampleCountStats {
   NamedSampleCountStats();
 
   string full_report(int indent_level = 0);
-  void add(const ustring &name, uint64_t samples, uint64_t hits);
+  string json_report(int indent_level = 0);
+  void add(const ustring &name, uint64_t samples, uint64_t hits, uint64_t nodes = 0);
 
   typedef unordered_map<ustring, NamedSampleCountPair, ustringHash> entry_map;
   entry_map entries;
+
+ protected:
+  /* Entries sorted by descending time. */
+  vector<NamedSampleCountPair> sorted_entries();
+};
+
+/* Named exact counts, like the number of rays traced of each type. */
+class NamedCountStats {
+ public:
+  NamedCountStats();
+
+  void add_entry(const string &name, uint64_t count);
+
+  string full_report(int indent_level = 0);
+  string json_report(int indent_level = 0);
+
+  vector<NamedSizeEntry> entries;
 };
 
 /* Statistics about mesh in the render database. */
@@ -116,6 +145,7 @@ class MeshStats {
 
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
+  string json_report(int indent_level = 0);
 
   /* Input geometry statistics, this is what is coming as an input to render
    * from. say, Blender. This does not include runtime or engine specific
@@ -131,6 +161,7 @@ class ImageStats {
 
   /* Generate full human-readable report. */
   string full_report(int indent_level = 0);
+  string json_report(int indent_level = 0);
 
   NamedSizeStats textures;
 };
@@ -143,6 +174,9 @@ class RenderStats {
   /* Return full report as string. */
   string full_report();
 
+  /* Return full report as JSON document, for processing by other tools. */
+  string json_report();
+
   /* Collect kernel sampling information from Stats. */
   void collect_profiling(Scene *scene, Profiler &prof);
 
@@ -153,6 +187,10 @@ class RenderStats {
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
+  NamedNestedSampleStats closures;
+  NamedCountStats counters;
+
+  SceneTimes times;
 };
 
 CCL_NAMESPACE_END
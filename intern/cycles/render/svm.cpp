@@ -18,6 +18,7 @@
 
 #include "render/background.h"
 #include "render/graph.h"
+#include "render/integrator.h"
 #include "render/light.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
@@ -48,20 +49,24 @@ void SVMShaderManager::reset(Scene * /*scene*/)
 
 void SVMShaderManager::device_update_shader(Scene *scene,
                                             Shader *shader,
-                                            Progress *progress,
-                                            array<int4> *svm_nodes)
+                                            bool background,
+                                            Progress *progress)
 {
   if (progress->get_cancel()) {
     return;
   }
   assert(shader->graph);
 
-  svm_nodes->push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+  array<int4> svm_nodes;
+  svm_nodes.push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
 
   SVMCompiler::Summary summary;
   SVMCompiler compiler(scene);
-  compiler.background = (shader == scene->background->get_shader(scene));
-  compiler.compile(shader, *svm_nodes, 0, &summary);
+  compiler.background = background;
+  compiler.compile(shader, svm_nodes, 0, &summary);
+
+  shader->svm_cache.reset(new SVMShaderCache(scene, shader, background));
+  shader->svm_cache->svm_nodes.steal_data(svm_nodes);
 
   VLOG(2) << "Compilation summary:\n"
           << "Shader name: " << shader->name << "\n"
@@ -85,16 +90,22 @@ void SVMShaderManager::device_update(Device *device,
   /* test if we need to update */
   device_free(device, dscene, scene);
 
-  /* Build all shaders. */
+  /* Build shaders that changed since they were last compiled. */
   TaskPool task_pool;
-  vector<array<int4>> shader_svm_nodes(num_shaders);
+  int num_compiled = 0;
+  Shader *background_shader = scene->background->get_shader(scene);
   for (int i = 0; i < num_shaders; i++) {
-    task_pool.push(function_bind(&SVMShaderManager::device_update_shader,
-                                 this,
-                                 scene,
-                                 scene->shaders[i],
-                                 &progress,
-                                 &shader_svm_nodes[i]));
+    Shader *shader = scene->shaders[i];
+    const bool background = (shader == background_shader);
+
+    if (shader->svm_cache && shader->svm_cache->matches(scene, shader, background)) {
+      shader->svm_cache->restore(shader);
+      continue;
+    }
+
+    task_pool.push(function_bind(
+        &SVMShaderManager::device_update_shader, this, scene, shader, background, &progress));
+    num_compiled++;
   }
   task_pool.wait_work();
 
@@ -107,7 +118,7 @@ void SVMShaderManager::device_update(Device *device,
   int svm_nodes_size = num_shaders;
   for (int i = 0; i < num_shaders; i++) {
     /* Since we're not copying the local jump node, the size ends up being one node lower. */
-    svm_nodes_size += shader_svm_nodes[i].size() - 1;
+    svm_nodes_size += scene->shaders[i]->svm_cache->svm_nodes.size() - 1;
   }
 
   int4 *svm_nodes = dscene->svm_nodes.alloc(svm_nodes_size);
@@ -115,6 +126,7 @@ void SVMShaderManager::device_update(Device *device,
   int node_offset = num_shaders;
   for (int i = 0; i < num_shaders; i++) {
     Shader *shader = scene->shaders[i];
+    const array<int4> &shader_svm_nodes = shader->svm_cache->svm_nodes;
 
     shader->need_update = false;
     if (shader->use_mis && shader->has_surface_emission) {
@@ -125,22 +137,23 @@ void SVMShaderManager::device_update(Device *device,
      * Each compiled shader starts with a jump node that has offsets local
      * to the shader, so copy those and add the offset into the global node list. */
     int4 &global_jump_node = svm_nodes[shader->id];
-    int4 &local_jump_node = shader_svm_nodes[i][0];
+    const int4 &local_jump_node = shader_svm_nodes[0];
 
     global_jump_node.x = NODE_SHADER_JUMP;
     global_jump_node.y = local_jump_node.y - 1 + node_offset;
     global_jump_node.z = local_jump_node.z - 1 + node_offset;
     global_jump_node.w = local_jump_node.w - 1 + node_offset;
 
-    node_offset += shader_svm_nodes[i].size() - 1;
+    node_offset += shader_svm_nodes.size() - 1;
   }
 
   /* Copy the nodes of each shader into the correct location. */
   svm_nodes += num_shaders;
   for (int i = 0; i < num_shaders; i++) {
-    int shader_size = shader_svm_nodes[i].size() - 1;
+    const array<int4> &shader_svm_nodes = scene->shaders[i]->svm_cache->svm_nodes;
+    int shader_size = shader_svm_nodes.size() - 1;
 
-    memcpy(svm_nodes, &shader_svm_nodes[i][1], sizeof(int4) * shader_size);
+    memcpy(svm_nodes, &shader_svm_nodes[1], sizeof(int4) * shader_size);
     svm_nodes += shader_size;
   }
 
@@ -155,7 +168,7 @@ void SVMShaderManager::device_update(Device *device,
   need_update = false;
 
   VLOG(1) << "Shader manager updated " << num_shaders << " shaders in " << time_dt() - start_time
-          << " seconds.";
+          << " seconds, compiled " << num_compiled << ".";
 }
 
 void SVMShaderManager::device_free(Device *device, DeviceScene *dscene, Scene *scene)
@@ -165,6 +178,62 @@ void SVMShaderManager::device_free(Device *device, DeviceScene *dscene, Scene *s
   dscene->svm_nodes.free();
 }
 
+/* Compiled Shader */
+
+SVMShaderCache::SVMShaderCache(const Scene *scene, const Shader *shader, bool background)
+    : used(shader->used),
+      background(background),
+      displacement_method(shader->displacement_method),
+      filter_glossy(scene->integrator->filter_glossy),
+      has_surface(shader->has_surface),
+      has_surface_emission(shader->has_surface_emission),
+      has_surface_transparent(shader->has_surface_transparent),
+      has_volume(shader->has_volume),
+      has_displacement(shader->has_displacement),
+      has_surface_bssrdf(shader->has_surface_bssrdf),
+      has_bump(shader->has_bump),
+      has_bssrdf_bump(shader->has_bssrdf_bump),
+      has_surface_spatial_varying(shader->has_surface_spatial_varying),
+      has_volume_spatial_varying(shader->has_volume_spatial_varying),
+      has_volume_attribute_dependency(shader->has_volume_attribute_dependency),
+      has_integrator_dependency(shader->has_integrator_dependency)
+{
+}
+
+bool SVMShaderCache::matches(const Scene *scene, const Shader *shader, bool background) const
+{
+  /* The graph is finalized once, so besides the graph itself only these settings change the
+   * generated nodes. Attribute IDs are stable for the lifetime of the shader manager. */
+  if (used != shader->used || this->background != background ||
+      displacement_method != shader->displacement_method) {
+    return false;
+  }
+
+  /* Nodes with an integrator dependency are simplified again on every compile, for example
+   * Glossy switching between sharp and GGX depending on filter glossy. */
+  if (has_integrator_dependency && filter_glossy != scene->integrator->filter_glossy) {
+    return false;
+  }
+
+  return true;
+}
+
+void SVMShaderCache::restore(Shader *shader) const
+{
+  shader->has_surface = has_surface;
+  shader->has_surface_emission = has_surface_emission;
+  shader->has_surface_transparent = has_surface_transparent;
+  shader->has_volume = has_volume;
+  shader->has_displacement = has_displacement;
+  shader->has_surface_bssrdf = has_surface_bssrdf;
+  shader->has_bump = has_bump;
+  shader->has_bssrdf_bump = has_bssrdf_bump;
+  shader->has_surface_spatial_varying = has_surface_spatial_varying;
+  shader->has_volume_spatial_varying = has_volume_spatial_varying;
+  shader->has_volume_attribute_dependency = has_volume_attribute_dependency;
+  shader->has_integrator_dependency = has_integrator_dependency;
+}
+
 /* Graph Compiler */
 
 SVMCompiler::SVMCompiler(Scene *scene) : scene(scene)
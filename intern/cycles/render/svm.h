@@ -37,6 +37,47 @@ class ShaderInput;
 class ShaderNode;
 class ShaderOutput;
 
+/* Compiled Shader
+ *
+ * SVM nodes of a shader together with the shader information the compiler fills in. Kept with
+ * the shader, so updates only compile shaders whose graph was replaced or whose compile settings
+ * changed. The nodes refer to image and IES slots owned by the graph, so they are only valid as
+ * long as the graph they were compiled from. */
+
+class SVMShaderCache {
+ public:
+  SVMShaderCache(const Scene *scene, const Shader *shader, bool background);
+
+  /* Whether the nodes match what compiling the shader would give now. */
+  bool matches(const Scene *scene, const Shader *shader, bool background) const;
+
+  /* Copy the information about the compiled shader back to the shader. */
+  void restore(Shader *shader) const;
+
+  /* Nodes starting with the local jump node. */
+  array<int4> svm_nodes;
+
+ protected:
+  bool used;
+  bool background;
+  DisplacementMethod displacement_method;
+  /* Integrator setting nodes simplify with, for shaders with an integrator dependency. */
+  float filter_glossy;
+
+  bool has_surface;
+  bool has_surface_emission;
+  bool has_surface_transparent;
+  bool has_volume;
+  bool has_displacement;
+  bool has_surface_bssrdf;
+  bool has_bump;
+  bool has_bssrdf_bump;
+  bool has_surface_spatial_varying;
+  bool has_volume_spatial_varying;
+  bool has_volume_attribute_dependency;
+  bool has_integrator_dependency;
+};
+
 /* Shader Manager */
 
 class SVMShaderManager : public ShaderManager {
@@ -50,10 +91,7 @@ class SVMShaderManager : public ShaderManager {
   void device_free(Device *device, DeviceScene *dscene, Scene *scene);
 
  protected:
-  void device_update_shader(Scene *scene,
-                            Shader *shader,
-                            Progress *progress,
-                            array<int4> *svm_nodes);
+  void device_update_shader(Scene *scene, Shader *shader, bool background, Progress *progress);
 };
 
 /* Graph Compiler */
@@ -18,6 +18,7 @@
 
 #include "util/util_algorithm.h"
 #include "util/util_foreach.h"
+#include "util/util_time.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -59,6 +60,28 @@ class TileComparator {
   Tile *tiles;
 };
 
+/* Orders tiles by decreasing render time in the previous pass. */
+class TileCostComparator {
+ public:
+  TileCostComparator(Tile *tiles_) : tiles(tiles_)
+  {
+  }
+
+  bool operator()(int a, int b)
+  {
+    return tiles[a].render_time > tiles[b].render_time;
+  }
+
+ protected:
+  Tile *tiles;
+};
+
+/* Tiles are not split below this size in pixels, beyond it the per tile overhead dominates. */
+const int TILE_SPLIT_MIN_SIZE = 8;
+
+/* Number of tiles per worker to reserve for splitting. */
+const int TILE_SPLIT_RESERVE = 16;
+
 inline int2 hilbert_index_to_pos(int n, int d)
 {
   int2 r, xy = make_int2(0, 0);
@@ -102,6 +125,8 @@ TileManager::TileManager(bool progressive_,
   start_resolution = start_resolution_;
   pixel_size = pixel_size_;
   slice_overlap = 0;
+  num_workers = 0;
+  align_top = false;
   num_samples = num_samples_;
   num_devices = num_devices_;
   preserve_tile_device = preserve_tile_device_;
@@ -206,6 +231,12 @@ int TileManager::gen_tiles(bool sliced)
   int slice_num = sliced ? num : 1;
   int tile_w = (tile_size.x >= image_w) ? 1 : divide_up(image_w, tile_size.x);
 
+  /* Rows of tiles are shifted down for top alignment, making the first row partial instead of
+   * the last one. The number of rows and tile indices stay the same. */
+  const int grid_offset_y = (align_top && !sliced && slice_overlap == 0 && tile_size.y < image_h) ?
+                                (tile_size.y - image_h % tile_size.y) % tile_size.y :
+                                0;
+
   device_free();
   state.render_tiles.clear();
   state.denoising_tiles.clear();
@@ -261,10 +292,11 @@ int TileManager::gen_tiles(bool sliced)
          * the spiral is always square). */
         if (pos.x >= 0 && pos.y >= 0 && pos.x < image_w && pos.y < image_h) {
           int w = min(tile_size.x, image_w - pos.x);
-          int h = min(tile_size.y, image_h - pos.y);
+          int y = max(pos.y - grid_offset_y, 0);
+          int h = min(pos.y - grid_offset_y + tile_size.y, image_h) - y;
           int2 ipos = pos / tile_size;
           int idx = ipos.y * tile_w + ipos.x;
-          state.tiles[idx] = Tile(idx, pos.x, pos.y, w, h, cur_device, Tile::RENDER);
+          state.tiles[idx] = Tile(idx, pos.x, y, w, h, cur_device, Tile::RENDER);
           tile_list->push_front(idx);
           cur_tiles++;
 
@@ -333,9 +365,10 @@ int TileManager::gen_tiles(bool sliced)
     for (int tile_y = 0; tile_y < tile_h; tile_y++) {
       for (int tile_x = 0; tile_x < tile_w; tile_x++, idx++) {
         int x = tile_x * tile_size.x;
-        int y = tile_y * tile_size.y;
+        int grid_y = tile_y * tile_size.y - grid_offset_y;
+        int y = max(grid_y, 0);
         int w = (tile_x == tile_w - 1) ? image_w - x : tile_size.x;
-        int h = (tile_y == tile_h - 1) ? slice_h - y : tile_size.y;
+        int h = (tile_y == tile_h - 1) ? slice_h - y : grid_y + tile_size.y - y;
 
         state.tiles.push_back(
             Tile(idx, x, y + slice_y, w, h, sliced ? slice : cur_device, Tile::RENDER));
@@ -372,6 +405,56 @@ void TileManager::gen_render_tiles()
     tile.state = Tile::RENDER;
     state.render_tiles[tile.device].push_back(tile.index);
   }
+
+  /* Start with the tiles that took longest in the previous pass, so that the pass does not end
+   * with most devices waiting for one expensive tile. */
+  foreach (list<int> &tiles, state.render_tiles) {
+    tiles.sort(TileCostComparator(&state.tiles[0]));
+  }
+}
+
+void TileManager::split_render_tiles(list<int> &tiles)
+{
+  /* Only tiles that are rendered once and into their own region can be split. Denoising needs
+   * the regular grid to find neighbors, and progressive rendering keeps the tile buffers. */
+  if (num_workers <= 1 || progressive || preserve_tile_device || schedule_denoising) {
+    return;
+  }
+
+  int num_remaining = 0;
+  foreach (list<int> &device_tiles, state.render_tiles) {
+    num_remaining += device_tiles.size();
+  }
+
+  /* Tiles are handed out by pointer, so the tile array must not be reallocated. */
+  while (!tiles.empty() && num_remaining < num_workers &&
+         state.tiles.size() < state.tiles.capacity()) {
+    Tile &tile = state.tiles[tiles.front()];
+    const bool split_x = tile.w >= tile.h;
+    const int size = split_x ? tile.w : tile.h;
+    if (size < 2 * TILE_SPLIT_MIN_SIZE) {
+      break;
+    }
+
+    Tile second = tile;
+    second.index = state.tiles.size();
+    if (split_x) {
+      tile.w = size / 2;
+      second.x += tile.w;
+      second.w -= tile.w;
+    }
+    else {
+      tile.h = size / 2;
+      second.y += tile.h;
+      second.h -= tile.h;
+    }
+
+    /* The second half is handed out right after the first, to the next idle worker. */
+    state.tiles.push_back(second);
+    tiles.insert(++tiles.begin(), second.index);
+    state.num_tiles++;
+    num_remaining++;
+  }
 }
 
 void TileManager::set_tiles()
@@ -381,6 +464,7 @@ void TileManager::set_tiles()
   int image_h = max(1, params.height / resolution);
 
   state.num_tiles = gen_tiles(!background);
+  state.tiles.reserve(state.num_tiles + TILE_SPLIT_RESERVE * num_workers);
 
   state.buffer.width = image_w;
   state.buffer.height = image_h;
@@ -447,6 +531,8 @@ bool TileManager::finish_tile(const int index, const bool need_denoise, bool &de
 
   switch (state.tiles[index].state) {
     case Tile::RENDER: {
+      state.tiles[index].render_time = time_dt() - state.tiles[index].start_time;
+
       if (!(schedule_denoising && need_denoise)) {
         state.tiles[index].state = Tile::DONE;
         delete_tile = !progressive;
@@ -542,6 +628,8 @@ bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
         }
       }
 
+      split_render_tiles(state.render_tiles[logical_device]);
+
       tile_index = state.render_tiles[logical_device].front();
       state.render_tiles[logical_device].pop_front();
       break;
@@ -549,6 +637,7 @@ bool TileManager::next_tile(Tile *&tile, int device, uint tile_types)
 
     if (tile_index >= 0) {
       tile = &state.tiles[tile_index];
+      tile->start_time = time_dt();
       return true;
     }
   }
@@ -40,12 +40,25 @@ class Tile {
   State state;
   RenderBuffers *buffers;
 
+  /* Time at which rendering of the tile started, and the time it took in the last pass. */
+  double start_time;
+  double render_time;
+
   Tile()
   {
   }
 
   Tile(int index_, int x_, int y_, int w_, int h_, int device_, State state_ = RENDER)
-      : index(index_), x(x_), y(y_), w(w_), h(h_), device(device_), state(state_), buffers(NULL)
+      : index(index_),
+        x(x_),
+        y(y_),
+        w(w_),
+        h(h_),
+        device(device_),
+        state(state_),
+        buffers(NULL),
+        start_time(0.0),
+        render_time(0.0)
   {
   }
 };
@@ -91,6 +104,16 @@ class TileManager {
   int num_samples;
   int slice_overlap;
 
+  /* Number of threads acquiring tiles. When fewer tiles than threads are left, the next tile is
+   * split so that threads finishing early near the end of the frame pick up part of the remaining
+   * work instead of idling. Zero disables splitting. */
+  int num_workers;
+
+  /* Align the tile grid with the top of the image instead of the bottom, so that the row of
+   * partial tiles is at the bottom. Used when tiles are streamed to files that store rows top to
+   * bottom, so that render tiles line up with the tiles in the file. */
+  bool align_top;
+
   TileManager(bool progressive,
               int num_samples,
               int2 tile_size,
@@ -165,6 +188,9 @@ class TileManager {
   /* Generate tile list, return number of tiles. */
   int gen_tiles(bool sliced);
   void gen_render_tiles();
+
+  /* Split tiles at the front of the list until there is work for all workers. */
+  void split_render_tiles(list<int> &tiles);
 };
 
 CCL_NAMESPACE_END
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/tile_output.h"
+
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+
+CCL_NAMESPACE_BEGIN
+
+static const char *channel_suffix(int components, int channel)
+{
+  if (components == 1) {
+    return "X";
+  }
+
+  static const char *rgba[4] = {"R", "G", "B", "A"};
+  return rgba[channel];
+}
+
+TileOutput::TileOutput(const string &filepath,
+                       const BufferParams &params,
+                       const int2 tile_size,
+                       const string &layer_name)
+    : filepath(filepath),
+      full_x(params.full_x),
+      full_y(params.full_y),
+      num_channels(0),
+      writer_exit(false)
+{
+  foreach (const Pass &pass, params.passes) {
+    /* Unnamed passes are only used internally, for example for dividing other passes. */
+    if (pass.name.empty()) {
+      continue;
+    }
+
+    OutputPass output_pass;
+    output_pass.name = pass.name;
+    output_pass.components = pass.components;
+    output_pass.channel_offset = num_channels;
+    passes.push_back(output_pass);
+
+    num_channels += pass.components;
+  }
+
+  if (passes.empty()) {
+    VLOG(1) << "No named passes to write to " << filepath << ".";
+    return;
+  }
+
+  spec = OIIO::ImageSpec(params.width, params.height, num_channels, OIIO::TypeDesc::FLOAT);
+  spec.tile_width = tile_size.x;
+  spec.tile_height = tile_size.y;
+  spec.tile_depth = 1;
+  spec.attribute("compression", "zip");
+  /* Tiles finish in any order. */
+  spec.attribute("openexr:lineOrder", "randomY");
+
+  spec.channelnames.clear();
+  foreach (const OutputPass &pass, passes) {
+    for (int c = 0; c < pass.components; c++) {
+      spec.channelnames.push_back(layer_name + "." + pass.name + "." +
+                                  channel_suffix(pass.components, c));
+    }
+  }
+
+  out = unique_ptr<OIIO::ImageOutput>(OIIO::ImageOutput::create(filepath));
+  if (!out || !out->supports("tiles") || !out->open(filepath, spec)) {
+    VLOG(1) << "Failed to open " << filepath << " for tiled output.";
+    out.reset();
+    return;
+  }
+
+  writer.reset(new thread(function_bind(&TileOutput::writer_thread_run, this)));
+}
+
+TileOutput::~TileOutput()
+{
+  if (!out) {
+    return;
+  }
+
+  {
+    thread_scoped_lock lock(mutex);
+
+    const int tiles_x = divide_up(spec.width, spec.tile_width);
+    for (auto &it : pending_tiles) {
+      queue_tile(it.first % tiles_x, it.first / tiles_x, it.second);
+    }
+    pending_tiles.clear();
+
+    writer_exit = true;
+  }
+
+  write_cond.notify_all();
+  writer->join();
+
+  out->close();
+}
+
+TileOutput::PendingTile &TileOutput::pending_tile(int tile_x, int tile_y)
+{
+  const int tiles_x = divide_up(spec.width, spec.tile_width);
+  const int index = tile_x + tile_y * tiles_x;
+
+  map<int, PendingTile>::iterator it = pending_tiles.find(index);
+  if (it != pending_tiles.end()) {
+    return it->second;
+  }
+
+  /* Tiles at the right and bottom edge of the file are partially outside of it. */
+  const int width = min(spec.tile_width, spec.width - tile_x * spec.tile_width);
+  const int height = min(spec.tile_height, spec.height - tile_y * spec.tile_height);
+
+  PendingTile &tile = pending_tiles[index];
+  tile.pixels.resize((size_t)spec.tile_width * spec.tile_height * num_channels, 0.0f);
+  tile.num_missing_pixels = width * height;
+  return tile;
+}
+
+void TileOutput::queue_tile(int tile_x, int tile_y, PendingTile &tile)
+{
+  write_queue.push_back(WriteTile());
+  WriteTile &write_tile = write_queue.back();
+  write_tile.tile_x = tile_x;
+  write_tile.tile_y = tile_y;
+  write_tile.pixels.swap(tile.pixels);
+}
+
+void TileOutput::write_tile(const WriteTile &tile)
+{
+  if (!out->write_tile(tile.tile_x * spec.tile_width,
+                       tile.tile_y * spec.tile_height,
+                       0,
+                       OIIO::TypeDesc::FLOAT,
+                       tile.pixels.data())) {
+    VLOG(1) << "Failed to write tile to " << filepath << ": " << out->geterror();
+  }
+}
+
+void TileOutput::writer_thread_run()
+{
+  thread_scoped_lock lock(mutex);
+
+  while (true) {
+    write_cond.wait(lock, [this] { return !write_queue.empty() || writer_exit; });
+
+    if (write_queue.empty()) {
+      break;
+    }
+
+    WriteTile tile;
+    tile.tile_x = write_queue.front().tile_x;
+    tile.tile_y = write_queue.front().tile_y;
+    tile.pixels.swap(write_queue.front().pixels);
+    write_queue.pop_front();
+
+    /* Compression and file access happen without blocking render threads. */
+    lock.unlock();
+    write_tile(tile);
+    lock.lock();
+  }
+}
+
+void TileOutput::write_render_tile(RenderTile &rtile, float exposure)
+{
+  if (!out) {
+    return;
+  }
+
+  RenderBuffers *buffers = rtile.buffers;
+  if (!buffers->copy_from_device()) {
+    return;
+  }
+
+  /* Read passes outside of the lock, other threads may finish tiles at the same time. */
+  const int w = rtile.w, h = rtile.h;
+  vector<float> pass_pixels((size_t)w * h * num_channels);
+  vector<float> pixels;
+
+  foreach (const OutputPass &pass, passes) {
+    pixels.resize((size_t)w * h * pass.components);
+    if (!buffers->get_pass_rect(pass.name, exposure, rtile.sample, pass.components, &pixels[0])) {
+      memset(&pixels[0], 0, pixels.size() * sizeof(float));
+    }
+
+    for (size_t i = 0; i < (size_t)w * h; i++) {
+      for (int c = 0; c < pass.components; c++) {
+        pass_pixels[i * num_channels + pass.channel_offset + c] =
+            pixels[i * pass.components + c];
+      }
+    }
+  }
+
+  write_pixels(rtile.x - full_x, rtile.y - full_y, w, h, pass_pixels.data());
+}
+
+void TileOutput::write_pixels(int x, int y, int w, int h, const float *pixels)
+{
+  if (!out) {
+    return;
+  }
+
+  bool queued = false;
+
+  {
+    thread_scoped_lock lock(mutex);
+
+    /* Render buffer rows go bottom to top, file rows top to bottom. */
+    for (int row_y = 0; row_y < h; row_y++) {
+      const int file_y = spec.height - 1 - (y + row_y);
+      const int tile_y = file_y / spec.tile_height;
+      const int row = file_y % spec.tile_height;
+
+      int row_x = 0;
+      while (row_x < w) {
+        const int file_x = x + row_x;
+        const int tile_x = file_x / spec.tile_width;
+        const int column = file_x % spec.tile_width;
+        const int num_pixels = min(w - row_x, spec.tile_width - column);
+
+        PendingTile &tile = pending_tile(tile_x, tile_y);
+        memcpy(&tile.pixels[((size_t)row * spec.tile_width + column) * num_channels],
+               &pixels[((size_t)row_y * w + row_x) * num_channels],
+               sizeof(float) * num_pixels * num_channels);
+        tile.num_missing_pixels -= num_pixels;
+
+        if (tile.num_missing_pixels == 0) {
+          queue_tile(tile_x, tile_y, tile);
+          pending_tiles.erase(tile_x + tile_y * divide_up(spec.width, spec.tile_width));
+          queued = true;
+        }
+
+        row_x += num_pixels;
+      }
+    }
+  }
+
+  if (queued) {
+    write_cond.notify_one();
+  }
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TILE_OUTPUT_H__
+#define __TILE_OUTPUT_H__
+
+#include "render/buffers.h"
+
+#include "util/util_list.h"
+#include "util/util_map.h"
+#include "util/util_string.h"
+#include "util/util_thread.h"
+#include "util/util_unique_ptr.h"
+#include "util/util_vector.h"
+
+#include <OpenImageIO/imageio.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Tile Output
+ *
+ * Streams finished render tiles of a background render to a tiled multilayer EXR file, so the
+ * render buffers of a tile can be freed as soon as it is written. The file stores rows top to
+ * bottom, so the render tile grid is expected to be aligned with the top of the image, in which
+ * case every file tile is complete once its render tile is. Pixels of file tiles that are only
+ * partially done, for split render tiles, are kept in memory until all of them arrived.
+ * Complete tiles are compressed and written by a separate thread, so render threads do not
+ * wait for it. Only named passes are written, with channels named Layer.Pass.Channel the same
+ * as Blender. */
+class TileOutput {
+ public:
+  TileOutput(const string &filepath,
+             const BufferParams &params,
+             const int2 tile_size,
+             const string &layer_name);
+  /* Writes tiles that did not receive all pixels, for canceled renders, and closes the file. */
+  ~TileOutput();
+
+  /* Copy the passes of a finished tile into the file. Thread safe. */
+  void write_render_tile(RenderTile &rtile, float exposure);
+
+  /* Copy pixels of a region of the render buffer into the file, with the channels of all passes
+   * interleaved and rows bottom to top like render buffers. Thread safe. */
+  void write_pixels(int x, int y, int w, int h, const float *pixels);
+
+ protected:
+  struct OutputPass {
+    string name;
+    int components;
+    /* First channel of the pass in the file. */
+    int channel_offset;
+  };
+
+  struct PendingTile {
+    vector<float> pixels;
+    int num_missing_pixels;
+  };
+
+  struct WriteTile {
+    int tile_x, tile_y;
+    vector<float> pixels;
+  };
+
+  PendingTile &pending_tile(int tile_x, int tile_y);
+  void queue_tile(int tile_x, int tile_y, PendingTile &tile);
+  void write_tile(const WriteTile &tile);
+  void writer_thread_run();
+
+  string filepath;
+  unique_ptr<OIIO::ImageOutput> out;
+  OIIO::ImageSpec spec;
+
+  /* Origin of the render buffer in the full image. */
+  int full_x, full_y;
+
+  vector<OutputPass> passes;
+  int num_channels;
+
+  /* Protects the pending tiles and the write queue. */
+  thread_mutex mutex;
+  map<int, PendingTile> pending_tiles;
+
+  list<WriteTile> write_queue;
+  thread_condition_variable write_cond;
+  bool writer_exit;
+  unique_ptr<thread> writer;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __TILE_OUTPUT_H__ */
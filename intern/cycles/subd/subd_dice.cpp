@@ -29,6 +29,10 @@ EdgeDice::EdgeDice(const SubdParams &params_) : params(params_)
   mesh_P = NULL;
   mesh_N = NULL;
   vert_offset = 0;
+  tri_offset = 0;
+  cache_face = NULL;
+  cache_index = 0;
+  cache_replay = false;
 
   params.mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -45,8 +49,9 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->verts.size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->verts.size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->verts.size() + num_verts, mesh->num_triangles() + num_triangles);
+  /* Triangles are written at their own offset rather than appended, so subpatches can be diced
+   * in parallel. */
+  mesh->resize_mesh(mesh->verts.size() + num_verts, mesh->num_triangles() + num_triangles);
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -60,10 +65,29 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
 {
   float3 P, N;
 
-  patch->eval(&P, NULL, NULL, &N, uv.x, uv.y);
+  if (cache_replay && cache_index < cache_face->P.size()) {
+    P = cache_face->P[cache_index];
+    N = cache_face->N[cache_index];
+    cache_index++;
+  }
+  else {
+    patch->eval(&P, NULL, NULL, &N, uv.x, uv.y);
+
+    if (cache_face) {
+      cache_face->P.push_back(P);
+      cache_face->N.push_back(N);
+    }
+  }
 
   assert(index < params.mesh->verts.size());
 
+  if (!side_verts_set.empty()) {
+    if (side_verts_set[index]) {
+      return;
+    }
+    side_verts_set[index] = true;
+  }
+
   mesh_P[index] = P;
   mesh_N[index] = N;
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
@@ -73,8 +97,14 @@ void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(tri_offset < mesh->num_triangles());
+
+  mesh->triangles[tri_offset * 3 + 0] = v0 + vert_offset;
+  mesh->triangles[tri_offset * 3 + 1] = v1 + vert_offset;
+  mesh->triangles[tri_offset * 3 + 2] = v2 + vert_offset;
+  mesh->shader[tri_offset] = patch->shader;
+  mesh->smooth[tri_offset] = true;
+  mesh->triangle_patch[tri_offset] = patch->patch_index;
 
   tri_offset++;
 }
@@ -250,7 +280,15 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::set_sides(Subpatch &sub)
+{
+  set_side(sub, 0);
+  set_side(sub, 1);
+  set_side(sub, 2);
+  set_side(sub, 3);
+}
+
+void QuadDice::dice_inner(Subpatch &sub)
 {
   /* compute inner grid size with scale factor */
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
@@ -268,16 +306,66 @@ void QuadDice::dice(Subpatch &sub)
   /* inner grid */
   add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
 
-  /* sides */
-  set_side(sub, 0);
-  set_side(sub, 1);
-  set_side(sub, 2);
-  set_side(sub, 3);
-
+  /* stitch to the sides, which are already set */
   stitch_triangles(sub, 0);
   stitch_triangles(sub, 1);
   stitch_triangles(sub, 2);
   stitch_triangles(sub, 3);
 }
 
+void QuadDice::set_face_sides(Subpatch *subpatches, int num_subpatches, DiceCache::Face *cache)
+{
+  cache_face = cache;
+  cache_index = 0;
+  cache_replay = false;
+
+  if (cache) {
+    /* The evaluations only depend on where the subpatches are within the patches and on their
+     * edge factors, vertex indices may change freely. */
+    vector<DiceCache::SubpatchKey> keys(num_subpatches);
+
+    for (int i = 0; i < num_subpatches; i++) {
+      for (int j = 0; j < 4; j++) {
+        keys[i].corners[j] = subpatches[i].corners[j];
+        keys[i].T[j] = subpatches[i].edges[j].T;
+      }
+    }
+
+    cache_replay = (keys == cache->subpatches);
+    cache->replay = cache_replay;
+
+    if (!cache_replay) {
+      cache->subpatches.swap(keys);
+      cache->P.clear();
+      cache->N.clear();
+    }
+  }
+
+  for (int i = 0; i < num_subpatches; i++) {
+    set_sides(subpatches[i]);
+  }
+
+  if (cache && !cache_replay) {
+    cache->num_side_evals = cache->P.size();
+  }
+
+  cache_face = NULL;
+  cache_replay = false;
+}
+
+void QuadDice::dice_face_inner(Subpatch *subpatches, int num_subpatches, DiceCache::Face *cache)
+{
+  /* Evaluations of the inner grids follow those of the sides. */
+  cache_face = cache;
+  cache_index = (cache) ? cache->num_side_evals : 0;
+  cache_replay = (cache) ? cache->replay : false;
+
+  for (int i = 0; i < num_subpatches; i++) {
+    dice_inner(subpatches[i]);
+  }
+
+  cache_face = NULL;
+  cache_replay = false;
+}
+
 CCL_NAMESPACE_END
@@ -43,6 +43,8 @@ struct SubdParams {
   int max_level;
   Camera *camera;
   Transform objecttoworld;
+  /* Reuse patch evaluations of the previous tessellation, see DiceCache. */
+  bool use_cache;
 
   SubdParams(Mesh *mesh_, bool ptex_ = false)
   {
@@ -54,6 +56,77 @@ struct SubdParams {
     dicing_rate = 1.0f;
     max_level = 12;
     camera = NULL;
+    use_cache = false;
+  }
+};
+
+/* Dice Cache
+ *
+ * Positions and normals evaluated by the previous tessellation of a mesh, for every face. When
+ * the mesh is tessellated again, for example because the dicing camera moved, faces that are
+ * split into the same subpatches with the same edge factors replay the stored evaluations, and
+ * only the patches of faces whose edge factors changed are evaluated again. */
+class DiceCache {
+ public:
+  struct SubpatchKey {
+    float2 corners[4];
+    int T[4];
+
+    bool operator==(const SubpatchKey &other) const
+    {
+      for (int i = 0; i < 4; i++) {
+        if (corners[i].x != other.corners[i].x || corners[i].y != other.corners[i].y ||
+            T[i] != other.T[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  struct Face {
+    /* Subpatches the face was diced into, the evaluations are only valid for these. */
+    vector<SubpatchKey> subpatches;
+    /* Evaluations in the order they were requested while dicing the face, first the sides of
+     * all subpatches and then their inner grids. */
+    vector<float3> P;
+    vector<float3> N;
+    size_t num_side_evals;
+    /* Whether the evaluations are replayed in the current tessellation. */
+    bool replay;
+
+    Face() : num_side_evals(0), replay(false)
+    {
+    }
+  };
+
+  /* Hash of the control mesh and subdivision settings the faces were evaluated for. */
+  uint64_t mesh_key;
+  int num_faces;
+  vector<Face> faces;
+
+  DiceCache() : mesh_key(0), num_faces(0)
+  {
+  }
+
+  /* Evaluations are only reused when the same control mesh is tessellated again, so they are
+   * only stored from the second tessellation with the same key on. Clears all faces when the
+   * mesh changed. */
+  void validate(uint64_t key, int num_faces_)
+  {
+    if (key != mesh_key || num_faces_ != num_faces) {
+      vector<Face>().swap(faces);
+      mesh_key = key;
+      num_faces = num_faces_;
+    }
+    else if (faces.size() != num_faces) {
+      faces.resize(num_faces);
+    }
+  }
+
+  bool empty() const
+  {
+    return faces.empty();
   }
 };
 
@@ -67,6 +140,15 @@ class EdgeDice {
   size_t vert_offset;
   size_t tri_offset;
 
+  /* Cached evaluations of the face being diced, replayed or recorded by set_vert. */
+  DiceCache::Face *cache_face;
+  size_t cache_index;
+  bool cache_replay;
+
+  /* Verts on subpatch sides that were already set while setting sides. Sides are shared with
+   * neighboring subpatches, only the first evaluation of a vert is written. */
+  vector<bool> side_verts_set;
+
   explicit EdgeDice(const SubdParams &params);
 
   void reserve(int num_verts, int num_triangles);
@@ -95,7 +177,15 @@ class QuadDice : public EdgeDice {
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
-  void dice(Subpatch &sub);
+  void set_sides(Subpatch &sub);
+  void dice_inner(Subpatch &sub);
+
+  /* Set the verts on the sides of all subpatches of a face, using the cache when there is one.
+   * Done for all faces before dicing, as sides are shared. */
+  void set_face_sides(Subpatch *subpatches, int num_subpatches, DiceCache::Face *cache);
+  /* Add the inner grids of all subpatches of a face and stitch them to the sides. Only writes
+   * verts owned by the subpatches, so faces can be diced in parallel. */
+  void dice_face_inner(Subpatch *subpatches, int num_subpatches, DiceCache::Face *cache);
 };
 
 CCL_NAMESPACE_END
@@ -25,6 +25,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_math.h"
+#include "util/util_task.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -339,24 +340,62 @@ Edge *DiagSplit::alloc_edge()
 
 void DiagSplit::split_patches(Patch *patches, size_t patches_byte_stride)
 {
+  /* Faces are split in blocks with grain size to avoid too much threading overhead for small
+   * faces. Every patch allocates four verts, so the index of the first vert of each block is
+   * known before splitting. */
+  static const int FACES_PER_TASK = 64;
+
+  const int num_faces = params.mesh->subd_faces.size();
+  const int num_blocks = divide_up(num_faces, FACES_PER_TASK);
+
+  vector<int> block_patch_index(num_blocks);
   int patch_index = 0;
 
-  for (int f = 0; f < params.mesh->subd_faces.size(); f++) {
-    Mesh::SubdFace &face = params.mesh->subd_faces[f];
+  for (int f = 0; f < num_faces; f++) {
+    if (f % FACES_PER_TASK == 0) {
+      block_patch_index[f / FACES_PER_TASK] = patch_index;
+    }
 
-    Patch *patch = (Patch *)(((char *)patches) + patch_index * patches_byte_stride);
+    patch_index += params.mesh->subd_faces[f].num_ptex_faces();
+  }
 
-    if (face.is_quad()) {
-      patch_index++;
+  blocks.clear();
+  blocks.resize(num_blocks);
 
-      split_quad(face, patch);
-    }
-    else {
-      patch_index += face.num_corners;
+  parallel_for(blocked_range<size_t>(0, num_blocks), [&](const blocked_range<size_t> &r) {
+    for (size_t b = r.begin(); b != r.end(); b++) {
+      DiagSplit *block = new DiagSplit(params);
+      blocks[b].reset(block);
+
+      int block_patch = block_patch_index[b];
+
+      block->first_face = b * FACES_PER_TASK;
+      block->num_alloced_verts = 4 * block_patch;
+
+      const int end_face = min(block->first_face + FACES_PER_TASK, num_faces);
+
+      for (int f = block->first_face; f < end_face; f++) {
+        Mesh::SubdFace &face = params.mesh->subd_faces[f];
+
+        Patch *patch = (Patch *)(((char *)patches) + block_patch * patches_byte_stride);
 
-      split_ngon(face, patch, patches_byte_stride);
+        if (face.is_quad()) {
+          block_patch++;
+
+          block->split_quad(face, patch);
+        }
+        else {
+          block_patch += face.num_corners;
+
+          block->split_ngon(face, patch, patches_byte_stride);
+        }
+
+        block->face_subpatches_end.push_back(block->subpatches.size());
+      }
     }
-  }
+  });
+
+  num_alloced_verts = 4 * patch_index;
 
   params.mesh->vert_to_stitching_key_map.clear();
   params.mesh->vert_stitching_map.clear();
@@ -605,16 +644,23 @@ void DiagSplit::post_split()
 {
   int num_stitch_verts = 0;
 
-  /* All patches are now split, and all T values known. */
+  /* All patches are now split, and all T values known. Edges of all blocks in face order. */
+  vector<Edge *> split_edges;
+
+  foreach (const unique_ptr<DiagSplit> &block, blocks) {
+    foreach (Edge &edge, block->edges) {
+      split_edges.push_back(&edge);
+    }
+  }
 
-  foreach (Edge &edge, edges) {
-    if (edge.second_vert_index < 0) {
-      edge.second_vert_index = alloc_verts(edge.T - 1);
+  foreach (Edge *edge, split_edges) {
+    if (edge->second_vert_index < 0) {
+      edge->second_vert_index = alloc_verts(edge->T - 1);
     }
 
-    if (edge.is_stitch_edge) {
+    if (edge->is_stitch_edge) {
       num_stitch_verts = max(num_stitch_verts,
-                             max(edge.stitch_start_vert_index, edge.stitch_end_vert_index));
+                             max(edge->stitch_start_vert_index, edge->stitch_end_vert_index));
     }
   }
 
@@ -630,43 +676,45 @@ void DiagSplit::post_split()
   typedef unordered_map<pair<int, int>, int, pair_hasher> edge_stitch_verts_map_t;
   edge_stitch_verts_map_t edge_stitch_verts_map;
 
-  foreach (Edge &edge, edges) {
-    if (edge.is_stitch_edge) {
-      if (edge.stitch_edge_T == 0) {
-        edge.stitch_edge_T = edge.T;
+  foreach (Edge *edge, split_edges) {
+    if (edge->is_stitch_edge) {
+      if (edge->stitch_edge_T == 0) {
+        edge->stitch_edge_T = edge->T;
       }
 
-      if (edge_stitch_verts_map.find(edge.stitch_edge_key) == edge_stitch_verts_map.end()) {
-        edge_stitch_verts_map[edge.stitch_edge_key] = num_stitch_verts;
-        num_stitch_verts += edge.stitch_edge_T - 1;
+      if (edge_stitch_verts_map.find(edge->stitch_edge_key) == edge_stitch_verts_map.end()) {
+        edge_stitch_verts_map[edge->stitch_edge_key] = num_stitch_verts;
+        num_stitch_verts += edge->stitch_edge_T - 1;
       }
     }
   }
 
   /* Set start and end indices for edges generated from a split. */
-  foreach (Edge &edge, edges) {
-    if (edge.start_vert_index < 0) {
+  foreach (Edge *edge, split_edges) {
+    if (edge->start_vert_index < 0) {
       /* Fixup offsets. */
-      if (edge.top_indices_decrease) {
-        edge.top_offset = edge.top->T - edge.top_offset;
+      if (edge->top_indices_decrease) {
+        edge->top_offset = edge->top->T - edge->top_offset;
       }
 
-      edge.start_vert_index = edge.top->get_vert_along_edge(edge.top_offset);
+      edge->start_vert_index = edge->top->get_vert_along_edge(edge->top_offset);
     }
 
-    if (edge.end_vert_index < 0) {
-      if (edge.bottom_indices_decrease) {
-        edge.bottom_offset = edge.bottom->T - edge.bottom_offset;
+    if (edge->end_vert_index < 0) {
+      if (edge->bottom_indices_decrease) {
+        edge->bottom_offset = edge->bottom->T - edge->bottom_offset;
       }
 
-      edge.end_vert_index = edge.bottom->get_vert_along_edge(edge.bottom_offset);
+      edge->end_vert_index = edge->bottom->get_vert_along_edge(edge->bottom_offset);
     }
   }
 
   int vert_offset = params.mesh->verts.size();
 
   /* Add verts to stitching map. */
-  foreach (const Edge &edge, edges) {
+  foreach (const Edge *edge_ptr, split_edges) {
+    const Edge &edge = *edge_ptr;
+
     if (edge.is_stitch_edge) {
       int second_stitch_vert_index = edge_stitch_verts_map[edge.stitch_edge_key];
 
@@ -720,29 +768,68 @@ void DiagSplit::post_split()
 
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
+  vector<size_t> block_tri_offset(blocks.size());
+
+  for (size_t b = 0; b < blocks.size(); b++) {
+    block_tri_offset[b] = num_triangles;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
+    foreach (Subpatch &sub, blocks[b]->subpatches) {
+      sub.edge_u0.T = max(sub.edge_u0.T, 1);
+      sub.edge_u1.T = max(sub.edge_u1.T, 1);
+      sub.edge_v0.T = max(sub.edge_v0.T, 1);
+      sub.edge_v1.T = max(sub.edge_v1.T, 1);
+
+      sub.inner_grid_vert_offset = num_verts;
+      num_verts += sub.calc_num_inner_verts();
+      num_triangles += sub.calc_num_triangles();
+    }
   }
 
   dice.reserve(num_verts, num_triangles);
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    Subpatch &sub = subpatches[i];
+  /* Verts on the sides of subpatches are shared with neighboring subpatches, which may be diced
+   * by another block. Set all of them first, serially and in face order so the first evaluation
+   * of each vert is kept deterministically. Dicing the blocks in parallel then only writes the
+   * inner grid verts owned by each subpatch, and reads the sides to stitch to. */
+  dice.side_verts_set.resize(num_verts, false);
+  foreach (const unique_ptr<DiagSplit> &block, blocks) {
+    block->dice_block(dice, true);
+  }
+  vector<bool>().swap(dice.side_verts_set);
 
-    sub.edge_u0.T = max(sub.edge_u0.T, 1);
-    sub.edge_u1.T = max(sub.edge_u1.T, 1);
-    sub.edge_v0.T = max(sub.edge_v0.T, 1);
-    sub.edge_v1.T = max(sub.edge_v1.T, 1);
+  parallel_for(blocked_range<size_t>(0, blocks.size()), [&](const blocked_range<size_t> &r) {
+    for (size_t b = r.begin(); b != r.end(); b++) {
+      QuadDice block_dice(dice);
+      block_dice.tri_offset = dice.tri_offset + block_tri_offset[b];
+      blocks[b]->dice_block(block_dice, false);
+    }
+  });
 
-    dice.dice(sub);
+  /* Cleanup */
+  blocks.clear();
+}
+
+void DiagSplit::dice_block(QuadDice &dice, bool sides)
+{
+  DiceCache *cache = params.mesh->subd_dice_cache;
+  if (!params.use_cache || (cache && cache->empty())) {
+    cache = NULL;
   }
 
-  /* Cleanup */
-  subpatches.clear();
-  edges.clear();
+  size_t begin = 0;
+
+  for (size_t i = 0; i < face_subpatches_end.size(); i++) {
+    const size_t end = face_subpatches_end[i];
+    DiceCache::Face *cache_face = (cache) ? &cache->faces[first_face + i] : NULL;
+
+    if (sides) {
+      dice.set_face_sides(subpatches.data() + begin, end - begin, cache_face);
+    }
+    else {
+      dice.dice_face_inner(subpatches.data() + begin, end - begin, cache_face);
+    }
+    begin = end;
+  }
 }
 
 CCL_NAMESPACE_END
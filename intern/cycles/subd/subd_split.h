@@ -27,6 +27,7 @@
 
 #include "util/util_deque.h"
 #include "util/util_types.h"
+#include "util/util_unique_ptr.h"
 #include "util/util_vector.h"
 
 #include <deque>
@@ -57,6 +58,16 @@ class DiagSplit {
   int num_alloced_verts = 0;
   int alloc_verts(int n); /* Returns start index of new verts. */
 
+  /* Faces are split in parallel, each range of faces by its own DiagSplit. Merged in order
+   * their subpatches and edges are the same as when splitting all faces serially. */
+  vector<unique_ptr<DiagSplit>> blocks;
+  /* First face split by this block, and the end of the subpatches of each face. */
+  int first_face = 0;
+  vector<size_t> face_subpatches_end;
+
+  /* Set the sides of, or dice, the faces of this block. */
+  void dice_block(QuadDice &dice, bool sides);
+
  public:
   Edge *alloc_edge();
 
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh.h"
+#include "bvh/bvh_params.h"
+
+#include "render/mesh.h"
+#include "render/object.h"
+
+#include "util/util_progress.h"
+#include "util/util_unique_ptr.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Flat grid of quads in the XY plane. */
+void make_grid_mesh(Mesh *mesh, int resolution)
+{
+  for (int y = 0; y <= resolution; y++) {
+    for (int x = 0; x <= resolution; x++) {
+      mesh->add_vertex(make_float3(x, y, 0.0f));
+    }
+  }
+
+  for (int y = 0; y < resolution; y++) {
+    for (int x = 0; x < resolution; x++) {
+      const int v0 = y * (resolution + 1) + x;
+      const int v1 = v0 + 1;
+      const int v2 = v0 + resolution + 1;
+      const int v3 = v2 + 1;
+      mesh->add_triangle(v0, v1, v3, 0, false);
+      mesh->add_triangle(v0, v3, v2, 0, false);
+    }
+  }
+}
+
+BVH *build_bvh(const vector<Geometry *> &geometry, const vector<Object *> &objects)
+{
+  BVHParams params;
+  params.bvh_layout = BVH_LAYOUT_BVH2;
+
+  Progress progress;
+  BVH *bvh = BVH::create(params, geometry, objects);
+  bvh->build(progress);
+  return bvh;
+}
+
+/* Bounds of the root node, stored as the bounds of its two children. */
+BoundBox bvh_root_bounds(const BVH *bvh)
+{
+  const PackedBVH &pack = bvh->pack;
+  EXPECT_NE(pack.root_index, -1);
+
+  const int4 x = pack.nodes[pack.root_index + 1];
+  const int4 y = pack.nodes[pack.root_index + 2];
+  const int4 z = pack.nodes[pack.root_index + 3];
+
+  BoundBox bounds = BoundBox::empty;
+  for (int child = 0; child < 2; child++) {
+    bounds.grow(make_float3(__int_as_float(x[child]),
+                            __int_as_float(y[child]),
+                            __int_as_float(z[child])));
+    bounds.grow(make_float3(__int_as_float(x[child + 2]),
+                            __int_as_float(y[child + 2]),
+                            __int_as_float(z[child + 2])));
+  }
+  return bounds;
+}
+
+void expect_bounds_eq(const BoundBox &a, const BoundBox &b)
+{
+  EXPECT_FLOAT_EQ(a.min.x, b.min.x);
+  EXPECT_FLOAT_EQ(a.min.y, b.min.y);
+  EXPECT_FLOAT_EQ(a.min.z, b.min.z);
+  EXPECT_FLOAT_EQ(a.max.x, b.max.x);
+  EXPECT_FLOAT_EQ(a.max.y, b.max.y);
+  EXPECT_FLOAT_EQ(a.max.z, b.max.z);
+}
+
+}  // namespace
+
+TEST(bvh_refit, moved_vertex)
+{
+  Mesh mesh;
+  make_grid_mesh(&mesh, 16);
+
+  Object object;
+  object.geometry = &mesh;
+
+  vector<Geometry *> geometry(1, &mesh);
+  vector<Object *> objects(1, &object);
+
+  unique_ptr<BVH> bvh(build_bvh(geometry, objects));
+
+  /* Without changes, refitting keeps the bounds and cost. */
+  const BoundBox built_bounds = bvh_root_bounds(bvh.get());
+  Progress progress;
+  bvh->refit(progress);
+  expect_bounds_eq(bvh_root_bounds(bvh.get()), built_bounds);
+  EXPECT_NEAR(bvh->refit_sah_cost, bvh->build_sah_cost, 1e-3f * bvh->build_sah_cost);
+
+  /* Lift a vertex in the middle of the grid, and lower a corner. */
+  mesh.verts[8 * 17 + 8].z = 3.0f;
+  mesh.verts[0].z = -1.0f;
+  bvh->refit(progress);
+
+  unique_ptr<BVH> rebuilt_bvh(build_bvh(geometry, objects));
+  const BoundBox refit_bounds = bvh_root_bounds(bvh.get());
+
+  expect_bounds_eq(refit_bounds, bvh_root_bounds(rebuilt_bvh.get()));
+  EXPECT_FLOAT_EQ(refit_bounds.max.z, 3.0f);
+  EXPECT_FLOAT_EQ(refit_bounds.min.z, -1.0f);
+
+  /* Packed vertices of the lifted triangles are updated as well. */
+  bool found_lifted_vertex = false;
+  for (size_t i = 0; i < bvh->pack.prim_tri_verts.size(); i++) {
+    if (bvh->pack.prim_tri_verts[i].z == 3.0f) {
+      found_lifted_vertex = true;
+    }
+  }
+  EXPECT_TRUE(found_lifted_vertex);
+  EXPECT_GE(bvh->refit_sah_cost, bvh->build_sah_cost);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+// clang-format off
+#include "kernel/kernel_compat_cpu.h"
+#include "kernel/kernel_math.h"
+#include "kernel/kernel_types.h"
+#include "kernel/split/kernel_split_data.h"
+#include "kernel/kernel_globals.h"
+// clang-format on
+
+#ifdef __BVH_PACKET__
+
+#  include "kernel/kernel_path_packet.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Primitives in BVH order, with the primitive index they map to. The BVH order differs from the
+ * primitive order, so looking up the shader by primitive address gives wrong results. */
+const uint prim_index[] = {3, 0, 2, 1, 0};
+const uint tri_shader[] = {5, 2, 7, (uint)(1 | SHADER_SMOOTH_NORMAL)};
+/* Curve 0 uses shader 4. */
+const float4 curves[] = {make_float4(0.0f, 0.0f, __int_as_float(4), 0.0f)};
+
+Intersection make_isect(int prim, int object, int type)
+{
+  Intersection isect;
+  isect.t = 1.0f;
+  isect.u = 0.0f;
+  isect.v = 0.0f;
+  isect.prim = prim;
+  isect.object = object;
+  isect.type = type;
+  return isect;
+}
+
+}  // namespace
+
+TEST(kernel_path_packet, sort_by_shader)
+{
+  KernelGlobals kg_storage;
+  KernelGlobals *kg = &kg_storage;
+  kg->__prim_index.data = (uint *)prim_index;
+  kg->__prim_index.width = sizeof(prim_index) / sizeof(*prim_index);
+  kg->__tri_shader.data = (uint *)tri_shader;
+  kg->__tri_shader.width = sizeof(tri_shader) / sizeof(*tri_shader);
+  kg->__curves.data = (float4 *)curves;
+  kg->__curves.width = sizeof(curves) / sizeof(*curves);
+
+  Intersection isects[BVH_PACKET_SIZE];
+  /* Path 0 hits prim index 3 with shader 1, the smooth normal flag is not part of the key. */
+  isects[0] = make_isect(0, OBJECT_NONE, PRIMITIVE_TRIANGLE);
+  /* Path 1 misses. */
+  isects[1] = make_isect(PRIM_NONE, OBJECT_NONE, PRIMITIVE_NONE);
+  /* Path 2 hits prim index 2 with shader 7 through an instance. */
+  isects[2] = make_isect(2, 1, PRIMITIVE_TRIANGLE);
+  /* Path 3 hits prim index 0 with shader 5. */
+  isects[3] = make_isect(1, OBJECT_NONE, PRIMITIVE_TRIANGLE);
+  /* Path 4 is not part of the packet. */
+  isects[4] = make_isect(0, OBJECT_NONE, PRIMITIVE_TRIANGLE);
+  /* Path 5 hits prim index 1 with shader 2. */
+  isects[5] = make_isect(3, OBJECT_NONE, PRIMITIVE_TRIANGLE);
+  /* Path 6 is not active. */
+  isects[6] = make_isect(0, OBJECT_NONE, PRIMITIVE_TRIANGLE);
+  /* Path 7 hits prim index 0 with shader 5 through a motion triangle. */
+  isects[7] = make_isect(4, OBJECT_NONE, PRIMITIVE_MOTION_TRIANGLE);
+  /* Path 8 hits curve 0 with shader 4. */
+  isects[8] = make_isect(4, OBJECT_NONE, PRIMITIVE_CURVE_THICK);
+  /* Path 9 hits prim index 3 with shader 1. */
+  isects[9] = make_isect(0, OBJECT_NONE, PRIMITIVE_TRIANGLE);
+
+  const uint active_mask = 0x3bf;
+  const uint packet_mask = 0x3af;
+
+  int order[BVH_PACKET_SIZE];
+  const int num_paths = kernel_path_packet_sort_by_shader(
+      kg, isects, active_mask, packet_mask, order);
+
+  /* Paths with the same shader keep their order, misses and paths outside of the packet last. */
+  const int expected[] = {0, 9, 5, 8, 3, 7, 2, 1, 4};
+  ASSERT_EQ(num_paths, sizeof(expected) / sizeof(*expected));
+  for (int i = 0; i < num_paths; i++) {
+    EXPECT_EQ(order[i], expected[i]) << "at " << i;
+  }
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __BVH_PACKET__ */
@@ -20,8 +20,11 @@
 #include "device/device.h"
 
 #include "render/graph.h"
+#include "render/integrator.h"
 #include "render/nodes.h"
 #include "render/scene.h"
+#include "render/shader.h"
+#include "render/svm.h"
 
 #include "util/util_array.h"
 #include "util/util_logging.h"
@@ -1532,4 +1535,190 @@ TEST_F(RenderGraph, constant_fold_convert_color_float_color)
   graph.finalize(scene);
 }
 
+/*
+ * Tests: Math multiply followed by add with a constant, merged into multiply add.
+ */
+TEST_F(RenderGraph, constant_fold_math_multiply_add)
+{
+  EXPECT_ANY_MESSAGE(log);
+  CORRECT_INFO_MESSAGE(log, "Folding MathMul and MathAdd to multiply add.");
+
+  builder.add_attribute("Attribute")
+      .add_node(ShaderNodeBuilder<MathNode>("MathMul")
+                    .set(&MathNode::type, NODE_MATH_MULTIPLY)
+                    .set("Value2", 2.0f))
+      .add_connection("Attribute::Fac", "MathMul::Value1")
+      .add_node(ShaderNodeBuilder<MathNode>("MathAdd")
+                    .set(&MathNode::type, NODE_MATH_ADD)
+                    .set("Value1", 0.5f))
+      .add_connection("MathMul::Value", "MathAdd::Value2")
+      .output_value("MathAdd::Value");
+
+  graph.finalize(scene);
+}
+
+/*
+ * Tests: constants of consecutive Math add nodes are combined.
+ */
+TEST_F(RenderGraph, constant_fold_math_add_chain)
+{
+  EXPECT_ANY_MESSAGE(log);
+  CORRECT_INFO_MESSAGE(log, "Folding constants of MathAdd1 into MathAdd2.");
+
+  builder.add_attribute("Attribute")
+      .add_node(ShaderNodeBuilder<MathNode>("MathAdd1")
+                    .set(&MathNode::type, NODE_MATH_ADD)
+                    .set("Value2", 1.0f))
+      .add_connection("Attribute::Fac", "MathAdd1::Value1")
+      .add_node(ShaderNodeBuilder<MathNode>("MathAdd2")
+                    .set(&MathNode::type, NODE_MATH_ADD)
+                    .set("Value2", 2.0f))
+      .add_connection("MathAdd1::Value", "MathAdd2::Value1")
+      .output_value("MathAdd2::Value");
+
+  graph.finalize(scene);
+}
+
+/*
+ * Tests: Math nodes are not merged when the first result is used elsewhere.
+ */
+TEST_F(RenderGraph, constant_fold_math_chain_shared)
+{
+  EXPECT_ANY_MESSAGE(log);
+  INVALID_INFO_MESSAGE(log, "to multiply add");
+
+  builder.add_attribute("Attribute")
+      .add_node(ShaderNodeBuilder<MathNode>("MathMul")
+                    .set(&MathNode::type, NODE_MATH_MULTIPLY)
+                    .set("Value2", 2.0f))
+      .add_connection("Attribute::Fac", "MathMul::Value1")
+      .add_node(ShaderNodeBuilder<MathNode>("MathAdd")
+                    .set(&MathNode::type, NODE_MATH_ADD)
+                    .set("Value2", 0.5f))
+      .add_connection("MathMul::Value", "MathAdd::Value1")
+      .add_node(ShaderNodeBuilder<MathNode>("MathSum").set(&MathNode::type, NODE_MATH_ADD))
+      .add_connection("MathMul::Value", "MathSum::Value1")
+      .add_connection("MathAdd::Value", "MathSum::Value2")
+      .output_value("MathSum::Value");
+
+  graph.finalize(scene);
+}
+
+/*
+ * Tests: Map Range with all constant inputs.
+ */
+TEST_F(RenderGraph, constant_fold_map_range)
+{
+  EXPECT_ANY_MESSAGE(log);
+  CORRECT_INFO_MESSAGE(log, "Folding MapRange::Result to constant (2.5).");
+
+  builder
+      .add_node(ShaderNodeBuilder<MapRangeNode>("MapRange")
+                    .set(&MapRangeNode::type, NODE_MAP_RANGE_LINEAR)
+                    .set(&MapRangeNode::clamp, false)
+                    .set("Value", 0.25f)
+                    .set("To Min", 2.0f)
+                    .set("To Max", 4.0f))
+      .output_value("MapRange::Result");
+
+  graph.finalize(scene);
+}
+
+/*
+ * Tests: Mapping with constant parameters is merged into the texture mapping of the texture
+ * node using it.
+ */
+TEST_F(RenderGraph, constant_fold_mapping_texture)
+{
+  EXPECT_ANY_MESSAGE(log);
+  CORRECT_INFO_MESSAGE(log, "Folding Mapping into texture mapping of Noise.");
+
+  builder.add_attribute("Attribute")
+      .add_node(ShaderNodeBuilder<MappingNode>("Mapping")
+                    .set(&MappingNode::type, NODE_MAPPING_TYPE_POINT)
+                    .set("Location", make_float3(1.0f, 2.0f, 3.0f))
+                    .set("Scale", make_float3(2.0f, 2.0f, 2.0f)))
+      .add_connection("Attribute::Vector", "Mapping::Vector")
+      .add_node(ShaderNodeBuilder<NoiseTextureNode>("Noise"))
+      .add_connection("Mapping::Vector", "Noise::Vector")
+      .output_color("Noise::Color");
+
+  graph.finalize(scene);
+
+  NoiseTextureNode *noise = (NoiseTextureNode *)builder.find_node("Noise");
+  EXPECT_TRUE(noise->tex_mapping.use_input_transform);
+  EXPECT_FALSE(noise->tex_mapping.skip());
+
+  const float3 P = transform_point(&noise->tex_mapping.input_transform,
+                                   make_float3(1.0f, 1.0f, 1.0f));
+  EXPECT_NEAR(P.x, 3.0f, 1e-5f);
+  EXPECT_NEAR(P.y, 4.0f, 1e-5f);
+  EXPECT_NEAR(P.z, 5.0f, 1e-5f);
+}
+
+/*
+ * Tests: Mapping with normal type is not merged into the texture mapping.
+ */
+TEST_F(RenderGraph, constant_fold_mapping_texture_normal)
+{
+  EXPECT_ANY_MESSAGE(log);
+  INVALID_INFO_MESSAGE(log, "into texture mapping");
+
+  builder.add_attribute("Attribute")
+      .add_node(ShaderNodeBuilder<MappingNode>("Mapping")
+                    .set(&MappingNode::type, NODE_MAPPING_TYPE_NORMAL)
+                    .set("Rotation", make_float3(0.5f, 0.0f, 0.0f)))
+      .add_connection("Attribute::Vector", "Mapping::Vector")
+      .add_node(ShaderNodeBuilder<NoiseTextureNode>("Noise"))
+      .add_connection("Mapping::Vector", "Noise::Vector")
+      .output_color("Noise::Color");
+
+  graph.finalize(scene);
+}
+
+/*
+ * Tests: SVM nodes of a shader depending on integrator settings are compiled again when the
+ * settings change.
+ */
+TEST_F(RenderGraph, svm_cache_integrator_dependency)
+{
+  EXPECT_ANY_MESSAGE(log);
+
+  ShaderGraph *shader_graph = new ShaderGraph();
+  ShaderGraphBuilder shader_builder(shader_graph);
+  shader_builder
+      .add_node(ShaderNodeBuilder<GlossyBsdfNode>("Glossy")
+                    .set(&GlossyBsdfNode::distribution, CLOSURE_BSDF_REFLECTION_ID))
+      .output_closure("Glossy::BSDF");
+  GlossyBsdfNode *glossy = (GlossyBsdfNode *)shader_builder.find_node("Glossy");
+
+  Shader *shader = new Shader();
+  shader->set_graph(shader_graph);
+  scene->shaders.push_back(shader);
+
+  scene->integrator->filter_glossy = 0.0f;
+
+  array<int4> svm_nodes;
+  svm_nodes.push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+  SVMCompiler compiler(scene);
+  compiler.compile(shader, svm_nodes, 0);
+  EXPECT_TRUE(shader->has_integrator_dependency);
+  EXPECT_EQ(glossy->distribution, CLOSURE_BSDF_REFLECTION_ID);
+
+  SVMShaderCache cache(scene, shader, false);
+  EXPECT_TRUE(cache.matches(scene, shader, false));
+
+  /* Filter glossy replaces the sharp distribution with GGX. */
+  scene->integrator->filter_glossy = 1.0f;
+  EXPECT_FALSE(cache.matches(scene, shader, false));
+
+  svm_nodes.clear();
+  svm_nodes.push_back_slow(make_int4(NODE_SHADER_JUMP, 0, 0, 0));
+  compiler.compile(shader, svm_nodes, 0);
+  EXPECT_EQ(glossy->distribution, CLOSURE_BSDF_MICROFACET_GGX_ID);
+
+  SVMShaderCache filter_cache(scene, shader, false);
+  EXPECT_TRUE(filter_cache.matches(scene, shader, false));
+}
+
 CCL_NAMESPACE_END
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/light_tree.h"
+
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+LightTreePrimitive make_point_prim(int lamp, float3 co, float energy)
+{
+  LightTreePrimitive prim;
+  prim.lamp = lamp;
+  prim.bbox.grow(co);
+  prim.cone = LightTreeCone();
+  prim.energy = energy;
+  return prim;
+}
+
+}  // namespace
+
+TEST(render_light_tree, cone_merge_contained)
+{
+  const LightTreeCone a(make_float3(0.0f, 0.0f, 1.0f), 0.5f, M_PI_2_F);
+  const LightTreeCone b(make_float3(0.0f, 0.0f, 1.0f), 0.1f, 0.2f);
+  const LightTreeCone cone = LightTreeCone::merge(a, b);
+
+  EXPECT_NEAR(cone.axis.z, 1.0f, 1e-6f);
+  EXPECT_NEAR(cone.theta_o, 0.5f, 1e-6f);
+  EXPECT_NEAR(cone.theta_e, M_PI_2_F, 1e-6f);
+}
+
+TEST(render_light_tree, cone_merge_orthogonal)
+{
+  const LightTreeCone a(make_float3(1.0f, 0.0f, 0.0f), 0.0f, M_PI_2_F);
+  const LightTreeCone b(make_float3(0.0f, 1.0f, 0.0f), 0.0f, M_PI_2_F);
+  const LightTreeCone cone = LightTreeCone::merge(a, b);
+
+  /* The merged axis lies halfway between both, and both axes are within theta_o. */
+  EXPECT_NEAR(cone.theta_o, M_PI_4_F, 1e-5f);
+  EXPECT_NEAR(cone.axis.x, sqrtf(0.5f), 1e-5f);
+  EXPECT_NEAR(cone.axis.y, sqrtf(0.5f), 1e-5f);
+  EXPECT_NEAR(cone.axis.z, 0.0f, 1e-5f);
+}
+
+TEST(render_light_tree, cone_merge_opposite)
+{
+  const LightTreeCone a(make_float3(0.0f, 0.0f, 1.0f), 0.0f, M_PI_2_F);
+  const LightTreeCone b(make_float3(0.0f, 0.0f, -1.0f), 0.0f, M_PI_2_F);
+  const LightTreeCone cone = LightTreeCone::merge(a, b);
+
+  EXPECT_NEAR(cone.theta_o, M_PI_F, 1e-6f);
+}
+
+TEST(render_light_tree, empty)
+{
+  vector<LightTreePrimitive> prims;
+  LightTree tree(prims, 3);
+
+  EXPECT_EQ(tree.get_nodes().size(), 0);
+  EXPECT_EQ(tree.get_leaf_nodes().size(), 3);
+  EXPECT_EQ(tree.get_leaf_nodes()[0], -1);
+}
+
+TEST(render_light_tree, structure)
+{
+  /* Grid of lamps, with a few lamp indices left out as if they were distant lights. */
+  vector<LightTreePrimitive> prims;
+  const int num_lamps = 100;
+  float total_energy = 0.0f;
+  for (int i = 0; i < num_lamps; i++) {
+    if (i % 10 == 3) {
+      continue;
+    }
+    const float energy = 1.0f + (i % 7);
+    prims.push_back(make_point_prim(i, make_float3(i % 10, i / 10, 0.0f), energy));
+    total_energy += energy;
+  }
+
+  LightTree tree(prims, num_lamps);
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+  const vector<int> &leaf_nodes = tree.get_leaf_nodes();
+
+  ASSERT_EQ(nodes.size(), 2 * prims.size() - 1);
+  EXPECT_EQ(tree.num_lamps(), prims.size());
+  EXPECT_EQ(nodes[0].parent, -1);
+  EXPECT_NEAR(nodes[0].energy, total_energy, 1e-3f);
+  EXPECT_EQ(nodes[0].bbox_min[0], 0.0f);
+  EXPECT_EQ(nodes[0].bbox_max[0], 9.0f);
+  EXPECT_EQ(nodes[0].bbox_max[1], 9.0f);
+
+  for (int lamp = 0; lamp < num_lamps; lamp++) {
+    if (lamp % 10 == 3) {
+      EXPECT_EQ(leaf_nodes[lamp], -1);
+      continue;
+    }
+
+    /* Every lamp has its own leaf, reachable from the root. */
+    int index = leaf_nodes[lamp];
+    ASSERT_GE(index, 0);
+    EXPECT_EQ(nodes[index].lamp, lamp);
+    EXPECT_EQ(nodes[index].child[0], -1);
+
+    int depth = 0;
+    while (index != 0) {
+      const KernelLightTreeNode &parent = nodes[nodes[index].parent];
+      EXPECT_TRUE(parent.child[0] == index || parent.child[1] == index);
+      EXPECT_EQ(parent.lamp, -1);
+      index = nodes[index].parent;
+      depth++;
+    }
+
+    /* Median splits keep the tree balanced. */
+    EXPECT_LE(depth, 7);
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (nodes[i].lamp >= 0) {
+      continue;
+    }
+
+    const KernelLightTreeNode &left = nodes[nodes[i].child[0]];
+    const KernelLightTreeNode &right = nodes[nodes[i].child[1]];
+    EXPECT_NEAR(nodes[i].energy, left.energy + right.energy, 1e-3f);
+    for (int j = 0; j < 3; j++) {
+      EXPECT_LE(nodes[i].bbox_min[j], min(left.bbox_min[j], right.bbox_min[j]));
+      EXPECT_GE(nodes[i].bbox_max[j], max(left.bbox_max[j], right.bbox_max[j]));
+    }
+  }
+}
+
+CCL_NAMESPACE_END
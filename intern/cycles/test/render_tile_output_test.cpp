@@ -0,0 +1,128 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/film.h"
+#include "render/tile_output.h"
+
+#include "util/util_image.h"
+#include "util/util_path.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+const int width = 37;
+const int height = 29;
+const int num_channels = 5;
+
+/* Value of a channel of a pixel in render buffer coordinates. */
+float pixel_value(int x, int y, int c)
+{
+  return x + y * 100.0f + c * 0.25f;
+}
+
+void write_region(TileOutput &output, int x, int y, int w, int h)
+{
+  vector<float> pixels((size_t)w * h * num_channels);
+  for (int j = 0; j < h; j++) {
+    for (int i = 0; i < w; i++) {
+      for (int c = 0; c < num_channels; c++) {
+        pixels[((size_t)j * w + i) * num_channels + c] = pixel_value(x + i, y + j, c);
+      }
+    }
+  }
+  output.write_pixels(x, y, w, h, pixels.data());
+}
+
+}  // namespace
+
+TEST(render_tile_output, write_read)
+{
+  const string filepath = path_join(testing::TempDir(), "cycles_tile_output_test.exr");
+
+  BufferParams params;
+  params.width = width;
+  params.height = height;
+  params.full_width = width;
+  params.full_height = height;
+  Pass::add(PASS_COMBINED, params.passes, "Combined");
+  Pass::add(PASS_DEPTH, params.passes, "Depth");
+
+  {
+    TileOutput output(filepath, params, make_int2(8, 8), "RenderLayer");
+
+    /* Render tiles aligned with the top of the image, finished from top to bottom. The first
+     * row is partial, and one tile is written in two halves. */
+    const int offset_y = 8 - height % 8;
+    for (int tile_y = 3; tile_y >= 0; tile_y--) {
+      const int y = max(tile_y * 8 - offset_y, 0);
+      const int h = tile_y * 8 - offset_y + 8 - y;
+      for (int x = 0; x < width; x += 8) {
+        const int w = min(8, width - x);
+        if (tile_y == 2 && x == 8) {
+          write_region(output, x, y, w, 3);
+          write_region(output, x, y + 3, w, h - 3);
+        }
+        else {
+          write_region(output, x, y, w, h);
+        }
+      }
+    }
+  }
+
+  unique_ptr<ImageInput> in(ImageInput::open(filepath));
+  ASSERT_TRUE(in);
+
+  const ImageSpec &spec = in->spec();
+  EXPECT_EQ(spec.width, width);
+  EXPECT_EQ(spec.height, height);
+  EXPECT_EQ(spec.tile_width, 8);
+  EXPECT_EQ(spec.tile_height, 8);
+  ASSERT_EQ(spec.nchannels, num_channels);
+
+  /* OpenEXR sorts channels by name. */
+  vector<string> channel_names(spec.channelnames.begin(), spec.channelnames.end());
+  std::sort(channel_names.begin(), channel_names.end());
+  EXPECT_EQ(channel_names[0], "RenderLayer.Combined.A");
+  EXPECT_EQ(channel_names[1], "RenderLayer.Combined.B");
+  EXPECT_EQ(channel_names[4], "RenderLayer.Depth.X");
+
+  vector<float> pixels((size_t)width * height * num_channels);
+  ASSERT_TRUE(in->read_image(TypeDesc::FLOAT, pixels.data()));
+  in->close();
+
+  /* Rows in the file go top to bottom. */
+  for (int c = 0; c < num_channels; c++) {
+    const string &name = spec.channelnames[c];
+    const int channel = (name == "RenderLayer.Combined.R") ? 0 :
+                        (name == "RenderLayer.Combined.G") ? 1 :
+                        (name == "RenderLayer.Combined.B") ? 2 :
+                        (name == "RenderLayer.Combined.A") ? 3 :
+                                                             4;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        const float value = pixels[((size_t)(height - 1 - y) * width + x) * num_channels + c];
+        ASSERT_EQ(value, pixel_value(x, y, channel)) << name << " " << x << " " << y;
+      }
+    }
+  }
+
+  path_remove(filepath);
+}
+
+CCL_NAMESPACE_END
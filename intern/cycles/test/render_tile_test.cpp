@@ -0,0 +1,154 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/tile.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+BufferParams make_buffer_params(int width, int height)
+{
+  BufferParams params;
+  params.width = width;
+  params.height = height;
+  params.full_x = 0;
+  params.full_y = 0;
+  params.full_width = width;
+  params.full_height = height;
+  return params;
+}
+
+/* Acquires and finishes all tiles of the pass, counting how often each pixel was rendered. */
+vector<int> render_pass(TileManager &tile_manager, int width, int height, int *num_tiles)
+{
+  vector<int> pixels(width * height, 0);
+  *num_tiles = 0;
+
+  Tile *tile;
+  while (tile_manager.next_tile(tile, 0, RenderTile::PATH_TRACE)) {
+    for (int y = tile->y; y < tile->y + tile->h; y++) {
+      for (int x = tile->x; x < tile->x + tile->w; x++) {
+        pixels[y * width + x]++;
+      }
+    }
+    (*num_tiles)++;
+
+    bool delete_tile;
+    tile_manager.finish_tile(tile->index, false, delete_tile);
+  }
+
+  return pixels;
+}
+
+}  // namespace
+
+TEST(render_tile, no_split)
+{
+  TileManager tile_manager(
+      false, 1, make_int2(64, 64), INT_MAX, false, true, TILE_BOTTOM_TO_TOP, 1, 1);
+  BufferParams params = make_buffer_params(256, 128);
+  tile_manager.reset(params, 1);
+  ASSERT_TRUE(tile_manager.next());
+
+  int num_tiles;
+  const vector<int> pixels = render_pass(tile_manager, 256, 128, &num_tiles);
+
+  EXPECT_EQ(num_tiles, 8);
+  EXPECT_EQ(tile_manager.state.num_tiles, 8);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    EXPECT_EQ(pixels[i], 1);
+  }
+  EXPECT_FALSE(tile_manager.has_tiles());
+}
+
+TEST(render_tile, split_for_workers)
+{
+  TileManager tile_manager(
+      false, 1, make_int2(64, 64), INT_MAX, false, true, TILE_BOTTOM_TO_TOP, 1, 1);
+  tile_manager.num_workers = 4;
+  BufferParams params = make_buffer_params(256, 128);
+  tile_manager.reset(params, 1);
+  ASSERT_TRUE(tile_manager.next());
+
+  int num_tiles;
+  const vector<int> pixels = render_pass(tile_manager, 256, 128, &num_tiles);
+
+  /* The last tiles are split, and together the tiles still cover every pixel exactly once. */
+  EXPECT_GT(num_tiles, 8);
+  EXPECT_EQ(tile_manager.state.num_tiles, num_tiles);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    EXPECT_EQ(pixels[i], 1);
+  }
+  EXPECT_FALSE(tile_manager.has_tiles());
+}
+
+TEST(render_tile, no_split_with_denoising)
+{
+  TileManager tile_manager(
+      false, 1, make_int2(64, 64), INT_MAX, false, true, TILE_BOTTOM_TO_TOP, 1, 1);
+  tile_manager.num_workers = 4;
+  tile_manager.schedule_denoising = true;
+  BufferParams params = make_buffer_params(256, 128);
+  tile_manager.reset(params, 1);
+  ASSERT_TRUE(tile_manager.next());
+
+  /* Denoising needs the regular tile grid to find neighbors. */
+  int num_tiles = 0;
+  Tile *tile;
+  while (tile_manager.next_tile(tile, 0, RenderTile::PATH_TRACE)) {
+    num_tiles++;
+  }
+  EXPECT_EQ(num_tiles, 8);
+}
+
+TEST(render_tile, align_top)
+{
+  TileManager tile_manager(
+      false, 1, make_int2(64, 64), INT_MAX, false, true, TILE_HILBERT_SPIRAL, 1, 1);
+  tile_manager.align_top = true;
+  BufferParams params = make_buffer_params(200, 150);
+  tile_manager.reset(params, 1);
+  ASSERT_TRUE(tile_manager.next());
+
+  /* Tile rows end at a multiple of the tile size from the top, the partial row is at the
+   * bottom. */
+  Tile *tile;
+  int num_tiles = 0;
+  vector<int> pixels(200 * 150, 0);
+  while (tile_manager.next_tile(tile, 0, RenderTile::PATH_TRACE)) {
+    EXPECT_EQ((150 - (tile->y + tile->h)) % 64, 0);
+    EXPECT_EQ(tile->x % 64, 0);
+    for (int y = tile->y; y < tile->y + tile->h; y++) {
+      for (int x = tile->x; x < tile->x + tile->w; x++) {
+        pixels[y * 200 + x]++;
+      }
+    }
+    num_tiles++;
+
+    bool delete_tile;
+    tile_manager.finish_tile(tile->index, false, delete_tile);
+  }
+
+  EXPECT_EQ(num_tiles, 12);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    EXPECT_EQ(pixels[i], 1);
+  }
+}
+
+CCL_NAMESPACE_END
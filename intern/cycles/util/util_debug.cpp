@@ -32,7 +32,9 @@ DebugFlags::CPU::CPU()
       sse3(true),
       sse2(true),
       bvh_layout(BVH_LAYOUT_AUTO),
-      split_kernel(false)
+      split_kernel(false),
+      packet_tracing(false),
+      numa_replication(false)
 {
   reset();
 }
@@ -60,6 +62,10 @@ void DebugFlags::CPU::reset()
   bvh_layout = BVH_LAYOUT_AUTO;
 
   split_kernel = false;
+
+  packet_tracing = (getenv("CYCLES_CPU_PACKET_TRACING") != NULL);
+
+  numa_replication = (getenv("CYCLES_CPU_NUMA_REPLICATION") != NULL);
 }
 
 DebugFlags::CUDA::CUDA() : adaptive_compile(false), split_kernel(false)
@@ -142,7 +148,9 @@ std::ostream &operator<<(std::ostream &os, DebugFlagsConstRef debug_flags)
      << "  SSE3       : " << string_from_bool(debug_flags.cpu.sse3) << "\n"
      << "  SSE2       : " << string_from_bool(debug_flags.cpu.sse2) << "\n"
      << "  BVH layout : " << bvh_layout_name(debug_flags.cpu.bvh_layout) << "\n"
-     << "  Split      : " << string_from_bool(debug_flags.cpu.split_kernel) << "\n";
+     << "  Split      : " << string_from_bool(debug_flags.cpu.split_kernel) << "\n"
+     << "  Packets    : " << string_from_bool(debug_flags.cpu.packet_tracing) << "\n"
+     << "  NUMA       : " << string_from_bool(debug_flags.cpu.numa_replication) << "\n";
 
   os << "CUDA flags:\n"
      << "  Adaptive Compile : " << string_from_bool(debug_flags.cuda.adaptive_compile) << "\n";
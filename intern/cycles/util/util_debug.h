@@ -82,6 +82,13 @@ class DebugFlags {
 
     /* Whether split kernel is used */
     bool split_kernel;
+
+    /* Whether camera rays are traced in packets, with the BVH2 layout. */
+    bool packet_tracing;
+
+    /* Whether scene data is replicated on every NUMA node, so render threads read from memory
+     * local to the node they run on. */
+    bool numa_replication;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -474,6 +474,30 @@ ccl_device_inline float4 fast_expf4(float4 x)
 {
   return fast_exp2f4(x / M_LN2_F);
 }
+
+#  ifdef __KERNEL_AVX2__
+/* Same approximation as fast_exp2f4(), for eight values at once. */
+ccl_device_inline avxf fast_exp2f8(avxf x)
+{
+  const avxf one(1.0f);
+  const avxf limit(126.0f);
+  x = min(max(x, avxf(-126.0f)), limit);
+  const __m256i m = _mm256_cvtps_epi32(x);
+  x = one - (one - (x - avxf(_mm256_cvtepi32_ps(m))));
+  avxf r(1.33336498402e-3f);
+  r = madd(x, r, avxf(9.810352697968e-3f));
+  r = madd(x, r, avxf(5.551834031939e-2f));
+  r = madd(x, r, avxf(0.2401793301105f));
+  r = madd(x, r, avxf(0.693144857883f));
+  r = madd(x, r, one);
+  return avxf(_mm256_add_epi32(_mm256_castps_si256(r), _mm256_slli_epi32(m, 23)));
+}
+
+ccl_device_inline avxf fast_expf8(const avxf &x)
+{
+  return fast_exp2f8(x / M_LN2_F);
+}
+#  endif
 #endif
 
 ccl_device_inline float fast_exp10(float x)
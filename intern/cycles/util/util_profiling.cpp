@@ -23,6 +23,7 @@ CCL_NAMESPACE_BEGIN
 
 Profiler::Profiler() : do_stop_worker(true), worker(NULL)
 {
+  std::fill(counters, counters + PROFILING_NUM_COUNTERS, 0);
 }
 
 Profiler::~Profiler()
@@ -40,6 +41,7 @@ void Profiler::run()
       uint32_t cur_event = state->event;
       int32_t cur_shader = state->shader;
       int32_t cur_object = state->object;
+      int32_t cur_closure = state->closure;
 
       /* The state reads/writes should be atomic, but just to be sure
        * check the values for validity anyways. */
@@ -60,6 +62,13 @@ void Profiler::run()
       if (cur_object >= 0 && cur_object < object_samples.size()) {
         object_samples[cur_object]++;
       }
+
+      if (cur_closure >= 0 && cur_closure < closure_samples.size()) {
+        if ((cur_event >= PROFILING_CLOSURE_EVAL) &&
+            (cur_event <= PROFILING_CLOSURE_VOLUME_SAMPLE)) {
+          closure_samples[cur_closure]++;
+        }
+      }
     }
     lock.unlock();
 
@@ -72,7 +81,7 @@ void Profiler::run()
   }
 }
 
-void Profiler::reset(int num_shaders, int num_objects)
+void Profiler::reset(int num_shaders, int num_objects, int num_closures)
 {
   bool running = (worker != NULL);
   if (running) {
@@ -82,10 +91,13 @@ void Profiler::reset(int num_shaders, int num_objects)
   /* Resize and clear the accumulation vectors. */
   shader_hits.assign(num_shaders, 0);
   object_hits.assign(num_objects, 0);
+  shader_svm_nodes.assign(num_shaders, 0);
+  std::fill(counters, counters + PROFILING_NUM_COUNTERS, 0);
 
   event_samples.assign(PROFILING_NUM_EVENTS, 0);
   shader_samples.assign(num_shaders, 0);
   object_samples.assign(num_objects, 0);
+  closure_samples.assign(num_closures, 0);
 
   if (running) {
     start();
@@ -121,11 +133,14 @@ void Profiler::add_state(ProfilingState *state)
   /* Resize thread-local hit counters. */
   state->shader_hits.assign(shader_hits.size(), 0);
   state->object_hits.assign(object_hits.size(), 0);
+  state->shader_svm_nodes.assign(shader_svm_nodes.size(), 0);
+  std::fill(state->counters, state->counters + PROFILING_NUM_COUNTERS, 0);
 
   /* Initialize the state. */
   state->event = PROFILING_UNKNOWN;
   state->shader = -1;
   state->object = -1;
+  state->closure = -1;
   state->active = true;
 }
 
@@ -147,6 +162,15 @@ void Profiler::remove_state(ProfilingState *state)
   for (int i = 0; i < object_hits.size(); i++) {
     object_hits[i] += state->object_hits[i];
   }
+
+  assert(shader_svm_nodes.size() == state->shader_svm_nodes.size());
+  for (int i = 0; i < shader_svm_nodes.size(); i++) {
+    shader_svm_nodes[i] += state->shader_svm_nodes[i];
+  }
+
+  for (int i = 0; i < PROFILING_NUM_COUNTERS; i++) {
+    counters[i] += state->counters[i];
+  }
 }
 
 uint64_t Profiler::get_event(ProfilingEvent event)
@@ -177,4 +201,22 @@ bool Profiler::get_object(int object, uint64_t &samples, uint64_t &hits)
   return true;
 }
 
+uint64_t Profiler::get_shader_svm_nodes(int shader)
+{
+  assert(worker == NULL);
+  return shader_svm_nodes[shader];
+}
+
+uint64_t Profiler::get_closure(int closure)
+{
+  assert(worker == NULL);
+  return closure_samples[closure];
+}
+
+uint64_t Profiler::get_counter(ProfilingCounter counter)
+{
+  assert(worker == NULL);
+  return counters[counter];
+}
+
 CCL_NAMESPACE_END
@@ -64,6 +64,18 @@ enum ProfilingEvent : uint32_t {
   PROFILING_NUM_EVENTS,
 };
 
+/* Exact counts of kernel work, as opposed to the sampled time of events. */
+enum ProfilingCounter : uint32_t {
+  PROFILING_COUNTER_CAMERA_RAYS,
+  PROFILING_COUNTER_INDIRECT_RAYS,
+  PROFILING_COUNTER_SHADOW_RAYS,
+  PROFILING_COUNTER_LOCAL_RAYS,
+  PROFILING_COUNTER_VOLUME_RAYS,
+  PROFILING_COUNTER_BVH_NODES,
+
+  PROFILING_NUM_COUNTERS,
+};
+
 /* Contains the current execution state of a worker thread.
  * These values are constantly updated by the worker.
  * Periodically the profiler thread will wake up, read them
@@ -81,10 +93,37 @@ struct ProfilingState {
   volatile uint32_t event = PROFILING_UNKNOWN;
   volatile int32_t shader = -1;
   volatile int32_t object = -1;
+  volatile int32_t closure = -1;
   volatile bool active = false;
 
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
+
+  /* Thread-local counts, merged into the profiler when the state is removed. */
+  vector<uint64_t> shader_svm_nodes;
+  uint64_t counters[PROFILING_NUM_COUNTERS] = {};
+
+  inline void count(ProfilingCounter counter, uint64_t n)
+  {
+    if (active) {
+      counters[counter] += n;
+    }
+  }
+
+  /* Storage for a ProfilingCountHelper, NULL while not profiling. */
+  inline uint64_t *counter_storage(ProfilingCounter counter)
+  {
+    return active ? &counters[counter] : NULL;
+  }
+
+  inline uint64_t *shader_svm_nodes_storage(int shader)
+  {
+    if (active) {
+      assert(shader < shader_svm_nodes.size());
+      return &shader_svm_nodes[shader];
+    }
+    return NULL;
+  }
 };
 
 class Profiler {
@@ -92,7 +131,7 @@ class Profiler {
   Profiler();
   ~Profiler();
 
-  void reset(int num_shaders, int num_objects);
+  void reset(int num_shaders, int num_objects, int num_closures);
 
   void start();
   void stop();
@@ -103,6 +142,9 @@ class Profiler {
   uint64_t get_event(ProfilingEvent event);
   bool get_shader(int shader, uint64_t &samples, uint64_t &hits);
   bool get_object(int object, uint64_t &samples, uint64_t &hits);
+  uint64_t get_shader_svm_nodes(int shader);
+  uint64_t get_closure(int closure);
+  uint64_t get_counter(ProfilingCounter counter);
 
  protected:
   void run();
@@ -113,6 +155,8 @@ class Profiler {
   vector<uint64_t> event_samples;
   vector<uint64_t> shader_samples;
   vector<uint64_t> object_samples;
+  /* Sampled only during closure evaluation and sampling events. */
+  vector<uint64_t> closure_samples;
 
   /* Tracks the total amounts every object/shader was hit.
    * Used to evaluate relative cost, written by the render thread.
@@ -121,6 +165,10 @@ class Profiler {
   vector<uint64_t> shader_hits;
   vector<uint64_t> object_hits;
 
+  /* Exact counts, merged from the thread states. */
+  vector<uint64_t> shader_svm_nodes;
+  uint64_t counters[PROFILING_NUM_COUNTERS];
+
   volatile bool do_stop_worker;
   thread *worker;
 
@@ -169,6 +217,27 @@ class ProfilingHelper {
   uint32_t previous_event;
 };
 
+/* Counts in a local variable, which is cheap enough for inner loops like BVH traversal, and adds
+ * the total to the storage when going out of scope. */
+class ProfilingCountHelper {
+ public:
+  explicit ProfilingCountHelper(uint64_t *storage) : count(0), storage(storage)
+  {
+  }
+
+  ~ProfilingCountHelper()
+  {
+    if (storage) {
+      *storage += count;
+    }
+  }
+
+  uint32_t count;
+
+ private:
+  uint64_t *storage;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_PROFILING_H__ */
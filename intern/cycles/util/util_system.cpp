@@ -39,6 +39,11 @@ OIIO_NAMESPACE_USING
 #  include <unistd.h>
 #endif
 
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 bool system_cpu_ensure_initialized()
@@ -118,6 +123,50 @@ bool system_cpu_run_thread_on_node(int node)
   return numaAPI_RunThreadOnNode(node);
 }
 
+bool system_cpu_thread_affinity_get(SystemThreadAffinity *affinity)
+{
+#if defined(_WIN32)
+  static_assert(sizeof(GROUP_AFFINITY) <= sizeof(affinity->data), "Affinity storage too small");
+  return GetThreadGroupAffinity(GetCurrentThread(), (GROUP_AFFINITY *)affinity->data) != 0;
+#elif defined(__linux__)
+  static_assert(sizeof(cpu_set_t) <= sizeof(affinity->data), "Affinity storage too small");
+  return pthread_getaffinity_np(
+             pthread_self(), sizeof(cpu_set_t), (cpu_set_t *)affinity->data) == 0;
+#else
+  /* Thread affinity is not supported by the NUMA API on other platforms. */
+  (void)affinity;
+  return false;
+#endif
+}
+
+void system_cpu_thread_affinity_set(const SystemThreadAffinity *affinity)
+{
+#if defined(_WIN32)
+  SetThreadGroupAffinity(GetCurrentThread(), (const GROUP_AFFINITY *)affinity->data, NULL);
+#elif defined(__linux__)
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), (const cpu_set_t *)affinity->data);
+#else
+  (void)affinity;
+#endif
+}
+
+void *system_cpu_numa_alloc(size_t size, int node)
+{
+  if (!system_cpu_ensure_initialized()) {
+    return malloc(size);
+  }
+  return numaAPI_AllocateOnNode(size, node);
+}
+
+void system_cpu_numa_free(void *mem, size_t size)
+{
+  if (!system_cpu_ensure_initialized()) {
+    free(mem);
+    return;
+  }
+  numaAPI_Free(mem, size);
+}
+
 int system_console_width()
 {
   int columns = 0;
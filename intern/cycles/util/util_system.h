@@ -48,6 +48,22 @@ int system_cpu_num_numa_node_processors(int node);
  * Returns truth if affinity has successfully changed. */
 bool system_cpu_run_thread_on_node(int node);
 
+/* Processor affinity of a thread, large enough for the affinity mask on all platforms. */
+struct SystemThreadAffinity {
+  uint64_t data[16];
+};
+
+/* Save and restore the affinity of the current thread, to run it on a node only temporarily.
+ *
+ * Returns false if the affinity can not be queried, in which case it must not be restored. */
+bool system_cpu_thread_affinity_get(SystemThreadAffinity *affinity);
+void system_cpu_thread_affinity_set(const SystemThreadAffinity *affinity);
+
+/* Allocate memory on a specific node, or with a regular allocation when the NUMA API is not
+ * available. Must be freed with system_cpu_numa_free() and the same size. */
+void *system_cpu_numa_alloc(size_t size, int node);
+void system_cpu_numa_free(void *mem, size_t size);
+
 /* Number of processors within the current CPU group (or within active thread
  * thread affinity). */
 int system_cpu_num_active_group_processors();
@@ -103,9 +103,67 @@ typedef struct TextureInfo {
   uint width, height, depth;
   /* Transform for 3D textures. */
   uint use_transform_3d;
+  /* Image is read through the image cache, and data points to its TextureCacheHandle. */
+  uint use_cache;
+  /* 3D image stored as a sparse grid. */
+  uint use_sparse_grid;
   Transform transform_3d;
 } TextureInfo;
 
+/* Sparse Grid
+ *
+ * Volumes are often mostly empty space. A sparse 3D image only stores the tiles of
+ * SPARSE_TILE_SIZE^3 voxels that are not empty. The image data starts with a table with an int
+ * for every tile of the full grid, which is the index of the tile in the pool of tiles that
+ * follows the table, or SPARSE_TILE_EMPTY for tiles where all voxels are zero. Voxels within a
+ * tile are stored in the same x, y, z order as dense images. */
+#define SPARSE_TILE_SIZE 8
+#define SPARSE_TILE_VOXELS (SPARSE_TILE_SIZE * SPARSE_TILE_SIZE * SPARSE_TILE_SIZE)
+#define SPARSE_TILE_EMPTY -1
+
+ccl_device_inline int sparse_grid_num_tiles(int width)
+{
+  return (width + SPARSE_TILE_SIZE - 1) / SPARSE_TILE_SIZE;
+}
+
+ccl_device_inline int sparse_grid_tile_index(int x, int y, int z, int width, int height)
+{
+  const int tiles_x = sparse_grid_num_tiles(width);
+  const int tiles_y = sparse_grid_num_tiles(height);
+  return (x / SPARSE_TILE_SIZE) + ((y / SPARSE_TILE_SIZE) + (z / SPARSE_TILE_SIZE) * tiles_y) *
+                                      tiles_x;
+}
+
+ccl_device_inline int sparse_grid_voxel_index(int x, int y, int z)
+{
+  return (x % SPARSE_TILE_SIZE) +
+         ((y % SPARSE_TILE_SIZE) + (z % SPARSE_TILE_SIZE) * SPARSE_TILE_SIZE) * SPARSE_TILE_SIZE;
+}
+
+/* Offset of the tile pool in bytes, aligned for float4 voxels. */
+ccl_device_inline size_t sparse_grid_pool_offset(int width, int height, int depth)
+{
+  const size_t num_tiles = (size_t)sparse_grid_num_tiles(width) * sparse_grid_num_tiles(height) *
+                           sparse_grid_num_tiles(depth);
+  return (num_tiles * sizeof(int) + 15) & ~(size_t)15;
+}
+
+#ifndef __KERNEL_GPU__
+/* Image read on demand from a tiled, mip-mapped image cache instead of being stored in device
+ * memory, only supported on the CPU. The derivatives of the texture coordinates select the mip
+ * level, the result is always RGBA. */
+typedef struct TextureCacheHandle {
+  void (*lookup)(const struct TextureCacheHandle *handle,
+                 float s,
+                 float t,
+                 float dsdx,
+                 float dtdx,
+                 float dsdy,
+                 float dtdy,
+                 float result[4]);
+} TextureCacheHandle;
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_TEXTURE_H__ */
@@ -187,7 +187,12 @@ template<class T> class MEM_CacheLimiter {
 
   void enforce_limits()
   {
-    size_t max = MEM_CacheLimiter_get_maximum();
+    enforce_limits(MEM_CacheLimiter_get_maximum());
+  }
+
+  /* Free elements until memory in use fits into given maximum, zero means no limit. */
+  void enforce_limits(size_t max)
+  {
     bool is_disabled = MEM_CacheLimiter_is_disabled();
     size_t mem_in_use, cur_size;
 
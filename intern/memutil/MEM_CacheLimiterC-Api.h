@@ -90,6 +90,16 @@ MEM_CacheLimiterHandleC *MEM_CacheLimiter_insert(MEM_CacheLimiterC *This, void *
 
 void MEM_CacheLimiter_enforce_limits(MEM_CacheLimiterC *This);
 
+/**
+ * Free objects until memory used by them fits into the given maximum,
+ * used when the global maximum is shared with memory which isn't managed by the limiter.
+ *
+ * \param This: "This" pointer.
+ * \param maximum: memory limit in bytes, zero means no limit.
+ */
+
+void MEM_CacheLimiter_enforce_limits_ex(MEM_CacheLimiterC *This, size_t maximum);
+
 /**
  * Unmanage object previously inserted object.
  * Does _not_ delete managed object!
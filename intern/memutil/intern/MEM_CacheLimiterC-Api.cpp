@@ -181,6 +181,11 @@ void MEM_CacheLimiter_enforce_limits(MEM_CacheLimiterC *This)
   cast(This)->get_cache()->enforce_limits();
 }
 
+void MEM_CacheLimiter_enforce_limits_ex(MEM_CacheLimiterC *This, size_t maximum)
+{
+  cast(This)->get_cache()->enforce_limits(maximum);
+}
+
 void MEM_CacheLimiter_unmanage(MEM_CacheLimiterHandleC *handle)
 {
   cast(handle)->unmanage();
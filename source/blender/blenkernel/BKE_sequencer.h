@@ -87,11 +87,18 @@ void BKE_sequence_iterator_end(SeqIterator *iter);
   } \
   ((void)0)
 
+/* Upper limit of concurrently rendered frames. Each worker owns a full copy of evaluated scene,
+ * so there is not much to gain beyond this. */
+#define SEQ_PREFETCH_MAX_WORKERS 4
+
+/* Prefetch workers use SEQ_TASK_PREFETCH_RENDER + worker index. */
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
   SEQ_TASK_PREFETCH_RENDER,
 } eSeqTaskId;
 
+#define SEQ_TASK_MAX_NUM (SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_MAX_WORKERS)
+
 typedef struct SeqRenderData {
   struct Main *bmain;
   struct Depsgraph *depsgraph;
@@ -219,6 +226,9 @@ struct ImBuf *BKE_sequencer_give_ibuf_seqbase(const SeqRenderData *context,
                                               float cfra,
                                               int chan_shown,
                                               struct ListBase *seqbasep);
+/* Whether the inputs of an effect can be rendered in parallel. */
+bool BKE_sequencer_effect_inputs_can_render_threaded(const struct Sequence *seq,
+                                                     struct Sequence *input[3]);
 struct ImBuf *BKE_sequencer_effect_execute_threaded(struct SeqEffectHandle *sh,
                                                     const SeqRenderData *context,
                                                     struct Sequence *seq,
@@ -385,6 +385,10 @@ static void setup_app_data(bContext *C,
     /* TODO(sergey): Can this be also move above? */
     RE_FreeAllPersistentData();
   }
+  else {
+    /* Render engines are kept on undo, but their dependency graphs use the old main. */
+    RE_FreeAllPersistentDepsgraphs();
+  }
 
   if (mode == LOAD_UNDO) {
     /* In undo/redo case, we do a whole lot of magic tricks to avoid having to re-read linked
@@ -257,6 +257,7 @@ static void imagecache_put(Image *image, int index, ImBuf *ibuf)
 
     image->cache = IMB_moviecache_create(
         "Image Datablock Cache", sizeof(ImageCacheKey), imagecache_hashhash, imagecache_hashcmp);
+    IMB_moviecache_set_consumer(image->cache, MOVIECACHE_CONSUMER_IMAGE);
     IMB_moviecache_set_getdata_callback(image->cache, imagecache_keydata);
   }
 
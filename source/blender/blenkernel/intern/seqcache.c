@@ -33,6 +33,7 @@
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
@@ -138,7 +139,11 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* Last key put by each task, used to link intermediate items to the final frame they belong
+   * to. Kept per task so chains of prefetch workers and the main render don't interleave. Effect
+   * inputs rendered in parallel share the chain of their task, all their items belong to the same
+   * final frame. */
+  struct SeqCacheKey *last_key[SEQ_TASK_MAX_NUM];
   size_t memory_used;
   SeqDiskCache *disk_cache;
 } SeqCache;
@@ -765,9 +770,10 @@ static void seq_cache_unlock(Scene *scene)
   }
 }
 
+/* Sequencer shares the memory limit with other image buffer caches. */
 static size_t seq_cache_get_mem_total(void)
 {
-  return ((size_t)U.memcachelimit) * 1024 * 1024;
+  return IMB_moviecache_consumer_memory_limit(MOVIECACHE_CONSUMER_SEQUENCER);
 }
 
 static void seq_cache_keyfree(void *val)
@@ -782,7 +788,9 @@ static void seq_cache_valfree(void *val)
   SeqCache *cache = item->cache_owner;
 
   if (item->ibuf) {
-    cache->memory_used -= IMB_get_size_in_memory(item->ibuf);
+    const size_t size = IMB_get_size_in_memory(item->ibuf);
+    cache->memory_used -= size;
+    IMB_moviecache_consumer_memory_remove(MOVIECACHE_CONSUMER_SEQUENCER, size);
     IMB_freeImBuf(item->ibuf);
   }
 
@@ -797,9 +805,11 @@ static void seq_cache_put(SeqCache *cache, SeqCacheKey *key, ImBuf *ibuf)
   item->ibuf = ibuf;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
+    const size_t size = IMB_get_size_in_memory(ibuf);
     IMB_refImBuf(ibuf);
-    cache->last_key = key;
-    cache->memory_used += IMB_get_size_in_memory(ibuf);
+    cache->last_key[key->task_id] = key;
+    cache->memory_used += size;
+    IMB_moviecache_consumer_memory_add(MOVIECACHE_CONSUMER_SEQUENCER, size);
   }
 }
 
@@ -993,6 +1003,9 @@ bool BKE_sequencer_cache_recycle_item(Scene *scene)
 
   seq_cache_lock(scene);
 
+  const int items_num = BLI_ghash_len(cache->hash);
+  bool result = true;
+
   while (cache->memory_used > memory_total) {
     SeqCacheKey *finalkey = seq_cache_get_item_for_removal(scene);
 
@@ -1000,12 +1013,15 @@ bool BKE_sequencer_cache_recycle_item(Scene *scene)
       seq_cache_recycle_linked(scene, finalkey);
     }
     else {
-      seq_cache_unlock(scene);
-      return false;
+      result = false;
+      break;
     }
   }
+
+  IMB_moviecache_consumer_tag_evicted(MOVIECACHE_CONSUMER_SEQUENCER,
+                                      items_num - (int)BLI_ghash_len(cache->hash));
   seq_cache_unlock(scene);
-  return true;
+  return result;
 }
 
 static void seq_cache_set_temp_cache_linked(Scene *scene, SeqCacheKey *base)
@@ -1062,7 +1078,6 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -1146,7 +1161,7 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1210,7 +1225,7 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1254,6 +1269,11 @@ struct ImBuf *BKE_sequencer_cache_get(
   }
   seq_cache_unlock(scene);
 
+  /* Lookups which skip disk cache only check for existing items before insertion. */
+  if (!skip_disk_cache) {
+    IMB_moviecache_consumer_tag_lookup(MOVIECACHE_CONSUMER_SEQUENCER, ibuf != NULL);
+  }
+
   if (ibuf) {
     return ibuf;
   }
@@ -1305,8 +1325,13 @@ bool BKE_sequencer_cache_put_if_possible(const SeqRenderData *context,
     return true;
   }
   else {
-    seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-    scene->ed->cache->last_key = NULL;
+    seq_cache_lock(scene);
+    SeqCache *cache = seq_cache_get_from_scene(scene);
+    if (cache) {
+      seq_cache_set_temp_cache_linked(scene, cache->last_key[context->task_id]);
+      cache->last_key[context->task_id] = NULL;
+    }
+    seq_cache_unlock(scene);
     return false;
   }
 }
@@ -1375,34 +1400,40 @@ void BKE_sequencer_cache_put(const SeqRenderData *context,
   key->is_temp_cache = true;
   key->task_id = context->task_id;
 
+  BLI_assert(key->task_id < SEQ_TASK_MAX_NUM);
+  SeqCacheKey **last_key = &cache->last_key[key->task_id];
+
   /* Item stored for later use */
   if (flag & type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = *last_key;
   }
 
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = *last_key;
   seq_cache_put(cache, key, i);
 
   /* Restore pointer to previous item as this one will be freed when stack is rendered. */
   if (key->is_temp_cache) {
-    cache->last_key = temp_last_key;
+    *last_key = temp_last_key;
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
+   * Item is already put in cache, so last_key points to current key.
    */
   if (flag & type && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = *last_key;
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    *last_key = NULL;
   }
 
   seq_cache_unlock(scene);
 
+  /* Make room for the new buffer in caches of other areas. */
+  IMB_moviecache_enforce_limits();
+
   if (!key->is_temp_cache && !skip_disk_cache) {
     if (seq_disk_cache_is_enabled(context->bmain)) {
       if (cache->disk_cache == NULL) {
@@ -1441,7 +1472,7 @@ void BKE_sequencer_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->nfra, key->type, key->cost);
   }
 
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
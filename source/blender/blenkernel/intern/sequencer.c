@@ -48,6 +48,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -2891,6 +2892,96 @@ ImBuf *BKE_sequencer_effect_execute_threaded(struct SeqEffectHandle *sh,
   return out;
 }
 
+/* Inputs of effect can be rendered concurrently if they don't share any data. Strips that read
+ * from other strips or from scenes are always rendered serially. */
+static bool seq_effect_input_is_threadsafe(const Sequence *seq)
+{
+  switch (seq->type) {
+    case SEQ_TYPE_IMAGE:
+    case SEQ_TYPE_MOVIE:
+    case SEQ_TYPE_COLOR:
+      break;
+    default:
+      return false;
+  }
+
+  /* Modifiers masked by a strip render that strip, which can be a scene or meta strip. */
+  LISTBASE_FOREACH (const SequenceModifierData *, smd, &seq->modifiers) {
+    if (smd->mask_input_type == SEQUENCE_MASK_INPUT_STRIP && smd->mask_sequence) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool BKE_sequencer_effect_inputs_can_render_threaded(const Sequence *seq, Sequence *input[3])
+{
+  int num_inputs = 0;
+
+  /* Speed effect renders single input multiple times. */
+  if (seq->type == SEQ_TYPE_SPEED) {
+    return false;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    if (input[i] == NULL) {
+      continue;
+    }
+    if (!seq_effect_input_is_threadsafe(input[i])) {
+      return false;
+    }
+    for (int j = 0; j < i; j++) {
+      if (input[j] == input[i]) {
+        return false;
+      }
+    }
+    num_inputs++;
+  }
+
+  return num_inputs > 1;
+}
+
+typedef struct RenderEffectInputData {
+  const SeqRenderData *context;
+  SeqRenderState *state;
+  Sequence **input;
+  ImBuf **ibuf;
+  float cfra;
+} RenderEffectInputData;
+
+static void render_effect_input_cb(void *__restrict userdata,
+                                   const int i,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RenderEffectInputData *data = userdata;
+
+  if (data->input[i]) {
+    SeqRenderState state = *data->state;
+    data->ibuf[i] = seq_render_strip(data->context, &state, data->input[i], data->cfra);
+  }
+}
+
+static void seq_render_effect_inputs_threaded(const SeqRenderData *context,
+                                              SeqRenderState *state,
+                                              Sequence *input[3],
+                                              float cfra,
+                                              ImBuf *ibuf[3])
+{
+  RenderEffectInputData data = {
+      .context = context,
+      .state = state,
+      .input = input,
+      .ibuf = ibuf,
+      .cfra = cfra,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, 3, &data, render_effect_input_cb, &settings);
+}
+
 static ImBuf *seq_render_effect_strip_impl(const SeqRenderData *context,
                                            SeqRenderState *state,
                                            Sequence *seq,
@@ -2939,15 +3030,21 @@ static ImBuf *seq_render_effect_strip_impl(const SeqRenderData *context,
       out = sh.execute(context, seq, cfra, fac, facf, NULL, NULL, NULL);
       break;
     case EARLY_DO_EFFECT:
-      for (i = 0; i < 3; i++) {
-        /* Speed effect requires time remapping of cfra for input(s). */
-        if (input[0] && seq->type == SEQ_TYPE_SPEED) {
-          float target_frame = BKE_sequencer_speed_effect_target_frame_get(context, seq, cfra, i);
-          ibuf[i] = seq_render_strip(context, state, input[0], target_frame);
-        }
-        else { /* Other effects. */
-          if (input[i]) {
-            ibuf[i] = seq_render_strip(context, state, input[i], cfra);
+      if (BKE_sequencer_effect_inputs_can_render_threaded(seq, input)) {
+        seq_render_effect_inputs_threaded(context, state, input, cfra, ibuf);
+      }
+      else {
+        for (i = 0; i < 3; i++) {
+          /* Speed effect requires time remapping of cfra for input(s). */
+          if (input[0] && seq->type == SEQ_TYPE_SPEED) {
+            float target_frame = BKE_sequencer_speed_effect_target_frame_get(
+                context, seq, cfra, i);
+            ibuf[i] = seq_render_strip(context, state, input[0], target_frame);
+          }
+          else { /* Other effects. */
+            if (input[i]) {
+              ibuf[i] = seq_render_strip(context, state, input[i], cfra);
+            }
           }
         }
       }
@@ -38,6 +38,32 @@ extern "C" {
 struct ImBuf;
 struct MovieCache;
 
+/* Areas which keep image buffers in memory. They all share the cache memory limit from the
+ * user preferences, each of them has a quota which is a share of the limit it is guaranteed
+ * to keep. Memory which isn't used by one consumer can be borrowed by another one, buffers
+ * stored above the quota are the first to be freed once the limit is exceeded. */
+typedef enum eMovieCacheConsumer {
+  MOVIECACHE_CONSUMER_IMAGE = 0,
+  MOVIECACHE_CONSUMER_CLIP = 1,
+  MOVIECACHE_CONSUMER_DISPLAY = 2,
+  /* Sequencer manages its own storage and only reports memory it uses. */
+  MOVIECACHE_CONSUMER_SEQUENCER = 3,
+  /* Pooled movie decoders and their reverse playback frames, also external. */
+  MOVIECACHE_CONSUMER_MOVIE_DECODER = 4,
+} eMovieCacheConsumer;
+
+#define MOVIECACHE_CONSUMER_TOT 5
+
+typedef struct MovieCacheStats {
+  const char *name;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t memory_in_use;
+  size_t memory_quota;
+  int items;
+} MovieCacheStats;
+
 typedef void (*MovieCacheGetKeyDataFP)(void *userkey, int *framenr, int *proxy, int *render_flags);
 
 typedef void *(*MovieCacheGetPriorityDataFP)(void *userkey);
@@ -51,6 +77,7 @@ struct MovieCache *IMB_moviecache_create(const char *name,
                                          int keysize,
                                          GHashHashFP hashfp,
                                          GHashCmpFP cmpfp);
+void IMB_moviecache_set_consumer(struct MovieCache *cache, eMovieCacheConsumer consumer);
 void IMB_moviecache_set_getdata_callback(struct MovieCache *cache,
                                          MovieCacheGetKeyDataFP getdatafp);
 void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
@@ -74,6 +101,19 @@ void IMB_moviecache_cleanup(struct MovieCache *cache,
 void IMB_moviecache_get_cache_segments(
     struct MovieCache *cache, int proxy, int render_flags, int *r_totseg, int **r_points);
 
+void IMB_moviecache_enforce_limits(void);
+
+/* Accounting for caches which manage their own storage. */
+void IMB_moviecache_consumer_memory_add(eMovieCacheConsumer consumer, size_t size);
+void IMB_moviecache_consumer_memory_remove(eMovieCacheConsumer consumer, size_t size);
+void IMB_moviecache_consumer_tag_lookup(eMovieCacheConsumer consumer, bool is_hit);
+void IMB_moviecache_consumer_tag_evicted(eMovieCacheConsumer consumer, int count);
+size_t IMB_moviecache_consumer_memory_limit(eMovieCacheConsumer consumer);
+
+void IMB_moviecache_consumer_quota_set(eMovieCacheConsumer consumer, float factor);
+void IMB_moviecache_consumer_stats_get(eMovieCacheConsumer consumer, MovieCacheStats *r_stats);
+void IMB_moviecache_print_stats(void);
+
 struct MovieCacheIter;
 struct MovieCacheIter *IMB_moviecacheIter_new(struct MovieCache *cache);
 void IMB_moviecacheIter_free(struct MovieCacheIter *iter);
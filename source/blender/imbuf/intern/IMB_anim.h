@@ -81,6 +81,12 @@
 
 #define MAXNUMSTREAMS 50
 
+/* Decoders kept at other positions of a movie in addition to the main one. */
+#define ANIM_DECODER_POOL_SIZE 3
+/* Frames kept while decoding towards a frame requested during backward playback. */
+#define ANIM_REVERSE_CACHE_SIZE 8
+
+struct AnimKeyframeIndex;
 struct IDProperty;
 struct _AviMovie;
 struct anim_index;
@@ -137,6 +143,30 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* Keyframes seen while reading packets, shared by all decoders of the movie. */
+  struct AnimKeyframeIndex *keyframe_index;
+  /* Packets are read without gaps since a point covered by the keyframe index. */
+  bool keyframe_index_contiguous;
+
+  /* Decoders of the same movie, positioned at other keyframe intervals. */
+  struct anim *decoder_pool[ANIM_DECODER_POOL_SIZE];
+  /* Movie this decoder belongs to, NULL for the main decoder. */
+  struct anim *decoder_owner;
+  /* Memory accounted to the cache limit for this pooled decoder. */
+  size_t decoder_memory;
+  /* Position of the frame this decoder decoded last, -1 before the first frame. */
+  int decoder_position;
+  uint64_t decoder_last_used;
+  uint64_t decoder_clock;
+  int last_requested_position;
+
+  struct ImBuf *reverse_frames[ANIM_REVERSE_CACHE_SIZE];
+  int64_t reverse_frames_pts[ANIM_REVERSE_CACHE_SIZE][2];
+  size_t reverse_frames_memory[ANIM_REVERSE_CACHE_SIZE];
+  int reverse_frames_next;
+  /* Decoded frames from this PTS are stored into the reverse cache while scanning. */
+  int64_t reverse_capture_pts;
 #endif
 
   char index_dir[768];
@@ -53,6 +53,7 @@
 #  include <io.h>
 #endif
 
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_utildefines.h"
@@ -72,6 +73,7 @@
 #include "IMB_anim.h"
 #include "IMB_indexer.h"
 #include "IMB_metadata.h"
+#include "IMB_moviecache.h"
 
 #ifdef WITH_FFMPEG
 #  include "BKE_global.h" /* ENDIAN_ORDER */
@@ -200,6 +202,7 @@ static void free_anim_avi(struct anim *anim)
 
 #ifdef WITH_FFMPEG
 static void free_anim_ffmpeg(struct anim *anim);
+static ImBuf *anim_getnew(struct anim *anim);
 #endif
 
 void IMB_free_anim(struct anim *anim)
@@ -481,6 +484,117 @@ static ImBuf *avi_fetchibuf(struct anim *anim, int position)
 
 #ifdef WITH_FFMPEG
 
+/* -------------------------------------------------------------------- */
+/** \name Keyframe Index
+ *
+ * Keyframes are collected while packets are read, so once a part of the movie was read
+ * linearly, seeking into it goes straight to the keyframe before the requested frame
+ * without a timecode index built in advance.
+ * \{ */
+
+typedef struct AnimKeyframe {
+  int64_t pts;
+  int64_t dts;
+} AnimKeyframe;
+
+typedef struct AnimKeyframeIndex {
+  /* Sorted by PTS. */
+  AnimKeyframe *keyframes;
+  int keyframes_len;
+  int keyframes_alloc;
+  /* All keyframes with PTS up to this one are in the index. */
+  int64_t pts_covered;
+} AnimKeyframeIndex;
+
+static AnimKeyframeIndex *ffmpeg_keyframe_index_new(void)
+{
+  AnimKeyframeIndex *index = MEM_callocN(sizeof(AnimKeyframeIndex), "anim keyframe index");
+  index->pts_covered = AV_NOPTS_VALUE;
+  return index;
+}
+
+static void ffmpeg_keyframe_index_free(AnimKeyframeIndex *index)
+{
+  MEM_SAFE_FREE(index->keyframes);
+  MEM_freeN(index);
+}
+
+/* Position in the index of the last keyframe with PTS lower or equal to the given one. */
+static int ffmpeg_keyframe_index_lower_bound(const AnimKeyframeIndex *index, int64_t pts)
+{
+  int low = 0, high = index->keyframes_len;
+
+  while (low < high) {
+    const int mid = (low + high) / 2;
+    if (index->keyframes[mid].pts <= pts) {
+      low = mid + 1;
+    }
+    else {
+      high = mid;
+    }
+  }
+
+  return low - 1;
+}
+
+/* Keyframe the frame with given PTS is decoded from, NULL when that part of the movie
+ * was not read yet. */
+static const AnimKeyframe *ffmpeg_keyframe_index_find(const AnimKeyframeIndex *index, int64_t pts)
+{
+  if (index == NULL || index->pts_covered == AV_NOPTS_VALUE || pts > index->pts_covered) {
+    return NULL;
+  }
+
+  const int i = ffmpeg_keyframe_index_lower_bound(index, pts);
+  return (i != -1) ? &index->keyframes[i] : NULL;
+}
+
+static void ffmpeg_keyframe_index_add_packet(struct anim *anim, const AVPacket *packet)
+{
+  AnimKeyframeIndex *index = anim->keyframe_index;
+  const int64_t pts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : packet->dts;
+  const int64_t dts = (packet->dts != AV_NOPTS_VALUE) ? packet->dts : packet->pts;
+
+  if (index == NULL) {
+    return;
+  }
+
+  if (pts == AV_NOPTS_VALUE) {
+    /* Can't tell where in the stream we are. */
+    anim->keyframe_index_contiguous = false;
+    return;
+  }
+
+  if (packet->flags & AV_PKT_FLAG_KEY) {
+    const int i = ffmpeg_keyframe_index_lower_bound(index, pts);
+
+    if (i == -1 || index->keyframes[i].pts != pts) {
+      if (index->keyframes_len == index->keyframes_alloc) {
+        index->keyframes_alloc = max_ii(64, index->keyframes_alloc * 2);
+        index->keyframes = MEM_reallocN_id(index->keyframes,
+                                           sizeof(AnimKeyframe) * index->keyframes_alloc,
+                                           "anim keyframes");
+      }
+
+      memmove(&index->keyframes[i + 2],
+              &index->keyframes[i + 1],
+              sizeof(AnimKeyframe) * (index->keyframes_len - i - 1));
+      index->keyframes[i + 1].pts = pts;
+      index->keyframes[i + 1].dts = dts;
+      index->keyframes_len++;
+    }
+  }
+
+  /* Keyframes which are not read yet have larger DTS, and PTS is never lower than DTS. So all
+   * keyframes presented up to this DTS are known when reading got here without gaps. */
+  if (anim->keyframe_index_contiguous &&
+      (index->pts_covered == AV_NOPTS_VALUE || dts > index->pts_covered)) {
+    index->pts_covered = dts;
+  }
+}
+
+/** \} */
+
 BLI_INLINE bool need_aligned_ffmpeg_buffer(struct anim *anim)
 {
   return (anim->x & 31) != 0;
@@ -617,11 +731,20 @@ static int startffmpeg(struct anim *anim)
   anim->framesize = anim->x * anim->y * 4;
 
   anim->curposition = -1;
+  anim->decoder_position = -1;
   anim->last_frame = 0;
   anim->last_pts = -1;
   anim->next_pts = -1;
   anim->next_packet.stream_index = -1;
 
+  /* Decoders of the pool share the index of the main decoder. */
+  if (anim->keyframe_index == NULL) {
+    anim->keyframe_index = ffmpeg_keyframe_index_new();
+  }
+  anim->keyframe_index_contiguous = true;
+  anim->last_requested_position = -1;
+  anim->reverse_capture_pts = AV_NOPTS_VALUE;
+
   anim->pFrame = av_frame_alloc();
   anim->pFrameComplete = false;
   anim->pFrameDeinterlaced = av_frame_alloc();
@@ -882,6 +1005,8 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
            (anim->next_packet.pts == AV_NOPTS_VALUE) ? -1 : (long long int)anim->next_packet.pts,
            (anim->next_packet.flags & AV_PKT_FLAG_KEY) ? " KEY" : "");
     if (anim->next_packet.stream_index == anim->videoStream) {
+      ffmpeg_keyframe_index_add_packet(anim, &anim->next_packet);
+
       anim->pFrameComplete = 0;
 
       avcodec_decode_video2(
@@ -949,6 +1074,118 @@ static int ffmpeg_decode_video_frame(struct anim *anim)
   return (rval >= 0);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Reverse Cache
+ *
+ * Playing backwards, every frame is decoded starting from the keyframe before it. Frames
+ * decoded on the way to the requested one are kept, so the next few requests don't need
+ * to decode the keyframe interval again.
+ * \{ */
+
+static struct anim *ffmpeg_decoder_owner(struct anim *anim)
+{
+  return anim->decoder_owner ? anim->decoder_owner : anim;
+}
+
+/* Pooled decoders and frames in the reverse cache count against the cache memory limit from the
+ * user preferences. They are only created while they fit. */
+static bool ffmpeg_decoder_memory_fits(size_t size)
+{
+  MovieCacheStats stats;
+  IMB_moviecache_consumer_stats_get(MOVIECACHE_CONSUMER_MOVIE_DECODER, &stats);
+
+  return stats.memory_in_use + size <=
+         IMB_moviecache_consumer_memory_limit(MOVIECACHE_CONSUMER_MOVIE_DECODER);
+}
+
+static void ffmpeg_decoder_memory_add(size_t size)
+{
+  IMB_moviecache_consumer_memory_add(MOVIECACHE_CONSUMER_MOVIE_DECODER, size);
+
+  /* Make room in other caches. */
+  IMB_moviecache_enforce_limits();
+}
+
+static void ffmpeg_decoder_memory_remove(size_t size)
+{
+  IMB_moviecache_consumer_memory_remove(MOVIECACHE_CONSUMER_MOVIE_DECODER, size);
+}
+
+static ImBuf *ffmpeg_reverse_cache_get(struct anim *anim, int64_t pts)
+{
+  for (int i = 0; i < ANIM_REVERSE_CACHE_SIZE; i++) {
+    if (anim->reverse_frames[i] && anim->reverse_frames_pts[i][0] <= pts &&
+        anim->reverse_frames_pts[i][1] > pts) {
+      IMB_refImBuf(anim->reverse_frames[i]);
+      return anim->reverse_frames[i];
+    }
+  }
+  return NULL;
+}
+
+static void ffmpeg_reverse_cache_free_frame(struct anim *anim, int i)
+{
+  if (anim->reverse_frames[i]) {
+    ffmpeg_decoder_memory_remove(anim->reverse_frames_memory[i]);
+    IMB_freeImBuf(anim->reverse_frames[i]);
+    anim->reverse_frames[i] = NULL;
+  }
+}
+
+static void ffmpeg_reverse_cache_add(struct anim *anim, ImBuf *ibuf, int64_t pts, int64_t pts_end)
+{
+  const int i = anim->reverse_frames_next;
+  const size_t size = IMB_get_size_in_memory(ibuf);
+
+  ffmpeg_reverse_cache_free_frame(anim, i);
+
+  if (!ffmpeg_decoder_memory_fits(size)) {
+    IMB_freeImBuf(ibuf);
+    return;
+  }
+  ffmpeg_decoder_memory_add(size);
+
+  anim->reverse_frames[i] = ibuf;
+  anim->reverse_frames_memory[i] = size;
+  anim->reverse_frames_pts[i][0] = pts;
+  anim->reverse_frames_pts[i][1] = pts_end;
+  anim->reverse_frames_next = (i + 1) % ANIM_REVERSE_CACHE_SIZE;
+}
+
+static void ffmpeg_reverse_cache_free(struct anim *anim)
+{
+  for (int i = 0; i < ANIM_REVERSE_CACHE_SIZE; i++) {
+    ffmpeg_reverse_cache_free_frame(anim, i);
+  }
+  anim->reverse_frames_next = 0;
+}
+
+/* Convert the decoded frame if it is to be kept in the reverse cache. */
+static ImBuf *ffmpeg_reverse_cache_capture(struct anim *anim)
+{
+  ImBuf *last_frame = anim->last_frame;
+  ImBuf *ibuf;
+
+  if (anim->reverse_capture_pts == AV_NOPTS_VALUE || anim->next_pts == -1 ||
+      anim->next_pts < anim->reverse_capture_pts || !anim->pFrameComplete) {
+    return NULL;
+  }
+  if (!ffmpeg_decoder_memory_fits((size_t)anim->x * anim->y * 4)) {
+    return NULL;
+  }
+
+  ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+  ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+
+  anim->last_frame = ibuf;
+  ffmpeg_postprocess(anim);
+  anim->last_frame = last_frame;
+
+  return ibuf;
+}
+
+/** \} */
+
 static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_search)
 {
   /* there seem to exist *very* silly GOP lengths out in the wild... */
@@ -966,9 +1203,17 @@ static void ffmpeg_decode_video_frame_scan(struct anim *anim, int64_t pts_to_sea
            "  WHILE: pts=%lld in search of %lld\n",
            (long long int)anim->next_pts,
            (long long int)pts_to_search);
+    const int64_t frame_pts = anim->next_pts;
+    ImBuf *captured_frame = ffmpeg_reverse_cache_capture(anim);
+
     if (!ffmpeg_decode_video_frame(anim)) {
+      IMB_freeImBuf(captured_frame);
       break;
     }
+    if (captured_frame) {
+      ffmpeg_reverse_cache_add(
+          ffmpeg_decoder_owner(anim), captured_frame, frame_pts, anim->next_pts);
+    }
     count--;
   }
   if (count == 0) {
@@ -1029,40 +1274,37 @@ static int ffmpeg_seek_by_byte(AVFormatContext *pFormatCtx)
   return false;
 }
 
-static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+/* -------------------------------------------------------------------- */
+/** \name Frame Fetching
+ * \{ */
+
+typedef enum eFFmpegFetchMethod {
+  /* Requested frame is the last decoded one. */
+  FFMPEG_FETCH_REPEAT = 0,
+  /* Requested frame is the next one in the stream. */
+  FFMPEG_FETCH_CONTINUE,
+  /* Decode forward from the current position, which is not slower than seeking. */
+  FFMPEG_FETCH_SCAN,
+  /* Seek to a keyframe before the requested frame. */
+  FFMPEG_FETCH_SEEK,
+} eFFmpegFetchMethod;
+
+static int64_t ffmpeg_get_pts_to_search(struct anim *anim,
+                                        struct anim_index *tc_index,
+                                        int position)
 {
-  int64_t pts_to_search = 0;
-  double frame_rate;
-  double pts_time_base;
-  long long st_time;
-  struct anim_index *tc_index = 0;
-  AVStream *v_st;
-  int new_frame_index = 0; /* To quiet gcc barking... */
-  int old_frame_index = 0; /* To quiet gcc barking... */
-
-  if (anim == NULL) {
-    return (0);
-  }
-
-  av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: pos=%d\n", position);
-
-  if (tc != IMB_TC_NONE) {
-    tc_index = IMB_anim_open_index(anim, tc);
-  }
-
-  v_st = anim->pFormatCtx->streams[anim->videoStream];
-
-  frame_rate = av_q2d(av_guess_frame_rate(anim->pFormatCtx, v_st, NULL));
-
-  st_time = anim->pFormatCtx->start_time;
-  pts_time_base = av_q2d(v_st->time_base);
+  int64_t pts_to_search;
 
   if (tc_index) {
-    new_frame_index = IMB_indexer_get_frame_index(tc_index, position);
-    old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->curposition);
+    int new_frame_index = IMB_indexer_get_frame_index(tc_index, position);
     pts_to_search = IMB_indexer_get_pts(tc_index, new_frame_index);
   }
   else {
+    AVStream *v_st = anim->pFormatCtx->streams[anim->videoStream];
+    double frame_rate = av_q2d(av_guess_frame_rate(anim->pFormatCtx, v_st, NULL));
+    double pts_time_base = av_q2d(v_st->time_base);
+    long long st_time = anim->pFormatCtx->start_time;
+
     pts_to_search = (long long)floor(((double)position) / pts_time_base / frame_rate + 0.5);
 
     if (st_time != AV_NOPTS_VALUE) {
@@ -1070,63 +1312,97 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
     }
   }
 
-  av_log(anim->pFormatCtx,
-         AV_LOG_DEBUG,
-         "FETCH: looking for PTS=%lld "
-         "(pts_timebase=%g, frame_rate=%g, st_time=%lld)\n",
-         (long long int)pts_to_search,
-         pts_time_base,
-         frame_rate,
-         st_time);
+  return pts_to_search;
+}
 
+static eFFmpegFetchMethod ffmpeg_fetch_method_get(struct anim *anim,
+                                                  struct anim_index *tc_index,
+                                                  int position,
+                                                  int64_t pts_to_search)
+{
   if (anim->last_frame && anim->last_pts <= pts_to_search && anim->next_pts > pts_to_search) {
-    av_log(anim->pFormatCtx,
-           AV_LOG_DEBUG,
-           "FETCH: frame repeat: last: %lld next: %lld\n",
-           (long long int)anim->last_pts,
-           (long long int)anim->next_pts);
-    IMB_refImBuf(anim->last_frame);
-    anim->curposition = position;
-    return anim->last_frame;
+    return FFMPEG_FETCH_REPEAT;
   }
 
-  if (position > anim->curposition + 1 && anim->preseek && !tc_index &&
-      position - (anim->curposition + 1) < anim->preseek) {
-    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within preseek interval (no index)\n");
+  if (tc_index) {
+    int new_frame_index = IMB_indexer_get_frame_index(tc_index, position);
+    int old_frame_index = IMB_indexer_get_frame_index(tc_index, anim->decoder_position);
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    if (IMB_indexer_can_scan(tc_index, old_frame_index, new_frame_index)) {
+      return FFMPEG_FETCH_SCAN;
+    }
   }
-  else if (tc_index && IMB_indexer_can_scan(tc_index, old_frame_index, new_frame_index)) {
-    av_log(anim->pFormatCtx,
-           AV_LOG_DEBUG,
-           "FETCH: within preseek interval "
-           "(index tells us)\n");
+  else {
+    if (position > anim->decoder_position + 1 && anim->preseek &&
+        position - (anim->decoder_position + 1) < anim->preseek) {
+      return FFMPEG_FETCH_SCAN;
+    }
 
-    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+    /* No keyframe between the decoder and the requested frame. */
+    if (anim->next_pts != -1 && anim->next_pts <= pts_to_search) {
+      const AnimKeyframe *keyframe = ffmpeg_keyframe_index_find(anim->keyframe_index,
+                                                                pts_to_search);
+      if (keyframe && keyframe->pts <= anim->next_pts) {
+        return FFMPEG_FETCH_SCAN;
+      }
+    }
   }
-  else if (position != anim->curposition + 1) {
-    long long pos;
-    int ret;
 
-    if (tc_index) {
-      unsigned long long dts;
+  if (position != anim->decoder_position + 1) {
+    return FFMPEG_FETCH_SEEK;
+  }
 
-      pos = IMB_indexer_get_seek_pos(tc_index, new_frame_index);
-      dts = IMB_indexer_get_seek_pos_dts(tc_index, new_frame_index);
+  return FFMPEG_FETCH_CONTINUE;
+}
 
-      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "TC INDEX seek pos = %lld\n", pos);
-      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "TC INDEX seek dts = %llu\n", dts);
+static void ffmpeg_seek_and_scan(struct anim *anim,
+                                 struct anim_index *tc_index,
+                                 int position,
+                                 int64_t pts_to_search)
+{
+  AVStream *v_st = anim->pFormatCtx->streams[anim->videoStream];
+  double frame_rate = av_q2d(av_guess_frame_rate(anim->pFormatCtx, v_st, NULL));
+  long long st_time = anim->pFormatCtx->start_time;
+  bool is_keyframe_index_contiguous = false;
+  long long pos;
+  int ret;
 
-      if (ffmpeg_seek_by_byte(anim->pFormatCtx)) {
-        av_log(anim->pFormatCtx, AV_LOG_DEBUG, "... using BYTE pos\n");
+  if (tc_index) {
+    int new_frame_index = IMB_indexer_get_frame_index(tc_index, position);
+    unsigned long long dts;
 
-        ret = av_seek_frame(anim->pFormatCtx, -1, pos, AVSEEK_FLAG_BYTE);
-        av_update_cur_dts(anim->pFormatCtx, v_st, dts);
-      }
-      else {
-        av_log(anim->pFormatCtx, AV_LOG_DEBUG, "... using DTS pos\n");
-        ret = av_seek_frame(anim->pFormatCtx, anim->videoStream, dts, AVSEEK_FLAG_BACKWARD);
-      }
+    pos = IMB_indexer_get_seek_pos(tc_index, new_frame_index);
+    dts = IMB_indexer_get_seek_pos_dts(tc_index, new_frame_index);
+
+    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "TC INDEX seek pos = %lld\n", pos);
+    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "TC INDEX seek dts = %llu\n", dts);
+
+    if (ffmpeg_seek_by_byte(anim->pFormatCtx)) {
+      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "... using BYTE pos\n");
+
+      ret = av_seek_frame(anim->pFormatCtx, -1, pos, AVSEEK_FLAG_BYTE);
+      av_update_cur_dts(anim->pFormatCtx, v_st, dts);
+    }
+    else {
+      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "... using DTS pos\n");
+      ret = av_seek_frame(anim->pFormatCtx, anim->videoStream, dts, AVSEEK_FLAG_BACKWARD);
+    }
+  }
+  else {
+    const AnimKeyframe *keyframe = NULL;
+
+    /* Timestamps are not reliable enough for byte seeking formats. */
+    if (!ffmpeg_seek_by_byte(anim->pFormatCtx)) {
+      keyframe = ffmpeg_keyframe_index_find(anim->keyframe_index, pts_to_search);
+    }
+
+    if (keyframe) {
+      pos = keyframe->dts;
+
+      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "KEYFRAME INDEX seek dts = %lld\n", pos);
+
+      ret = av_seek_frame(anim->pFormatCtx, anim->videoStream, pos, AVSEEK_FLAG_BACKWARD);
+      is_keyframe_index_contiguous = true;
     }
     else {
       pos = (long long)(position - anim->preseek) * AV_TIME_BASE / frame_rate;
@@ -1149,40 +1425,82 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
       ret = av_seek_frame(anim->pFormatCtx, -1, pos, AVSEEK_FLAG_BACKWARD);
     }
+  }
 
-    if (ret < 0) {
-      av_log(anim->pFormatCtx,
-             AV_LOG_ERROR,
-             "FETCH: "
-             "error while seeking to DTS = %lld "
-             "(frameno = %d, PTS = %lld): errcode = %d\n",
-             pos,
-             position,
-             (long long int)pts_to_search,
-             ret);
-    }
+  if (ret < 0) {
+    av_log(anim->pFormatCtx,
+           AV_LOG_ERROR,
+           "FETCH: "
+           "error while seeking to DTS = %lld "
+           "(frameno = %d, PTS = %lld): errcode = %d\n",
+           pos,
+           position,
+           (long long int)pts_to_search,
+           ret);
+  }
 
-    avcodec_flush_buffers(anim->pCodecCtx);
+  /* Reading continues from a keyframe which is already in the index. */
+  anim->keyframe_index_contiguous = is_keyframe_index_contiguous && ret >= 0;
 
-    anim->next_pts = -1;
+  avcodec_flush_buffers(anim->pCodecCtx);
 
-    if (anim->next_packet.stream_index == anim->videoStream) {
-      av_free_packet(&anim->next_packet);
-      anim->next_packet.stream_index = -1;
-    }
+  anim->next_pts = -1;
 
-    /* memset(anim->pFrame, ...) ?? */
+  if (anim->next_packet.stream_index == anim->videoStream) {
+    av_free_packet(&anim->next_packet);
+    anim->next_packet.stream_index = -1;
+  }
 
-    if (ret >= 0) {
-      ffmpeg_decode_video_frame_scan(anim, pts_to_search);
-    }
+  /* memset(anim->pFrame, ...) ?? */
+
+  if (ret >= 0) {
+    ffmpeg_decode_video_frame_scan(anim, pts_to_search);
   }
-  else if (position == 0 && anim->curposition == -1) {
-    /* first frame without seeking special case... */
-    ffmpeg_decode_video_frame(anim);
+}
+
+static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, struct anim_index *tc_index)
+{
+  int64_t pts_to_search;
+
+  if (anim == NULL) {
+    return (0);
   }
-  else {
-    av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: no seek necessary, just continue...\n");
+
+  av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: pos=%d\n", position);
+
+  pts_to_search = ffmpeg_get_pts_to_search(anim, tc_index, position);
+
+  av_log(anim->pFormatCtx,
+         AV_LOG_DEBUG,
+         "FETCH: looking for PTS=%lld\n",
+         (long long int)pts_to_search);
+
+  switch (ffmpeg_fetch_method_get(anim, tc_index, position, pts_to_search)) {
+    case FFMPEG_FETCH_REPEAT:
+      av_log(anim->pFormatCtx,
+             AV_LOG_DEBUG,
+             "FETCH: frame repeat: last: %lld next: %lld\n",
+             (long long int)anim->last_pts,
+             (long long int)anim->next_pts);
+      IMB_refImBuf(anim->last_frame);
+      anim->decoder_position = position;
+      return anim->last_frame;
+    case FFMPEG_FETCH_SCAN:
+      av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: within preseek interval\n");
+      ffmpeg_decode_video_frame_scan(anim, pts_to_search);
+      break;
+    case FFMPEG_FETCH_SEEK:
+      ffmpeg_seek_and_scan(anim, tc_index, position, pts_to_search);
+      break;
+    case FFMPEG_FETCH_CONTINUE:
+      if (anim->decoder_position == -1) {
+        /* first frame without seeking special case... */
+        ffmpeg_decode_video_frame(anim);
+      }
+      else {
+        av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: no seek necessary, just continue...\n");
+      }
+      break;
   }
 
   IMB_freeImBuf(anim->last_frame);
@@ -1195,13 +1513,195 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
 
   ffmpeg_decode_video_frame(anim);
 
-  anim->curposition = position;
+  anim->decoder_position = position;
 
   IMB_refImBuf(anim->last_frame);
 
   return anim->last_frame;
 }
 
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Decoder Pool
+ *
+ * Scrubbing jumps between a few places of the movie. Instead of seeking one decoder back
+ * and forth, a few decoders stay at the keyframe intervals they were used for, and the one
+ * which can reach the requested frame with the least decoding is used.
+ * \{ */
+
+/* Frame buffers of a decoder, the decoded, converted and last frame. Memory used internally by
+ * the codec is not known. */
+static size_t ffmpeg_decoder_memory_size(const struct anim *anim)
+{
+  return (size_t)anim->x * anim->y * 4 * 3;
+}
+
+static struct anim *ffmpeg_decoder_pool_add(struct anim *anim, int slot)
+{
+  const size_t size = ffmpeg_decoder_memory_size(anim);
+  if (!ffmpeg_decoder_memory_fits(size)) {
+    return NULL;
+  }
+
+  struct anim *decoder = IMB_open_anim(
+      anim->name, anim->ib_flags, anim->streamindex, anim->colorspace);
+  ImBuf *ibuf;
+
+  decoder->decoder_owner = anim;
+  decoder->keyframe_index = anim->keyframe_index;
+
+  ibuf = anim_getnew(decoder);
+  if (ibuf == NULL || decoder->curtype != ANIM_FFMPEG) {
+    IMB_freeImBuf(ibuf);
+    IMB_free_anim(decoder);
+    return NULL;
+  }
+  IMB_freeImBuf(ibuf);
+
+  /* Use same playback settings as the main decoder. */
+  decoder->preseek = anim->preseek;
+
+  decoder->decoder_memory = size;
+  ffmpeg_decoder_memory_add(size);
+
+  anim->decoder_pool[slot] = decoder;
+  return decoder;
+}
+
+static void ffmpeg_decoder_pool_free(struct anim *anim)
+{
+  for (int i = 0; i < ANIM_DECODER_POOL_SIZE; i++) {
+    if (anim->decoder_pool[i]) {
+      ffmpeg_decoder_memory_remove(anim->decoder_pool[i]->decoder_memory);
+      IMB_free_anim(anim->decoder_pool[i]);
+      anim->decoder_pool[i] = NULL;
+    }
+  }
+}
+
+static int ffmpeg_fetch_method_cost(struct anim *decoder, eFFmpegFetchMethod method, int position)
+{
+  switch (method) {
+    case FFMPEG_FETCH_REPEAT:
+      return 0;
+    case FFMPEG_FETCH_CONTINUE:
+      return 1;
+    case FFMPEG_FETCH_SCAN:
+      return 1 + abs(position - decoder->decoder_position);
+    case FFMPEG_FETCH_SEEK:
+      break;
+  }
+  return INT_MAX;
+}
+
+static struct anim *ffmpeg_decoder_pool_get(struct anim *anim,
+                                            struct anim_index *tc_index,
+                                            int position,
+                                            int64_t pts_to_search,
+                                            bool is_backward_step,
+                                            eFFmpegFetchMethod *r_method)
+{
+  struct anim *best_decoder = NULL, *unused_decoder = NULL;
+  struct anim *lru_decoder = NULL, *mru_decoder = NULL;
+  eFFmpegFetchMethod best_method = FFMPEG_FETCH_SEEK;
+  int best_cost = INT_MAX, free_slot = -1;
+
+  for (int i = -1; i < ANIM_DECODER_POOL_SIZE; i++) {
+    struct anim *decoder = (i == -1) ? anim : anim->decoder_pool[i];
+
+    if (decoder == NULL) {
+      if (free_slot == -1) {
+        free_slot = i;
+      }
+      continue;
+    }
+
+    const eFFmpegFetchMethod method = ffmpeg_fetch_method_get(
+        decoder, tc_index, position, pts_to_search);
+    const int cost = ffmpeg_fetch_method_cost(decoder, method, position);
+
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_decoder = decoder;
+      best_method = method;
+    }
+    if (decoder->decoder_position == -1 && unused_decoder == NULL) {
+      unused_decoder = decoder;
+    }
+    if (lru_decoder == NULL || decoder->decoder_last_used < lru_decoder->decoder_last_used) {
+      lru_decoder = decoder;
+    }
+    if (mru_decoder == NULL || decoder->decoder_last_used > mru_decoder->decoder_last_used) {
+      mru_decoder = decoder;
+    }
+  }
+
+  if (best_decoder == NULL) {
+    /* Seeking is needed, keep decoders which are in use at their positions. Playing
+     * backwards, position of the last used decoder is not going to be needed again. */
+    if (is_backward_step) {
+      best_decoder = mru_decoder;
+    }
+    else if (unused_decoder) {
+      best_decoder = unused_decoder;
+    }
+    else if (free_slot != -1) {
+      best_decoder = ffmpeg_decoder_pool_add(anim, free_slot);
+    }
+    if (best_decoder == NULL) {
+      best_decoder = lru_decoder;
+    }
+  }
+
+  best_decoder->decoder_last_used = ++anim->decoder_clock;
+  *r_method = best_method;
+  return best_decoder;
+}
+
+static ImBuf *ffmpeg_fetchibuf_pooled(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  struct anim_index *tc_index = NULL;
+  struct anim *decoder;
+  eFFmpegFetchMethod method;
+  int64_t pts_to_search;
+  bool is_backward_step;
+  ImBuf *ibuf;
+
+  if (tc != IMB_TC_NONE) {
+    tc_index = IMB_anim_open_index(anim, tc);
+  }
+
+  pts_to_search = ffmpeg_get_pts_to_search(anim, tc_index, position);
+
+  ibuf = ffmpeg_reverse_cache_get(anim, pts_to_search);
+  if (ibuf) {
+    anim->last_requested_position = position;
+    return ibuf;
+  }
+
+  is_backward_step = (position < anim->last_requested_position &&
+                      anim->last_requested_position - position <= ANIM_REVERSE_CACHE_SIZE);
+
+  decoder = ffmpeg_decoder_pool_get(
+      anim, tc_index, position, pts_to_search, is_backward_step, &method);
+
+  /* Keep frames before the requested one while decoding towards it. */
+  if (method == FFMPEG_FETCH_SEEK && is_backward_step) {
+    decoder->reverse_capture_pts = ffmpeg_get_pts_to_search(
+        anim, tc_index, max_ii(0, position - ANIM_REVERSE_CACHE_SIZE));
+  }
+
+  ibuf = ffmpeg_fetchibuf(decoder, position, tc_index);
+
+  decoder->reverse_capture_pts = AV_NOPTS_VALUE;
+  anim->last_requested_position = position;
+
+  return ibuf;
+}
+
+/** \} */
+
 static void free_anim_ffmpeg(struct anim *anim)
 {
   if (anim == NULL) {
@@ -1236,6 +1736,17 @@ static void free_anim_ffmpeg(struct anim *anim)
       av_free_packet(&anim->next_packet);
     }
   }
+
+  if (anim->decoder_owner == NULL) {
+    ffmpeg_decoder_pool_free(anim);
+    ffmpeg_reverse_cache_free(anim);
+
+    if (anim->keyframe_index) {
+      ffmpeg_keyframe_index_free(anim->keyframe_index);
+      anim->keyframe_index = NULL;
+    }
+  }
+
   anim->duration_in_frames = 0;
 }
 
@@ -1388,7 +1899,8 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
 #endif
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
-      ibuf = ffmpeg_fetchibuf(anim, position, tc);
+      /* Pooled decoders track their own position in decoder_position. */
+      ibuf = ffmpeg_fetchibuf_pooled(anim, position, tc);
       if (ibuf) {
         anim->curposition = position;
       }
@@ -1401,7 +1913,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
     if (filter_y) {
       IMB_filtery(ibuf);
     }
-    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
   }
   return (ibuf);
 }
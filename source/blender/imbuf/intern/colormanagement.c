@@ -32,6 +32,7 @@
 #include "DNA_movieclip_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 
 #include "IMB_filetype.h"
 #include "IMB_filter.h"
@@ -60,6 +61,10 @@
 
 #include <ocio_capi.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /*********************** Global declarations *************************/
 
 #define DISPLAY_BUFFER_CHANNELS 4
@@ -97,12 +102,40 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
  */
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
+/* Display transform baked into a 3D LUT, see #display_lut_acquire. */
+typedef struct ColormanageDisplayLUT {
+  struct ColormanageDisplayLUT *next, *prev;
+
+  /* Settings the LUT was baked for. */
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  float exposure, gamma;
+
+  /* Number of processors using this LUT. */
+  int users;
+  bool is_cached;
+
+  /* RGBA per grid point, alpha is padding to allow aligned SIMD loads. */
+  float *table;
+} ColormanageDisplayLUT;
+
 typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
+  ColormanageDisplayLUT *display_lut;
   CurveMapping *curve_mapping;
   bool is_data_result;
 } ColormanageProcessor;
 
+/* Most recently used baked display transforms, protected by display_lut_lock. */
+static ListBase global_display_luts = {NULL, NULL};
+static pthread_mutex_t display_lut_lock = BLI_MUTEX_INITIALIZER;
+
+static void display_lut_free_all(void);
+static ColormanageProcessor *display_buffer_processor_new(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings);
+
 static struct global_glsl_state {
   /* Actual processor used for GLSL baked LUTs. */
   /* UI colorspace here refers to the display linear color space,
@@ -209,6 +242,7 @@ typedef struct ColormanageCacheViewSettings {
   float gamma;
   float dither;
   CurveMapping *curve_mapping;
+  bool use_display_lut;
 } ColormanageCacheViewSettings;
 
 typedef struct ColormanageCacheDisplaySettings {
@@ -228,6 +262,7 @@ typedef struct ColormanageCacheData {
   float dither;                /* dither value cached buffer is calculated with */
   CurveMapping *curve_mapping; /* curve mapping used for cached buffer */
   int curve_mapping_timestamp; /* time stamp of curve mapping used for cached buffer */
+  bool use_display_lut;        /* buffer was calculated with baked display transform LUT */
 } ColormanageCacheData;
 
 typedef struct ColormanageCache {
@@ -284,6 +319,7 @@ static struct MovieCache *colormanage_moviecache_ensure(ImBuf *ibuf)
                                        sizeof(ColormanageCacheKey),
                                        colormanage_hashhash,
                                        colormanage_hashcmp);
+    IMB_moviecache_set_consumer(moviecache, MOVIECACHE_CONSUMER_DISPLAY);
 
     ibuf->colormanage_cache->moviecache = moviecache;
   }
@@ -314,6 +350,7 @@ static void colormanage_view_settings_to_cache(ImBuf *ibuf,
   cache_view_settings->dither = ibuf->dither;
   cache_view_settings->flag = view_settings->flag;
   cache_view_settings->curve_mapping = view_settings->curve_mapping;
+  cache_view_settings->use_display_lut = (U.flag & USER_DISPLAY_TRANSFORM_LUT) != 0;
 }
 
 static void colormanage_display_settings_to_cache(
@@ -394,7 +431,8 @@ static unsigned char *colormanage_cache_get(
         cache_data->exposure != view_settings->exposure ||
         cache_data->gamma != view_settings->gamma || cache_data->dither != view_settings->dither ||
         cache_data->flag != view_settings->flag || cache_data->curve_mapping != curve_mapping ||
-        cache_data->curve_mapping_timestamp != curve_mapping_timestamp) {
+        cache_data->curve_mapping_timestamp != curve_mapping_timestamp ||
+        cache_data->use_display_lut != view_settings->use_display_lut) {
       *cache_handle = NULL;
 
       IMB_freeImBuf(cache_ibuf);
@@ -444,6 +482,7 @@ static void colormanage_cache_put(ImBuf *ibuf,
   cache_data->flag = view_settings->flag;
   cache_data->curve_mapping = curve_mapping;
   cache_data->curve_mapping_timestamp = curve_mapping_timestamp;
+  cache_data->use_display_lut = view_settings->use_display_lut;
 
   colormanage_cachedata_set(cache_ibuf, cache_data);
 
@@ -635,6 +674,9 @@ static void colormanage_free_config(void)
   BLI_listbase_clear(&global_displays);
   global_tot_display = 0;
 
+  /* free baked display transforms */
+  display_lut_free_all();
+
   /* free views */
   BLI_freelistN(&global_views);
   global_tot_view = 0;
@@ -1785,7 +1827,8 @@ static void colormanage_display_buffer_process_ex(
     float *display_buffer,
     unsigned char *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
-    const ColorManagedDisplaySettings *display_settings)
+    const ColorManagedDisplaySettings *display_settings,
+    const bool is_for_drawing)
 {
   ColormanageProcessor *cm_processor = NULL;
   bool skip_transform = false;
@@ -1800,7 +1843,12 @@ static void colormanage_display_buffer_process_ex(
   }
 
   if (skip_transform == false) {
-    cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+    if (is_for_drawing) {
+      cm_processor = display_buffer_processor_new(view_settings, display_settings);
+    }
+    else {
+      cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1821,7 +1869,7 @@ static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                const ColorManagedDisplaySettings *display_settings)
 {
   colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+      ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /*********************** Threaded processor transform routines *************************/
@@ -2482,8 +2530,12 @@ static void colormanagement_imbuf_make_display_space(
     imb_addrectImBuf(ibuf);
   }
 
-  colormanage_display_buffer_process_ex(
-      ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect, view_settings, display_settings);
+  colormanage_display_buffer_process_ex(ibuf,
+                                        ibuf->rect_float,
+                                        (unsigned char *)ibuf->rect,
+                                        view_settings,
+                                        display_settings,
+                                        false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(
@@ -3631,7 +3683,7 @@ static void imb_partial_display_buffer_update_ex(
     }
 
     if (!skip_transform) {
-      cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+      cm_processor = display_buffer_processor_new(view_settings, display_settings);
     }
 
     if (do_threads) {
@@ -3747,11 +3799,271 @@ void IMB_partial_display_buffer_update_delayed(ImBuf *ibuf, int xmin, int ymin,
   }
 }
 
-/*********************** Pixel processor functions *************************/
+/*********************** Baked display transform *************************/
 
-ColormanageProcessor *IMB_colormanagement_display_processor_new(
+/* Display transforms of some configurations (Filmic with looks, for example) are expensive to
+ * evaluate per pixel. For drawing they can optionally be baked into a 3D LUT which is indexed
+ * by a log2 shaper of scene linear values and evaluated with tetrahedral interpolation.
+ * LUTs are cached for the most recently used view/display/look/exposure/gamma combinations. */
+
+#define DISPLAY_LUT_SIZE 64
+#define DISPLAY_LUT_CACHE_MAX 4
+
+/* Shaper maps [0 .. 2^DISPLAY_LUT_LOG_MAX] scene linear range to [0 .. 1],
+ * DISPLAY_LUT_LOG_MIN defines the smallest value with distinct precision. */
+#define DISPLAY_LUT_LOG_MIN -14.0f
+#define DISPLAY_LUT_LOG_MAX 10.0f
+
+BLI_INLINE float display_lut_shaper(float value)
+{
+  const float eps = exp2f(DISPLAY_LUT_LOG_MIN);
+  const float range = DISPLAY_LUT_LOG_MAX - DISPLAY_LUT_LOG_MIN;
+  return (log2f(max_ff(value, 0.0f) + eps) - DISPLAY_LUT_LOG_MIN) / range;
+}
+
+BLI_INLINE float display_lut_shaper_inverse(float value)
+{
+  const float eps = exp2f(DISPLAY_LUT_LOG_MIN);
+  const float range = DISPLAY_LUT_LOG_MAX - DISPLAY_LUT_LOG_MIN;
+  return exp2f(value * range + DISPLAY_LUT_LOG_MIN) - eps;
+}
+
+static bool display_lut_matches(const ColormanageDisplayLUT *lut,
+                                const ColorManagedViewSettings *view_settings,
+                                const ColorManagedDisplaySettings *display_settings)
+{
+  return STREQ(lut->look, view_settings->look) &&
+         STREQ(lut->view, view_settings->view_transform) &&
+         STREQ(lut->display, display_settings->display_device) &&
+         lut->exposure == view_settings->exposure && lut->gamma == view_settings->gamma;
+}
+
+static ColormanageDisplayLUT *display_lut_bake(const ColorManagedViewSettings *view_settings,
+                                               const ColorManagedDisplaySettings *display_settings)
+{
+  const int size = DISPLAY_LUT_SIZE;
+  OCIO_ConstProcessorRcPtr *processor = create_display_buffer_processor(
+      view_settings->look,
+      view_settings->view_transform,
+      display_settings->display_device,
+      view_settings->exposure,
+      view_settings->gamma,
+      global_role_scene_linear,
+      false);
+
+  if (processor == NULL) {
+    return NULL;
+  }
+
+  ColormanageDisplayLUT *lut = MEM_callocN(sizeof(ColormanageDisplayLUT), "display lut");
+  STRNCPY(lut->look, view_settings->look);
+  STRNCPY(lut->view, view_settings->view_transform);
+  STRNCPY(lut->display, display_settings->display_device);
+  lut->exposure = view_settings->exposure;
+  lut->gamma = view_settings->gamma;
+  lut->table = MEM_mallocN(sizeof(float[4]) * size * size * size, "display lut table");
+
+  float grid[DISPLAY_LUT_SIZE];
+  for (int i = 0; i < size; i++) {
+    grid[i] = display_lut_shaper_inverse((float)i / (size - 1));
+  }
+
+  float *value = lut->table;
+  for (int b = 0; b < size; b++) {
+    for (int g = 0; g < size; g++) {
+      for (int r = 0; r < size; r++, value += 4) {
+        value[0] = grid[r];
+        value[1] = grid[g];
+        value[2] = grid[b];
+        value[3] = 1.0f;
+      }
+    }
+  }
+
+  /* Evaluate exact transform for every grid point at once, one grid slice per scan-line. */
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(lut->table,
+                                                              size * size,
+                                                              size,
+                                                              4,
+                                                              sizeof(float),
+                                                              4 * sizeof(float),
+                                                              4 * sizeof(float) * size * size);
+  OCIO_processorApply(processor, img);
+  OCIO_PackedImageDescRelease(img);
+  OCIO_processorRelease(processor);
+
+  return lut;
+}
+
+static void display_lut_free(ColormanageDisplayLUT *lut)
+{
+  MEM_freeN(lut->table);
+  MEM_freeN(lut);
+}
+
+static ColormanageDisplayLUT *display_lut_acquire(
     const ColorManagedViewSettings *view_settings,
     const ColorManagedDisplaySettings *display_settings)
+{
+  ColormanageDisplayLUT *lut;
+
+  BLI_mutex_lock(&display_lut_lock);
+
+  for (lut = global_display_luts.first; lut; lut = lut->next) {
+    if (display_lut_matches(lut, view_settings, display_settings)) {
+      break;
+    }
+  }
+
+  if (lut) {
+    /* Keep most recently used first. */
+    BLI_remlink(&global_display_luts, lut);
+  }
+  else {
+    lut = display_lut_bake(view_settings, display_settings);
+  }
+
+  if (lut) {
+    BLI_addhead(&global_display_luts, lut);
+    lut->is_cached = true;
+    lut->users++;
+
+    /* Evict least recently used LUTs, the ones still in use are freed on release. */
+    int num_luts = BLI_listbase_count(&global_display_luts);
+    ColormanageDisplayLUT *lut_evict = global_display_luts.last;
+    while (num_luts > DISPLAY_LUT_CACHE_MAX && lut_evict != lut) {
+      ColormanageDisplayLUT *lut_prev = lut_evict->prev;
+      BLI_remlink(&global_display_luts, lut_evict);
+      lut_evict->is_cached = false;
+      if (lut_evict->users == 0) {
+        display_lut_free(lut_evict);
+      }
+      lut_evict = lut_prev;
+      num_luts--;
+    }
+  }
+
+  BLI_mutex_unlock(&display_lut_lock);
+
+  return lut;
+}
+
+static void display_lut_release(ColormanageDisplayLUT *lut)
+{
+  BLI_mutex_lock(&display_lut_lock);
+  lut->users--;
+  if (lut->users == 0 && !lut->is_cached) {
+    display_lut_free(lut);
+  }
+  BLI_mutex_unlock(&display_lut_lock);
+}
+
+static void display_lut_free_all(void)
+{
+  BLI_mutex_lock(&display_lut_lock);
+  LISTBASE_FOREACH_MUTABLE (ColormanageDisplayLUT *, lut, &global_display_luts) {
+    BLI_remlink(&global_display_luts, lut);
+    lut->is_cached = false;
+    if (lut->users == 0) {
+      display_lut_free(lut);
+    }
+  }
+  BLI_mutex_unlock(&display_lut_lock);
+}
+
+/* Tetrahedral interpolation of the LUT, alpha is passed through. */
+static void display_lut_apply_rgb(const ColormanageDisplayLUT *lut, float pixel[3])
+{
+  const int size = DISPLAY_LUT_SIZE;
+  const int stride_g = size, stride_b = size * size;
+  float f[3];
+  int index = 0, strides[3] = {1, stride_g, stride_b};
+
+  for (int i = 0; i < 3; i++) {
+    const float coord = clamp_f(display_lut_shaper(pixel[i]), 0.0f, 1.0f) * (size - 1);
+    const int cell = min_ii((int)coord, size - 2);
+    f[i] = coord - cell;
+    index += cell * strides[i];
+  }
+
+  /* Walk from c000 to c111 along edges ordered by the largest fractional coordinate. */
+  int order[3] = {0, 1, 2};
+  if (f[order[0]] < f[order[1]]) {
+    SWAP(int, order[0], order[1]);
+  }
+  if (f[order[1]] < f[order[2]]) {
+    SWAP(int, order[1], order[2]);
+  }
+  if (f[order[0]] < f[order[1]]) {
+    SWAP(int, order[0], order[1]);
+  }
+
+  const float *c0 = lut->table + 4 * (size_t)index;
+  const float *c1 = c0 + 4 * strides[order[0]];
+  const float *c2 = c1 + 4 * strides[order[1]];
+  const float *c3 = c2 + 4 * strides[order[2]];
+  const float w0 = 1.0f - f[order[0]];
+  const float w1 = f[order[0]] - f[order[1]];
+  const float w2 = f[order[1]] - f[order[2]];
+  const float w3 = f[order[2]];
+
+#ifdef __SSE2__
+  __m128 result = _mm_mul_ps(_mm_set1_ps(w0), _mm_loadu_ps(c0));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w1), _mm_loadu_ps(c1)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w2), _mm_loadu_ps(c2)));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(w3), _mm_loadu_ps(c3)));
+  float result_v4[4];
+  _mm_storeu_ps(result_v4, result);
+  copy_v3_v3(pixel, result_v4);
+#else
+  for (int i = 0; i < 3; i++) {
+    pixel[i] = w0 * c0[i] + w1 * c1[i] + w2 * c2[i] + w3 * c3[i];
+  }
+#endif
+}
+
+static void display_lut_apply_rgba_predivide(const ColormanageDisplayLUT *lut, float pixel[4])
+{
+  if (pixel[3] == 1.0f || pixel[3] == 0.0f) {
+    display_lut_apply_rgb(lut, pixel);
+  }
+  else {
+    const float alpha = pixel[3];
+    const float inv_alpha = 1.0f / alpha;
+    mul_v3_fl(pixel, inv_alpha);
+    display_lut_apply_rgb(lut, pixel);
+    mul_v3_fl(pixel, alpha);
+  }
+}
+
+static void display_lut_apply(const ColormanageDisplayLUT *lut,
+                              float *buffer,
+                              int width,
+                              int height,
+                              int channels,
+                              bool predivide)
+{
+  const size_t num_pixels = (size_t)width * height;
+  float *pixel = buffer;
+
+  if (predivide && channels == 4) {
+    for (size_t i = 0; i < num_pixels; i++, pixel += channels) {
+      display_lut_apply_rgba_predivide(lut, pixel);
+    }
+  }
+  else {
+    for (size_t i = 0; i < num_pixels; i++, pixel += channels) {
+      display_lut_apply_rgb(lut, pixel);
+    }
+  }
+}
+
+/*********************** Pixel processor functions *************************/
+
+static ColormanageProcessor *colormanage_display_processor_new_ex(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    const bool use_lut)
 {
   ColormanageProcessor *cm_processor;
   ColorManagedViewSettings default_view_settings;
@@ -3773,13 +4085,20 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
     cm_processor->is_data_result = display_space->is_data;
   }
 
-  cm_processor->processor = create_display_buffer_processor(applied_view_settings->look,
-                                                            applied_view_settings->view_transform,
-                                                            display_settings->display_device,
-                                                            applied_view_settings->exposure,
-                                                            applied_view_settings->gamma,
-                                                            global_role_scene_linear,
-                                                            false);
+  if (use_lut) {
+    cm_processor->display_lut = display_lut_acquire(applied_view_settings, display_settings);
+  }
+
+  if (cm_processor->display_lut == NULL) {
+    cm_processor->processor = create_display_buffer_processor(
+        applied_view_settings->look,
+        applied_view_settings->view_transform,
+        display_settings->display_device,
+        applied_view_settings->exposure,
+        applied_view_settings->gamma,
+        global_role_scene_linear,
+        false);
+  }
 
   if (applied_view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
     cm_processor->curve_mapping = BKE_curvemapping_copy(applied_view_settings->curve_mapping);
@@ -3789,6 +4108,32 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
   return cm_processor;
 }
 
+ColormanageProcessor *IMB_colormanagement_display_processor_new(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  return colormanage_display_processor_new_ex(view_settings, display_settings, false);
+}
+
+/* Same as #IMB_colormanagement_display_processor_new, but the display transform is baked into
+ * a cached 3D LUT. Faster for expensive transforms at the cost of slight loss of accuracy, so
+ * only meant to be used for drawing. */
+ColormanageProcessor *IMB_colormanagement_display_lut_processor_new(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  return colormanage_display_processor_new_ex(view_settings, display_settings, true);
+}
+
+/* Processor for display buffers which are used for drawing. */
+static ColormanageProcessor *display_buffer_processor_new(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings)
+{
+  const bool use_lut = (U.flag & USER_DISPLAY_TRANSFORM_LUT) != 0;
+  return colormanage_display_processor_new_ex(view_settings, display_settings, use_lut);
+}
+
 ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(const char *from_colorspace,
                                                                    const char *to_colorspace)
 {
@@ -3811,7 +4156,10 @@ void IMB_colormanagement_processor_apply_v4(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    display_lut_apply_rgb(cm_processor->display_lut, pixel);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGBA(cm_processor->processor, pixel);
   }
 }
@@ -3823,7 +4171,10 @@ void IMB_colormanagement_processor_apply_v4_predivide(ColormanageProcessor *cm_p
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    display_lut_apply_rgba_predivide(cm_processor->display_lut, pixel);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGBA_predivide(cm_processor->processor, pixel);
   }
 }
@@ -3834,7 +4185,10 @@ void IMB_colormanagement_processor_apply_v3(ColormanageProcessor *cm_processor,
     BKE_curvemapping_evaluate_premulRGBF(cm_processor->curve_mapping, pixel, pixel);
   }
 
-  if (cm_processor->processor) {
+  if (cm_processor->display_lut) {
+    display_lut_apply_rgb(cm_processor->display_lut, pixel);
+  }
+  else if (cm_processor->processor) {
     OCIO_processorApplyRGB(cm_processor->processor, pixel);
   }
 }
@@ -3880,7 +4234,10 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->processor && channels >= 3) {
+  if (cm_processor->display_lut && channels >= 3) {
+    display_lut_apply(cm_processor->display_lut, buffer, width, height, channels, predivide);
+  }
+  else if (cm_processor->processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3929,6 +4286,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->processor) {
     OCIO_processorRelease(cm_processor->processor);
   }
+  if (cm_processor->display_lut) {
+    display_lut_release(cm_processor->display_lut);
+  }
 
   MEM_freeN(cm_processor);
 }
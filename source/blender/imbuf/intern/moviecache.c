@@ -23,13 +23,18 @@
 
 #undef DEBUG_MESSAGES
 
+#include <limits.h>
 #include <memory.h>
+#include <stdio.h>
 #include <stdlib.h> /* for qsort */
 
 #include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_ghash.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -53,9 +58,33 @@
 static MEM_CacheLimiterC *limitor = NULL;
 static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
 
+typedef struct MovieCacheConsumer {
+  const char *name;
+  /* Share of the cache memory limit which is guaranteed to this consumer. */
+  float quota_factor;
+  /* Consumer manages its own storage, its items are not in the limiter. */
+  bool is_external;
+
+  size_t memory_in_use;
+  int32_t items;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+} MovieCacheConsumer;
+
+static MovieCacheConsumer consumers[MOVIECACHE_CONSUMER_TOT] = {
+    {"Image", 0.3f, false},
+    {"Movie Clip", 0.25f, false},
+    {"Display Buffers", 0.1f, false},
+    {"Sequencer", 0.3f, true},
+    {"Movie Decoders", 0.05f, true},
+};
+
 typedef struct MovieCache {
   char name[64];
 
+  eMovieCacheConsumer consumer;
+
   GHash *hash;
   GHashHashFP hashfp;
   GHashCmpFP cmpfp;
@@ -87,8 +116,159 @@ typedef struct MovieCacheItem {
   ImBuf *ibuf;
   MEM_CacheLimiterHandleC *c_handle;
   void *priority_data;
+  /* Size accounted to the consumer when the item was added. */
+  size_t consumer_size;
 } MovieCacheItem;
 
+/* -------------------------------------------------------------------- */
+/** \name Cache Consumers
+ *
+ * All caches share the memory limit from the user preferences. Buffers which belong to the
+ * consumers stored in this cache are managed by the cache limiter, external consumers only
+ * report memory they use. The part of the external memory which fits into the quota is
+ * reserved, so movie cache buffers are freed to make room for it. External consumers are
+ * limited by their quota or by the memory nobody else uses, whichever is larger.
+ * \{ */
+
+static size_t consumer_quota_get(eMovieCacheConsumer consumer)
+{
+  return (size_t)((double)MEM_CacheLimiter_get_maximum() * consumers[consumer].quota_factor);
+}
+
+static bool consumer_is_over_quota(eMovieCacheConsumer consumer)
+{
+  return consumers[consumer].memory_in_use > consumer_quota_get(consumer);
+}
+
+static size_t consumer_external_memory_reserved(void)
+{
+  size_t reserved = 0;
+
+  for (int i = 0; i < MOVIECACHE_CONSUMER_TOT; i++) {
+    if (consumers[i].is_external) {
+      reserved += min_zz(consumers[i].memory_in_use, consumer_quota_get(i));
+    }
+  }
+
+  return reserved;
+}
+
+/* Limit for the memory used by buffers in the cache limiter. */
+static size_t moviecache_memory_limit(void)
+{
+  const size_t max = MEM_CacheLimiter_get_maximum();
+  const size_t reserved = consumer_external_memory_reserved();
+
+  if (max == 0) {
+    /* No limit at all. */
+    return 0;
+  }
+
+  /* Zero would disable the limit, so keep at least a byte. */
+  return (reserved < max) ? max - reserved : 1;
+}
+
+static void consumer_item_add(eMovieCacheConsumer consumer, size_t size)
+{
+  atomic_add_and_fetch_z(&consumers[consumer].memory_in_use, size);
+  atomic_add_and_fetch_int32(&consumers[consumer].items, 1);
+}
+
+static void consumer_item_remove(eMovieCacheConsumer consumer, size_t size)
+{
+  atomic_sub_and_fetch_z(&consumers[consumer].memory_in_use, size);
+  atomic_sub_and_fetch_int32(&consumers[consumer].items, 1);
+}
+
+void IMB_moviecache_consumer_memory_add(eMovieCacheConsumer consumer, size_t size)
+{
+  consumer_item_add(consumer, size);
+}
+
+void IMB_moviecache_consumer_memory_remove(eMovieCacheConsumer consumer, size_t size)
+{
+  consumer_item_remove(consumer, size);
+}
+
+void IMB_moviecache_consumer_tag_lookup(eMovieCacheConsumer consumer, bool is_hit)
+{
+  if (is_hit) {
+    atomic_add_and_fetch_uint64(&consumers[consumer].hits, 1);
+  }
+  else {
+    atomic_add_and_fetch_uint64(&consumers[consumer].misses, 1);
+  }
+}
+
+void IMB_moviecache_consumer_tag_evicted(eMovieCacheConsumer consumer, int count)
+{
+  atomic_add_and_fetch_uint64(&consumers[consumer].evictions, (uint64_t)count);
+}
+
+/* Memory the consumer is allowed to use now. */
+size_t IMB_moviecache_consumer_memory_limit(eMovieCacheConsumer consumer)
+{
+  const size_t max = MEM_CacheLimiter_get_maximum();
+  size_t used_by_others = 0;
+
+  if (max == 0) {
+    return SIZE_MAX;
+  }
+
+  for (int i = 0; i < MOVIECACHE_CONSUMER_TOT; i++) {
+    if (i != consumer) {
+      used_by_others += consumers[i].memory_in_use;
+    }
+  }
+
+  const size_t available = (used_by_others < max) ? max - used_by_others : 0;
+  return max_zz(consumer_quota_get(consumer), available);
+}
+
+void IMB_moviecache_consumer_quota_set(eMovieCacheConsumer consumer, float factor)
+{
+  CLAMP(factor, 0.0f, 1.0f);
+  consumers[consumer].quota_factor = factor;
+}
+
+void IMB_moviecache_consumer_stats_get(eMovieCacheConsumer consumer, MovieCacheStats *r_stats)
+{
+  const MovieCacheConsumer *data = &consumers[consumer];
+
+  r_stats->name = data->name;
+  r_stats->hits = data->hits;
+  r_stats->misses = data->misses;
+  r_stats->evictions = data->evictions;
+  r_stats->memory_in_use = data->memory_in_use;
+  r_stats->memory_quota = consumer_quota_get(consumer);
+  r_stats->items = data->items;
+}
+
+void IMB_moviecache_print_stats(void)
+{
+  printf("\nImage buffer cache statistics (limit %.1f MB)\n",
+         (double)MEM_CacheLimiter_get_maximum() / (1024.0 * 1024.0));
+
+  for (int i = 0; i < MOVIECACHE_CONSUMER_TOT; i++) {
+    MovieCacheStats stats;
+    IMB_moviecache_consumer_stats_get(i, &stats);
+
+    const uint64_t lookups = stats.hits + stats.misses;
+    printf("  %-16s %8.1f MB of %8.1f MB quota, %6d items, ",
+           stats.name,
+           (double)stats.memory_in_use / (1024.0 * 1024.0),
+           (double)stats.memory_quota / (1024.0 * 1024.0),
+           stats.items);
+    printf("%llu hits, %llu misses (%.1f%% hit rate), %llu evictions\n",
+           (unsigned long long)stats.hits,
+           (unsigned long long)stats.misses,
+           lookups ? 100.0 * (double)stats.hits / (double)lookups : 0.0,
+           (unsigned long long)stats.evictions);
+  }
+}
+
+/** \} */
+
 static unsigned int moviecache_hashhash(const void *keyv)
 {
   const MovieCacheKey *key = keyv;
@@ -123,6 +303,7 @@ static void moviecache_valfree(void *val)
   if (item->ibuf) {
     MEM_CacheLimiter_unmanage(item->c_handle);
     IMB_freeImBuf(item->ibuf);
+    consumer_item_remove(cache->consumer, item->consumer_size);
   }
 
   if (item->priority_data && cache->prioritydeleterfp) {
@@ -174,6 +355,8 @@ static void IMB_moviecache_destructor(void *p)
     PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
     IMB_freeImBuf(item->ibuf);
+    consumer_item_remove(cache->consumer, item->consumer_size);
+    IMB_moviecache_consumer_tag_evicted(cache->consumer, 1);
 
     item->ibuf = NULL;
     item->c_handle = NULL;
@@ -221,10 +404,16 @@ static int get_item_priority(void *item_v, int default_priority)
           item,
           default_priority);
 
-    return default_priority;
+    priority = default_priority;
+  }
+  else {
+    priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
   }
 
-  priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
+  /* Buffers of consumers which borrowed memory from others are freed first. */
+  if (consumer_is_over_quota(cache->consumer)) {
+    priority -= INT_MAX / 2;
+  }
 
   PRINT("%s: cache '%s' item %p priority %d\n", __func__, cache->name, item, priority);
 
@@ -260,6 +449,18 @@ void IMB_moviecache_destruct(void)
   }
 }
 
+/* Free buffers to make room for memory reported by external consumers. */
+void IMB_moviecache_enforce_limits(void)
+{
+  if (!limitor) {
+    return;
+  }
+
+  BLI_mutex_lock(&limitor_lock);
+  MEM_CacheLimiter_enforce_limits_ex(limitor, moviecache_memory_limit());
+  BLI_mutex_unlock(&limitor_lock);
+}
+
 MovieCache *IMB_moviecache_create(const char *name,
                                   int keysize,
                                   GHashHashFP hashfp,
@@ -283,10 +484,18 @@ MovieCache *IMB_moviecache_create(const char *name,
   cache->hashfp = hashfp;
   cache->cmpfp = cmpfp;
   cache->proxy = -1;
+  cache->consumer = MOVIECACHE_CONSUMER_IMAGE;
 
   return cache;
 }
 
+void IMB_moviecache_set_consumer(MovieCache *cache, eMovieCacheConsumer consumer)
+{
+  BLI_assert(!consumers[consumer].is_external);
+  BLI_assert(BLI_ghash_len(cache->hash) == 0);
+  cache->consumer = consumer;
+}
+
 void IMB_moviecache_set_getdata_callback(MovieCache *cache, MovieCacheGetKeyDataFP getdatafp)
 {
   cache->getdatafp = getdatafp;
@@ -328,6 +537,9 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
   item->cache_owner = cache;
   item->c_handle = NULL;
   item->priority_data = NULL;
+  item->consumer_size = get_size_in_memory(ibuf);
+
+  consumer_item_add(cache->consumer, item->consumer_size);
 
   if (cache->getprioritydatafp) {
     item->priority_data = cache->getprioritydatafp(userkey);
@@ -346,7 +558,7 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
   item->c_handle = MEM_CacheLimiter_insert(limitor, item);
 
   MEM_CacheLimiter_ref(item->c_handle);
-  MEM_CacheLimiter_enforce_limits(limitor);
+  MEM_CacheLimiter_enforce_limits_ex(limitor, moviecache_memory_limit());
   MEM_CacheLimiter_unref(item->c_handle);
 
   if (need_lock) {
@@ -373,9 +585,9 @@ bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibu
   bool result = false;
 
   elem_size = get_size_in_memory(ibuf);
-  mem_limit = MEM_CacheLimiter_get_maximum();
 
   BLI_mutex_lock(&limitor_lock);
+  mem_limit = moviecache_memory_limit();
   mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
 
   if (mem_in_use + elem_size <= mem_limit) {
@@ -412,11 +624,14 @@ ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
       BLI_mutex_unlock(&limitor_lock);
 
       IMB_refImBuf(item->ibuf);
+      IMB_moviecache_consumer_tag_lookup(cache->consumer, true);
 
       return item->ibuf;
     }
   }
 
+  IMB_moviecache_consumer_tag_lookup(cache->consumer, false);
+
   return NULL;
 }
 
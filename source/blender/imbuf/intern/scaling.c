@@ -22,8 +22,9 @@
  * \ingroup imbuf
  */
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
-#include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -35,6 +36,10 @@
 
 #include "BLI_sys_types.h"  // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 static void imb_half_x_no_alloc(struct ImBuf *ibuf2, struct ImBuf *ibuf1)
 {
   uchar *p1, *_p1, *dest;
@@ -476,1141 +481,421 @@ ImBuf *IMB_onehalf(struct ImBuf *ibuf1)
   return (ibuf2);
 }
 
-/* q_scale_linear_interpolation helper functions */
-
-static void enlarge_picture_byte(unsigned char *src,
-                                 unsigned char *dst,
-                                 int src_width,
-                                 int src_height,
-                                 int dst_width,
-                                 int dst_height)
+static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
-  double ratiox = (double)(dst_width - 1.0) / (double)(src_width - 1.001);
-  double ratioy = (double)(dst_height - 1.0) / (double)(src_height - 1.001);
-  uintptr_t x_src, dx_src, x_dst;
-  uintptr_t y_src, dy_src, y_dst;
-
-  dx_src = 65536.0 / ratiox;
-  dy_src = 65536.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    unsigned char *line1 = src + (y_src >> 16) * 4 * src_width;
-    unsigned char *line2 = line1 + 4 * src_width;
-    uintptr_t weight1y = 65536 - (y_src & 0xffff);
-    uintptr_t weight2y = 65536 - weight1y;
-
-    if ((y_src >> 16) == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      uintptr_t weight1x = 65536 - (x_src & 0xffff);
-      uintptr_t weight2x = 65536 - weight1x;
-
-      unsigned long x = (x_src >> 16) * 4;
-
-      *dst++ = ((((line1[x] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 1] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 1] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 1] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 1] * weight2y) >> 16) * weight2x) >> 16);
-
-      *dst++ = ((((line1[x + 2] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 2] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 2] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 2] * weight2y) >> 16) * weight2x) >> 16);
+  int *zbuf, *newzbuf, *_newzbuf = NULL;
+  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
+  int x, y;
+  int ofsx, ofsy, stepx, stepy;
 
-      *dst++ = ((((line1[x + 3] * weight1y) >> 16) * weight1x) >> 16) +
-               ((((line2[x + 3] * weight2y) >> 16) * weight1x) >> 16) +
-               ((((line1[4 + x + 3] * weight1y) >> 16) * weight2x) >> 16) +
-               ((((line2[4 + x + 3] * weight2y) >> 16) * weight2x) >> 16);
+  if (ibuf->zbuf) {
+    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
+    if (_newzbuf == NULL) {
+      IMB_freezbufImBuf(ibuf);
+    }
+  }
 
-      x_src += dx_src;
+  if (ibuf->zbuf_float) {
+    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
+    if (_newzbuf_float == NULL) {
+      IMB_freezbuffloatImBuf(ibuf);
     }
-    y_src += dy_src;
   }
-}
 
-struct scale_outpix_byte {
-  uintptr_t r;
-  uintptr_t g;
-  uintptr_t b;
-  uintptr_t a;
+  if (!_newzbuf && !_newzbuf_float) {
+    return;
+  }
 
-  uintptr_t weight;
-};
+  stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
+  stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
+  ofsy = 32768;
 
-static void shrink_picture_byte(unsigned char *src,
-                                unsigned char *dst,
-                                int src_width,
-                                int src_height,
-                                int dst_width,
-                                int dst_height)
-{
-  double ratiox = (double)(dst_width) / (double)(src_width);
-  double ratioy = (double)(dst_height) / (double)(src_height);
-  uintptr_t x_src, dx_dst, x_dst;
-  uintptr_t y_src, dy_dst, y_dst;
-  intptr_t y_counter;
-  unsigned char *dst_begin = dst;
-
-  struct scale_outpix_byte *dst_line1 = NULL;
-  struct scale_outpix_byte *dst_line2 = NULL;
-
-  dst_line1 = (struct scale_outpix_byte *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_byte), "shrink_picture_byte 1");
-  dst_line2 = (struct scale_outpix_byte *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_byte), "shrink_picture_byte 2");
-
-  dx_dst = 65536.0 * ratiox;
-  dy_dst = 65536.0 * ratioy;
-
-  y_dst = 0;
-  y_counter = 65536;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    unsigned char *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 65535 - (y_dst & 0xffff);
-    uintptr_t weight2y = 65535 - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 65535 - (x_dst & 0xffff);
-      uintptr_t weight2x = 65535 - weight1x;
-
-      uintptr_t x = x_dst >> 16;
-
-      uintptr_t w;
-
-      w = (weight1y * weight1x) >> 16;
-
-      /* Ensure correct rounding, without this you get ugly banding,
-       * or too low color values (ton). */
-      dst_line1[x].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x].weight += w;
-
-      w = (weight2y * weight1x) >> 16;
-
-      dst_line2[x].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x].weight += w;
-
-      w = (weight1y * weight2x) >> 16;
-
-      dst_line1[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line1[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line1[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line1[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line1[x + 1].weight += w;
-
-      w = (weight2y * weight2x) >> 16;
-
-      dst_line2[x + 1].r += (line[0] * w + 32767) >> 16;
-      dst_line2[x + 1].g += (line[1] * w + 32767) >> 16;
-      dst_line2[x + 1].b += (line[2] * w + 32767) >> 16;
-      dst_line2[x + 1].a += (line[3] * w + 32767) >> 16;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
+  newzbuf = _newzbuf;
+  newzbuf_float = _newzbuf_float;
 
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      int val;
-      uintptr_t x;
-      struct scale_outpix_byte *temp;
-
-      y_counter += 65536;
-
-      for (x = 0; x < dst_width; x++) {
-        uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-        *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-        *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
+  for (y = newy; y > 0; y--, ofsy += stepy) {
+    if (newzbuf) {
+      zbuf = ibuf->zbuf;
+      zbuf += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf++ = zbuf[ofsx >> 16];
       }
-      memset(dst_line1, 0, dst_width * sizeof(struct scale_outpix_byte));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
     }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    int val;
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      uintptr_t f = 0x80000000UL / dst_line1[x].weight;
-      *dst++ = (val = (dst_line1[x].r * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].g * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].b * f) >> 15) > 255 ? 255 : val;
-      *dst++ = (val = (dst_line1[x].a * f) >> 15) > 255 ? 255 : val;
+
+    if (newzbuf_float) {
+      zbuf_float = ibuf->zbuf_float;
+      zbuf_float += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf_float++ = zbuf_float[ofsx >> 16];
+      }
     }
   }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
-}
 
-static void q_scale_byte(unsigned char *in,
-                         unsigned char *out,
-                         int in_width,
-                         int in_height,
-                         int dst_width,
-                         int dst_height)
-{
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
-  }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_byte(in, out, in_width, in_height, dst_width, dst_height);
+  if (_newzbuf) {
+    IMB_freezbufImBuf(ibuf);
+    ibuf->mall |= IB_zbuf;
+    ibuf->zbuf = _newzbuf;
   }
-}
-
-static void enlarge_picture_float(
-    float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
-{
-  double ratiox = (double)(dst_width - 1.0) / (double)(src_width - 1.001);
-  double ratioy = (double)(dst_height - 1.0) / (double)(src_height - 1.001);
-  uintptr_t x_dst;
-  uintptr_t y_dst;
-  double x_src, dx_src;
-  double y_src, dy_src;
-
-  dx_src = 1.0 / ratiox;
-  dy_src = 1.0 / ratioy;
-
-  y_src = 0;
-  for (y_dst = 0; y_dst < dst_height; y_dst++) {
-    float *line1 = src + ((int)y_src) * 4 * src_width;
-    const float *line2 = line1 + 4 * src_width;
-    const float weight1y = (float)(1.0 - (y_src - (int)y_src));
-    const float weight2y = 1.0f - weight1y;
-
-    if ((int)y_src == src_height - 1) {
-      line2 = line1;
-    }
-
-    x_src = 0;
-    for (x_dst = 0; x_dst < dst_width; x_dst++) {
-      const float weight1x = (float)(1.0 - (x_src - (int)x_src));
-      const float weight2x = (float)(1.0f - weight1x);
-
-      const float w11 = weight1y * weight1x;
-      const float w21 = weight2y * weight1x;
-      const float w12 = weight1y * weight2x;
-      const float w22 = weight2y * weight2x;
-
-      uintptr_t x = ((int)x_src) * 4;
-
-      *dst++ = line1[x] * w11 + line2[x] * w21 + line1[4 + x] * w12 + line2[4 + x] * w22;
-
-      *dst++ = line1[x + 1] * w11 + line2[x + 1] * w21 + line1[4 + x + 1] * w12 +
-               line2[4 + x + 1] * w22;
-
-      *dst++ = line1[x + 2] * w11 + line2[x + 2] * w21 + line1[4 + x + 2] * w12 +
-               line2[4 + x + 2] * w22;
-
-      *dst++ = line1[x + 3] * w11 + line2[x + 3] * w21 + line1[4 + x + 3] * w12 +
-               line2[4 + x + 3] * w22;
 
-      x_src += dx_src;
-    }
-    y_src += dy_src;
+  if (_newzbuf_float) {
+    IMB_freezbuffloatImBuf(ibuf);
+    ibuf->mall |= IB_zbuffloat;
+    ibuf->zbuf_float = _newzbuf_float;
   }
 }
 
-struct scale_outpix_float {
-  float r;
-  float g;
-  float b;
-  float a;
+/* ******** filtered scaling ******** */
 
-  float weight;
-};
+/* Separable resampling: rows are filtered horizontally into an intermediate float buffer,
+ * which is then filtered vertically into the final buffer. Filter weights are computed once
+ * per output column/row, both passes are multi-threaded over rows. */
 
-static void shrink_picture_float(
-    const float *src, float *dst, int src_width, int src_height, int dst_width, int dst_height)
-{
-  double ratiox = (double)(dst_width) / (double)(src_width);
-  double ratioy = (double)(dst_height) / (double)(src_height);
-  uintptr_t x_src;
-  uintptr_t y_src;
-  float dx_dst, x_dst;
-  float dy_dst, y_dst;
-  float y_counter;
-  const float *dst_begin = dst;
-
-  struct scale_outpix_float *dst_line1;
-  struct scale_outpix_float *dst_line2;
-
-  dst_line1 = (struct scale_outpix_float *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_float), "shrink_picture_float 1");
-  dst_line2 = (struct scale_outpix_float *)MEM_callocN(
-      (dst_width + 1) * sizeof(struct scale_outpix_float), "shrink_picture_float 2");
-
-  dx_dst = ratiox;
-  dy_dst = ratioy;
-
-  y_dst = 0;
-  y_counter = 1.0;
-  for (y_src = 0; y_src < src_height; y_src++) {
-    const float *line = src + y_src * 4 * src_width;
-    uintptr_t weight1y = 1.0f - (y_dst - (int)y_dst);
-    uintptr_t weight2y = 1.0f - weight1y;
-    x_dst = 0;
-    for (x_src = 0; x_src < src_width; x_src++) {
-      uintptr_t weight1x = 1.0f - (x_dst - (int)x_dst);
-      uintptr_t weight2x = 1.0f - weight1x;
-
-      uintptr_t x = (int)x_dst;
-
-      float w;
-
-      w = weight1y * weight1x;
-
-      dst_line1[x].r += line[0] * w;
-      dst_line1[x].g += line[1] * w;
-      dst_line1[x].b += line[2] * w;
-      dst_line1[x].a += line[3] * w;
-      dst_line1[x].weight += w;
-
-      w = weight2y * weight1x;
-
-      dst_line2[x].r += line[0] * w;
-      dst_line2[x].g += line[1] * w;
-      dst_line2[x].b += line[2] * w;
-      dst_line2[x].a += line[3] * w;
-      dst_line2[x].weight += w;
-
-      w = weight1y * weight2x;
-
-      dst_line1[x + 1].r += line[0] * w;
-      dst_line1[x + 1].g += line[1] * w;
-      dst_line1[x + 1].b += line[2] * w;
-      dst_line1[x + 1].a += line[3] * w;
-      dst_line1[x + 1].weight += w;
-
-      w = weight2y * weight2x;
-
-      dst_line2[x + 1].r += line[0] * w;
-      dst_line2[x + 1].g += line[1] * w;
-      dst_line2[x + 1].b += line[2] * w;
-      dst_line2[x + 1].a += line[3] * w;
-      dst_line2[x + 1].weight += w;
-
-      x_dst += dx_dst;
-      line += 4;
-    }
-
-    y_dst += dy_dst;
-    y_counter -= dy_dst;
-    if (y_counter < 0) {
-      uintptr_t x;
-      struct scale_outpix_float *temp;
-
-      y_counter += 1.0f;
+typedef struct ScaleFilterWeights {
+  /* First source pixel and number of source pixels contributing to each output pixel. */
+  int *first;
+  int *num;
+  /* Normalized weights, `taps` per output pixel. */
+  float *weights;
+  int taps;
+} ScaleFilterWeights;
 
-      for (x = 0; x < dst_width; x++) {
-        float f = 1.0f / dst_line1[x].weight;
-        *dst++ = dst_line1[x].r * f;
-        *dst++ = dst_line1[x].g * f;
-        *dst++ = dst_line1[x].b * f;
-        *dst++ = dst_line1[x].a * f;
-      }
-      memset(dst_line1, 0, dst_width * sizeof(struct scale_outpix_float));
-      temp = dst_line1;
-      dst_line1 = dst_line2;
-      dst_line2 = temp;
-    }
-  }
-  if (dst - dst_begin < dst_width * dst_height * 4) {
-    uintptr_t x;
-    for (x = 0; x < dst_width; x++) {
-      float f = 1.0f / dst_line1[x].weight;
-      *dst++ = dst_line1[x].r * f;
-      *dst++ = dst_line1[x].g * f;
-      *dst++ = dst_line1[x].b * f;
-      *dst++ = dst_line1[x].a * f;
-    }
-  }
-  MEM_freeN(dst_line1);
-  MEM_freeN(dst_line2);
+static float scale_filter_radius(eIMBScaleFilter filter)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return 0.5f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_BICUBIC:
+      return 2.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+  }
+  return 1.0f;
 }
 
-static void q_scale_float(
-    float *in, float *out, int in_width, int in_height, int dst_width, int dst_height)
+static float scale_filter_sinc(float x)
 {
-  if (dst_width > in_width && dst_height > in_height) {
-    enlarge_picture_float(in, out, in_width, in_height, dst_width, dst_height);
-  }
-  else if (dst_width < in_width && dst_height < in_height) {
-    shrink_picture_float(in, out, in_width, in_height, dst_width, dst_height);
+  if (x == 0.0f) {
+    return 1.0f;
   }
+  x *= (float)M_PI;
+  return sinf(x) / x;
 }
 
-/**
- * q_scale_linear_interpolation (derived from ppmqscale, http://libdv.sf.net)
- *
- * q stands for quick _and_ quality :)
- *
- * only handles common cases when we either
- *
- * scale  both, x and y or
- * shrink both, x and y
- *
- * but that is pretty fast:
- * - does only blit once instead of two passes like the old code
- *   (fewer cache misses)
- * - uses fixed point integer arithmetic for byte buffers
- * - doesn't branch in tight loops
- *
- * Should be comparable in speed to the ImBuf ..._fast functions at least
- * for byte-buffers.
- *
- * NOTE: disabled, due to unacceptable inaccuracy and quality loss, see bug #18609 (ton)
- */
-static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
+static float scale_filter_eval(eIMBScaleFilter filter, float x)
 {
-  if ((newx >= ibuf->x && newy <= ibuf->y) || (newx <= ibuf->x && newy >= ibuf->y)) {
-    return false;
-  }
-
-  if (ibuf->rect) {
-    unsigned char *newrect = MEM_mallocN(newx * newy * sizeof(int), "q_scale rect");
-    q_scale_byte((unsigned char *)ibuf->rect, newrect, ibuf->x, ibuf->y, newx, newy);
-
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)newrect;
-  }
-  if (ibuf->rect_float) {
-    float *newrect = MEM_mallocN(newx * newy * 4 * sizeof(float), "q_scale rectfloat");
-    q_scale_float(ibuf->rect_float, newrect, ibuf->x, ibuf->y, newx, newy);
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = newrect;
-  }
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  return true;
+  x = fabsf(x);
+
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      /* Box is evaluated as pixel coverage, see #scale_filter_weights_init. */
+      return 1.0f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return (x < 1.0f) ? 1.0f - x : 0.0f;
+    case IMB_SCALE_FILTER_BICUBIC:
+      /* Catmull-Rom spline. */
+      if (x < 1.0f) {
+        return (1.5f * x - 2.5f) * x * x + 1.0f;
+      }
+      if (x < 2.0f) {
+        return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+      }
+      return 0.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return (x < 3.0f) ? scale_filter_sinc(x) * scale_filter_sinc(x / 3.0f) : 0.0f;
+  }
+  return 0.0f;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+static void scale_filter_weights_init(ScaleFilterWeights *fw,
+                                      eIMBScaleFilter filter,
+                                      int src_size,
+                                      int dst_size)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return (ibuf);
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(uchar) * 4, "scaledownx");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
-  }
-
-  add = (ibuf->x - 0.01) / newx;
-
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
-  }
-
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+  const float scale = (float)src_size / (float)dst_size;
+  /* Widen the filter when shrinking to avoid aliasing. */
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = scale_filter_radius(filter) * filter_scale;
 
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+  fw->taps = (int)ceilf(support) * 2 + 1;
+  fw->first = MEM_mallocN(sizeof(int) * dst_size, "scale filter first");
+  fw->num = MEM_mallocN(sizeof(int) * dst_size, "scale filter num");
+  fw->weights = MEM_calloc_arrayN(
+      (size_t)dst_size * fw->taps, sizeof(float), "scale filter weights");
 
-      sample += add;
+  for (int i = 0; i < dst_size; i++) {
+    const float center = ((float)i + 0.5f) * scale;
+    int left = (int)floorf(center - support);
+    int right = (int)ceilf(center + support);
+    float *weights = fw->weights + (size_t)i * fw->taps;
+    float total = 0.0f;
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+    CLAMP_MIN(left, 0);
+    CLAMP_MAX(right, src_size);
+    CLAMP_MAX(right, left + fw->taps);
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
+    for (int j = left; j < right; j++) {
+      float weight;
+      if (filter == IMB_SCALE_FILTER_BOX) {
+        /* Area of source pixel covered by the output pixel. */
+        weight = min_ff((float)j + 1.0f, center + support) - max_ff((float)j, center - support);
+        CLAMP_MIN(weight, 0.0f);
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += 4;
+      else {
+        weight = scale_filter_eval(filter, ((float)j + 0.5f - center) / filter_scale);
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+      weights[j - left] = weight;
+      total += weight;
+    }
 
-        newrectf += 4;
-      }
+    if (total == 0.0f) {
+      /* Can only happen for degenerate sizes, fall back to nearest pixel. */
+      left = min_ii((int)center, src_size - 1);
+      right = left + 1;
+      weights[0] = 1.0f;
+      total = 1.0f;
+    }
 
-      sample -= 1.0f;
+    for (int j = 0; j < right - left; j++) {
+      weights[j] /= total;
     }
-  }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    fw->first[i] = left;
+    fw->num[i] = right - left;
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->x = newx;
-  return (ibuf);
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+static void scale_filter_weights_free(ScaleFilterWeights *fw)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return (ibuf);
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(newy * ibuf->x * sizeof(uchar) * 4, "scaledowny");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(newy * ibuf->x * sizeof(float) * 4, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
-  }
-
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
+  MEM_freeN(fw->first);
+  MEM_freeN(fw->num);
+  MEM_freeN(fw->weights);
+}
 
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
-    }
+typedef struct ScaleFilterData {
+  int channels;
 
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+  int src_x, src_y;
+  int dst_x, dst_y;
 
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
-
-      sample += add;
+  const unsigned char *src_byte;
+  const float *src_float;
+  /* Horizontally filtered rows, dst_x * src_y pixels. */
+  float *tmp;
+  unsigned char *dst_byte;
+  float *dst_float;
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+  const ScaleFilterWeights *weights_x;
+  const ScaleFilterWeights *weights_y;
+} ScaleFilterData;
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
+static void scale_filter_row_x_cb(void *__restrict userdata,
+                                  const int y,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFilterData *data = userdata;
+  const ScaleFilterWeights *fw = data->weights_x;
+  const int channels = data->channels;
+  const size_t src_row = (size_t)y * data->src_x * channels;
+  float *out = data->tmp + (size_t)y * data->dst_x * channels;
+
+  for (int x = 0; x < data->dst_x; x++, out += channels) {
+    const float *weights = fw->weights + (size_t)x * fw->taps;
+    const size_t first = src_row + (size_t)fw->first[x] * channels;
+    const int num = fw->num[x];
+
+#ifdef __SSE2__
+    if (channels == 4) {
+      __m128 acc = _mm_setzero_ps();
+      if (data->src_float) {
+        const float *in = data->src_float + first;
+        for (int k = 0; k < num; k++, in += 4) {
+          acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(in)));
         }
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-        newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-        newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-        newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-
-        newrect += skipx;
+      else {
+        const __m128i zero = _mm_setzero_si128();
+        const unsigned char *in = data->src_byte + first;
+        for (int k = 0; k < num; k++, in += 4) {
+          int pixel;
+          memcpy(&pixel, in, sizeof(pixel));
+          __m128i pixel_i = _mm_unpacklo_epi16(
+              _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero), zero);
+          acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_cvtepi32_ps(pixel_i)));
+        }
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+      _mm_storeu_ps(out, acc);
+      continue;
+    }
+#endif
 
-        newrectf += skipx;
+    for (int c = 0; c < channels; c++) {
+      out[c] = 0.0f;
+    }
+    for (int k = 0; k < num; k++) {
+      const size_t offset = first + (size_t)k * channels;
+      for (int c = 0; c < channels; c++) {
+        const float value = data->src_float ? data->src_float[offset + c] :
+                                              (float)data->src_byte[offset + c];
+        out[c] += weights[k] * value;
       }
-
-      sample -= 1.0f;
     }
   }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug [#26502] */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug [#26502] */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return (ibuf);
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+static void scale_filter_row_y_cb(void *__restrict userdata,
+                                  const int y,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
+  const ScaleFilterData *data = userdata;
+  const ScaleFilterWeights *fw = data->weights_y;
+  const size_t row_len = (size_t)data->dst_x * data->channels;
+  const float *weights = fw->weights + (size_t)y * fw->taps;
+  float *out;
 
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return (NULL);
+  if (data->dst_float) {
+    out = data->dst_float + (size_t)y * row_len;
   }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return (ibuf);
+  else {
+    out = MEM_mallocN(sizeof(float) * row_len, "scale filter row");
   }
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
+  /* Accumulate whole rows so the inner loop is contiguous and gets vectorized. */
+  const float *in = data->tmp + (size_t)fw->first[y] * row_len;
+  for (size_t i = 0; i < row_len; i++) {
+    out[i] = weights[0] * in[i];
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(newx * ibuf->y * sizeof(float) * 4, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
+  for (int k = 1; k < fw->num[y]; k++) {
+    in += row_len;
+    const float weight = weights[k];
+    for (size_t i = 0; i < row_len; i++) {
+      out[i] += weight * in[i];
     }
   }
 
-  add = (ibuf->x - 1.001) / (newx - 1.0);
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
-
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
+  if (data->dst_byte) {
+    unsigned char *out_byte = data->dst_byte + (size_t)y * row_len;
+    for (size_t i = 0; i < row_len; i++) {
+      out_byte[i] = unit_float_to_uchar_clamp(out[i] * (1.0f / 255.0f));
     }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
+    MEM_freeN(out);
+  }
+}
 
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
+static void scale_filter_buffer(ScaleFilterData *data)
+{
+  TaskParallelSettings settings;
 
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
+  data->tmp = MEM_mallocN(
+      sizeof(float) * data->channels * (size_t)data->dst_x * data->src_y, "scale filter tmp");
 
-      rectf += 8;
-    }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
-      }
-      sample += add;
-    }
-  }
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ((size_t)data->dst_x * data->src_y > 64 * 64);
+  BLI_task_parallel_range(0, data->src_y, data, scale_filter_row_x_cb, &settings);
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
+  settings.use_threading = ((size_t)data->dst_x * data->dst_y > 64 * 64);
+  BLI_task_parallel_range(0, data->dst_y, data, scale_filter_row_y_cb, &settings);
 
-  ibuf->x = newx;
-  return (ibuf);
+  MEM_freeN(data->tmp);
+  data->tmp = NULL;
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+static bool imb_scale_filtered(struct ImBuf *ibuf,
+                               unsigned int newx,
+                               unsigned int newy,
+                               eIMBScaleFilter filter_x,
+                               eIMBScaleFilter filter_y)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
+  ScaleFilterWeights weights_x, weights_y;
+  unsigned char *dst_byte = NULL;
+  float *dst_float = NULL;
+
   if (ibuf == NULL) {
-    return (NULL);
+    return false;
   }
   if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return (ibuf);
+    return false;
   }
-
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return (ibuf);
-    }
+  if (newx == 0) {
+    newx = ibuf->x;
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(ibuf->x * newy * sizeof(float) * 4, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return (ibuf);
-    }
+  if (newy == 0) {
+    newy = ibuf->y;
+  }
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
   }
 
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (x = ibuf->x; x > 0; x--) {
-
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
+  scale_filter_weights_init(&weights_x, filter_x, ibuf->x, newx);
+  scale_filter_weights_init(&weights_y, filter_y, ibuf->y, newy);
 
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
+  ScaleFilterData data = {
+      .src_x = ibuf->x,
+      .src_y = ibuf->y,
+      .dst_x = newx,
+      .dst_y = newy,
+      .weights_x = &weights_x,
+      .weights_y = &weights_y,
+  };
 
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
+  if (ibuf->rect) {
+    dst_byte = MEM_mallocN(sizeof(char) * 4 * newx * newy, "scale filter byte buffer");
+    data.channels = 4;
+    data.src_byte = (unsigned char *)ibuf->rect;
+    data.src_float = NULL;
+    data.dst_byte = dst_byte;
+    data.dst_float = NULL;
+    scale_filter_buffer(&data);
+  }
 
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
+  if (ibuf->rect_float) {
+    dst_float = MEM_mallocN(
+        sizeof(float) * ibuf->channels * newx * newy, "scale filter float buffer");
+    data.channels = ibuf->channels;
+    data.src_byte = NULL;
+    data.src_float = ibuf->rect_float;
+    data.dst_byte = NULL;
+    data.dst_float = dst_float;
+    scale_filter_buffer(&data);
+  }
 
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
+  scale_filter_weights_free(&weights_x);
+  scale_filter_weights_free(&weights_y);
 
-      rectf += 2 * skipx;
-    }
+  /* Z-buffer is not filtered, scale it before ibuf->x and ibuf->y are changed. */
+  scalefast_Z_ImBuf(ibuf, newx, newy);
 
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
-    }
-  }
+  ibuf->x = newx;
+  ibuf->y = newy;
 
-  if (do_rect) {
+  if (dst_byte) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)dst_byte;
   }
-  if (do_float) {
+
+  if (dst_float) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = dst_float;
   }
 
-  ibuf->y = newy;
-  return (ibuf);
+  return true;
 }
 
-static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
+/**
+ * Scale \a ibuf using given reconstruction filter, both byte and float buffers are scaled.
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             eIMBScaleFilter filter)
 {
-  int *zbuf, *newzbuf, *_newzbuf = NULL;
-  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
-  int x, y;
-  int ofsx, ofsy, stepx, stepy;
-
-  if (ibuf->zbuf) {
-    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
-    if (_newzbuf == NULL) {
-      IMB_freezbufImBuf(ibuf);
-    }
-  }
-
-  if (ibuf->zbuf_float) {
-    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
-    if (_newzbuf_float == NULL) {
-      IMB_freezbuffloatImBuf(ibuf);
-    }
-  }
-
-  if (!_newzbuf && !_newzbuf_float) {
-    return;
-  }
-
-  stepx = (65536.0 * (ibuf->x - 1.0) / (newx - 1.0)) + 0.5;
-  stepy = (65536.0 * (ibuf->y - 1.0) / (newy - 1.0)) + 0.5;
-  ofsy = 32768;
-
-  newzbuf = _newzbuf;
-  newzbuf_float = _newzbuf_float;
-
-  for (y = newy; y > 0; y--, ofsy += stepy) {
-    if (newzbuf) {
-      zbuf = ibuf->zbuf;
-      zbuf += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf++ = zbuf[ofsx >> 16];
-      }
-    }
-
-    if (newzbuf_float) {
-      zbuf_float = ibuf->zbuf_float;
-      zbuf_float += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf_float++ = zbuf_float[ofsx >> 16];
-      }
-    }
-  }
-
-  if (_newzbuf) {
-    IMB_freezbufImBuf(ibuf);
-    ibuf->mall |= IB_zbuf;
-    ibuf->zbuf = _newzbuf;
-  }
-
-  if (_newzbuf_float) {
-    IMB_freezbuffloatImBuf(ibuf);
-    ibuf->mall |= IB_zbuffloat;
-    ibuf->zbuf_float = _newzbuf_float;
-  }
+  return imb_scale_filtered(ibuf, newx, newy, filter, filter);
 }
 
 /**
@@ -1618,41 +903,13 @@ static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  if (ibuf == NULL) {
-    return false;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return false;
-  }
-
-  if (newx == ibuf->x && newy == ibuf->y) {
-    return false;
-  }
-
-  /* Scale-up / scale-down functions below change ibuf->x and ibuf->y
-   * so we first scale the Z-buffer (if any). */
-  scalefast_Z_ImBuf(ibuf, newx, newy);
-
-  /* try to scale common cases in a fast way */
-  /* disabled, quality loss is unacceptable, see report #18609  (ton) */
-  if (0 && q_scale_linear_interpolation(ibuf, newx, newy)) {
-    return true;
-  }
-
-  if (newx && (newx < ibuf->x)) {
-    scaledownx(ibuf, newx);
-  }
-  if (newy && (newy < ibuf->y)) {
-    scaledowny(ibuf, newy);
-  }
-  if (newx && (newx > ibuf->x)) {
-    scaleupx(ibuf, newx);
-  }
-  if (newy && (newy > ibuf->y)) {
-    scaleupy(ibuf, newy);
-  }
+  /* Average covered pixels when shrinking, interpolate linearly when enlarging. */
+  const eIMBScaleFilter filter_x = (ibuf && newx < ibuf->x) ? IMB_SCALE_FILTER_BOX :
+                                                              IMB_SCALE_FILTER_BILINEAR;
+  const eIMBScaleFilter filter_y = (ibuf && newy < ibuf->y) ? IMB_SCALE_FILTER_BOX :
+                                                              IMB_SCALE_FILTER_BILINEAR;
 
-  return true;
+  return imb_scale_filtered(ibuf, newx, newy, filter_x, filter_y);
 }
 
 struct imbufRGBA {
@@ -1760,117 +1017,7 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
 
 /* ******** threaded scaling ******** */
 
-typedef struct ScaleTreadInitData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleTreadInitData;
-
-typedef struct ScaleThreadData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  int start_line;
-  int tot_line;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleThreadData;
-
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ScaleTreadInitData *init_data = (ScaleTreadInitData *)init_data_v;
-
-  data->ibuf = init_data->ibuf;
-
-  data->newx = init_data->newx;
-  data->newy = init_data->newy;
-
-  data->start_line = start_line;
-  data->tot_line = tot_line;
-
-  data->byte_buffer = init_data->byte_buffer;
-  data->float_buffer = init_data->float_buffer;
-}
-
-static void *do_scale_thread(void *data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ImBuf *ibuf = data->ibuf;
-  int i;
-  float factor_x = (float)ibuf->x / data->newx;
-  float factor_y = (float)ibuf->y / data->newy;
-
-  for (i = 0; i < data->tot_line; i++) {
-    int y = data->start_line + i;
-    int x;
-
-    for (x = 0; x < data->newx; x++) {
-      float u = (float)x * factor_x;
-      float v = (float)y * factor_y;
-      int offset = y * data->newx + x;
-
-      if (data->byte_buffer) {
-        unsigned char *pixel = data->byte_buffer + 4 * offset;
-        BLI_bilinear_interpolation_char(
-            (unsigned char *)ibuf->rect, pixel, ibuf->x, ibuf->y, 4, u, v);
-      }
-
-      if (data->float_buffer) {
-        float *pixel = data->float_buffer + ibuf->channels * offset;
-        BLI_bilinear_interpolation_fl(
-            ibuf->rect_float, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-      }
-    }
-  }
-
-  return NULL;
-}
-
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  ScaleTreadInitData init_data = {NULL};
-
-  /* prepare initialization data */
-  init_data.ibuf = ibuf;
-
-  init_data.newx = newx;
-  init_data.newy = newy;
-
-  if (ibuf->rect) {
-    init_data.byte_buffer = MEM_mallocN(4 * newx * newy * sizeof(char),
-                                        "threaded scale byte buffer");
-  }
-
-  if (ibuf->rect_float) {
-    init_data.float_buffer = MEM_mallocN(ibuf->channels * newx * newy * sizeof(float),
-                                         "threaded scale float buffer");
-  }
-
-  /* actual scaling threads */
-  IMB_processor_apply_threaded(
-      newy, sizeof(ScaleThreadData), &init_data, scale_thread_init, do_scale_thread);
-
-  /* alter image buffer */
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  if (ibuf->rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)init_data.byte_buffer;
-  }
-
-  if (ibuf->rect_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = init_data.float_buffer;
-  }
+  imb_scale_filtered(ibuf, newx, newy, IMB_SCALE_FILTER_BILINEAR, IMB_SCALE_FILTER_BILINEAR);
 }
@@ -253,6 +253,17 @@ static void rna_userdef_update(Main *UNUSED(bmain), Scene *UNUSED(scene), Pointe
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_userdef_display_transform_lut_update(Main *UNUSED(bmain),
+                                                     Scene *UNUSED(scene),
+                                                     PointerRNA *UNUSED(ptr))
+{
+  /* Cached display buffers know whether they were made with the LUT, redraw to update them. */
+  WM_main_add_notifier(NC_IMAGE | NA_EDITED, NULL);
+  WM_main_add_notifier(NC_SCENE | ND_SEQUENCER, NULL);
+  WM_main_add_notifier(NC_WINDOW, NULL);
+  USERDEF_TAG_DIRTY;
+}
+
 static void rna_userdef_theme_update(Main *bmain, Scene *scene, PointerRNA *ptr)
 {
   /* Recreate gizmos when changing themes. */
@@ -5263,6 +5274,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "use_display_transform_lut", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", USER_DISPLAY_TRANSFORM_LUT);
+  RNA_def_property_ui_text(prop,
+                           "Fast Display Transform",
+                           "Bake display transform into a 3D lookup table when drawing images "
+                           "and sequencer previews, faster for expensive views and looks at "
+                           "the cost of slight loss of accuracy");
+  RNA_def_property_update(prop, 0, "rna_userdef_display_transform_lut_update");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
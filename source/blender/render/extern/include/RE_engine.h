@@ -145,6 +145,8 @@ typedef struct RenderEngine {
 
   /* Depsgraph */
   struct Depsgraph *depsgraph;
+  /* Main database the depsgraph was built for, a kept depsgraph is rebuilt when it differs. */
+  struct Main *depsgraph_main;
 
   /* callback for render pass query */
   ThreadMutex update_render_passes_mutex;
@@ -159,6 +161,7 @@ typedef struct RenderEngine {
 
 RenderEngine *RE_engine_create(RenderEngineType *type);
 void RE_engine_free(RenderEngine *engine);
+void RE_engine_free_depsgraph(RenderEngine *engine);
 
 void RE_layer_load_from_file(
     struct RenderLayer *layer, struct ReportList *reports, const char *filename, int x, int y);
@@ -190,6 +190,10 @@ void RE_FreeAllRender(void);
  * Invoked when loading new file.
  */
 void RE_FreeAllPersistentData(void);
+/* Free dependency graphs kept by render engines with persistent data.
+ * Invoked on undo, which replaces the main database they were built for.
+ */
+void RE_FreeAllPersistentDepsgraphs(void);
 /* only call on file load */
 void RE_FreeAllRenderResults(void);
 /* for external render engines that can keep persistent data */
@@ -66,6 +66,8 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -113,6 +115,9 @@ typedef struct TriTessFace {
   bool is_smooth;
 } TriTessFace;
 
+/* Number of pixels handled by a single task when populating pixel arrays in parallel. */
+#define BAKE_PIXELS_PER_TASK 4096
+
 static void store_bake_pixel(void *handle, int x, int y, float u, float v)
 {
   BakeDataZSpan *bd = (BakeDataZSpan *)handle;
@@ -517,6 +522,107 @@ static TriTessFace *mesh_calc_tri_tessface(Mesh *me, bool tangent, Mesh *me_eval
   return triangles;
 }
 
+typedef struct BakeHighPolyRaycastData {
+  BakePixel *pixel_array_from;
+  BakePixel *pixel_array_to;
+  BakeHighPolyData *highpoly;
+  int tot_highpoly;
+  size_t num_pixels;
+  bool is_custom_cage;
+  bool is_cage;
+  float cage_extrusion;
+  float max_ray_distance;
+  float (*mat_low)[4];
+  float (*mat_cage)[4];
+  float (*imat_low)[4];
+  TriTessFace *tris_low;
+  TriTessFace *tris_cage;
+  TriTessFace **tris_high;
+  BVHTreeFromMesh *treeData;
+} BakeHighPolyRaycastData;
+
+static void bake_highpoly_raycast_cb(void *__restrict userdata,
+                                     const int task_index,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  BakeHighPolyRaycastData *data = userdata;
+  const size_t start = (size_t)task_index * BAKE_PIXELS_PER_TASK;
+  const size_t end = min_zz(start + BAKE_PIXELS_PER_TASK, data->num_pixels);
+
+  for (size_t i = start; i < end; i++) {
+    float co[3];
+    float dir[3];
+    TriTessFace *tri_low;
+
+    const int primitive_id = data->pixel_array_from[i].primitive_id;
+
+    if (primitive_id == -1) {
+      data->pixel_array_to[i].primitive_id = -1;
+      continue;
+    }
+
+    const float u = data->pixel_array_from[i].uv[0];
+    const float v = data->pixel_array_from[i].uv[1];
+
+    /* calculate from low poly mesh cage */
+    if (data->is_custom_cage) {
+      calc_point_from_barycentric_cage(data->tris_low,
+                                       data->tris_cage,
+                                       data->mat_low,
+                                       data->mat_cage,
+                                       primitive_id,
+                                       u,
+                                       v,
+                                       co,
+                                       dir);
+      tri_low = &data->tris_cage[primitive_id];
+    }
+    else if (data->is_cage) {
+      calc_point_from_barycentric_extrusion(data->tris_cage,
+                                            data->mat_low,
+                                            data->imat_low,
+                                            primitive_id,
+                                            u,
+                                            v,
+                                            data->cage_extrusion,
+                                            co,
+                                            dir,
+                                            true);
+      tri_low = &data->tris_cage[primitive_id];
+    }
+    else {
+      calc_point_from_barycentric_extrusion(data->tris_low,
+                                            data->mat_low,
+                                            data->imat_low,
+                                            primitive_id,
+                                            u,
+                                            v,
+                                            data->cage_extrusion,
+                                            co,
+                                            dir,
+                                            false);
+      tri_low = &data->tris_low[primitive_id];
+    }
+
+    /* cast ray */
+    if (!cast_ray_highpoly(data->treeData,
+                           tri_low,
+                           data->tris_high,
+                           data->pixel_array_from,
+                           data->pixel_array_to,
+                           data->mat_low,
+                           data->highpoly,
+                           co,
+                           dir,
+                           i,
+                           data->tot_highpoly,
+                           data->max_ray_distance)) {
+      /* if it fails mask out the original pixel array */
+      data->pixel_array_from[i].primitive_id = -1;
+    }
+  }
+}
+
 bool RE_bake_pixels_populate_from_objects(struct Mesh *me_low,
                                           BakePixel pixel_array_from[],
                                           BakePixel pixel_array_to[],
@@ -531,8 +637,6 @@ bool RE_bake_pixels_populate_from_objects(struct Mesh *me_low,
                                           struct Mesh *me_cage)
 {
   size_t i;
-  int primitive_id;
-  float u, v;
   float imat_low[4][4];
   bool is_cage = me_cage != NULL;
   bool result = true;
@@ -586,54 +690,31 @@ bool RE_bake_pixels_populate_from_objects(struct Mesh *me_low,
     }
   }
 
-  for (i = 0; i < num_pixels; i++) {
-    float co[3];
-    float dir[3];
-    TriTessFace *tri_low;
-
-    primitive_id = pixel_array_from[i].primitive_id;
-
-    if (primitive_id == -1) {
-      pixel_array_to[i].primitive_id = -1;
-      continue;
-    }
-
-    u = pixel_array_from[i].uv[0];
-    v = pixel_array_from[i].uv[1];
-
-    /* calculate from low poly mesh cage */
-    if (is_custom_cage) {
-      calc_point_from_barycentric_cage(
-          tris_low, tris_cage, mat_low, mat_cage, primitive_id, u, v, co, dir);
-      tri_low = &tris_cage[primitive_id];
-    }
-    else if (is_cage) {
-      calc_point_from_barycentric_extrusion(
-          tris_cage, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, true);
-      tri_low = &tris_cage[primitive_id];
-    }
-    else {
-      calc_point_from_barycentric_extrusion(
-          tris_low, mat_low, imat_low, primitive_id, u, v, cage_extrusion, co, dir, false);
-      tri_low = &tris_low[primitive_id];
-    }
-
-    /* cast ray */
-    if (!cast_ray_highpoly(treeData,
-                           tri_low,
-                           tris_high,
-                           pixel_array_from,
-                           pixel_array_to,
-                           mat_low,
-                           highpoly,
-                           co,
-                           dir,
-                           i,
-                           tot_highpoly,
-                           max_ray_distance)) {
-      /* if it fails mask out the original pixel array */
-      pixel_array_from[i].primitive_id = -1;
-    }
+  {
+    /* Pixels are independent, and the BVH trees are only read. */
+    BakeHighPolyRaycastData data = {
+        .pixel_array_from = pixel_array_from,
+        .pixel_array_to = pixel_array_to,
+        .highpoly = highpoly,
+        .tot_highpoly = tot_highpoly,
+        .num_pixels = num_pixels,
+        .is_custom_cage = is_custom_cage,
+        .is_cage = is_cage,
+        .cage_extrusion = cage_extrusion,
+        .max_ray_distance = max_ray_distance,
+        .mat_low = mat_low,
+        .mat_cage = mat_cage,
+        .imat_low = imat_low,
+        .tris_low = tris_low,
+        .tris_cage = tris_cage,
+        .tris_high = tris_high,
+        .treeData = treeData,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    const int num_tasks = (int)((num_pixels + BAKE_PIXELS_PER_TASK - 1) / BAKE_PIXELS_PER_TASK);
+    BLI_task_parallel_range(0, num_tasks, &data, bake_highpoly_raycast_cb, &settings);
   }
 
   /* garbage collection */
@@ -688,15 +769,69 @@ static void bake_differentials(BakeDataZSpan *bd,
   }
 }
 
+typedef struct BakeRasterizeData {
+  const MLoopUV *mloopuv;
+  const MLoopTri *looptri;
+  const int *tri_image_id;
+  const int *tri_primitive_id;
+  int tottri;
+  BakePixel *pixel_array;
+  const BakeImages *bake_images;
+} BakeRasterizeData;
+
+/* Rasterize the triangles of one image. Images cover separate ranges of the pixel array, so
+ * they can be filled in parallel, in the same triangle order as before. */
+static void bake_rasterize_image_cb(void *__restrict userdata,
+                                    const int image_id,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BakeRasterizeData *data = userdata;
+  BakeDataZSpan bd;
+  ZSpan zspan;
+  int i, a;
+
+  bd.pixel_array = data->pixel_array;
+  bd.zspan = &zspan;
+  bd.bk_image = &data->bake_images->data[image_id];
+
+  zbuf_alloc_span(&zspan, bd.bk_image->width, bd.bk_image->height);
+
+  for (i = 0; i < data->tottri; i++) {
+    const MLoopTri *lt = &data->looptri[i];
+    float vec[3][2];
+
+    if (data->tri_image_id[i] != image_id) {
+      continue;
+    }
+
+    bd.primitive_id = data->tri_primitive_id[i];
+
+    for (a = 0; a < 3; a++) {
+      const float *uv = data->mloopuv[lt->tri[a]].uv;
+
+      /* Note, workaround for pixel aligned UVs which are common and can screw up our
+       * intersection tests where a pixel gets in between 2 faces or the middle of a quad,
+       * camera aligned quads also have this problem but they are less common.
+       * Add a small offset to the UVs, fixes bug #18685 - Campbell */
+      vec[a][0] = uv[0] * (float)bd.bk_image->width - (0.5f + 0.001f);
+      vec[a][1] = uv[1] * (float)bd.bk_image->height - (0.5f + 0.002f);
+    }
+
+    bake_differentials(&bd, vec[0], vec[1], vec[2]);
+    zspan_scanconvert(&zspan, (void *)&bd, vec[0], vec[1], vec[2], store_bake_pixel);
+  }
+
+  zbuf_free_span(&zspan);
+}
+
 void RE_bake_pixels_populate(Mesh *me,
                              BakePixel pixel_array[],
                              const size_t num_pixels,
                              const BakeImages *bake_images,
                              const char *uv_layer)
 {
-  BakeDataZSpan bd;
   size_t i;
-  int a, p_id;
+  int p_id;
 
   const MLoopUV *mloopuv;
   const int tottri = poly_to_tri_count(me->totpoly, me->totloop);
@@ -714,59 +849,47 @@ void RE_bake_pixels_populate(Mesh *me,
     return;
   }
 
-  bd.pixel_array = pixel_array;
-  bd.zspan = MEM_callocN(sizeof(ZSpan) * bake_images->size, "bake zspan");
-
   /* initialize all pixel arrays so we know which ones are 'blank' */
   for (i = 0; i < num_pixels; i++) {
     pixel_array[i].primitive_id = -1;
     pixel_array[i].object_id = 0;
   }
 
-  for (i = 0; i < bake_images->size; i++) {
-    zbuf_alloc_span(&bd.zspan[i], bake_images->data[i].width, bake_images->data[i].height);
-  }
-
   looptri = MEM_mallocN(sizeof(*looptri) * tottri, __func__);
+  int *tri_image_id = MEM_mallocN(sizeof(int) * tottri, __func__);
+  int *tri_primitive_id = MEM_mallocN(sizeof(int) * tottri, __func__);
 
   BKE_mesh_recalc_looptri(me->mloop, me->mpoly, me->mvert, me->totloop, me->totpoly, looptri);
 
+  /* Primitive ids only count triangles with an image, assign them up front so images can be
+   * rasterized independently. */
   p_id = -1;
   for (i = 0; i < tottri; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const MPoly *mp = &me->mpoly[lt->poly];
-    float vec[3][2];
-    int mat_nr = mp->mat_nr;
-    int image_id = bake_images->lookup[mat_nr];
+    const MPoly *mp = &me->mpoly[looptri[i].poly];
+    const int image_id = bake_images->lookup[mp->mat_nr];
 
-    if (image_id < 0) {
-      continue;
-    }
-
-    bd.bk_image = &bake_images->data[image_id];
-    bd.primitive_id = ++p_id;
-
-    for (a = 0; a < 3; a++) {
-      const float *uv = mloopuv[lt->tri[a]].uv;
-
-      /* Note, workaround for pixel aligned UVs which are common and can screw up our
-       * intersection tests where a pixel gets in between 2 faces or the middle of a quad,
-       * camera aligned quads also have this problem but they are less common.
-       * Add a small offset to the UVs, fixes bug #18685 - Campbell */
-      vec[a][0] = uv[0] * (float)bd.bk_image->width - (0.5f + 0.001f);
-      vec[a][1] = uv[1] * (float)bd.bk_image->height - (0.5f + 0.002f);
-    }
-
-    bake_differentials(&bd, vec[0], vec[1], vec[2]);
-    zspan_scanconvert(&bd.zspan[image_id], (void *)&bd, vec[0], vec[1], vec[2], store_bake_pixel);
+    tri_image_id[i] = image_id;
+    tri_primitive_id[i] = (image_id < 0) ? -1 : ++p_id;
   }
 
-  for (i = 0; i < bake_images->size; i++) {
-    zbuf_free_span(&bd.zspan[i]);
-  }
+  BakeRasterizeData data = {
+      .mloopuv = mloopuv,
+      .looptri = looptri,
+      .tri_image_id = tri_image_id,
+      .tri_primitive_id = tri_primitive_id,
+      .tottri = tottri,
+      .pixel_array = pixel_array,
+      .bake_images = bake_images,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (bake_images->size > 1);
+  BLI_task_parallel_range(0, bake_images->size, &data, bake_rasterize_image_cb, &settings);
 
   MEM_freeN(looptri);
-  MEM_freeN(bd.zspan);
+  MEM_freeN(tri_image_id);
+  MEM_freeN(tri_primitive_id);
 }
 
 /* ******************** NORMALS ************************ */
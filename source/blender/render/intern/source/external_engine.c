@@ -142,6 +142,9 @@ RenderEngine *RE_engine_create(RenderEngineType *type)
 
 void RE_engine_free(RenderEngine *engine)
 {
+  /* Dependency graph kept alive for persistent data. */
+  RE_engine_free_depsgraph(engine);
+
 #ifdef WITH_PYTHON
   if (engine->py_instance) {
     BPY_DECREF_RNA_INVALIDATE(engine->py_instance);
@@ -591,12 +594,52 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+static void engine_depsgraph_free(RenderEngine *engine)
+{
+  if (engine->depsgraph) {
+    DEG_graph_free(engine->depsgraph);
+    engine->depsgraph = NULL;
+  }
+  engine->depsgraph_main = NULL;
+}
+
+/* Free the dependency graph kept for persistent data, when the data it was built for is about
+ * to be freed. */
+void RE_engine_free_depsgraph(RenderEngine *engine)
+{
+  engine_depsgraph_free(engine);
+}
+
+/* With persistent data the dependency graph is kept between frames of a final render, so that
+ * only what changed is evaluated again, and the render engine can update just that. */
+static bool engine_keep_depsgraph(RenderEngine *engine)
+{
+  Render *re = engine->re;
+  return (re->r.mode & R_PERSISTENT_DATA) && !(re->r.scemode & R_BUTS_PREVIEW);
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
   Main *bmain = engine->re->main;
   Scene *scene = engine->re->scene;
 
+  if (engine->depsgraph) {
+    /* Scene and view layer pointers can be reused by memfile undo, which reads a new main
+     * database. Data of the old one is freed, so the graph must be built again. */
+    if (engine_keep_depsgraph(engine) && engine->depsgraph_main == bmain &&
+        DEG_get_input_scene(engine->depsgraph) == scene &&
+        DEG_get_input_view_layer(engine->depsgraph) == view_layer) {
+      /* Keep recalc flags, they tell the render engine what changed since the previous frame.
+       * They are cleared once the frame is rendered. */
+      BKE_scene_graph_update_for_newframe_ex(engine->depsgraph, bmain, false);
+      return;
+    }
+
+    engine_depsgraph_free(engine);
+  }
+
   engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  engine->depsgraph_main = bmain;
   DEG_debug_name_set(engine->depsgraph, "RENDER");
 
   if (engine->re->r.scemode & R_BUTS_PREVIEW) {
@@ -611,13 +654,6 @@ static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
   }
 }
 
-static void engine_depsgraph_free(RenderEngine *engine)
-{
-  DEG_graph_free(engine->depsgraph);
-
-  engine->depsgraph = NULL;
-}
-
 void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
 {
   if (!engine->depsgraph) {
@@ -699,6 +735,7 @@ bool RE_bake_engine(Render *re,
   BLI_rw_mutex_unlock(&re->partsmutex);
 
   if (type->bake) {
+    engine_depsgraph_free(engine);
     engine->depsgraph = depsgraph;
 
     /* update is only called so we create the engine.session */
@@ -883,7 +920,14 @@ int RE_engine_render(Render *re, int do_all)
         DRW_render_gpencil(engine, engine->depsgraph);
       }
 
-      engine_depsgraph_free(engine);
+      /* A cancelled render may not have handled all changes, start over in that case. */
+      if (engine_keep_depsgraph(engine) && engine->depsgraph != NULL &&
+          !RE_engine_test_break(engine)) {
+        DEG_ids_clear_recalc(re->main, engine->depsgraph);
+      }
+      else {
+        engine_depsgraph_free(engine);
+      }
 
       if (RE_engine_test_break(engine)) {
         break;
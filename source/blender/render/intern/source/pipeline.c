@@ -677,6 +677,16 @@ void RE_FreeAllPersistentData(void)
   }
 }
 
+void RE_FreeAllPersistentDepsgraphs(void)
+{
+  Render *re;
+  for (re = RenderGlobal.renderlist.first; re != NULL; re = re->next) {
+    if (re->engine != NULL && !(re->engine->flag & RE_ENGINE_RENDERING)) {
+      RE_engine_free_depsgraph(re->engine);
+    }
+  }
+}
+
 /* on file load, free all re */
 void RE_FreeAllRenderResults(void)
 {
@@ -84,6 +84,7 @@
 #include "GPU_state.h"
 
 #include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
 
 #include "ED_numinput.h"
 #include "ED_screen.h"
@@ -3334,6 +3335,7 @@ static void WM_OT_redraw_timer(wmOperatorType *ot)
 static int memory_statistics_exec(bContext *UNUSED(C), wmOperator *UNUSED(op))
 {
   MEM_printmemlist_stats();
+  IMB_moviecache_print_stats();
   return OPERATOR_FINISHED;
 }
 
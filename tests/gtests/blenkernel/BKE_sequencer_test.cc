@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+
+#include "BKE_sequencer.h"
+
+#include "DNA_sequence_types.h"
+}
+
+TEST(sequencer_effect_inputs, ImageInputsThreaded)
+{
+  Sequence effect = {nullptr};
+  Sequence image1 = {nullptr};
+  Sequence image2 = {nullptr};
+  effect.type = SEQ_TYPE_CROSS;
+  image1.type = SEQ_TYPE_IMAGE;
+  image2.type = SEQ_TYPE_MOVIE;
+
+  Sequence *input[3] = {&image1, &image2, nullptr};
+  EXPECT_TRUE(BKE_sequencer_effect_inputs_can_render_threaded(&effect, input));
+}
+
+TEST(sequencer_effect_inputs, SceneInputSerial)
+{
+  Sequence effect = {nullptr};
+  Sequence image = {nullptr};
+  Sequence scene = {nullptr};
+  effect.type = SEQ_TYPE_CROSS;
+  image.type = SEQ_TYPE_IMAGE;
+  scene.type = SEQ_TYPE_SCENE;
+
+  Sequence *input[3] = {&image, &scene, nullptr};
+  EXPECT_FALSE(BKE_sequencer_effect_inputs_can_render_threaded(&effect, input));
+}
+
+TEST(sequencer_effect_inputs, StripMaskedInputSerial)
+{
+  Sequence effect = {nullptr};
+  Sequence image1 = {nullptr};
+  Sequence image2 = {nullptr};
+  Sequence mask_scene = {nullptr};
+  effect.type = SEQ_TYPE_CROSS;
+  image1.type = SEQ_TYPE_IMAGE;
+  image2.type = SEQ_TYPE_IMAGE;
+  mask_scene.type = SEQ_TYPE_SCENE;
+
+  /* A modifier masked by a strip renders that strip while rendering the input. */
+  SequenceModifierData smd = {nullptr};
+  smd.mask_input_type = SEQUENCE_MASK_INPUT_STRIP;
+  smd.mask_sequence = &mask_scene;
+  BLI_addtail(&image2.modifiers, &smd);
+
+  Sequence *input[3] = {&image1, &image2, nullptr};
+  EXPECT_FALSE(BKE_sequencer_effect_inputs_can_render_threaded(&effect, input));
+
+  /* Modifiers masked by a mask ID don't render other strips. */
+  smd.mask_input_type = SEQUENCE_MASK_INPUT_ID;
+  EXPECT_TRUE(BKE_sequencer_effect_inputs_can_render_threaded(&effect, input));
+}
@@ -0,0 +1,115 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_color_types.h"
+
+#include "IMB_colormanagement.h"
+#include "IMB_imbuf.h"
+}
+
+/* Baked display transform is only used for drawing, it has to be visually identical to the
+ * exact transform: within one step of 8 bit display buffer. */
+static const float LUT_EPSILON = 1.0f / 255.0f;
+
+class ColormanagementLUTTest : public testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    IMB_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    IMB_exit();
+  }
+
+  void SetUp() override
+  {
+    memset(&display_settings, 0, sizeof(display_settings));
+    STRNCPY(display_settings.display_device, IMB_colormanagement_display_get_default_name());
+    IMB_colormanagement_init_default_view_settings(&view_settings, &display_settings);
+  }
+
+  void compare_with_exact_transform()
+  {
+    ColormanageProcessor *exact = IMB_colormanagement_display_processor_new(&view_settings,
+                                                                             &display_settings);
+    ColormanageProcessor *baked = IMB_colormanagement_display_lut_processor_new(
+        &view_settings, &display_settings);
+
+    /* Walk over HDR range with different ratios between channels. */
+    unsigned int seed = 1;
+    for (int i = 0; i < 10000; i++) {
+      float pixel[4];
+      for (int c = 0; c < 3; c++) {
+        seed = seed * 1103515245 + 12345;
+        pixel[c] = powf(2.0f, ((float)(seed >> 8) / (float)(1 << 24)) * 16.0f - 12.0f);
+      }
+      pixel[3] = 1.0f;
+
+      float exact_pixel[4], baked_pixel[4];
+      copy_v4_v4(exact_pixel, pixel);
+      copy_v4_v4(baked_pixel, pixel);
+      IMB_colormanagement_processor_apply_v4(exact, exact_pixel);
+      IMB_colormanagement_processor_apply_v4(baked, baked_pixel);
+
+      for (int c = 0; c < 3; c++) {
+        EXPECT_NEAR(clamp_f(baked_pixel[c], 0.0f, 1.0f),
+                    clamp_f(exact_pixel[c], 0.0f, 1.0f),
+                    LUT_EPSILON);
+      }
+      EXPECT_EQ(baked_pixel[3], 1.0f);
+    }
+
+    IMB_colormanagement_processor_free(exact);
+    IMB_colormanagement_processor_free(baked);
+  }
+
+  ColorManagedDisplaySettings display_settings;
+  ColorManagedViewSettings view_settings;
+};
+
+TEST_F(ColormanagementLUTTest, DefaultView)
+{
+  compare_with_exact_transform();
+}
+
+TEST_F(ColormanagementLUTTest, ExposureAndGamma)
+{
+  view_settings.exposure = 1.5f;
+  view_settings.gamma = 0.8f;
+  compare_with_exact_transform();
+}
+
+TEST_F(ColormanagementLUTTest, Buffer)
+{
+  const int width = 64, height = 4;
+  float exact_buffer[width * height * 4], baked_buffer[width * height * 4];
+
+  for (int i = 0; i < width * height; i++) {
+    const float value = (float)i / (width * height) * 4.0f;
+    copy_v4_fl4(exact_buffer + i * 4, value, value * 0.5f, value * 0.25f, 0.5f);
+  }
+  memcpy(baked_buffer, exact_buffer, sizeof(exact_buffer));
+
+  ColormanageProcessor *exact = IMB_colormanagement_display_processor_new(&view_settings,
+                                                                           &display_settings);
+  ColormanageProcessor *baked = IMB_colormanagement_display_lut_processor_new(&view_settings,
+                                                                              &display_settings);
+  IMB_colormanagement_processor_apply(exact, exact_buffer, width, height, 4, true);
+  IMB_colormanagement_processor_apply(baked, baked_buffer, width, height, 4, true);
+  IMB_colormanagement_processor_free(exact);
+  IMB_colormanagement_processor_free(baked);
+
+  for (int i = 0; i < width * height * 4; i++) {
+    EXPECT_NEAR(clamp_f(baked_buffer[i], 0.0f, 1.0f),
+                clamp_f(exact_buffer[i], 0.0f, 1.0f),
+                LUT_EPSILON);
+  }
+}
@@ -0,0 +1,154 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+
+#include "MEM_CacheLimiterC-Api.h"
+
+extern "C" {
+#include "BLI_ghash.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
+}
+
+static unsigned int test_hashhash(const void *key)
+{
+  return (unsigned int)*(const int *)key;
+}
+
+static bool test_hashcmp(const void *a, const void *b)
+{
+  return *(const int *)a != *(const int *)b;
+}
+
+class MovieCacheTest : public testing::Test {
+ protected:
+  static const int BUFFER_SIZE = 64;
+
+  void SetUp() override
+  {
+    IMB_moviecache_init();
+
+    ImBuf *ibuf = create_buffer();
+    buffer_size = IMB_get_size_in_memory(ibuf);
+    IMB_freeImBuf(ibuf);
+
+    /* Room for ten buffers. */
+    MEM_CacheLimiter_set_maximum(buffer_size * 10);
+  }
+
+  void TearDown() override
+  {
+    IMB_moviecache_destruct();
+    MEM_CacheLimiter_set_maximum(0);
+  }
+
+  ImBuf *create_buffer()
+  {
+    return IMB_allocImBuf(BUFFER_SIZE, BUFFER_SIZE, 32, IB_rect);
+  }
+
+  MovieCache *create_cache(eMovieCacheConsumer consumer)
+  {
+    MovieCache *cache = IMB_moviecache_create("test", sizeof(int), test_hashhash, test_hashcmp);
+    IMB_moviecache_set_consumer(cache, consumer);
+    return cache;
+  }
+
+  void put_buffers(MovieCache *cache, int first, int num)
+  {
+    for (int i = first; i < first + num; i++) {
+      ImBuf *ibuf = create_buffer();
+      IMB_moviecache_put(cache, &i, ibuf);
+      IMB_freeImBuf(ibuf);
+    }
+  }
+
+  static MovieCacheStats stats_get(eMovieCacheConsumer consumer)
+  {
+    MovieCacheStats stats;
+    IMB_moviecache_consumer_stats_get(consumer, &stats);
+    return stats;
+  }
+
+  size_t buffer_size;
+};
+
+TEST_F(MovieCacheTest, Statistics)
+{
+  const MovieCacheStats before = stats_get(MOVIECACHE_CONSUMER_IMAGE);
+  MovieCache *cache = create_cache(MOVIECACHE_CONSUMER_IMAGE);
+
+  put_buffers(cache, 0, 2);
+
+  int key = 1;
+  ImBuf *ibuf = IMB_moviecache_get(cache, &key);
+  EXPECT_NE(ibuf, nullptr);
+  IMB_freeImBuf(ibuf);
+
+  key = 5;
+  EXPECT_EQ(IMB_moviecache_get(cache, &key), nullptr);
+
+  MovieCacheStats stats = stats_get(MOVIECACHE_CONSUMER_IMAGE);
+  EXPECT_EQ(stats.hits - before.hits, 1u);
+  EXPECT_EQ(stats.misses - before.misses, 1u);
+  EXPECT_EQ(stats.items - before.items, 2);
+  EXPECT_EQ(stats.memory_in_use - before.memory_in_use, buffer_size * 2);
+  EXPECT_EQ(stats.memory_quota / buffer_size, 3u);
+
+  IMB_moviecache_free(cache);
+
+  stats = stats_get(MOVIECACHE_CONSUMER_IMAGE);
+  EXPECT_EQ(stats.items, before.items);
+  EXPECT_EQ(stats.memory_in_use, before.memory_in_use);
+  EXPECT_EQ(stats.evictions, before.evictions);
+}
+
+TEST_F(MovieCacheTest, ExternalMemoryIsReserved)
+{
+  MovieCache *cache = create_cache(MOVIECACHE_CONSUMER_IMAGE);
+
+  /* Sequencer uses all of its quota, three buffers. */
+  const size_t sequencer_memory = stats_get(MOVIECACHE_CONSUMER_SEQUENCER).memory_quota;
+  IMB_moviecache_consumer_memory_add(MOVIECACHE_CONSUMER_SEQUENCER, sequencer_memory);
+
+  put_buffers(cache, 0, 10);
+
+  const MovieCacheStats stats = stats_get(MOVIECACHE_CONSUMER_IMAGE);
+  EXPECT_LE(stats.memory_in_use + sequencer_memory, buffer_size * 10);
+  EXPECT_GE(stats.evictions, 3u);
+
+  /* Sequencer can use its quota or memory which is not used by images. */
+  EXPECT_EQ(IMB_moviecache_consumer_memory_limit(MOVIECACHE_CONSUMER_SEQUENCER),
+            std::max(sequencer_memory, buffer_size * 10 - stats.memory_in_use));
+
+  IMB_moviecache_consumer_memory_remove(MOVIECACHE_CONSUMER_SEQUENCER, sequencer_memory);
+  IMB_moviecache_free(cache);
+}
+
+TEST_F(MovieCacheTest, OverQuotaConsumerIsEvictedFirst)
+{
+  MovieCache *image_cache = create_cache(MOVIECACHE_CONSUMER_IMAGE);
+  MovieCache *display_cache = create_cache(MOVIECACHE_CONSUMER_DISPLAY);
+
+  /* Display buffers borrow memory, their quota is one buffer. */
+  put_buffers(display_cache, 0, 8);
+  /* Images stay within their quota of three buffers. */
+  put_buffers(image_cache, 0, 3);
+
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(IMB_moviecache_has_frame(image_cache, &i));
+    ImBuf *ibuf = IMB_moviecache_get(image_cache, &i);
+    EXPECT_NE(ibuf, nullptr);
+    IMB_freeImBuf(ibuf);
+  }
+
+  EXPECT_LE(stats_get(MOVIECACHE_CONSUMER_DISPLAY).memory_in_use, buffer_size * 7);
+
+  IMB_moviecache_free(image_cache);
+  IMB_moviecache_free(display_cache);
+}
@@ -0,0 +1,77 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+}
+
+#define NUM_RUN_AVERAGED 5
+
+static const char *filter_names[] = {"box", "bilinear", "bicubic", "lanczos"};
+
+static ImBuf *create_noise_ibuf(int x, int y, int flags)
+{
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, flags);
+  unsigned int seed = 1;
+
+  for (size_t i = 0; i < (size_t)x * y * 4; i++) {
+    seed = seed * 1103515245 + 12345;
+    if (ibuf->rect) {
+      ((unsigned char *)ibuf->rect)[i] = (unsigned char)(seed >> 24);
+    }
+    if (ibuf->rect_float) {
+      ibuf->rect_float[i] = (float)(seed >> 8) / (float)(1 << 24);
+    }
+  }
+  return ibuf;
+}
+
+static void scaling_performance(const char *id, int flags, int x, int y, int newx, int newy)
+{
+  for (int filter = IMB_SCALE_FILTER_BOX; filter <= IMB_SCALE_FILTER_LANCZOS; filter++) {
+    double time_total = 0.0;
+
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      ImBuf *ibuf = create_noise_ibuf(x, y, flags);
+      const double time_start = PIL_check_seconds_timer();
+      IMB_scaleImBuf_filtered(ibuf, newx, newy, (eIMBScaleFilter)filter);
+      time_total += PIL_check_seconds_timer() - time_start;
+      IMB_freeImBuf(ibuf);
+    }
+
+    printf("%s %s %dx%d -> %dx%d: %fs\n",
+           id,
+           filter_names[filter],
+           x,
+           y,
+           newx,
+           newy,
+           time_total / NUM_RUN_AVERAGED);
+  }
+}
+
+TEST(imbuf_scaling, ByteDownscale4K)
+{
+  scaling_performance("byte", IB_rect, 3840, 2160, 1920, 1080);
+}
+
+TEST(imbuf_scaling, FloatDownscale4K)
+{
+  scaling_performance("float", IB_rectfloat, 3840, 2160, 1920, 1080);
+}
+
+TEST(imbuf_scaling, ByteDownscale8KProxy)
+{
+  scaling_performance("byte", IB_rect, 7680, 4320, 1920, 1080);
+}
+
+TEST(imbuf_scaling, FloatUpscale)
+{
+  scaling_performance("float", IB_rectfloat, 1920, 1080, 3840, 2160);
+}
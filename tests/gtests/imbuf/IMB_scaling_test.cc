@@ -0,0 +1,111 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_math_vector.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+static const eIMBScaleFilter filters[] = {
+    IMB_SCALE_FILTER_BOX,
+    IMB_SCALE_FILTER_BILINEAR,
+    IMB_SCALE_FILTER_BICUBIC,
+    IMB_SCALE_FILTER_LANCZOS,
+};
+
+static ImBuf *create_constant_ibuf(int x, int y, unsigned char byte_value, float float_value)
+{
+  ImBuf *ibuf = IMB_allocImBuf(x, y, 32, IB_rect | IB_rectfloat);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+
+  for (size_t i = 0; i < (size_t)x * y * 4; i++) {
+    rect[i] = byte_value;
+    ibuf->rect_float[i] = float_value;
+  }
+  return ibuf;
+}
+
+TEST(imbuf_scaling, ConstantImagePreserved)
+{
+  for (const eIMBScaleFilter filter : filters) {
+    /* Shrink in one axis, enlarge in the other. */
+    ImBuf *ibuf = create_constant_ibuf(37, 23, 200, 0.25f);
+
+    EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, 11, 50, filter));
+    EXPECT_EQ(ibuf->x, 11);
+    EXPECT_EQ(ibuf->y, 50);
+
+    unsigned char *rect = (unsigned char *)ibuf->rect;
+    for (size_t i = 0; i < (size_t)ibuf->x * ibuf->y * 4; i++) {
+      EXPECT_EQ(rect[i], 200);
+      EXPECT_NEAR(ibuf->rect_float[i], 0.25f, 1e-5f);
+    }
+
+    IMB_freeImBuf(ibuf);
+  }
+}
+
+TEST(imbuf_scaling, BoxAveragesCoveredPixels)
+{
+  ImBuf *ibuf = IMB_allocImBuf(4, 1, 32, IB_rectfloat);
+  for (int x = 0; x < 4; x++) {
+    copy_v4_fl(ibuf->rect_float + 4 * x, (float)x);
+  }
+
+  EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, 2, 1, IMB_SCALE_FILTER_BOX));
+  EXPECT_NEAR(ibuf->rect_float[0], 0.5f, 1e-6f);
+  EXPECT_NEAR(ibuf->rect_float[4], 2.5f, 1e-6f);
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, BilinearEnlargeInterpolates)
+{
+  ImBuf *ibuf = IMB_allocImBuf(4, 1, 32, IB_rectfloat);
+  for (int x = 0; x < 4; x++) {
+    copy_v4_fl(ibuf->rect_float + 4 * x, (float)x);
+  }
+
+  EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, 8, 1, IMB_SCALE_FILTER_BILINEAR));
+
+  const float expected[8] = {0.0f, 0.25f, 0.75f, 1.25f, 1.75f, 2.25f, 2.75f, 3.0f};
+  for (int x = 0; x < 8; x++) {
+    EXPECT_NEAR(ibuf->rect_float[4 * x], expected[x], 1e-6f);
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, ByteResultIsClamped)
+{
+  /* Sharp edge makes Lanczos and bicubic overshoot, byte result must not wrap around. */
+  ImBuf *ibuf = IMB_allocImBuf(16, 1, 32, IB_rect);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+  for (int x = 0; x < 16; x++) {
+    const unsigned char value = (x < 8) ? 0 : 255;
+    rect[4 * x + 0] = rect[4 * x + 1] = rect[4 * x + 2] = rect[4 * x + 3] = value;
+  }
+
+  EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, 37, 1, IMB_SCALE_FILTER_LANCZOS));
+
+  rect = (unsigned char *)ibuf->rect;
+  for (int x = 0; x < 14; x++) {
+    EXPECT_LT(rect[4 * x], 128);
+  }
+  for (int x = 24; x < 37; x++) {
+    EXPECT_GT(rect[4 * x], 128);
+  }
+
+  IMB_freeImBuf(ibuf);
+}
+
+TEST(imbuf_scaling, SameSizeIsNoop)
+{
+  ImBuf *ibuf = create_constant_ibuf(8, 8, 10, 1.0f);
+  EXPECT_FALSE(IMB_scaleImBuf_filtered(ibuf, 8, 8, IMB_SCALE_FILTER_LANCZOS));
+  IMB_freeImBuf(ibuf);
+}
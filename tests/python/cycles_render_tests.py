@@ -9,7 +9,7 @@ import subprocess
 import sys
 
 
-def get_arguments(filepath, output_filepath):
+def get_arguments(filepath, output_filepath, packet_tracing=False):
     dirname = os.path.dirname(filepath)
     basedir = os.path.dirname(dirname)
     subject = os.path.basename(dirname)
@@ -31,6 +31,17 @@ def get_arguments(filepath, output_filepath):
     if custom_args:
         args.extend(shlex.split(custom_args))
 
+    if packet_tracing:
+        # Debug options are only used with the debug preferences enabled. Packets are only
+        # traced with the BVH2 layout, the same references are used as for single rays.
+        args.extend([
+            "--python-expr",
+            "import bpy; "
+            "bpy.context.preferences.experimental.use_cycles_debug = True; "
+            "bpy.context.preferences.view.show_developer_ui = True; "
+            "bpy.context.scene.cycles.debug_bvh_layout = 'BVH2'; "
+            "bpy.context.scene.cycles.debug_use_cpu_packet_tracing = True"])
+
     if subject == 'bake':
         args.extend(['--python', os.path.join(basedir, "util", "render_bake.py")])
     elif subject == 'denoise_animation':
@@ -46,6 +57,7 @@ def create_argparse():
     parser.add_argument("-testdir", nargs=1)
     parser.add_argument("-outdir", nargs=1)
     parser.add_argument("-idiff", nargs=1)
+    parser.add_argument("-packet-tracing", action="store_true")
     return parser
 
 
@@ -59,11 +71,20 @@ def main():
     output_dir = args.outdir[0]
 
     from modules import render_report
-    report = render_report.Report("Cycles", output_dir, idiff)
+    packet_tracing = args.packet_tracing
+
+    def arguments_cb(filepath, output_filepath):
+        return get_arguments(filepath, output_filepath, packet_tracing)
+
+    title = "Cycles Packet Tracing" if packet_tracing else "Cycles"
+    report = render_report.Report(title, output_dir, idiff)
     report.set_pixelated(True)
     report.set_reference_dir("cycles_renders")
     report.set_compare_engines('cycles', 'eevee')
-    ok = report.run(test_dir, blender, get_arguments, batch=True)
+    if packet_tracing:
+        # References are only updated from single ray renders.
+        report.update = False
+    ok = report.run(test_dir, blender, arguments_cb, batch=True)
 
     sys.exit(not ok)
 